@@ -12,48 +12,263 @@
 #include "PluginEditor.h"
 #include <stdio.h>
 
+//==============================================================================
+// Decodes all of the samples in a dataset folder, one pool job per file, and hands the
+// finished set to the processor.  Long samples are only partly loaded, and the rest is
+// streamed from disk when they're played.
+class AutomelloPluginAudioProcessor::DatasetLoader  : public Thread
+{
+public:
+  DatasetLoader( AutomelloPluginAudioProcessor& owner_, const File& directory_ )
+    : Thread( "automello dataset loader" ),
+      owner( owner_ ),
+      directory( directory_ )
+  {
+  }
+
+  ~DatasetLoader()
+  {
+    stopThread( 10000 );
+  }
+
+  void run()
+  {
+    DirectoryIterator directoryIterator( directory, false, "*.wav", File::findFiles );
+    while (directoryIterator.next())
+    {
+      File theFileItFound( directoryIterator.getFile() );
+      int MIDINote = theFileItFound.getFileNameWithoutExtension().getIntValue();
+      if (MIDINote >= 0 && MIDINote < 128)
+      {
+        jobs.add( new SampleLoadJob( theFileItFound, MIDINote, *owner.sampleStreamer, owner.getSampleRate() ) );
+      }
+    }
+
+    ThreadPool decodePool( jmax( 1, SystemStats::getNumCpus() ) );
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+      decodePool.addJob( jobs.getUnchecked( i ) );
+    }
+
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+      while (! decodePool.waitForJobToFinish( jobs.getUnchecked( i ), 50 ))
+      {
+        if (threadShouldExit())
+        {
+          decodePool.removeAllJobs( true, 10000 );
+          return;
+        }
+      }
+    }
+
+    if (threadShouldExit())
+      return;
+
+    ReferenceCountedArray<SynthesiserSound> sounds;
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+      if (jobs.getUnchecked( i )->sound != nullptr)
+        sounds.add( jobs.getUnchecked( i )->sound );
+    }
+
+    owner.publishSounds( sounds );
+  }
+
+private:
+  class SampleLoadJob  : public ThreadPoolJob
+  {
+  public:
+    SampleLoadJob( const File& file_, int MIDINote_, SamplerStreamer& streamer_, double hostSampleRate_ )
+      : ThreadPoolJob( file_.getFileName() ),
+        file( file_ ),
+        MIDINote( MIDINote_ ),
+        streamer( streamer_ ),
+        hostSampleRate( hostSampleRate_ )
+    {
+    }
+
+    JobStatus runJob()
+    {
+      if (shouldExit())
+        return jobHasFinished;
+
+      // Mapping the file lets the samples be converted straight from the page cache; the
+      // stream reader is only needed if the file can't be mapped
+      WavAudioFormat wavFormat;
+      ScopedPointer<AudioFormatReader> audioReader( wavFormat.createMemoryMappedReader( file ) );
+
+      if (audioReader == nullptr)
+        audioReader = wavFormat.createReaderFor( new FileInputStream( file ), true );
+
+      if (audioReader != nullptr)
+      {
+        BigInteger whichNote;
+        whichNote.setRange( MIDINote, 1, true );
+
+        // The decoded audio comes from the shared cache, so any other instance that has
+        // already loaded this file saves us from decoding it again
+        const bool streamed = audioReader->lengthInSamples > streamingThresholdSeconds * audioReader->sampleRate;
+        const double secondsToLoad = streamed ? preloadSeconds : streamingThresholdSeconds;
+        SamplerSoundData::Ptr data( SampleCache::getFromFile( file, *audioReader,
+                                                              roundToInt( secondsToLoad * audioReader->sampleRate ) ) );
+
+        if (streamed)
+        {
+          sound = new StreamingSamplerSound (file.getFileNameWithoutExtension(),
+                                             audioReader.release(),
+                                             data,
+                                             whichNote,
+                                             MIDINote,   // root midi note
+                                             0.01,  // attack time
+                                             0.1,  // release time
+                                             streamer
+                                             );
+        }
+        else
+        {
+          SamplerSound* const samplerSound = new SamplerSound (file.getFileNameWithoutExtension(),
+                                                               data,
+                                                               whichNote,
+                                                               MIDINote,   // root midi note
+                                                               0.01,  // attack time
+                                                               0.1  // release time
+                                                               );
+          sound = samplerSound;
+          // We're already off the audio thread, so convert it to the host's rate here rather
+          // than leaving it to the next prepareToPlay
+          if (hostSampleRate > 0)
+            samplerSound->resampleTo( hostSampleRate );
+        }
+      }
+      return jobHasFinished;
+    }
+
+    const File file;
+    const int MIDINote;
+    SamplerStreamer& streamer;
+    const double hostSampleRate;
+    SynthesiserSound::Ptr sound;
+  };
+
+  // Samples longer than this are streamed from disk, keeping only the first
+  // preloadSeconds of them in memory
+  static const double streamingThresholdSeconds;
+  static const double preloadSeconds;
+
+  AutomelloPluginAudioProcessor& owner;
+  const File directory;
+  OwnedArray<SampleLoadJob> jobs;
+
+  JUCE_DECLARE_NON_COPYABLE (DatasetLoader);
+};
+
+const double AutomelloPluginAudioProcessor::DatasetLoader::streamingThresholdSeconds = 4.0;
+const double AutomelloPluginAudioProcessor::DatasetLoader::preloadSeconds = 1.0;
+
+//==============================================================================
+// Converts a set of sounds to the host's sample rate, so that the voices don't have to
+// interpolate them at their root note.  The sounds keep playing their current data until
+// each one has been converted.
+class AutomelloPluginAudioProcessor::ResampleJob  : public ThreadPoolJob
+{
+public:
+  ResampleJob( const ReferenceCountedArray<SynthesiserSound>& sounds_, double sampleRate_ )
+    : ThreadPoolJob( "automello resampler" ),
+      sounds( sounds_ ),
+      sampleRate( sampleRate_ )
+  {
+  }
+
+  JobStatus runJob()
+  {
+    for (int i = 0; i < sounds.size() && ! shouldExit(); ++i)
+    {
+      SamplerSound* const sound = dynamic_cast<SamplerSound*>( sounds.getUnchecked( i ).getObject() );
+      if (sound != nullptr)
+        sound->resampleTo( sampleRate );
+    }
+    return jobHasFinishedAndShouldBeDeleted;
+  }
+
+private:
+  ReferenceCountedArray<SynthesiserSound> sounds;
+  const double sampleRate;
+
+  JUCE_DECLARE_NON_COPYABLE (ResampleJob);
+};
+
 //==============================================================================
 AutomelloPluginAudioProcessor::AutomelloPluginAudioProcessor()
+  : interpolationMode( SamplerVoice::linearInterpolation ),
+    streamingThread( "automello sample streaming" ),
+    resamplingPool( 1 )
 {
   nVoices = 10;
+  // The loader thread changes the synth's sounds while it's playing, so the audio thread
+  // mustn't have to wait for it
+  synth.setRealtimeSafeMode( true );
+  // The interpolation parameter can be changed from the host's audio thread, so the sinc
+  // tables have to be built before that happens
+  SamplerVoice::createInterpolationTables();
   // Initialise the synth...
   for (int i = nVoices; --i >= 0;)
-    synth.addVoice( new SamplerVoice() );
+  {
+    SamplerVoice* const voice = new SamplerVoice();
+    samplerVoices.add( voice );
+    synth.addVoice( voice );
+  }
+  // ...with a stream for every voice
+  sampleStreamer = new SamplerStreamer( streamingThread, nVoices );
+  streamingThread.startThread();
 }
 
 AutomelloPluginAudioProcessor::~AutomelloPluginAudioProcessor()
 {
+  resamplingPool.removeAllJobs( true, 10000, true );
+  datasetLoader = nullptr;
+  // Leaving real-time-safe mode lets go of everything the synth was holding on to for
+  // the audio thread, so the sounds can be cleared straight away
+  synth.setRealtimeSafeMode( false );
+  // The streamed sounds have to go before the streamer does
+  synth.allNotesOff( 0, false );
+  synth.clearSounds();
+  sampleStreamer = nullptr;
+  streamingThread.stopThread( 5000 );
 }
 
 void AutomelloPluginAudioProcessor::setDirectory( File directory )
 {
-  synth.clearSounds();
-  DirectoryIterator directoryIterator( directory, false, "*.wav", File::findFiles );
-  while (directoryIterator.next())
-  {
-    File theFileItFound( directoryIterator.getFile() );
-    String MIDINoteText = theFileItFound.getFileNameWithoutExtension();
-    int MIDINote = MIDINoteText.getIntValue();
-    if (MIDINote >= 0 && MIDINote < 128)
-    {
-      WavAudioFormat wavFormat;
-        
-      ScopedPointer<AudioFormatReader> audioReader( wavFormat.createReaderFor( new FileInputStream( theFileItFound ), true ) );
-      
-      BigInteger whichNote;
-      whichNote.setRange( MIDINote, 1, true );
-      
-      synth.addSound (new SamplerSound (MIDINoteText,
-                                        *audioReader,
-                                        whichNote,
-                                        MIDINote,   // root midi note
-                                        0.01,  // attack time
-                                        0.1,  // release time
-                                        10.0  // maximum sample length
-                                        ));
+  // Abandon any dataset that's still loading before starting on the new one
+  datasetLoader = nullptr;
+  datasetLoader = new DatasetLoader( *this, directory );
+  datasetLoader->startThread();
+}
 
-    }
+void AutomelloPluginAudioProcessor::publishSounds( ReferenceCountedArray<SynthesiserSound>& newSounds )
+{
+  // The synth picks the new set up at the start of its next block, and releases the old
+  // sounds on the message thread once no voice is playing them
+  synth.swapSounds( newSounds );
+}
+
+void AutomelloPluginAudioProcessor::resampleSounds( double sampleRate )
+{
+  // Any conversion to the previous rate is no longer wanted
+  resamplingPool.removeAllJobs( true, 10000, true );
+
+  // The loader thread can swap the synth's sounds at any moment, so this works from a
+  // copy that keeps them alive.  Streamed sounds are left out - they always play at
+  // their file's own rate
+  ReferenceCountedArray<SynthesiserSound> sounds( synth.getSounds() );
+  for (int i = sounds.size(); --i >= 0;)
+  {
+    if (dynamic_cast<StreamingSamplerSound*>( sounds.getUnchecked( i ).getObject() ) != nullptr)
+      sounds.remove( i );
   }
+
+  if (sounds.size() > 0)
+    resamplingPool.addJob( new ResampleJob( sounds, sampleRate ) );
 }
 
 //==============================================================================
@@ -64,26 +279,50 @@ const String AutomelloPluginAudioProcessor::getName() const
 
 int AutomelloPluginAudioProcessor::getNumParameters()
 {
-    return 0;
+    return totalNumParams;
 }
 
 float AutomelloPluginAudioProcessor::getParameter (int index)
 {
-    return 0.0f;
+  if (index == interpolationParam)
+    return interpolationMode / (float) SamplerVoice::sincInterpolation;
+  return 0.0f;
 }
 
 void AutomelloPluginAudioProcessor::setParameter (int index, float newValue)
 {
+  if (index == interpolationParam)
+  {
+    // Spread the three modes evenly over the parameter's range
+    interpolationMode = (SamplerVoice::InterpolationMode) roundToInt( jlimit( 0.0f, 1.0f, newValue )
+                                                                      * SamplerVoice::sincInterpolation );
+    // Notes that are already sounding keep the mode they started with.  This can be
+    // called on the audio thread, so it uses our own list of the voices rather than
+    // asking the synth, which would mean taking its configuration lock
+    for (int i = samplerVoices.size(); --i >= 0;)
+      samplerVoices.getUnchecked( i )->setInterpolationMode( interpolationMode );
+  }
 }
 
 const String AutomelloPluginAudioProcessor::getParameterName (int index)
 {
-    return String::empty;
+  if (index == interpolationParam)
+    return "Interpolation";
+  return String::empty;
 }
 
 const String AutomelloPluginAudioProcessor::getParameterText (int index)
 {
-    return String::empty;
+  if (index == interpolationParam)
+  {
+    switch (interpolationMode)
+    {
+      case SamplerVoice::cubicInterpolation:  return "Cubic";
+      case SamplerVoice::sincInterpolation:   return "Sinc";
+      default:                                return "Linear";
+    }
+  }
+  return String::empty;
 }
 
 const String AutomelloPluginAudioProcessor::getInputChannelName (int channelIndex) const
@@ -153,6 +392,11 @@ void AutomelloPluginAudioProcessor::prepareToPlay (double sampleRate, int sample
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
   synth.setCurrentPlaybackSampleRate (sampleRate);
+  // Big chords get their voices shared out between any spare cores, so a single-core
+  // machine gets no extra threads at all (the synth keeps its threads if this hasn't
+  // changed since the last time)
+  synth.setNumRenderThreads( jlimit( 0, 3, SystemStats::getNumCpus() - 1 ), getNumOutputChannels(), samplesPerBlock );
+  resampleSounds( sampleRate );
 }
 
 void AutomelloPluginAudioProcessor::releaseResources()
@@ -64,13 +64,41 @@ public:
   //==============================================================================
   void getStateInformation (MemoryBlock& destData);
   void setStateInformation (const void* data, int sizeInBytes);
+  // Starts loading a dataset in the background - the current sounds keep playing
+  // until the new set is complete, and are then swapped out on the audio thread
   void setDirectory( File directory );
 
+  enum Parameters
+  {
+    // Chooses how the voices interpolate between sample frames: linear, cubic or sinc
+    interpolationParam = 0,
+    totalNumParams
+  };
+
 private:
   //==============================================================================
+  class DatasetLoader;
+  friend class DatasetLoader;
+  class ResampleJob;
+
+  // Called by the loader thread when a complete set of sounds is ready
+  void publishSounds( ReferenceCountedArray<SynthesiserSound>& newSounds );
+  // Starts converting the synth's sounds to the host's rate in the background
+  void resampleSounds( double sampleRate );
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AutomelloPluginAudioProcessor);
   Synthesiser synth;
   unsigned int nVoices;
+  // The voices that were given to the synth, which owns them and keeps them for as long
+  // as the processor exists
+  Array<SamplerVoice*> samplerVoices;
+  SamplerVoice::InterpolationMode interpolationMode;
+  // Reads the rest of long samples from disk while they're playing
+  TimeSliceThread streamingThread;
+  ScopedPointer<SamplerStreamer> sampleStreamer;
+  // Converts sounds to the host's sample rate after prepareToPlay
+  ThreadPool resamplingPool;
+  ScopedPointer<DatasetLoader> datasetLoader;
 };
 
 
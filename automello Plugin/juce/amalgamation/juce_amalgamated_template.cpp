@@ -148,6 +148,7 @@
  #include "../src/text/juce_XmlDocument.cpp"
  #include "../src/text/juce_XmlElement.cpp"
  #include "../src/text/juce_JSON.cpp"
+ #include "../src/threads/juce_ParallelTaskRunner.cpp"
  #include "../src/threads/juce_ReadWriteLock.cpp"
  #include "../src/threads/juce_Thread.cpp"
  #include "../src/threads/juce_ThreadPool.cpp"
@@ -176,6 +177,7 @@
  #include "../src/audio/audio_file_formats/juce_AudioSubsectionReader.cpp"
  #include "../src/audio/audio_file_formats/juce_AudioThumbnail.cpp"
  #include "../src/audio/audio_file_formats/juce_AudioThumbnailCache.cpp"
+ #include "../src/audio/audio_file_formats/juce_MemoryMappedAudioFormatReader.cpp"
  #include "../src/audio/audio_file_formats/juce_QuickTimeAudioFormat.cpp"
  #include "../src/audio/audio_file_formats/juce_WavAudioFormat.cpp"
  #include "../src/audio/audio_file_formats/juce_AudioCDReader.cpp"
@@ -192,9 +194,13 @@
  #include "../src/audio/devices/juce_AudioDeviceManager.cpp"
  #include "../src/audio/devices/juce_AudioIODevice.cpp"
  #include "../src/audio/devices/juce_AudioIODeviceType.cpp"
+ #include "../src/audio/dsp/juce_AudioBufferPool.cpp"
  #include "../src/audio/dsp/juce_AudioDataConverters.cpp"
  #include "../src/audio/dsp/juce_AudioSampleBuffer.cpp"
+ #include "../src/audio/dsp/juce_FloatVectorOperations.cpp"
  #include "../src/audio/dsp/juce_IIRFilter.cpp"
+ #include "../src/audio/dsp/juce_IIRFilterCascade.cpp"
+ #include "../src/audio/dsp/juce_Reverb.cpp"
  #include "../src/audio/midi/juce_MidiOutput.cpp"
  #include "../src/audio/midi/juce_MidiBuffer.cpp"
  #include "../src/audio/midi/juce_MidiFile.cpp"
@@ -216,7 +222,9 @@
  #include "../src/audio/processors/juce_AudioProcessorGraph.cpp"
  #include "../src/audio/processors/juce_AudioProcessorPlayer.cpp"
  #include "../src/audio/processors/juce_GenericAudioProcessorEditor.cpp"
+ #include "../src/audio/synthesisers/juce_SampleCache.cpp"
  #include "../src/audio/synthesisers/juce_Sampler.cpp"
+ #include "../src/audio/synthesisers/juce_StreamingSamplerSound.cpp"
  #include "../src/audio/synthesisers/juce_Synthesiser.cpp"
  #include "../src/events/juce_ActionBroadcaster.cpp"
  #include "../src/events/juce_AsyncUpdater.cpp"
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_BENCHMARK_JUCEHEADER__
+#define __JUCE_BENCHMARK_JUCEHEADER__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    A base class for the benchmarks that this app runs.
+
+    Like UnitTest, each subclass should be created as a static object, which registers
+    itself in the list returned by getAllBenchmarks(), and its run() method should time
+    whatever it's measuring and print the results with report().
+*/
+class Benchmark
+{
+public:
+    //==============================================================================
+    explicit Benchmark (const String& name);
+    virtual ~Benchmark();
+
+    /** Returns the name that was passed to the constructor. */
+    const String& getName() const noexcept          { return name; }
+
+    /** Runs the benchmark, printing its results. */
+    virtual void run() = 0;
+
+    /** Returns all the benchmarks that have been created. */
+    static Array<Benchmark*>& getAllBenchmarks();
+
+protected:
+    //==============================================================================
+    /** Calls an operation's run() method repeatedly for at least the given length of time,
+        and returns the average number of seconds that each call took.
+    */
+    template <class OperationType>
+    static double timeOperation (OperationType& operation, const double minimumSeconds = 0.25)
+    {
+        operation.run(); // (warms up the caches)
+
+        const int64 startTicks = Time::getHighResolutionTicks();
+        const int64 minimumTicks = Time::secondsToHighResolutionTicks (minimumSeconds);
+        int64 elapsedTicks = 0;
+        int numRuns = 0;
+
+        do
+        {
+            operation.run();
+            ++numRuns;
+            elapsedTicks = Time::getHighResolutionTicks() - startTicks;
+        }
+        while (elapsedTicks < minimumTicks);
+
+        return Time::highResolutionTicksToSeconds (elapsedTicks) / numRuns;
+    }
+
+    /** Prints a line of results, giving the throughput of an operation that reads and/or
+        writes the given number of bytes each time it's called.
+        If a baseline time is given, the speed-up relative to that is printed too.
+    */
+    static void report (const String& description, double numBytesPerRun, double secondsPerRun,
+                        double baselineSecondsPerRun = 0);
+
+private:
+    const String name;
+
+    Benchmark (const Benchmark&);
+    Benchmark& operator= (const Benchmark&);
+};
+
+
+#endif   // __JUCE_BENCHMARK_JUCEHEADER__
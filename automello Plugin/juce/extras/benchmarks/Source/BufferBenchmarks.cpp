@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+
+//==============================================================================
+/*
+    Times the AudioSampleBuffer methods that use FloatVectorOperations, at a few typical
+    block sizes, with each of the instruction sets that this machine supports. The speed-ups
+    are relative to the plain scalar code.
+*/
+class BufferBenchmarks  : public Benchmark
+{
+public:
+    BufferBenchmarks()  : Benchmark ("AudioSampleBuffer operations") {}
+
+    void run()
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        // The repeated gain changes would eventually shrink some samples into denormals, which
+        // would swamp the timings, so those get flushed to zero
+        const unsigned int oldFlags = _mm_getcsr();
+        _mm_setcsr (oldFlags | 0x8040);
+       #endif
+
+        const int blockSizes[] = { 64, 512, 4096 };
+
+        for (int op = 0; op < BufferOperation::numOperations; ++op)
+        {
+            for (int i = 0; i < numElementsInArray (blockSizes); ++i)
+            {
+                BufferOperation operation ((BufferOperation::OperationType) op, blockSizes[i]);
+                const String description (operation.getName() + ", " + String (blockSizes[i]) + " samples");
+
+                FloatVectorOperations::setInstructionSet (FloatVectorOperations::scalar);
+                const double scalarTime = timeOperation (operation, 0.1);
+                report (description + ", scalar", operation.getNumBytesPerRun(), scalarTime);
+
+                if (FloatVectorOperations::setInstructionSet (FloatVectorOperations::sse2))
+                    report (description + ", SSE2", operation.getNumBytesPerRun(), timeOperation (operation, 0.1), scalarTime);
+
+                if (FloatVectorOperations::setInstructionSet (FloatVectorOperations::avx))
+                    report (description + ", AVX", operation.getNumBytesPerRun(), timeOperation (operation, 0.1), scalarTime);
+            }
+        }
+
+        FloatVectorOperations::setInstructionSet (FloatVectorOperations::getBestAvailableInstructionSet());
+
+       #if JUCE_USE_SSE_INTRINSICS
+        _mm_setcsr (oldFlags);
+       #endif
+    }
+
+private:
+    class BufferOperation
+    {
+    public:
+        enum OperationType
+        {
+            applyGain, applyGainRamp, addFrom, addFromWithRamp, copyFromWithRamp,
+            findMinMax, getMagnitude, getRMSLevel, numOperations
+        };
+
+        BufferOperation (const OperationType type_, const int numSamples_)
+            : type (type_), numSamples (numSamples_), buffer (2, numSamples_), result (0)
+        {
+            Random r (1);
+
+            for (int chan = 0; chan < 2; ++chan)
+                for (int i = 0; i < numSamples; ++i)
+                    *buffer.getSampleData (chan, i) = r.nextFloat() * 0.5f - 0.25f;
+        }
+
+        void run()
+        {
+            switch (type)
+            {
+                case applyGain:         buffer.applyGain (0, 0, numSamples, 0.9999f); break;
+                case applyGainRamp:     buffer.applyGainRamp (0, 0, numSamples, 0.9999f, 1.0001f); break;
+                case addFrom:           buffer.addFrom (0, 0, buffer, 1, 0, numSamples, 0.5f); break;
+                case addFromWithRamp:   buffer.addFromWithRamp (0, 0, buffer.getSampleData (1), numSamples, 0.5f, -0.5f); break;
+                case copyFromWithRamp:  buffer.copyFromWithRamp (0, 0, buffer.getSampleData (1), numSamples, 0.5f, 1.0f); break;
+                case findMinMax:        { float mn, mx; buffer.findMinMax (0, 0, numSamples, mn, mx); result += mx - mn; break; }
+                case getMagnitude:      result += buffer.getMagnitude (0, 0, numSamples); break;
+                case getRMSLevel:       result += buffer.getRMSLevel (0, 0, numSamples); break;
+                default:                jassertfalse; break;
+            }
+        }
+
+        String getName() const
+        {
+            const char* const names[] = { "applyGain", "applyGainRamp", "addFrom", "addFromWithRamp",
+                                          "copyFromWithRamp", "findMinMax", "getMagnitude", "getRMSLevel" };
+            return names [type];
+        }
+
+        double getNumBytesPerRun() const
+        {
+            // (reads plus writes)
+            switch (type)
+            {
+                case addFrom:
+                case addFromWithRamp:   return numSamples * sizeof (float) * 3.0;
+                case findMinMax:
+                case getMagnitude:
+                case getRMSLevel:       return numSamples * sizeof (float) * 1.0;
+                default:                return numSamples * sizeof (float) * 2.0;
+            }
+        }
+
+    private:
+        const OperationType type;
+        const int numSamples;
+        AudioSampleBuffer buffer;
+        float result;
+    };
+};
+
+static BufferBenchmarks bufferBenchmarks;
@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+
+//==============================================================================
+/*
+    Measures the throughput of AudioData::Pointer::convertSamples() for each pair of
+    integer and float formats. The figures count the bytes that are read plus the bytes
+    that are written, and only include the samples of the channel being converted.
+
+    To compare the vectorised conversions with the plain per-sample loop, rebuild with
+    JUCE_USE_SSE_INTRINSICS set to 0.
+*/
+namespace ConversionBenchmarkHelpers
+{
+    static const char* getName (AudioData::Int16*)          { return "Int16"; }
+    static const char* getName (AudioData::Int24*)          { return "Int24"; }
+    static const char* getName (AudioData::Int32*)          { return "Int32"; }
+    static const char* getName (AudioData::Float32*)        { return "Float32"; }
+    static const char* getName (AudioData::LittleEndian*)   { return "LE"; }
+    static const char* getName (AudioData::BigEndian*)      { return "BE"; }
+
+    template <class SourceFormat, class SourceEndianness, class DestFormat, class DestEndianness, class InterleavingType>
+    class ConversionOperation
+    {
+    public:
+        typedef AudioData::Pointer <SourceFormat, SourceEndianness, InterleavingType, AudioData::Const> SourceType;
+        typedef AudioData::Pointer <DestFormat, DestEndianness, InterleavingType, AudioData::NonConst> DestType;
+
+        ConversionOperation (const int numSamples_, const int numChannels_)
+            : numSamples (numSamples_), numChannels (numChannels_),
+              source ((size_t) (numSamples * numChannels * 4), true),
+              dest ((size_t) (numSamples * numChannels * 4), true)
+        {
+            AudioData::Pointer <SourceFormat, SourceEndianness, AudioData::Interleaved, AudioData::NonConst> s (source.getData(), numChannels);
+            Random r (1);
+
+            for (int i = numSamples; --i >= 0;)
+            {
+                s.setAsFloat (r.nextFloat() * 2.0f - 1.0f);
+                ++s;
+            }
+        }
+
+        void run()
+        {
+            DestType (dest.getData(), numChannels).convertSamples (SourceType (source.getData(), numChannels), numSamples);
+        }
+
+        double getNumBytesPerRun() const
+        {
+            return numSamples * (double) (SourceType::getBytesPerSample() + DestType::getBytesPerSample());
+        }
+
+        static String getDescription()
+        {
+            return String (getName ((SourceFormat*) 0)) + " " + getName ((SourceEndianness*) 0)
+                    + " -> " + getName ((DestFormat*) 0) + " " + getName ((DestEndianness*) 0);
+        }
+
+    private:
+        const int numSamples, numChannels;
+        MemoryBlock source, dest;
+    };
+
+}
+
+//==============================================================================
+class ConversionBenchmarks  : public Benchmark
+{
+public:
+    ConversionBenchmarks()  : Benchmark ("AudioData conversions") {}
+
+    void run()
+    {
+        // (these all go to or from native-endian floats, which is what the audio classes use)
+        fromFormat <AudioData::Int16>();
+        fromFormat <AudioData::Int24>();
+        fromFormat <AudioData::Int32>();
+        fromFormat <AudioData::Float32>();
+
+        toFormat <AudioData::Int16>();
+        toFormat <AudioData::Int24>();
+        toFormat <AudioData::Int32>();
+        toFormat <AudioData::Float32>();
+    }
+
+private:
+    enum { numSamples = 65536 };
+
+    template <class SourceFormat>
+    void fromFormat()
+    {
+        timeConversion <SourceFormat, AudioData::LittleEndian, AudioData::Float32, AudioData::NativeEndian>();
+        timeConversion <SourceFormat, AudioData::BigEndian, AudioData::Float32, AudioData::NativeEndian>();
+    }
+
+    template <class DestFormat>
+    void toFormat()
+    {
+        timeConversion <AudioData::Float32, AudioData::NativeEndian, DestFormat, AudioData::LittleEndian>();
+        timeConversion <AudioData::Float32, AudioData::NativeEndian, DestFormat, AudioData::BigEndian>();
+    }
+
+    template <class SourceFormat, class SourceEndianness, class DestFormat, class DestEndianness>
+    void timeConversion()
+    {
+        using namespace ConversionBenchmarkHelpers;
+
+        ConversionOperation <SourceFormat, SourceEndianness, DestFormat, DestEndianness, AudioData::NonInterleaved> nonInterleaved (numSamples, 1);
+        report (nonInterleaved.getDescription(), nonInterleaved.getNumBytesPerRun(), timeOperation (nonInterleaved));
+
+        ConversionOperation <SourceFormat, SourceEndianness, DestFormat, DestEndianness, AudioData::Interleaved> interleaved (numSamples, 2);
+        report (interleaved.getDescription() + " (stereo interleaved)", interleaved.getNumBytesPerRun(), timeOperation (interleaved));
+    }
+};
+
+static ConversionBenchmarks conversionBenchmarks;
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "Benchmark.h"
+
+
+//==============================================================================
+Benchmark::Benchmark (const String& name_)
+    : name (name_)
+{
+    getAllBenchmarks().add (this);
+}
+
+Benchmark::~Benchmark()
+{
+    getAllBenchmarks().removeValue (this);
+}
+
+Array<Benchmark*>& Benchmark::getAllBenchmarks()
+{
+    static Array<Benchmark*> benchmarks;
+    return benchmarks;
+}
+
+void Benchmark::report (const String& description, double numBytesPerRun, double secondsPerRun,
+                        double baselineSecondsPerRun)
+{
+    String gigabytesPerSecond (String (numBytesPerRun / (secondsPerRun * 1.0e9), 2) + " GB/s");
+
+    if (baselineSecondsPerRun > 0)
+        gigabytesPerSecond = gigabytesPerSecond.paddedRight (' ', 14) + "x" + String (baselineSecondsPerRun / secondsPerRun, 1);
+
+    std::cout << "  " << description.paddedRight (' ', 56) << gigabytesPerSecond << "\n";
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    std::cout << "\n*** Juce benchmarks\n";
+
+    // Any arguments are treated as wildcards, to pick which benchmarks get run
+    StringArray wildcards;
+    for (int i = 1; i < argc; ++i)
+        wildcards.add (argv[i]);
+
+    const Array<Benchmark*>& benchmarks = Benchmark::getAllBenchmarks();
+
+    for (int i = 0; i < benchmarks.size(); ++i)
+    {
+        Benchmark* const b = benchmarks.getUnchecked (i);
+        bool shouldRun = wildcards.size() == 0;
+
+        for (int j = 0; j < wildcards.size() && ! shouldRun; ++j)
+            shouldRun = b->getName().matchesWildcard (wildcards[j], true);
+
+        if (shouldRun)
+        {
+            std::cout << "\n" << b->getName() << ":\n";
+            b->run();
+        }
+    }
+
+    std::cout << "\n";
+    return 0;
+}
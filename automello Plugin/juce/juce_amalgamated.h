@@ -867,6 +867,37 @@ namespace JuceDummyNamespace {}
   #include <byteswap.h>
 #endif
 
+// Work out which SIMD instruction sets the compiler is allowed to use..
+#ifndef JUCE_USE_SSE_INTRINSICS
+  #if JUCE_INTEL && (defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define JUCE_USE_SSE_INTRINSICS 1
+  #endif
+#endif
+
+#ifndef JUCE_USE_AVX_INTRINSICS
+  #if JUCE_USE_SSE_INTRINSICS && defined (__AVX__)
+	#define JUCE_USE_AVX_INTRINSICS 1
+  #endif
+#endif
+
+#ifndef JUCE_USE_ARM_NEON
+  #if defined (__ARM_NEON__) || defined (__ARM_NEON)
+	#define JUCE_USE_ARM_NEON 1
+  #endif
+#endif
+
+#if JUCE_USE_SSE_INTRINSICS
+  #include <emmintrin.h>
+#endif
+
+#if JUCE_USE_AVX_INTRINSICS
+  #include <immintrin.h>
+#endif
+
+#if JUCE_USE_ARM_NEON
+  #include <arm_neon.h>
+#endif
+
 // DLL building settings on Win32
 #if JUCE_MSVC
   #ifdef JUCE_DLL_BUILD
@@ -1474,6 +1505,9 @@ public:
 	/** Turns 2 bytes into a little-endian integer. */
 	static uint16 littleEndianShort (const void* bytes);
 
+	/** Turns 8 bytes into a little-endian integer. */
+	static uint64 littleEndianInt64 (const void* bytes);
+
 	/** Turns 4 bytes into a big-endian integer. */
 	static uint32 bigEndianInt (const void* bytes);
 
@@ -1557,6 +1591,7 @@ inline uint64 ByteOrder::swap (uint64 value)
  inline uint64 ByteOrder::swapIfLittleEndian (const uint64 v)				   { return swap (v); }
  inline uint32 ByteOrder::littleEndianInt (const void* const bytes)			 { return *static_cast <const uint32*> (bytes); }
  inline uint16 ByteOrder::littleEndianShort (const void* const bytes)			   { return *static_cast <const uint16*> (bytes); }
+ inline uint64 ByteOrder::littleEndianInt64 (const void* const bytes)			   { return *static_cast <const uint64*> (bytes); }
  inline uint32 ByteOrder::bigEndianInt (const void* const bytes)				{ return swap (*static_cast <const uint32*> (bytes)); }
  inline uint16 ByteOrder::bigEndianShort (const void* const bytes)			  { return swap (*static_cast <const uint16*> (bytes)); }
  inline bool ByteOrder::isBigEndian()							   { return false; }
@@ -1569,6 +1604,7 @@ inline uint64 ByteOrder::swap (uint64 value)
  inline uint64 ByteOrder::swapIfLittleEndian (const uint64 v)				   { return v; }
  inline uint32 ByteOrder::littleEndianInt (const void* const bytes)			 { return swap (*static_cast <const uint32*> (bytes)); }
  inline uint16 ByteOrder::littleEndianShort (const void* const bytes)			   { return swap (*static_cast <const uint16*> (bytes)); }
+ inline uint64 ByteOrder::littleEndianInt64 (const void* const bytes)			   { return swap (*static_cast <const uint64*> (bytes)); }
  inline uint32 ByteOrder::bigEndianInt (const void* const bytes)				{ return *static_cast <const uint32*> (bytes); }
  inline uint16 ByteOrder::bigEndianShort (const void* const bytes)			  { return *static_cast <const uint16*> (bytes); }
  inline bool ByteOrder::isBigEndian()							   { return true; }
@@ -14071,6 +14107,20 @@ public:
 		return data.elements [index];
 	}
 
+	/** Returns a raw pointer to the object at this index in the array, without checking
+		whether the index is in-range.
+
+		This is like getUnchecked(), but avoids the cost of creating a temporary
+		ReferenceCountedObjectPtr, so it's handy in time-critical loops. The pointer that's
+		returned is only valid for as long as the array keeps hold of the object.
+	*/
+	inline ObjectClass* getObjectPointerUnchecked (const int index) const noexcept
+	{
+		const ScopedLockType lock (getLock());
+		jassert (isPositiveAndBelow (index, numUsed));
+		return data.elements [index];
+	}
+
 	/** Returns a pointer to the first object in the array.
 
 		This will return a null pointer if the array's empty.
@@ -20914,7 +20964,13 @@ class JUCE_API  FileInputSource	 : public InputSource
 {
 public:
 
-	FileInputSource (const File& file, bool useFileTimeInHashGeneration = false);
+	/** Creates a source for a file.
+
+		If useFileTimeInHashGeneration is true, the file's modification time is mixed into
+		its hashCode(), so anything that's cached using the hash (e.g. an AudioThumbnail)
+		won't be reused once the file has been changed.
+	*/
+	FileInputSource (const File& file, bool useFileTimeInHashGeneration = true);
 	~FileInputSource();
 
 	InputStream* createInputStream();
@@ -22519,152 +22575,16 @@ private:
 
 
 #endif
-#ifndef __JUCE_PROCESS_JUCEHEADER__
-
-/*** Start of inlined file: juce_Process.h ***/
-#ifndef __JUCE_PROCESS_JUCEHEADER__
-#define __JUCE_PROCESS_JUCEHEADER__
-
-/** Represents the current executable's process.
-
-	This contains methods for controlling the current application at the
-	process-level.
-
-	@see Thread, JUCEApplication
-*/
-class JUCE_API  Process
-{
-public:
-
-	enum ProcessPriority
-	{
-		LowPriority	 = 0,
-		NormalPriority	  = 1,
-		HighPriority	= 2,
-		RealtimePriority	= 3
-	};
-
-	/** Changes the current process's priority.
-
-		@param priority	 the process priority, where
-							0=low, 1=normal, 2=high, 3=realtime
-	*/
-	static void setPriority (const ProcessPriority priority);
-
-	/** Kills the current process immediately.
-
-		This is an emergency process terminator that kills the application
-		immediately - it's intended only for use only when something goes
-		horribly wrong.
-
-		@see JUCEApplication::quit
-	*/
-	static void terminate();
-
-	/** Returns true if this application process is the one that the user is
-		currently using.
-	*/
-	static bool isForegroundProcess();
-
-	/** Raises the current process's privilege level.
-
-		Does nothing if this isn't supported by the current OS, or if process
-		privilege level is fixed.
-	*/
-	static void raisePrivilege();
-
-	/** Lowers the current process's privilege level.
-
-		Does nothing if this isn't supported by the current OS, or if process
-		privilege level is fixed.
-	*/
-	static void lowerPrivilege();
-
-	/** Returns true if this process is being hosted by a debugger.
-	*/
-	static bool JUCE_CALLTYPE isRunningUnderDebugger();
-
-private:
-	Process();
-
-	JUCE_DECLARE_NON_COPYABLE (Process);
-};
-
-#endif   // __JUCE_PROCESS_JUCEHEADER__
-
-/*** End of inlined file: juce_Process.h ***/
-
-
-#endif
-#ifndef __JUCE_READWRITELOCK_JUCEHEADER__
-
-/*** Start of inlined file: juce_ReadWriteLock.h ***/
-#ifndef __JUCE_READWRITELOCK_JUCEHEADER__
-#define __JUCE_READWRITELOCK_JUCEHEADER__
-
-
-/*** Start of inlined file: juce_SpinLock.h ***/
-#ifndef __JUCE_SPINLOCK_JUCEHEADER__
-#define __JUCE_SPINLOCK_JUCEHEADER__
-
-/**
-	A simple spin-lock class that can be used as a simple, low-overhead mutex for
-	uncontended situations.
-
-	Note that unlike a CriticalSection, this type of lock is not re-entrant, and may
-	be less efficient when used it a highly contended situation, but it's very small and
-	requires almost no initialisation.
-	It's most appropriate for simple situations where you're only going to hold the
-	lock for a very brief time.
-
-	@see CriticalSection
-*/
-class JUCE_API  SpinLock
-{
-public:
-	inline SpinLock() noexcept {}
-	inline ~SpinLock() noexcept {}
-
-	/** Acquires the lock.
-		This will block until the lock has been successfully acquired by this thread.
-		Note that a SpinLock is NOT re-entrant, and is not smart enough to know whether the
-		caller thread already has the lock - so if a thread tries to acquire a lock that it
-		already holds, this method will never return!
-
-		It's strongly recommended that you never call this method directly - instead use the
-		ScopedLockType class to manage the locking using an RAII pattern instead.
-	*/
-	void enter() const noexcept;
-
-	/** Attempts to acquire the lock, returning true if this was successful. */
-	inline bool tryEnter() const noexcept
-	{
-		return lock.compareAndSetBool (1, 0);
-	}
-
-	/** Releases the lock. */
-	inline void exit() const noexcept
-	{
-		jassert (lock.value == 1); // Agh! Releasing a lock that isn't currently held!
-		lock = 0;
-	}
+#ifndef __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
 
-	/** Provides the type of scoped lock to use for locking a SpinLock. */
-	typedef GenericScopedLock <SpinLock>	   ScopedLockType;
+/*** Start of inlined file: juce_ParallelTaskRunner.h ***/
+#ifndef __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
+#define __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
 
-	/** Provides the type of scoped unlocker to use with a SpinLock. */
-	typedef GenericScopedUnlock <SpinLock>	 ScopedUnlockType;
-
-private:
-
-	mutable Atomic<int> lock;
-
-	JUCE_DECLARE_NON_COPYABLE (SpinLock);
-};
-
-#endif   // __JUCE_SPINLOCK_JUCEHEADER__
 
-/*** End of inlined file: juce_SpinLock.h ***/
+/*** Start of inlined file: juce_Thread.h ***/
+#ifndef __JUCE_THREAD_JUCEHEADER__
+#define __JUCE_THREAD_JUCEHEADER__
 
 
 /*** Start of inlined file: juce_WaitableEvent.h ***/
@@ -22747,11 +22667,6 @@ private:
 
 /*** End of inlined file: juce_WaitableEvent.h ***/
 
-
-/*** Start of inlined file: juce_Thread.h ***/
-#ifndef __JUCE_THREAD_JUCEHEADER__
-#define __JUCE_THREAD_JUCEHEADER__
-
 /**
 	Encapsulates a thread.
 
@@ -23016,6 +22931,247 @@ private:
 
 /*** End of inlined file: juce_Thread.h ***/
 
+/**
+	A set of worker threads that helps a time-critical thread (normally the audio thread)
+	get through a batch of independent tasks.
+
+	Each call to runTasks() shares the tasks out between the workers and the thread that
+	called it. The tasks are claimed one at a time by whichever thread gets to them first,
+	and the calling thread claims them too, so it never waits for a worker to wake up:
+	anything that the workers haven't started by the time it runs out of work of its own
+	just gets run by the calling thread.
+
+	The only waiting it ever does is for tasks that a worker has already started, and if
+	that takes longer than the caller says it can afford, the next few batches are run
+	entirely on the calling thread, so that a worker that's been held up by the system
+	can't keep on delaying it.
+
+	Because any task can end up on any thread, the results of the tasks should be kept
+	apart (e.g. in a buffer for each task) and combined in task order afterwards, which
+	makes them independent of the way the tasks happened to get shared out.
+
+	@see Thread
+*/
+class JUCE_API  ParallelTaskRunner
+{
+public:
+
+	/** A batch of tasks that can be run by a ParallelTaskRunner. */
+	class JUCE_API  TaskList
+	{
+	public:
+		/** Destructor. */
+		virtual ~TaskList()  {}
+
+		/** Runs one of the tasks.
+
+			This may be called on any of the runner's threads, and at the same time as other
+			tasks from the list, but each task is only run once by each call to runTasks().
+		*/
+		virtual void runTask (int taskIndex) = 0;
+	};
+
+	/** Creates a runner, and starts its worker threads.
+
+		If numThreads is 0, all the tasks get run on the thread that calls runTasks().
+	*/
+	ParallelTaskRunner (const String& threadName, int numThreads, int threadPriority = 9);
+
+	/** Destructor.
+
+		This stops the worker threads, so it mustn't be called while runTasks() is running.
+	*/
+	~ParallelTaskRunner();
+
+	/** Returns the number of worker threads (not counting the thread that calls runTasks()). */
+	int getNumThreads() const noexcept		  { return workers.size(); }
+
+	/** The largest number of tasks that can be run by a call to runTasks(). */
+	enum { maximumNumTasks = 0xffff };
+
+	/** Runs tasks 0 to (numTasks - 1) from the list, and returns once they've all finished.
+
+		This never allocates memory or takes a lock while the workers are keeping up. If a
+		worker has started a task but not finished it within maxMillisecondsToWait of the
+		calling thread running out of work, the calling thread still has to let it finish,
+		but it runs the next few batches by itself.
+
+		Only one thread at a time can call this.
+	*/
+	void runTasks (TaskList& tasks, int numTasks, int maxMillisecondsToWait);
+
+private:
+
+	class Worker;
+	friend class Worker;
+
+	OwnedArray <Worker> workers;
+
+	// (the top 16 bits of the claim state hold the number of tasks, and the bottom 16 bits
+	// hold the index of the next one to be claimed)
+	Atomic <int> claimState, numTasksFinished;
+	TaskList* currentTasks;
+	WaitableEvent workersFinished;
+	int numBatchesToRunSerially;
+
+	void runClaimedTasks (bool isWorker);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelTaskRunner);
+};
+
+#endif   // __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
+
+/*** End of inlined file: juce_ParallelTaskRunner.h ***/
+
+
+#endif
+#ifndef __JUCE_PROCESS_JUCEHEADER__
+
+/*** Start of inlined file: juce_Process.h ***/
+#ifndef __JUCE_PROCESS_JUCEHEADER__
+#define __JUCE_PROCESS_JUCEHEADER__
+
+/** Represents the current executable's process.
+
+	This contains methods for controlling the current application at the
+	process-level.
+
+	@see Thread, JUCEApplication
+*/
+class JUCE_API  Process
+{
+public:
+
+	enum ProcessPriority
+	{
+		LowPriority	 = 0,
+		NormalPriority	  = 1,
+		HighPriority	= 2,
+		RealtimePriority	= 3
+	};
+
+	/** Changes the current process's priority.
+
+		@param priority	 the process priority, where
+							0=low, 1=normal, 2=high, 3=realtime
+	*/
+	static void setPriority (const ProcessPriority priority);
+
+	/** Kills the current process immediately.
+
+		This is an emergency process terminator that kills the application
+		immediately - it's intended only for use only when something goes
+		horribly wrong.
+
+		@see JUCEApplication::quit
+	*/
+	static void terminate();
+
+	/** Returns true if this application process is the one that the user is
+		currently using.
+	*/
+	static bool isForegroundProcess();
+
+	/** Raises the current process's privilege level.
+
+		Does nothing if this isn't supported by the current OS, or if process
+		privilege level is fixed.
+	*/
+	static void raisePrivilege();
+
+	/** Lowers the current process's privilege level.
+
+		Does nothing if this isn't supported by the current OS, or if process
+		privilege level is fixed.
+	*/
+	static void lowerPrivilege();
+
+	/** Returns true if this process is being hosted by a debugger.
+	*/
+	static bool JUCE_CALLTYPE isRunningUnderDebugger();
+
+private:
+	Process();
+
+	JUCE_DECLARE_NON_COPYABLE (Process);
+};
+
+#endif   // __JUCE_PROCESS_JUCEHEADER__
+
+/*** End of inlined file: juce_Process.h ***/
+
+
+#endif
+#ifndef __JUCE_READWRITELOCK_JUCEHEADER__
+
+/*** Start of inlined file: juce_ReadWriteLock.h ***/
+#ifndef __JUCE_READWRITELOCK_JUCEHEADER__
+#define __JUCE_READWRITELOCK_JUCEHEADER__
+
+
+/*** Start of inlined file: juce_SpinLock.h ***/
+#ifndef __JUCE_SPINLOCK_JUCEHEADER__
+#define __JUCE_SPINLOCK_JUCEHEADER__
+
+/**
+	A simple spin-lock class that can be used as a simple, low-overhead mutex for
+	uncontended situations.
+
+	Note that unlike a CriticalSection, this type of lock is not re-entrant, and may
+	be less efficient when used it a highly contended situation, but it's very small and
+	requires almost no initialisation.
+	It's most appropriate for simple situations where you're only going to hold the
+	lock for a very brief time.
+
+	@see CriticalSection
+*/
+class JUCE_API  SpinLock
+{
+public:
+	inline SpinLock() noexcept {}
+	inline ~SpinLock() noexcept {}
+
+	/** Acquires the lock.
+		This will block until the lock has been successfully acquired by this thread.
+		Note that a SpinLock is NOT re-entrant, and is not smart enough to know whether the
+		caller thread already has the lock - so if a thread tries to acquire a lock that it
+		already holds, this method will never return!
+
+		It's strongly recommended that you never call this method directly - instead use the
+		ScopedLockType class to manage the locking using an RAII pattern instead.
+	*/
+	void enter() const noexcept;
+
+	/** Attempts to acquire the lock, returning true if this was successful. */
+	inline bool tryEnter() const noexcept
+	{
+		return lock.compareAndSetBool (1, 0);
+	}
+
+	/** Releases the lock. */
+	inline void exit() const noexcept
+	{
+		jassert (lock.value == 1); // Agh! Releasing a lock that isn't currently held!
+		lock = 0;
+	}
+
+	/** Provides the type of scoped lock to use for locking a SpinLock. */
+	typedef GenericScopedLock <SpinLock>	   ScopedLockType;
+
+	/** Provides the type of scoped unlocker to use with a SpinLock. */
+	typedef GenericScopedUnlock <SpinLock>	 ScopedUnlockType;
+
+private:
+
+	mutable Atomic<int> lock;
+
+	JUCE_DECLARE_NON_COPYABLE (SpinLock);
+};
+
+#endif   // __JUCE_SPINLOCK_JUCEHEADER__
+
+/*** End of inlined file: juce_SpinLock.h ***/
+
 /**
 	A critical section that allows multiple simultaneous readers.
 
@@ -23359,7 +23515,18 @@ private:
 	friend class ThreadPoolThread;
 	String jobName;
 	ThreadPool* pool;
+
+	/** Whether the job's in a pool. This is what ThreadPool::contains() looks at, so it's
+		the last thing to change when a job leaves, and a job that's on its way out can't
+		be given any new dependents.
+	*/
+	enum PoolState { notInPool = 0, inPool, inPoolWithDependents, leavingPool };
+	Atomic <int> poolState;
+
 	bool shouldStop, isActive, shouldBeDeleted;
+	ThreadPoolJob* nextQueuedJob;
+	ThreadPoolJob* outerRunningJob;
+	Array <ThreadPoolJob*> unfinishedPrerequisites, dependentJobs;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolJob);
 };
@@ -23370,6 +23537,13 @@ private:
 	When a ThreadPoolJob object is added to the ThreadPool's list, its run() method
 	will be called by the next pooled thread that becomes free.
 
+	Each thread keeps its own queue of jobs and takes work from the other threads'
+	queues when its own runs dry, so adding jobs never blocks, and jobs that are added
+	from inside a running job are picked up by the same thread while they're still hot
+	in its cache. Jobs can also be held back until others have finished with
+	addJobAfter(), and a job that calls waitForJobToFinish() will help run the queued
+	jobs rather than just blocking its thread.
+
 	@see ThreadPoolJob, Thread
 */
 class JUCE_API  ThreadPool
@@ -23428,6 +23602,21 @@ public:
 	*/
 	void addJob (ThreadPoolJob* job);
 
+	/** Adds a job that will only be started once some other jobs have finished.
+
+		The job is held back until every one of the prerequisite jobs has either
+		finished or been removed from the pool, and then it's queued as if it had been
+		passed to addJob(). Any prerequisites that aren't currently in this pool are
+		ignored, so if none of them are still pending, the job is queued straight away.
+
+		While it's waiting, the job counts as one of the pool's jobs, so it can be
+		found with getJob() or removed with removeJob() like any other queued job.
+
+		As with contains(), the prerequisites mustn't be jobs that might already have
+		deleted themselves.
+	*/
+	void addJobAfter (ThreadPoolJob* job, const Array <ThreadPoolJob*>& prerequisites);
+
 	/** Tries to remove a job from the pool.
 
 		If the job isn't yet running, this will simply remove it. If it is running, it
@@ -23482,6 +23671,9 @@ public:
 
 	/** Returns true if the given job is currently queued or running.
 
+		This looks at the job object itself, so it mustn't be used on a job that might
+		already have deleted itself by returning ThreadPoolJob::jobHasFinishedAndShouldBeDeleted.
+
 		@see isJobRunning()
 	*/
 	bool contains (const ThreadPoolJob* job) const;
@@ -23495,8 +23687,13 @@ public:
 		This will wait until the job is no longer in the pool - i.e. until its
 		runJob() method returns ThreadPoolJob::jobHasFinished.
 
+		If this is called from inside one of this pool's jobs, the calling thread will
+		carry on running other queued jobs while it waits, so a job can split its work
+		into smaller jobs and wait for them without tying up a thread.
+
 		If the timeout period expires before the job finishes, this will return false;
-		it returns true if the job has finished successfully.
+		it returns true if the job has finished successfully. As with contains(), the job
+		mustn't be one that deletes itself when it finishes.
 	*/
 	bool waitForJobToFinish (const ThreadPoolJob* job,
 							 int timeOutMilliseconds) const;
@@ -23521,14 +23718,32 @@ private:
 	class ThreadPoolThread;
 	friend class OwnedArray <ThreadPoolThread>;
 	OwnedArray <ThreadPoolThread> threads;
-	Array <ThreadPoolJob*> jobs;
 
-	CriticalSection lock;
+	Atomic <ThreadPoolJob*> incomingJobs;
+	Atomic <int> numJobs, numThreadsRunning, numIdleThreads;
+	Array <ThreadPoolJob*> waitingJobs;
+
+	CriticalSection lock, threadStartLock;
 	uint32 lastJobEndTime;
 	WaitableEvent jobFinishedSignal;
 
 	friend class ThreadPoolThread;
-	bool runNextJob();
+	bool runNextJob (ThreadPoolThread&);
+	ThreadPoolJob* takeNextJob (ThreadPoolThread&);
+	void finishJob (ThreadPoolThread&, ThreadPoolJob*, ThreadPoolJob::JobStatus);
+	void releaseDependentJobs (ThreadPoolJob*);
+	void jobHasLeftPool (ThreadPoolJob*);
+	void removeQueuedJobs (JobSelector*, Array <ThreadPoolJob*>& removedJobs);
+	void queueJob (ThreadPoolJob*);
+	void pushIncomingJob (ThreadPoolJob*);
+	void takeAllIncomingJobs (Array <ThreadPoolJob*>&);
+	void restoreIncomingJobs (const Array <ThreadPoolJob*>&);
+	void getAllJobs (Array <ThreadPoolJob*>&, bool onlyRunningJobs) const;
+	bool isWorkAvailable() const;
+	void wakeIdleThread();
+	void startThreadIfNeeded();
+	bool stopIdleThread (ThreadPoolThread&);
+	ThreadPoolThread* getCurrentPoolThread() const;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPool);
 };
@@ -35367,6 +35582,106 @@ public:
 	 class NativeEndian   : public LittleEndian  {};
 	#endif
 
+   #if JUCE_USE_SSE_INTRINSICS
+	enum { hasVectorConversions = 1 };
+
+	/** Shared code for the sample formats' vectorised conversions, which work on four
+		samples at a time, held as either full-scale 32-bit ints or floats.
+	*/
+	struct VectorHelpers
+	{
+		static inline __m128i swapBytes16 (__m128i v) noexcept
+		{
+			return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+		}
+
+		static inline __m128i swapBytes32 (__m128i v) noexcept
+		{
+			v = swapBytes16 (v);
+			return _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1)), _MM_SHUFFLE (2, 3, 0, 1));
+		}
+
+		static inline __m128 int32ToFloat (__m128i v) noexcept
+		{
+			return _mm_mul_ps (_mm_cvtepi32_ps (v), _mm_set1_ps (1.0f / 2147483648.0f));
+		}
+
+		// For samples that aren't contiguous, the values are moved one at a time using the
+		// scalar methods, and only the arithmetic is vectorised
+		template <class SampleFormatType, int bigEndian>
+		static inline int32 getInt32 (const char* src) noexcept
+		{
+			SampleFormatType s (const_cast <char*> (src));
+			return bigEndian ? s.getAsInt32BE() : s.getAsInt32LE();
+		}
+
+		template <class SampleFormatType, int bigEndian>
+		static inline void setInt32 (char* dest, __m128i v) noexcept
+		{
+			SampleFormatType s (dest);
+			if (bigEndian)  s.setAsInt32BE (_mm_cvtsi128_si32 (v));
+			else		s.setAsInt32LE (_mm_cvtsi128_si32 (v));
+		}
+
+		template <class SampleFormatType, int bigEndian>
+		static inline __m128i gatherInt32 (const char* src, const int stride) noexcept
+		{
+			return _mm_set_epi32 (getInt32 <SampleFormatType, bigEndian> (src + 3 * stride),
+								  getInt32 <SampleFormatType, bigEndian> (src + 2 * stride),
+								  getInt32 <SampleFormatType, bigEndian> (src + stride),
+								  getInt32 <SampleFormatType, bigEndian> (src));
+		}
+
+		template <class SampleFormatType, int bigEndian>
+		static inline void scatterInt32 (char* dest, const int stride, __m128i values) noexcept
+		{
+			setInt32 <SampleFormatType, bigEndian> (dest, values);
+			setInt32 <SampleFormatType, bigEndian> (dest + stride, _mm_srli_si128 (values, 4));
+			setInt32 <SampleFormatType, bigEndian> (dest + 2 * stride, _mm_srli_si128 (values, 8));
+			setInt32 <SampleFormatType, bigEndian> (dest + 3 * stride, _mm_srli_si128 (values, 12));
+		}
+
+		template <int bigEndian>
+		static inline __m128 gatherFloat (const char* src, const int stride) noexcept
+		{
+			return _mm_castsi128_ps (_mm_set_epi32 (getFloatBits <bigEndian> (src + 3 * stride),
+													getFloatBits <bigEndian> (src + 2 * stride),
+													getFloatBits <bigEndian> (src + stride),
+													getFloatBits <bigEndian> (src)));
+		}
+
+		template <int bigEndian>
+		static inline void scatterFloat (char* dest, const int stride, __m128 values) noexcept
+		{
+			const __m128i v (_mm_castps_si128 (values));
+			setFloatBits <bigEndian> (dest, v);
+			setFloatBits <bigEndian> (dest + stride, _mm_srli_si128 (v, 4));
+			setFloatBits <bigEndian> (dest + 2 * stride, _mm_srli_si128 (v, 8));
+			setFloatBits <bigEndian> (dest + 3 * stride, _mm_srli_si128 (v, 12));
+		}
+
+	private:
+		// (float samples are moved as raw bits, so that the compiler doesn't bounce them through memory)
+		template <int bigEndian>
+		static inline int32 getFloatBits (const char* src) noexcept
+		{
+			const int32 v = *reinterpret_cast <const int32*> (src);
+			return bigEndian ? (int32) ByteOrder::swapIfLittleEndian ((uint32) v)
+							 : (int32) ByteOrder::swapIfBigEndian ((uint32) v);
+		}
+
+		template <int bigEndian>
+		static inline void setFloatBits (char* dest, __m128i v) noexcept
+		{
+			const uint32 n = (uint32) _mm_cvtsi128_si32 (v);
+			*reinterpret_cast <uint32*> (dest) = bigEndian ? ByteOrder::swapIfLittleEndian (n)
+														  : ByteOrder::swapIfBigEndian (n);
+		}
+	};
+   #else
+	enum { hasVectorConversions = 0 };
+   #endif
+
 	class Int8
 	{
 	public:
@@ -35389,7 +35704,7 @@ public:
 		inline void copyFromSameType (Int8& source) noexcept	{ *data = *source.data; }
 
 		int8* data;
-		enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0 };
+		enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0, canUseVectors = 0 };
 	};
 
 	class UInt8
@@ -35414,7 +35729,7 @@ public:
 		inline void copyFromSameType (UInt8& source) noexcept   { *data = *source.data; }
 
 		uint8* data;
-		enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0 };
+		enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0, canUseVectors = 0 };
 	};
 
 	class Int16
@@ -35439,7 +35754,35 @@ public:
 		inline void copyFromSameType (Int16& source) noexcept   { *data = *source.data; }
 
 		uint16* data;
-		enum { bytesPerSample = 2, maxValue = 0x7fff, resolution = (1 << 16), isFloat = 0 };
+		enum { bytesPerSample = 2, maxValue = 0x7fff, resolution = (1 << 16), isFloat = 0, canUseVectors = hasVectorConversions };
+
+	   #if JUCE_USE_SSE_INTRINSICS
+		template <int bigEndian>
+		static inline __m128i loadInt32 (const char* src, const int stride) noexcept
+		{
+			if (stride != bytesPerSample)
+				return VectorHelpers::gatherInt32 <Int16, bigEndian> (src, stride);
+
+			__m128i v = _mm_loadl_epi64 (reinterpret_cast <const __m128i*> (src));
+			if (bigEndian) v = VectorHelpers::swapBytes16 (v);
+			return _mm_unpacklo_epi16 (_mm_setzero_si128(), v);
+		}
+
+		template <int bigEndian>
+		static inline __m128 loadFloat (const char* src, const int stride) noexcept	{ return VectorHelpers::int32ToFloat (loadInt32 <bigEndian> (src, stride)); }
+
+		template <int bigEndian>
+		static inline void storeInt32 (char* dest, const int stride, __m128i v) noexcept
+		{
+			if (stride != bytesPerSample)
+				return VectorHelpers::scatterInt32 <Int16, bigEndian> (dest, stride, v);
+
+			v = _mm_srai_epi32 (v, 16);
+			v = _mm_packs_epi32 (v, v);
+			if (bigEndian) v = VectorHelpers::swapBytes16 (v);
+			_mm_storel_epi64 (reinterpret_cast <__m128i*> (dest), v);
+		}
+	   #endif
 	};
 
 	class Int24
@@ -35464,7 +35807,19 @@ public:
 		inline void copyFromSameType (Int24& source) noexcept   { data[0] = source.data[0]; data[1] = source.data[1]; data[2] = source.data[2]; }
 
 		char* data;
-		enum { bytesPerSample = 3, maxValue = 0x7fffff, resolution = (1 << 8), isFloat = 0 };
+		enum { bytesPerSample = 3, maxValue = 0x7fffff, resolution = (1 << 8), isFloat = 0, canUseVectors = hasVectorConversions };
+
+	   #if JUCE_USE_SSE_INTRINSICS
+		// (without SSSE3's byte shuffles, there's no quick way to unpack 24-bit values)
+		template <int bigEndian>
+		static inline __m128i loadInt32 (const char* src, const int stride) noexcept	{ return VectorHelpers::gatherInt32 <Int24, bigEndian> (src, stride); }
+
+		template <int bigEndian>
+		static inline __m128 loadFloat (const char* src, const int stride) noexcept	 { return VectorHelpers::int32ToFloat (loadInt32 <bigEndian> (src, stride)); }
+
+		template <int bigEndian>
+		static inline void storeInt32 (char* dest, const int stride, __m128i v) noexcept	{ VectorHelpers::scatterInt32 <Int24, bigEndian> (dest, stride, v); }
+	   #endif
 	};
 
 	class Int32
@@ -35489,7 +35844,31 @@ public:
 		inline void copyFromSameType (Int32& source) noexcept   { *data = *source.data; }
 
 		uint32* data;
-		enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = 1, isFloat = 0 };
+		enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = 1, isFloat = 0, canUseVectors = hasVectorConversions };
+
+	   #if JUCE_USE_SSE_INTRINSICS
+		template <int bigEndian>
+		static inline __m128i loadInt32 (const char* src, const int stride) noexcept
+		{
+			if (stride != bytesPerSample)
+				return VectorHelpers::gatherInt32 <Int32, bigEndian> (src, stride);
+
+			const __m128i v = _mm_loadu_si128 (reinterpret_cast <const __m128i*> (src));
+			return bigEndian ? VectorHelpers::swapBytes32 (v) : v;
+		}
+
+		template <int bigEndian>
+		static inline __m128 loadFloat (const char* src, const int stride) noexcept	{ return VectorHelpers::int32ToFloat (loadInt32 <bigEndian> (src, stride)); }
+
+		template <int bigEndian>
+		static inline void storeInt32 (char* dest, const int stride, __m128i v) noexcept
+		{
+			if (stride != bytesPerSample)
+				return VectorHelpers::scatterInt32 <Int32, bigEndian> (dest, stride, v);
+
+			_mm_storeu_si128 (reinterpret_cast <__m128i*> (dest), bigEndian ? VectorHelpers::swapBytes32 (v) : v);
+		}
+	   #endif
 	};
 
 	class Float32
@@ -35521,7 +35900,44 @@ public:
 		inline void copyFromSameType (Float32& source) noexcept { *data = *source.data; }
 
 		float* data;
-		enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = (1 << 8), isFloat = 1 };
+		enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = (1 << 8), isFloat = 1, canUseVectors = hasVectorConversions };
+
+	   #if JUCE_USE_SSE_INTRINSICS
+		template <int bigEndian>
+		static inline __m128 loadFloat (const char* src, const int stride) noexcept
+		{
+			if (stride != bytesPerSample)
+				return VectorHelpers::gatherFloat <bigEndian> (src, stride);
+
+			if (bigEndian)
+				return _mm_castsi128_ps (VectorHelpers::swapBytes32 (_mm_loadu_si128 (reinterpret_cast <const __m128i*> (src))));
+
+			return _mm_loadu_ps (reinterpret_cast <const float*> (src));
+		}
+
+		template <int bigEndian>
+		static inline __m128i loadInt32 (const char* src, const int stride) noexcept
+		{
+			// (this has to be done in double precision to match getAsInt32())
+			const __m128 v = loadFloat <bigEndian> (src, stride);
+			const __m128d one (_mm_set1_pd (1.0)), minusOne (_mm_set1_pd (-1.0)), scale (_mm_set1_pd ((double) maxValue));
+			const __m128d lo (_mm_mul_pd (scale, _mm_min_pd (one, _mm_max_pd (minusOne, _mm_cvtps_pd (v)))));
+			const __m128d hi (_mm_mul_pd (scale, _mm_min_pd (one, _mm_max_pd (minusOne, _mm_cvtps_pd (_mm_movehl_ps (v, v))))));
+			return _mm_unpacklo_epi64 (_mm_cvtpd_epi32 (lo), _mm_cvtpd_epi32 (hi));
+		}
+
+		template <int bigEndian>
+		static inline void storeFloat (char* dest, const int stride, __m128 v) noexcept
+		{
+			if (stride != bytesPerSample)
+				return VectorHelpers::scatterFloat <bigEndian> (dest, stride, v);
+
+			if (bigEndian)
+				_mm_storeu_si128 (reinterpret_cast <__m128i*> (dest), VectorHelpers::swapBytes32 (_mm_castps_si128 (v)));
+			else
+				_mm_storeu_ps (reinterpret_cast <float*> (dest), v);
+		}
+	   #endif
 	};
 
 	class NonInterleaved
@@ -35569,6 +35985,75 @@ public:
 		static inline void* toVoidPtr (VoidType* v) noexcept { return const_cast<void*> (v); }
 		enum { isConst = 1 };
 	};
+
+	// Pointer::convertSamples() uses these to do as much of a conversion as it can four
+	// samples at a time, when both formats provide vectorised load and store methods.
+	// They return the number of samples converted, and leave the remainder to the caller.
+	template <int canUseVectors, int dummy = 0>
+	struct VectorConverter
+	{
+		template <class DestPointerType, class SourcePointerType>
+		static inline int convert (const DestPointerType&, const SourcePointerType&, int) noexcept	{ return 0; }
+	};
+
+   #if JUCE_USE_SSE_INTRINSICS
+	template <int destIsFloat, int dummy = 0>
+	struct VectorTransfer
+	{
+		template <class DestFormat, int destBigEndian, class SourceFormat, int sourceBigEndian>
+		static inline void transfer (char* dest, int destStride, const char* source, int sourceStride) noexcept
+		{
+			DestFormat::template storeInt32 <destBigEndian> (dest, destStride, SourceFormat::template loadInt32 <sourceBigEndian> (source, sourceStride));
+		}
+	};
+
+	template <int dummy>
+	struct VectorTransfer <1, dummy>
+	{
+		template <class DestFormat, int destBigEndian, class SourceFormat, int sourceBigEndian>
+		static inline void transfer (char* dest, int destStride, const char* source, int sourceStride) noexcept
+		{
+			DestFormat::template storeFloat <destBigEndian> (dest, destStride, SourceFormat::template loadFloat <sourceBigEndian> (source, sourceStride));
+		}
+	};
+
+	template <int dummy>
+	struct VectorConverter <1, dummy>
+	{
+		template <class DestPointerType, class SourcePointerType>
+		static int convert (const DestPointerType& dest, const SourcePointerType& source, const int numSamples) noexcept
+		{
+			typedef typename DestPointerType::FormatType DestFormat;
+			typedef typename SourcePointerType::FormatType SourceFormat;
+
+			char* d = static_cast <char*> (const_cast <void*> (dest.getRawData()));
+			const char* s = static_cast <const char*> (source.getRawData());
+			const int destStride = dest.getNumBytesBetweenSamples();
+			const int sourceStride = source.getNumBytesBetweenSamples();
+
+			// When the samples aren't contiguous they have to be moved one at a time, which
+			// costs more than the vectorising saves, unless the clipping and rounding of a
+			// conversion to an integer format is involved
+			if (DestFormat::isFloat && (destStride != (int) DestFormat::bytesPerSample
+										 || sourceStride != (int) SourceFormat::bytesPerSample))
+				return 0;
+
+			const int numBlocks = numSamples / 4;
+
+			for (int i = numBlocks; --i >= 0;)
+			{
+				VectorTransfer <DestFormat::isFloat>::template transfer <DestFormat, DestPointerType::EndiannessType::isBigEndian,
+																		 SourceFormat, SourcePointerType::EndiannessType::isBigEndian>
+					(d, destStride, s, sourceStride);
+
+				d += 4 * destStride;
+				s += 4 * sourceStride;
+			}
+
+			return numBlocks * 4;
+		}
+	};
+   #endif
   #endif
 
 	/**
@@ -35602,6 +36087,9 @@ public:
 	class Pointer
 	{
 	public:
+		/** The sample format and endianness that this pointer was declared with. */
+		typedef SampleFormat FormatType;
+		typedef Endianness EndiannessType;
 
 		/** Creates a non-interleaved pointer from some raw data in the appropriate format.
 			This constructor is only used if you've specified the AudioData::NonInterleaved option -
@@ -35711,6 +36199,12 @@ public:
 
 			if (source.getRawData() != getRawData() || source.getNumBytesBetweenSamples() >= getNumBytesBetweenSamples())
 			{
+				const int numDone = VectorConverter <SampleFormat::canUseVectors && OtherPointerType::FormatType::canUseVectors>
+										::convert (dest, source, numSamples);
+				dest += numDone;
+				source += numDone;
+				numSamples -= numDone;
+
 				while (--numSamples >= 0)
 				{
 					Endianness::copyFrom (dest.data, source);
@@ -35986,6 +36480,21 @@ public:
 			   int numSamplesToRead,
 			   bool fillLeftoverChannelsWithCopies);
 
+	/** Reads samples from the stream, converting them to floating-point.
+
+		This works just like the other read() method, but always fills the destination
+		buffers with floats in the range -1.0 to 1.0, whatever format the source uses. Readers
+		that override readFloatSamples() can decode straight into these buffers, which avoids
+		the extra pass that's needed to convert the integer data that read() produces.
+
+		@see readFloatSamples
+	*/
+	bool read (float* const* destSamples,
+			   int numDestChannels,
+			   int64 startSampleInSource,
+			   int numSamplesToRead,
+			   bool fillLeftoverChannelsWithCopies);
+
 	/** Finds the highest and lowest sample levels from a section of the audio stream.
 
 		This will read a block of samples from the stream, and measure the
@@ -36085,6 +36594,21 @@ public:
 							  int64 startSampleInFile,
 							  int numSamples) = 0;
 
+	/** Performs the low-level read operation, producing floating-point samples.
+
+		This has the same parameters as readSamples(), but the destination buffers must be
+		filled with floats in the range -1.0 to 1.0. The default implementation calls
+		readSamples() and then converts its output in-place, so subclasses that can produce
+		floats directly should override it.
+
+		Callers should use read() instead of calling this directly.
+	*/
+	virtual bool readFloatSamples (float** destSamples,
+								   int numDestChannels,
+								   int startOffsetInDestBuffer,
+								   int64 startSampleInFile,
+								   int numSamples);
+
 protected:
 
 	/** Used by AudioFormatReader subclasses to copy data to different formats. */
@@ -36112,9 +36636,48 @@ protected:
 		}
 	};
 
+	/** Used by AudioFormatReader subclasses to convert data directly into floats. */
+	template <class SourceSampleType, class SourceEndianness>
+	struct FloatReadHelper
+	{
+		typedef AudioData::Pointer <AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst> DestType;
+		typedef AudioData::Pointer <SourceSampleType, SourceEndianness, AudioData::Interleaved, AudioData::Const>		   SourceType;
+
+		static void read (float** destData, int destOffset, int numDestChannels, const void* sourceData, int numSourceChannels, int numSamples) noexcept
+		{
+			for (int i = 0; i < numDestChannels; ++i)
+			{
+				if (destData[i] != nullptr)
+				{
+					DestType dest (destData[i]);
+					dest += destOffset;
+
+					if (i < numSourceChannels)
+						dest.convertSamples (SourceType (addBytesToPointer (sourceData, i * SourceType::getBytesPerSample()), numSourceChannels), numSamples);
+					else
+						dest.clearSamples (numSamples);
+				}
+			}
+		}
+	};
+
 private:
 	String formatName;
 
+	template <typename SampleType>
+	bool readInto (SampleType* const* destSamples, int numDestChannels, int64 startSampleInSource,
+				   int numSamplesToRead, bool fillLeftoverChannelsWithCopies);
+
+	bool readSamplesInto (int** destSamples, int numDestChannels, int startOffsetInDestBuffer, int64 startSampleInFile, int numSamples)
+	{
+		return readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+	}
+
+	bool readSamplesInto (float** destSamples, int numDestChannels, int startOffsetInDestBuffer, int64 startSampleInFile, int numSamples)
+	{
+		return readFloatSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+	}
+
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFormatReader);
 };
 
@@ -36137,6 +36700,151 @@ private:
 #ifndef __JUCE_AUDIOSAMPLEBUFFER_JUCEHEADER__
 #define __JUCE_AUDIOSAMPLEBUFFER_JUCEHEADER__
 
+
+/*** Start of inlined file: juce_AudioBufferPool.h ***/
+#ifndef __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
+#define __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
+
+/**
+	A pool of pre-allocated memory blocks that AudioSampleBuffers can be allocated from
+	without going to the system allocator.
+
+	Blocks are grouped into power-of-two size classes. You reserve some blocks before
+	the audio starts (typically in a prepareToPlay() method), and then any buffer that
+	has been given the pool with AudioSampleBuffer::setBufferPool() will take its memory
+	from these blocks when it gets resized. Taking and returning a block is lock-free, so
+	it's safe to do on the audio thread.
+
+	If a request can't be met from the reserved blocks, the pool falls back to a normal
+	heap allocation, and getNumHeapAllocations() counts how often that's happened.
+
+	The pool must outlive any buffers that are using it.
+
+	@see AudioSampleBuffer
+*/
+class JUCE_API  AudioBufferPool
+{
+public:
+
+	/** Creates an empty pool. */
+	AudioBufferPool();
+
+	/** Destructor.
+		All the blocks must have been returned to the pool before it's deleted.
+	*/
+	~AudioBufferPool();
+
+	/** Makes sure the pool contains at least the given number of free blocks that can
+		each hold numBytes.
+
+		Blocks that are in use when this is called aren't counted, so it'll add more if
+		some of the existing ones are still being used by buffers.
+
+		This allocates memory, so call it before the audio starts rather than on the
+		audio thread.
+	*/
+	void reserve (size_t numBytes, int numBlocks);
+
+	/** Makes sure there are enough blocks for the given number of AudioSampleBuffers
+		of this size to be allocated from the pool at the same time.
+	*/
+	void reserveForBuffers (int numChannels, int numSamples, int numBuffers);
+
+	/** Frees any reserved blocks that aren't currently in use.
+		This is safe to call while other threads are using the pool.
+	*/
+	void releaseUnusedBlocks();
+
+	/** Returns the number of allocations that couldn't be met from the reserved blocks,
+		and which had to use the heap instead.
+	*/
+	int getNumHeapAllocations() const noexcept	  { return numHeapAllocations.get(); }
+
+	/** The alignment of all the blocks that are handed out. */
+	enum { blockAlignment = 32 };
+
+	/** Takes a block of at least numBytes from the pool.
+		If no suitable block is free, this will allocate one from the heap.
+	*/
+	void* allocate (size_t numBytes) noexcept;
+
+	/** Returns a block to whichever pool it came from.
+		This also works for blocks that were allocated from the heap, and does nothing
+		if the pointer is null.
+	*/
+	static void release (void* block) noexcept;
+
+	/**
+		Holds a block of memory that comes either from an AudioBufferPool or from the heap.
+
+		This behaves like a HeapBlock<char>, but all the memory it allocates is aligned
+		to blockAlignment bytes.
+	*/
+	class JUCE_API  Block
+	{
+	public:
+		Block() noexcept : data (nullptr)   {}
+		~Block()				{ free(); }
+
+		/** Frees any existing data and allocates a new block, taking it from the given
+			pool if it's not null, or from the heap otherwise.
+		*/
+		void allocate (AudioBufferPool* pool, size_t numBytes, bool initialiseToZero);
+
+		/** Frees the data, if any. */
+		void free() noexcept;
+
+		/** Swaps the data with another block. */
+		void swapWith (Block& other) noexcept	   { std::swap (data, other.data); }
+
+		/** Clears the first numBytes of the data. */
+		void clear (size_t numBytes) noexcept	   { zeromem (data, numBytes); }
+
+		inline operator char*() const noexcept	  { return data; }
+		inline char* getData() const noexcept	   { return data; }
+
+	private:
+		char* data;
+
+		JUCE_DECLARE_NON_COPYABLE (Block);
+	};
+
+private:
+
+	enum
+	{
+		minSizeClassBits = 8,
+		numSizeClasses = 24,
+		maxBlocksPerSizeClass = 64,
+		maxSizeClassesToSearch = 4
+	};
+
+	enum SlotState
+	{
+		slotEmpty = 0,
+		slotBusy,
+		slotFree,
+		slotInUse
+	};
+
+	struct BlockHeader;
+
+	Atomic<int> slotStates [numSizeClasses][maxBlocksPerSizeClass];
+	void* volatile blocks [numSizeClasses][maxBlocksPerSizeClass];
+	Atomic<int> numHeapAllocations;
+
+	static int getSizeClassFor (size_t numBytes) noexcept;
+	static void* allocateBlock (size_t numBytes, AudioBufferPool* owner, int sizeClass, int slot) noexcept;
+	static void freeBlock (void* block) noexcept;
+	void* takeFreeBlock (int sizeClass) noexcept;
+
+	JUCE_DECLARE_NON_COPYABLE (AudioBufferPool);
+};
+
+#endif   // __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
+
+/*** End of inlined file: juce_AudioBufferPool.h ***/
+
 class AudioFormatReader;
 class AudioFormatWriter;
 
@@ -36307,6 +37015,16 @@ public:
 						   int numChannels,
 						   int numSamples) noexcept;
 
+	/** Makes the buffer take any memory that it allocates from now on from a pool.
+
+		This doesn't move the buffer's current data - that'll only happen when it's next
+		resized. Passing nullptr makes it go back to using the heap. The pool must stay
+		alive for as long as the buffer uses any of its blocks.
+
+		@see AudioBufferPool
+	*/
+	void setBufferPool (AudioBufferPool* poolToUse) noexcept	{ pool = poolToUse; }
+
 	/** Clears all the samples in all channels. */
 	void clear() noexcept;
 
@@ -36548,7 +37266,8 @@ private:
 	int numChannels, size;
 	size_t allocatedBytes;
 	float** channels;
-	HeapBlock <char> allocatedData;
+	AudioBufferPool::Block allocatedData;
+	AudioBufferPool* pool;
 	float* preallocatedChannelSpace [32];
 
 	void allocateData();
@@ -37808,9 +38527,12 @@ struct ThumbnailCacheEntry;
 /**
 	An instance of this class is used to manage multiple AudioThumbnail objects.
 
-	The cache runs a single background thread that is shared by all the thumbnails
-	that need it, and it maintains a set of low-res previews in memory, to avoid
-	having to re-scan audio files too often.
+	The cache has a pool of background threads that is shared by all the thumbnails
+	that need it, so that many files can be scanned at once, and it maintains a set
+	of low-res previews in memory, to avoid having to re-scan audio files too often.
+
+	It can also keep its previews in a file with setCacheFile(), so that they're
+	available straight away the next time the application runs.
 
 	@see AudioThumbnail
 */
@@ -37822,8 +38544,11 @@ public:
 
 		The maxNumThumbsToStore parameter lets you specify how many previews should
 		be kept in memory at once.
+
+		The numThreadsForScanning parameter sets how many audio files can be scanned
+		at the same time. If it's 0, one thread is used for each CPU core.
 	*/
-	explicit AudioThumbnailCache (int maxNumThumbsToStore);
+	explicit AudioThumbnailCache (int maxNumThumbsToStore, int numThreadsForScanning = 0);
 
 	/** Destructor. */
 	~AudioThumbnailCache();
@@ -37847,12 +38572,53 @@ public:
 	*/
 	void storeThumb (const AudioThumbnail& thumb, int64 hashCode);
 
+	/** Makes the cache keep its thumbnails in a file as well as in memory.
+
+		Any thumbnails that are already in the file can be loaded by the AudioThumbnail
+		objects that use this cache without scanning their audio again. The file is
+		memory-mapped rather than read, so even a cache holding thousands of thumbnails
+		opens instantly, and only the thumbnails that are actually used get paged in.
+
+		Newly generated thumbnails are added to the file in batches as they build up,
+		and when saveCacheFile() is called or the cache is deleted.
+
+		The thumbnails are looked up using the hash code of their source. A FileInputSource
+		includes the file's modification time in its hash, so a file gets rescanned if it's
+		changed, rather than using a thumbnail from before the change.
+
+		Passing File::nonexistent stops the cache from using a file. This returns false
+		if the file exists but isn't a cache file in the current format, in which case
+		it'll be replaced when the cache is next saved.
+
+		@see saveCacheFile
+	*/
+	bool setCacheFile (const File& file);
+
+	/** Writes any thumbnails that have been added since the cache file was last saved.
+
+		The file is written without holding the lock that loadThumb() uses, so thumbnails
+		can still be loaded while it's being saved. Returns false if there's no cache file
+		or it couldn't be written.
+		@see setCacheFile
+	*/
+	bool saveCacheFile();
+
 private:
 
-	OwnedArray <ThumbnailCacheEntry> thumbs;
+	class MappedCacheFile;
+	friend class AudioThumbnail::LevelDataSource;
+
+	OwnedArray <ThumbnailCacheEntry> thumbs, unsavedThumbs;
 	int maxNumThumbsToStore;
+	ThreadPool scanningPool;
+
+	File cacheFile;
+	ScopedPointer <MappedCacheFile> mappedCacheFile;
+	size_t numUnsavedBytes;
+	CriticalSection lock, cacheFileLock;
 
 	ThumbnailCacheEntry* findThumbFor (int64 hash) const;
+	bool addThumb (const AudioThumbnail&, int64 hash);
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioThumbnailCache);
 };
@@ -37913,6 +38679,116 @@ private:
 /*** End of inlined file: juce_FlacAudioFormat.h ***/
 
 
+#endif
+#ifndef __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
+
+/*** Start of inlined file: juce_MemoryMappedAudioFormatReader.h ***/
+#ifndef __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
+#define __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
+
+/**
+	A specialised type of AudioFormatReader that reads its samples directly from
+	a memory-mapped file, rather than through an InputStream.
+
+	Because the file is mapped into memory, the samples never have to be copied
+	through an intermediate buffer - they're pulled in lazily by the OS as they're
+	touched, so reading a file costs little more than the page-cache lookups. For
+	formats that store their samples uncompressed, this also lets you get a pointer
+	straight to the sample data with sampleToPointer(), and reading it as floats will
+	convert the raw data in a single pass.
+
+	To create one of these, use an AudioFormat method such as
+	WavAudioFormat::createMemoryMappedReader().
+
+	@see AudioFormatReader, MemoryMappedFile
+*/
+class JUCE_API  MemoryMappedAudioFormatReader  : public AudioFormatReader
+{
+protected:
+
+	/** Creates a MemoryMappedAudioFormatReader and maps the given file into memory.
+
+		@param file		 the file to map
+		@param details	  a reader that has already parsed the file's header - its
+								format settings and metadata are copied into this one
+		@param dataChunkStart   the byte offset within the file of the first sample frame
+		@param dataChunkLength  the number of bytes of sample data that follow dataChunkStart.
+								If the file turns out to be shorter than this, it'll be
+								clipped to whatever is actually there
+		@param bytesPerFrame	the number of bytes used by one sample of all the channels
+	*/
+	MemoryMappedAudioFormatReader (const File& file, const AudioFormatReader& details,
+								   int64 dataChunkStart, int64 dataChunkLength, int bytesPerFrame);
+
+public:
+	/** Destructor. */
+	~MemoryMappedAudioFormatReader();
+
+	/** Returns the file that is being read. */
+	const File& getFile() const noexcept		{ return file; }
+
+	/** Returns true if the file was successfully mapped into memory.
+		If this is false, none of the read methods will return any data.
+	*/
+	bool isMapped() const noexcept			  { return sampleData != nullptr; }
+
+	/** Returns the number of bytes that one frame (i.e. one sample of every channel)
+		occupies in the file.
+	*/
+	int getBytesPerFrame() const noexcept		   { return bytesPerFrame; }
+
+	/** Returns a pointer to the raw data for a given sample frame.
+
+		The data is in whatever format the file uses, with the channels interleaved - so
+		for a 32-bit floating point file this can be cast to a const float*, giving you
+		numChannels interleaved floats per frame without any copying at all.
+
+		This will return nullptr if the file isn't mapped or the sample index is out of range.
+	*/
+	const void* sampleToPointer (int64 sampleIndex) const noexcept;
+
+	/** Mapped readers must convert their samples to floats straight from the mapped data,
+		rather than going through readSamples().
+		@see AudioFormatReader::readFloatSamples
+	*/
+	virtual bool readFloatSamples (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+								   int64 startSampleInFile, int numSamples) = 0;
+
+protected:
+
+	/** Zeroes any part of a destination range that lies beyond the end of the file, and
+		returns the number of samples at the start of it that can actually be read.
+	*/
+	template <typename SampleType>
+	int clearSamplesBeyondEnd (SampleType** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+							   int64 startSampleInFile, int numSamples) const noexcept
+	{
+		const int numAvailable = (int) jlimit ((int64) 0, (int64) numSamples, lengthInSamples - startSampleInFile);
+
+		if (numAvailable < numSamples)
+			for (int i = numDestChannels; --i >= 0;)
+				if (destSamples[i] != nullptr)
+					zeromem (destSamples[i] + startOffsetInDestBuffer + numAvailable,
+							 sizeof (SampleType) * (size_t) (numSamples - numAvailable));
+
+		return numAvailable;
+	}
+
+private:
+
+	const File file;
+	ScopedPointer<MemoryMappedFile> map;
+	const char* sampleData;
+	const int bytesPerFrame;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedAudioFormatReader);
+};
+
+#endif   // __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
+
+/*** End of inlined file: juce_MemoryMappedAudioFormatReader.h ***/
+
+
 #endif
 #ifndef __JUCE_OGGVORBISAUDIOFORMAT_JUCEHEADER__
 
@@ -38129,6 +39005,19 @@ public:
 	AudioFormatReader* createReaderFor (InputStream* sourceStream,
 										bool deleteStreamIfOpeningFails);
 
+	/** Creates a reader that maps a wav file into memory instead of reading it through a stream.
+
+		This parses the file's header, then maps the whole file, so that its samples can be
+		read without being copied through any intermediate buffers. The reader that's returned
+		can also give you a pointer to the raw sample data, or convert it straight to floats
+		with MemoryMappedAudioFormatReader::readFloatSamples().
+
+		Returns nullptr if the file isn't a valid wav file or couldn't be mapped (e.g. if
+		there isn't enough address space), in which case you can fall back to createReaderFor().
+		The caller is responsible for deleting the object that is returned.
+	*/
+	MemoryMappedAudioFormatReader* createMemoryMappedReader (const File& file);
+
 	AudioFormatWriter* createWriterFor (OutputStream* streamToWriteTo,
 										double sampleRateToUse,
 										unsigned int numberOfChannels,
@@ -38570,6 +39459,31 @@ public:
 	*/
 	virtual int getInputLatencyInSamples() = 0;
 
+	/** Returns the number of times that the device has had to recover from a buffer
+		underrun or overrun since it was opened, or -1 if it doesn't keep count of them.
+	*/
+	virtual int getXRunCount() const noexcept;
+
+	/** Timing details for the callbacks that a device has made.
+		@see getCallbackStatistics
+	*/
+	struct JUCE_API  CallbackStatistics
+	{
+		CallbackStatistics() noexcept;
+
+		int numCallbacks;		   /**< The number of callbacks made since the device was opened. */
+		int numLateCallbacks;	   /**< The number of callbacks that took longer than the duration of their block. */
+		double averageMilliseconds;	 /**< The average time spent inside the callback. */
+		double maximumMilliseconds;	 /**< The longest time spent inside the callback. */
+	};
+
+	/** Fills in some timing details for the callbacks that the device has made since
+		it was opened.
+
+		Returns false if the device doesn't keep track of these.
+	*/
+	virtual bool getCallbackStatistics (CallbackStatistics& result) const;
+
 	/** True if this device can show a pop-up control panel for editing its settings.
 
 		This is generally just true of ASIO devices. If true, you can call showControlPanel()
@@ -38776,6 +39690,12 @@ private:
 /**
 	A type of AudioSource that takes an input source and changes its sample rate.
 
+	The conversion uses a polyphase windowed-sinc filter, whose length depends on the
+	quality that's selected with setQuality(). The filter's cutoff follows the ratio, so
+	that down-sampling doesn't alias, and the ratio can be changed while the source is
+	playing: each change is ramped over the course of the next block, so it can be used
+	for varispeed effects as well as for sample rate conversion.
+
 	@see AudioSource
 */
 class JUCE_API  ResamplingAudioSource  : public AudioSource
@@ -38812,34 +39732,57 @@ public:
 	*/
 	double getResamplingRatio() const noexcept		  { return ratio; }
 
+	/** The different filter lengths that the resampler can use. */
+	enum Quality
+	{
+		lowQuality = 0,	 /**< A 16-point filter, which is cheap, but lets a little aliasing through. */
+		mediumQuality,	  /**< A 32-point filter, with about 70dB of stop-band rejection. */
+		highQuality	 /**< A 64-point filter, with about 90dB of stop-band rejection. */
+	};
+
+	/** Changes the length of filter that's used.
+
+		When down-sampling, the filter is made longer in proportion to the ratio (up to
+		four times), so that its transition band stays the same width.
+
+		The filter tables are shared between all the resamplers that use them. This method
+		and prepareToPlay() make all the tables that the quality needs, so the ratio can be
+		changed while the source is playing without any of them having to be made on the
+		audio thread. If the ratio is the one between two common sample rates, an exact table
+		is used for it, but only if the ratio was set before this or prepareToPlay() was called.
+	*/
+	void setQuality (Quality newQuality);
+
+	/** Returns the quality that's currently being used.
+		@see setQuality
+	*/
+	Quality getQuality() const noexcept			 { return quality; }
+
 	void prepareToPlay (int samplesPerBlockExpected, double sampleRate);
 	void releaseResources();
 	void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill);
 
 private:
 
+	class Filter;
+
 	OptionalScopedPointer<AudioSource> input;
 	double ratio, lastRatio;
+	Quality quality;
+	const Filter* filter;
+	const Filter* filterInUse;
 	AudioSampleBuffer buffer;
-	int bufferPos, sampsInBuffer;
+	int bufferPos, bufferEnd;
 	double subSampleOffset;
-	double coefficients[6];
 	SpinLock ratioLock;
 	const int numChannels;
-	HeapBlock<float*> destBuffers, srcBuffers;
-
-	void setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6);
-	void createLowPass (double proportionalRate);
-
-	struct FilterState
-	{
-		double x1, x2, y1, y2;
-	};
-
-	HeapBlock<FilterState> filterStates;
-	void resetFilters();
+	HeapBlock<float*> destBuffers;
+	HeapBlock<const float*> srcBuffers;
+	HeapBlock<float> coefficients;
 
-	void applyFilter (float* samples, int num, FilterState& fs);
+	void fillBuffer (int numNeeded);
+	void renderSamples (AudioSampleBuffer&, int startSample, int numSamples,
+						double startRatio, double ratioDelta, const Filter&);
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResamplingAudioSource);
 };
@@ -39128,6 +40071,11 @@ private:
 #define __JUCE_IIRFILTERAUDIOSOURCE_JUCEHEADER__
 
 
+/*** Start of inlined file: juce_IIRFilterCascade.h ***/
+#ifndef __JUCE_IIRFILTERCASCADE_JUCEHEADER__
+#define __JUCE_IIRFILTERCASCADE_JUCEHEADER__
+
+
 /*** Start of inlined file: juce_IIRFilter.h ***/
 #ifndef __JUCE_IIRFILTER_JUCEHEADER__
 #define __JUCE_IIRFILTER_JUCEHEADER__
@@ -39239,6 +40187,8 @@ protected:
 	float coefficients[6];
 	float x1, x2, y1, y2;
 
+	friend class IIRFilterCascade;
+
 	// (use the copyCoefficientsFrom() method instead of this operator)
 	IIRFilter& operator= (const IIRFilter&);
 	JUCE_LEAK_DETECTOR (IIRFilter);
@@ -39248,8 +40198,109 @@ protected:
 
 /*** End of inlined file: juce_IIRFilter.h ***/
 
+/**
+	A chain of biquad filters that's applied to a set of channels.
+
+	Each stage of the cascade is set up with an IIRFilter, and all the channels are
+	put through the same stages. The filters run in transposed direct form II, and
+	their state is kept as a structure-of-arrays so that several of them can be
+	processed at once in the lanes of a SIMD register: if there are at least as
+	many channels as lanes, each lane handles a different channel; otherwise the
+	stages themselves are pipelined across the lanes, so that a long chain of EQ
+	bands on a mono or stereo signal is still vectorised.
+
+	When a stage's settings are changed, its coefficients are ramped from their old
+	values to the new ones over a number of samples (see setSmoothingLength()), so
+	the parameters can be moved while audio is playing without clicking.
+
+	@see IIRFilter, IIRFilterAudioSource
+*/
+class JUCE_API  IIRFilterCascade
+{
+public:
+
+	/** Creates a cascade with the given number of channels and stages.
+		The stages are initially inactive, i.e. they leave the signal unchanged.
+	*/
+	IIRFilterCascade (int numChannels = 2, int numStages = 1);
+
+	/** Destructor. */
+	~IIRFilterCascade();
+
+	/** Changes the number of channels and stages.
+
+		Any stages that already exist keep their settings, but the processing
+		state is reset. This allocates memory, so avoid calling it on the audio
+		thread if the size is actually changing.
+	*/
+	void setSize (int numChannels, int numStages);
+
+	/** Returns the number of channels that the cascade processes. */
+	int getNumChannels() const noexcept		 { return numChannels; }
+
+	/** Returns the number of stages in the cascade. */
+	int getNumStages() const noexcept		   { return numStages; }
+
+	/** Makes one of the stages use the same coefficients as the given filter.
+
+		If the filter is inactive, the stage will pass the signal through unchanged.
+		The change is smoothed over the number of samples set by setSmoothingLength().
+	*/
+	void setStage (int stageIndex, const IIRFilter& newSettings) noexcept;
+
+	/** Sets the number of samples over which changes to the stages are ramped.
+		A length of 0 makes changes take effect immediately. The default is 128.
+	*/
+	void setSmoothingLength (int numSamples) noexcept;
+
+	/** Resets the filters' processing state, ready to start a new stream of data.
+		This doesn't change the settings of the stages, and any coefficient ramps
+		that are in progress are completed immediately.
+	*/
+	void reset() noexcept;
+
+	/** Filters a section of an AudioSampleBuffer.
+
+		Only the first getNumChannels() channels of the buffer are processed.
+	*/
+	void processSamples (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept;
+
+private:
+
+	CriticalSection processLock;
+	int numChannels, numStages;
+	bool channelsInLanes;
+
+	// For each coefficient (b0, b1, b2, a1, a2) these hold the current values for each
+	// stage, the values being ramped towards, and the per-sample ramp increments.
+	enum { numCoefficients = 5 };
+	HeapBlock<float> coefficients, targets, deltas;
+	int numStagesAllocated, numRampSamplesLeft, smoothingLength;
+
+	// The two state variables for each filter, laid out so that the lanes that are
+	// processed together are next to each other.
+	HeapBlock<float> state1, state2, silence;
+
+	template <class Ops> void processChannelsInLanes (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+	template <class Ops> void processStagesInLanes (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+	void updateRamp (int numSteps) noexcept;
+	void flushDenormals() noexcept;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IIRFilterCascade);
+};
+
+#endif   // __JUCE_IIRFILTERCASCADE_JUCEHEADER__
+
+/*** End of inlined file: juce_IIRFilterCascade.h ***/
+
 /**
 	An AudioSource that performs an IIR filter on another source.
+
+	The source can run a whole chain of filters, which are all applied to each of its
+	channels using an IIRFilterCascade. Changes to the filters' settings are smoothed,
+	so they can be made while the source is playing.
+
+	@see IIRFilterCascade
 */
 class JUCE_API  IIRFilterAudioSource  : public AudioSource
 {
@@ -39267,9 +40318,27 @@ public:
 	/** Destructor. */
 	~IIRFilterAudioSource();
 
-	/** Changes the filter to use the same parameters as the one being passed in. */
+	/** Changes the filter to use the same parameters as the one being passed in.
+		If there's more than one stage, this sets the first one.
+	*/
 	void setFilterParameters (const IIRFilter& newSettings);
 
+	/** Changes the number of filters that are applied one after another.
+		Any new stages are initially inactive. The default is one stage.
+	*/
+	void setNumStages (int numStages);
+
+	/** Returns the number of stages of filtering. */
+	int getNumStages() const noexcept			   { return cascade.getNumStages(); }
+
+	/** Changes one of the stages to use the same parameters as the filter passed in. */
+	void setStageParameters (int stageIndex, const IIRFilter& newSettings);
+
+	/** Sets the number of samples over which changes to the filters are smoothed.
+		@see IIRFilterCascade::setSmoothingLength
+	*/
+	void setSmoothingLength (int numSamples);
+
 	void prepareToPlay (int samplesPerBlockExpected, double sampleRate);
 	void releaseResources();
 	void getNextAudioBlock (const AudioSourceChannelInfo& bufferToFill);
@@ -39277,7 +40346,7 @@ public:
 private:
 
 	OptionalScopedPointer<AudioSource> input;
-	OwnedArray <IIRFilter> iirFilters;
+	IIRFilterCascade cascade;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IIRFilterAudioSource);
 };
@@ -39300,6 +40369,14 @@ private:
 	Input sources can be added and removed while the mixer is running as long as their
 	prepareToPlay() and releaseResources() methods are called before and after adding
 	them to the mixer.
+
+	The audio thread never has to wait for a lock while this happens: each change to the
+	inputs publishes a new copy of the list for getNextAudioBlock() to pick up, and the
+	methods that remove inputs wait until any block that might still be using the old
+	list has finished before they return. This means that inputs mustn't be removed
+	from inside the mixer's own getNextAudioBlock() call.
+
+	The inputs can also be rendered on several threads at once - see setNumRenderThreads().
 */
 class JUCE_API  MixerAudioSource  : public AudioSource
 {
@@ -39347,6 +40424,33 @@ public:
 	*/
 	void removeAllInputs();
 
+	/** Shares out the work of rendering the inputs between some extra threads.
+
+		When there's more than one input, getNextAudioBlock() hands them out to a set of
+		worker threads, each input rendering into a buffer of its own, and these buffers
+		are added together once they're all finished. They're added in the same order as
+		they would have been without the threads, so the output is exactly the same. The
+		calling thread renders inputs as well, and picks up any that the workers haven't
+		got round to, so it never waits for a worker to start. If a worker that's already
+		started an input takes longer than the block lasts (as worked out from the rate
+		passed to prepareToPlay()), the next few blocks are rendered on the calling thread
+		alone.
+
+		The numChannels and maximumBlockSize values are used to allocate the inputs'
+		buffers, so any block that's longer than this or has a different number of channels
+		gets mixed on the calling thread in the normal way. Passing 0 for numThreads stops
+		the threads.
+
+		Each input is only ever called by one thread at a time, but inputs which share any
+		state with each other will need to protect it themselves.
+	*/
+	void setNumRenderThreads (int numThreads, int numChannels, int maximumBlockSize);
+
+	/** Returns the number of extra threads that are used to render the inputs.
+		@see setNumRenderThreads
+	*/
+	int getNumRenderThreads() const noexcept;
+
 	/** Implementation of the AudioSource method.
 
 		This will call prepareToPlay() on all its input sources.
@@ -39364,12 +40468,23 @@ public:
 
 private:
 
+	class InputList;
+	class RenderThreads;
+
 	Array <AudioSource*> inputs;
 	BigInteger inputsToDelete;
 	CriticalSection lock;
+	Atomic <InputList*> currentInputs;
+	Atomic <int> renderCounter;
+	OwnedArray <InputList> oldLists;
+	ScopedPointer <RenderThreads> renderThreads;
 	AudioSampleBuffer tempBuffer;
 	double currentSampleRate;
-	int bufferSizeExpected;
+	int bufferSizeExpected, renderChannels, renderBlockSize;
+
+	void publishInputs();
+	void releaseOldLists (bool waitForAudioThread);
+	void mixInputs (const InputList&, const AudioSourceChannelInfo&);
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerAudioSource);
 };
@@ -39404,17 +40519,20 @@ private:
 	Use setSampleRate() to prepare it, and then call processStereo() or processMono() to
 	apply the reverb to your audio data.
 
+	The comb filters are run several at a time in the lanes of SIMD registers, and
+	denormalised values are flushed to zero while the reverb is processing, so that its
+	tail doesn't get slower as it dies away.
+
 	@see ReverbAudioSource
 */
-class Reverb
+class JUCE_API  Reverb
 {
 public:
 
-	Reverb()
-	{
-		setParameters (Parameters());
-		setSampleRate (44100.0);
-	}
+	Reverb();
+
+	/** Destructor. */
+	~Reverb();
 
 	/** Holds the parameters being used by a Reverb object. */
 	struct Parameters
@@ -39443,243 +40561,80 @@ public:
 	/** Applies a new set of parameters to the reverb.
 		Note that this doesn't attempt to lock the reverb, so if you call this in parallel with
 		the process method, you may get artifacts.
+		@see setSmoothingTime
 	*/
-	void setParameters (const Parameters& newParams)
-	{
-		const float wetScaleFactor = 3.0f;
-		const float dryScaleFactor = 2.0f;
+	void setParameters (const Parameters& newParams) noexcept;
 
-		const float wet = newParams.wetLevel * wetScaleFactor;
-		wet1 = wet * (newParams.width * 0.5f + 0.5f);
-		wet2 = wet * (1.0f - newParams.width) * 0.5f;
-		dry = newParams.dryLevel * dryScaleFactor;
-		gain = isFrozen (newParams.freezeMode) ? 0.0f : 0.015f;
-		parameters = newParams;
-		shouldUpdateDamping = true;
-	}
+	/** Makes changes to the parameters glide to their new values over the given time,
+		rather than taking effect immediately.
+
+		The values are moved in steps of a few samples at a time. A time of 0 (the
+		default) turns the smoothing off. The time is measured at the sample rate that
+		was last given to setSampleRate().
+	*/
+	void setSmoothingTime (double seconds) noexcept;
 
 	/** Sets the sample rate that will be used for the reverb.
 		You must call this before the process methods, in order to tell it the correct sample rate.
 	*/
-	void setSampleRate (const double sampleRate)
-	{
-		jassert (sampleRate > 0);
-
-		static const short combTunings[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 }; // (at 44100Hz)
-		static const short allPassTunings[] = { 556, 441, 341, 225 };
-		const int stereoSpread = 23;
-		const int intSampleRate = (int) sampleRate;
-
-		int i;
-		for (i = 0; i < numCombs; ++i)
-		{
-			comb[0][i].setSize ((intSampleRate * combTunings[i]) / 44100);
-			comb[1][i].setSize ((intSampleRate * (combTunings[i] + stereoSpread)) / 44100);
-		}
-
-		for (i = 0; i < numAllPasses; ++i)
-		{
-			allPass[0][i].setSize ((intSampleRate * allPassTunings[i]) / 44100);
-			allPass[1][i].setSize ((intSampleRate * (allPassTunings[i] + stereoSpread)) / 44100);
-		}
-
-		shouldUpdateDamping = true;
-	}
+	void setSampleRate (double sampleRate);
 
 	/** Clears the reverb's buffers. */
-	void reset()
-	{
-		for (int j = 0; j < numChannels; ++j)
-		{
-			int i;
-			for (i = 0; i < numCombs; ++i)
-				comb[j][i].clear();
-
-			for (i = 0; i < numAllPasses; ++i)
-				allPass[j][i].clear();
-		}
-	}
+	void reset() noexcept;
 
 	/** Applies the reverb to two stereo channels of audio data. */
-	void processStereo (float* const left, float* const right, const int numSamples) noexcept
-	{
-		jassert (left != nullptr && right != nullptr);
-
-		if (shouldUpdateDamping)
-			updateDamping();
-
-		for (int i = 0; i < numSamples; ++i)
-		{
-			const float input = (left[i] + right[i]) * gain;
-			float outL = 0, outR = 0;
-
-			int j;
-			for (j = 0; j < numCombs; ++j)  // accumulate the comb filters in parallel
-			{
-				outL += comb[0][j].process (input);
-				outR += comb[1][j].process (input);
-			}
-
-			for (j = 0; j < numAllPasses; ++j)  // run the allpass filters in series
-			{
-				outL = allPass[0][j].process (outL);
-				outR = allPass[1][j].process (outR);
-			}
-
-			left[i]  = outL * wet1 + outR * wet2 + left[i]  * dry;
-			right[i] = outR * wet1 + outL * wet2 + right[i] * dry;
-		}
-	}
+	void processStereo (float* left, float* right, int numSamples) noexcept;
 
 	/** Applies the reverb to a single mono channel of audio data. */
-	void processMono (float* const samples, const int numSamples) noexcept
-	{
-		jassert (samples != nullptr);
-
-		if (shouldUpdateDamping)
-			updateDamping();
-
-		for (int i = 0; i < numSamples; ++i)
-		{
-			const float input = samples[i] * gain;
-			float output = 0;
-
-			int j;
-			for (j = 0; j < numCombs; ++j)  // accumulate the comb filters in parallel
-				output += comb[0][j].process (input);
-
-			for (j = 0; j < numAllPasses; ++j)  // run the allpass filters in series
-				output = allPass[0][j].process (output);
-
-			samples[i] = output * wet1 + input * dry;
-		}
-	}
+	void processMono (float* samples, int numSamples) noexcept;
 
 private:
 
-	Parameters parameters;
-
-	volatile bool shouldUpdateDamping;
-	float gain, wet1, wet2, dry;
+	enum { numCombs = 8, numAllPasses = 4, numChannels = 2, maxChunkSize = 32 };
 
-	inline static bool isFrozen (const float freezeMode) noexcept  { return freezeMode >= 0.5f; }
-
-	void updateDamping() noexcept
+	// Holds a value that can be moved smoothly towards a new target
+	struct SmoothedValue
 	{
-		const float roomScaleFactor = 0.28f;
-		const float roomOffset = 0.7f;
-		const float dampScaleFactor = 0.4f;
+		SmoothedValue() noexcept  : current (0), target (0), numSamplesLeft (0) {}
 
-		shouldUpdateDamping = false;
+		void setTarget (float newTarget, int numSamplesToTake) noexcept;
+		void skip (int numSamples) noexcept;
 
-		if (isFrozen (parameters.freezeMode))
-			setDamping (1.0f, 0.0f);
-		else
-			setDamping (parameters.damping * dampScaleFactor,
-						parameters.roomSize * roomScaleFactor + roomOffset);
-	}
-
-	void setDamping (const float dampingToUse, const float roomSizeToUse) noexcept
-	{
-		for (int j = 0; j < numChannels; ++j)
-			for (int i = numCombs; --i >= 0;)
-				comb[j][i].setFeedbackAndDamp (roomSizeToUse, dampingToUse);
-	}
+		float current, target;
+		int numSamplesLeft;
+	};
 
-	class CombFilter
+	// A circular delay line. The samples are processed in chunks that don't run
+	// past the end of any of the lines, so their positions don't need to wrap
+	// around in the middle of a chunk.
+	struct DelayLine
 	{
-	public:
-		CombFilter() noexcept  : bufferSize (0), bufferIndex (0) {}
+		DelayLine() noexcept  : size (0), position (0) {}
 
-		void setSize (const int size)
-		{
-			if (size != bufferSize)
-			{
-				bufferIndex = 0;
-				buffer.malloc (size);
-				bufferSize = size;
-			}
+		void setSize (int newSize);
+		void clear() noexcept;
+		void advance (int numSamples) noexcept;
 
-			clear();
-		}
-
-		void clear() noexcept
-		{
-			last = 0;
-			buffer.clear (bufferSize);
-		}
-
-		void setFeedbackAndDamp (const float f, const float d) noexcept
-		{
-			damp1 = d;
-			damp2 = 1.0f - d;
-			feedback = f;
-		}
-
-		inline float process (const float input) noexcept
-		{
-			const float output = buffer [bufferIndex];
-			last = (output * damp2) + (last * damp1);
-			JUCE_UNDENORMALISE (last);
-
-			float temp = input + (last * feedback);
-			JUCE_UNDENORMALISE (temp);
-			buffer [bufferIndex] = temp;
-			bufferIndex = (bufferIndex + 1) % bufferSize;
-			return output;
-		}
-
-	private:
 		HeapBlock<float> buffer;
-		int bufferSize, bufferIndex;
-		float feedback, last, damp1, damp2;
-
-		JUCE_DECLARE_NON_COPYABLE (CombFilter);
+		int size, position;
 	};
 
-	class AllPassFilter
-	{
-	public:
-		AllPassFilter() noexcept  : bufferSize (0), bufferIndex (0) {}
-
-		void setSize (const int size)
-		{
-			if (size != bufferSize)
-			{
-				bufferIndex = 0;
-				buffer.malloc (size);
-				bufferSize = size;
-			}
-
-			clear();
-		}
-
-		void clear() noexcept
-		{
-			buffer.clear (bufferSize);
-		}
-
-		inline float process (const float input) noexcept
-		{
-			const float bufferedValue = buffer [bufferIndex];
-			float temp = input + (bufferedValue * 0.5f);
-			JUCE_UNDENORMALISE (temp);
-			buffer [bufferIndex] = temp;
-			bufferIndex = (bufferIndex + 1) % bufferSize;
-			return bufferedValue - input;
-		}
+	Parameters parameters;
+	SmoothedValue gain, wet1, wet2, dry, feedback, damping;
+	double sampleRate, smoothingTime;
 
-	private:
-		HeapBlock<float> buffer;
-		int bufferSize, bufferIndex;
+	DelayLine combs [numChannels][numCombs];
+	DelayLine allPasses [numChannels][numAllPasses];
 
-		JUCE_DECLARE_NON_COPYABLE (AllPassFilter);
-	};
+	// the state of the low-pass filter in each comb's feedback loop
+	float combFilterStates [numChannels * numCombs];
 
-	enum { numCombs = 8, numAllPasses = 4, numChannels = 2 };
+	inline static bool isFrozen (const float freezeMode) noexcept  { return freezeMode >= 0.5f; }
 
-	CombFilter comb [numChannels][numCombs];
-	AllPassFilter allPass [numChannels][numAllPasses];
+	int getChunkSize (int numSamplesLeft, int numChannelsToUse) const noexcept;
+	void processCombs (const float* input, float** outputs, int numSamples, int numChannelsToUse) noexcept;
+	void processAllPasses (float* samples, int channel, int numSamples) noexcept;
+	void updateSmoothedValues (int numSamples) noexcept;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Reverb);
 };
@@ -39927,6 +40882,11 @@ public:
 	static AudioIODeviceType* createAudioIODeviceType_ASIO();
 	/** Creates an ALSA device type if it's available on this platform, or returns null. */
 	static AudioIODeviceType* createAudioIODeviceType_ALSA();
+	/** Creates an ALSA device type that transfers audio through the devices' mmapped buffers
+		and runs its thread with SCHED_FIFO priority, if it's available on this platform, or
+		returns null.
+	*/
+	static AudioIODeviceType* createAudioIODeviceType_ALSALowLatency();
 	/** Creates a JACK device type if it's available on this platform, or returns null. */
 	static AudioIODeviceType* createAudioIODeviceType_JACK();
 	/** Creates an Android device type if it's available on this platform, or returns null. */
@@ -41004,6 +41964,12 @@ private:
 	Analogous to the AudioSampleBuffer, this holds a set of midi events with
 	integer time-stamps. The buffer is kept sorted in order of the time-stamps.
 
+	Adding events in time order just appends them, and the buffer keeps an index of
+	where each event starts, so counting the events or seeking to a given time doesn't
+	involve searching through them all. If you need to fill a buffer on the audio
+	thread, you can give it a fixed capacity with setFixedCapacity(), so that it never
+	has to allocate any memory.
+
 	@see MidiMessage
 */
 class JUCE_API  MidiBuffer
@@ -41041,12 +42007,7 @@ public:
 	*/
 	bool isEmpty() const noexcept;
 
-	/** Counts the number of events in the buffer.
-
-		This is actually quite a slow operation, as it has to iterate through all
-		the events, so you might prefer to call isEmpty() if that's all you need
-		to know.
-	*/
+	/** Returns the number of events in the buffer. */
 	int getNumEvents() const noexcept;
 
 	/** Adds an event to the buffer.
@@ -41058,6 +42019,9 @@ public:
 		If an event is added whose sample position is the same as one or more events
 		already in the buffer, the new event will be placed after the existing ones.
 
+		Adding an event whose position isn't before the last one in the buffer is
+		a quick operation, as it just gets appended to the end.
+
 		To retrieve events, use a MidiBuffer::Iterator object
 	*/
 	void addEvent (const MidiMessage& midiMessage, int sampleNumber);
@@ -41095,6 +42059,9 @@ public:
 									startSample will be taken.
 		@param sampleDeltaToAdd	 a value which will be added to the source timestamps of the events
 									that are added to this buffer
+
+		The new events are merged with the existing ones in a single pass, so this is
+		much quicker than adding them one at a time if they overlap the existing ones.
 	*/
 	void addEvents (const MidiBuffer& otherBuffer,
 					int startSample,
@@ -41126,6 +42093,21 @@ public:
 	*/
 	void ensureSize (size_t minimumNumBytes);
 
+	/** Preallocates enough memory for the given number of bytes of events, and stops the
+		buffer from ever allocating any more.
+
+		Once a buffer has a fixed capacity, adding events to it (or copying another buffer
+		into it) won't allocate any memory, so it's safe to do on the audio thread. If
+		there's no room left for an event, it gets dropped, and an assertion fires in a
+		debug build, so make the capacity big enough for the busiest block you expect.
+		Each event takes up its midi data plus 6 bytes, so e.g. a note-on needs 9 bytes.
+
+		Passing 0 lets the buffer go back to growing as needed.
+
+		@see ensureSize
+	*/
+	void setFixedCapacity (size_t numBytes);
+
 	/**
 		Used to iterate through the events in a MidiBuffer.
 
@@ -41188,10 +42170,17 @@ private:
 
 	friend class MidiBuffer::Iterator;
 	MemoryBlock data;
-	int bytesUsed;
+	HeapBlock <int> eventOffsets;   // the position of each event in the data
+	int bytesUsed, numEvents, numEventOffsetsAllocated;
+	bool hasFixedCapacity;
 
 	uint8* getData() const noexcept;
-	uint8* findEventAfter (uint8* d, int samplePosition) const noexcept;
+	int getEventOffset (int eventIndex) const noexcept;
+	int getEventTimeAt (int eventIndex) const noexcept;
+	int findIndexOfFirstEventAfter (int samplePosition) const noexcept;
+	bool ensureSpaceFor (int totalNumBytes, int totalNumEvents);
+	void ensureIndexSize (int numEventOffsetsNeeded);
+	void removeEvents (int startIndex, int endIndex) noexcept;
 	static int getEventTime (const void* d) noexcept;
 	static uint16 getEventDataSize (const void* d) noexcept;
 	static uint16 getEventTotalSize (const void* d) noexcept;
@@ -41798,6 +42787,9 @@ private:
 #endif
 #ifndef __JUCE_AUDIOIODEVICETYPE_JUCEHEADER__
 
+#endif
+#ifndef __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
+
 #endif
 #ifndef __JUCE_AUDIODATACONVERTERS_JUCEHEADER__
 
@@ -41887,9 +42879,126 @@ private:
 /*** End of inlined file: juce_Decibels.h ***/
 
 
+#endif
+#ifndef __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
+
+/*** Start of inlined file: juce_FloatVectorOperations.h ***/
+#ifndef __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
+#define __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
+
+/**
+	A collection of simple vector operations on arrays of floats, accelerated with
+	SIMD instructions where possible.
+
+	The best instruction set that the CPU supports is picked at runtime, so for example
+	an SSE2 build made with GCC or Clang will use AVX when it's running on a machine that
+	has it. The arrays don't need to be aligned, although the operations run fastest on
+	32-byte aligned data, which is what AudioSampleBuffer allocates.
+
+	@see AudioSampleBuffer
+*/
+class JUCE_API  FloatVectorOperations
+{
+public:
+
+	/** Clears a vector of floats. */
+	static void JUCE_CALLTYPE clear (float* dest, int numValues) noexcept;
+
+	/** Copies a vector of floats. */
+	static void JUCE_CALLTYPE copy (float* dest, const float* src, int numValues) noexcept;
+
+	/** Copies a vector of floats, multiplying each value by a given multiplier. */
+	static void JUCE_CALLTYPE copyWithMultiply (float* dest, const float* src, float multiplier, int numValues) noexcept;
+
+	/** Copies a vector of floats, multiplying them by a gain that starts at startGain and
+		changes by gainIncrement after each value.
+	*/
+	static void JUCE_CALLTYPE copyWithRamp (float* dest, const float* src, float startGain, float gainIncrement, int numValues) noexcept;
+
+	/** Adds the source values to the destination values. */
+	static void JUCE_CALLTYPE add (float* dest, const float* src, int numValues) noexcept;
+
+	/** Multiplies each source value by the given multiplier, and adds it to the destination value. */
+	static void JUCE_CALLTYPE addWithMultiply (float* dest, const float* src, float multiplier, int numValues) noexcept;
+
+	/** Adds the source values to the destination values, multiplying them by a gain that starts
+		at startGain and changes by gainIncrement after each value.
+	*/
+	static void JUCE_CALLTYPE addWithRamp (float* dest, const float* src, float startGain, float gainIncrement, int numValues) noexcept;
+
+	/** Multiplies each of the destination values by a fixed multiplier. */
+	static void JUCE_CALLTYPE multiply (float* dest, float multiplier, int numValues) noexcept;
+
+	/** Multiplies the destination values by a gain that starts at startGain and changes by
+		gainIncrement after each value.
+	*/
+	static void JUCE_CALLTYPE multiplyWithRamp (float* dest, float startGain, float gainIncrement, int numValues) noexcept;
+
+	/** Finds the lowest and highest values in a vector.
+		If numValues is 0, both results will be 0.
+	*/
+	static void JUCE_CALLTYPE findMinAndMax (const float* src, int numValues, float& minResult, float& maxResult) noexcept;
+
+	/** Returns the sum of the squares of the values in a vector, accumulated in double precision. */
+	static double JUCE_CALLTYPE sumOfSquares (const float* src, int numValues) noexcept;
+
+	/** The instruction sets that the operations can be performed with. */
+	enum InstructionSet
+	{
+		scalar,	 /**< Plain C++ loops. */
+		sse2,	   /**< 128-bit SSE2 vectors. */
+		avx	 /**< 256-bit AVX vectors. */
+	};
+
+	/** Returns the instruction set that's currently being used. */
+	static InstructionSet JUCE_CALLTYPE getInstructionSet() noexcept;
+
+	/** Forces the operations to use a particular instruction set.
+
+		This is intended for testing and benchmarking, and shouldn't be called while any other
+		threads might be using these functions. It returns false (and changes nothing) if the
+		instruction set isn't supported by this build or this CPU.
+	*/
+	static bool JUCE_CALLTYPE setInstructionSet (InstructionSet newInstructionSet) noexcept;
+
+	/** Returns the best instruction set that this build can use on this CPU. */
+	static InstructionSet JUCE_CALLTYPE getBestAvailableInstructionSet() noexcept;
+};
+
+/**
+	While this object is in scope, the CPU treats denormalised floating point values as
+	zero, both as inputs and as results.
+
+	Recursive filters and feedback loops can produce values that decay into the denormal
+	range when their input goes quiet, and on many CPUs, arithmetic with these is much
+	slower. Create one of these on the stack around the processing code to avoid this.
+	It only affects the calling thread, and the previous mode is restored when it's deleted.
+
+	On CPUs where this isn't supported, it does nothing.
+*/
+class JUCE_API  ScopedNoDenormals
+{
+public:
+	ScopedNoDenormals() noexcept;
+	~ScopedNoDenormals() noexcept;
+
+private:
+	pointer_sized_int previousState;
+
+	JUCE_DECLARE_NON_COPYABLE (ScopedNoDenormals);
+};
+
+#endif   // __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
+
+/*** End of inlined file: juce_FloatVectorOperations.h ***/
+
+
 #endif
 #ifndef __JUCE_IIRFILTER_JUCEHEADER__
 
+#endif
+#ifndef __JUCE_IIRFILTERCASCADE_JUCEHEADER__
+
 #endif
 #ifndef __JUCE_REVERB_JUCEHEADER__
 
@@ -46603,6 +47712,10 @@ private:
 	added, you can connect any of their input or output channels to other
 	nodes using addConnection().
 
+	Whenever the nodes or connections change, the graph works out its new rendering
+	sequence on a background thread, and the audio thread carries on playing the old one
+	until the new one is ready, so editing a large graph won't interrupt the audio.
+
 	To play back a graph through an audio device, you might want to use an
 	AudioProcessorPlayer object.
 */
@@ -46807,6 +47920,27 @@ public:
 	*/
 	bool removeIllegalConnections();
 
+	/** Lets independent branches of the graph be rendered on several threads at once.
+
+		The rendering sequence is split up into one task per node, and any nodes that
+		don't share buffers with each other (e.g. several synths that all feed into a
+		mixer) are shared out between the audio thread and the given number of extra
+		threads. Nodes that depend on each other still run in the same order as they
+		would on a single thread, so the output is exactly the same, including the
+		order in which signals are mixed together. If a graph has no branches that can
+		run in parallel, it's just rendered serially.
+
+		Each processor is still only called by one thread at a time, but it may be a
+		different thread from one block to the next. Passing 0 stops the threads, and
+		goes back to rendering everything on the audio thread.
+	*/
+	void setNumRenderThreads (int numThreads);
+
+	/** Returns the number of extra threads that are used to render the graph.
+		@see setNumRenderThreads
+	*/
+	int getNumRenderThreads() const noexcept;
+
 	/** A special number that represents the midi channel of a node.
 
 		This is used as a channel index value if you want to refer to the midi input
@@ -46947,11 +48081,18 @@ private:
 	ReferenceCountedArray <Node> nodes;
 	OwnedArray <Connection> connections;
 	uint32 lastNodeId;
-	AudioSampleBuffer renderingBuffers;
-	OwnedArray <MidiBuffer> midiBuffers;
+	AudioBufferPool bufferPool;
+
+	class RenderSequence;
+	class SequenceBuilder;
+	class ParallelRenderer;
+	friend class SequenceBuilder;
 
 	CriticalSection renderLock;
-	Array<void*> renderingOps;
+	RenderSequence* currentSequence;
+	Atomic <RenderSequence*> pendingSequence, retiredSequences;
+	ScopedPointer <SequenceBuilder> sequenceBuilder;
+	ScopedPointer <ParallelRenderer> parallelRenderer;
 
 	friend class AudioGraphIOProcessor;
 	AudioSampleBuffer* currentAudioInputBuffer;
@@ -46961,8 +48102,10 @@ private:
 
 	void clearRenderingSequence();
 	void buildRenderingSequence();
-
-	bool isAnInputTo (uint32 possibleInputId, uint32 possibleDestinationId, int recursionCheck) const;
+	void prepareNodes();
+	void installSequence (RenderSequence*);
+	void publishSequence (RenderSequence*) noexcept;
+	void retireSequence (RenderSequence*) noexcept;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorGraph);
 };
@@ -47325,7 +48468,12 @@ private:
 
 
 #endif
-#ifndef __JUCE_SAMPLER_JUCEHEADER__
+#ifndef __JUCE_SAMPLECACHE_JUCEHEADER__
+
+/*** Start of inlined file: juce_SampleCache.h ***/
+#ifndef __JUCE_SAMPLECACHE_JUCEHEADER__
+#define __JUCE_SAMPLECACHE_JUCEHEADER__
+
 
 /*** Start of inlined file: juce_Sampler.h ***/
 #ifndef __JUCE_SAMPLER_JUCEHEADER__
@@ -47336,6 +48484,8 @@ private:
 #ifndef __JUCE_SYNTHESISER_JUCEHEADER__
 #define __JUCE_SYNTHESISER_JUCEHEADER__
 
+class Synthesiser;
+
 /**
 	Describes one of the sounds that a Synthesiser can play.
 
@@ -47361,14 +48511,17 @@ public:
 	/** Returns true if this sound should be played when a given midi note is pressed.
 
 		The Synthesiser will use this information when deciding which sounds to trigger
-		for a given note.
+		for a given note. It asks once for every note when the sound is added, and keeps
+		the answers in a lookup table, so the result mustn't change while the sound is
+		in use (if it does, call Synthesiser::updateSoundLookup()).
 	*/
 	virtual bool appliesToNote (const int midiNoteNumber) = 0;
 
 	/** Returns true if the sound should be triggered by midi events on a given channel.
 
 		The Synthesiser will use this information when deciding which sounds to trigger
-		for a given note.
+		for a given note. While a voice is playing the sound, the synth remembers which
+		channels it applies to, so the result mustn't change while the sound is in use.
 	*/
 	virtual bool appliesToChannel (const int midiChannel) = 0;
 
@@ -47528,6 +48681,15 @@ private:
 	bool keyIsDown; // the voice may still be playing when the key is not down (i.e. sustain pedal)
 	bool sostenutoPedalDown;
 
+	// these are used by the synth that owns the voice to keep track of what it's doing
+	Synthesiser* owner;
+	int listIndex, listNote, channelMask;
+	bool isActive;
+	SynthesiserVoice* previousWithNote;
+	SynthesiserVoice* nextWithNote;
+	SynthesiserVoice* previousOnChannel [16];
+	SynthesiserVoice* nextOnChannel [16];
+
 	JUCE_LEAK_DETECTOR (SynthesiserVoice);
 };
 
@@ -47553,6 +48715,10 @@ private:
 	Before rendering, be sure to call the setCurrentPlaybackSampleRate() to tell it
 	what the target playback rate is. This value is passed on to the voices so that
 	they can pitch their output correctly.
+
+	Normally the voices and sounds are protected by a lock which the audio thread has to
+	take while rendering, so changing them from another thread can hold up the audio. If
+	that's a problem, see setRealtimeSafeMode().
 */
 class JUCE_API  Synthesiser
 {
@@ -47571,7 +48737,7 @@ public:
 	void clearVoices();
 
 	/** Returns the number of voices that have been added. */
-	int getNumVoices() const					{ return voices.size(); }
+	int getNumVoices() const;
 
 	/** Returns one of the voices that have been added. */
 	SynthesiserVoice* getVoice (int index) const;
@@ -47593,10 +48759,18 @@ public:
 	void clearSounds();
 
 	/** Returns the number of sounds that have been added to the synth. */
-	int getNumSounds() const					{ return sounds.size(); }
+	int getNumSounds() const;
 
 	/** Returns one of the sounds. */
-	SynthesiserSound* getSound (int index) const			{ return sounds [index]; }
+	SynthesiserSound* getSound (int index) const;
+
+	/** Returns a copy of the synth's current set of sounds.
+
+		The copy holds a reference to each sound, so unlike the pointer that getSound()
+		returns, these can be used safely while another thread is changing the synth's
+		sounds.
+	*/
+	const ReferenceCountedArray <SynthesiserSound> getSounds() const;
 
 	/** Adds a new sound to the synthesiser.
 
@@ -47608,6 +48782,28 @@ public:
 	/** Removes and deletes one of the sounds. */
 	void removeSound (int index);
 
+	/** Replaces the synth's complete set of sounds with the contents of another array.
+
+		The two arrays just exchange their contents, so nothing gets deleted while the lock
+		is held. When this returns, the array that was passed in holds the sounds that the
+		synth was previously using, so the caller can choose which thread they finally get
+		released on (voices that are still playing them will keep them alive until their
+		notes finish).
+
+		The synth's note lookup table is rebuilt for the new sounds. It's created with room
+		for one sound per note, and only needs to allocate memory if the new sounds cover
+		more notes between them than that, or than any previous set did.
+	*/
+	void swapSounds (ReferenceCountedArray <SynthesiserSound>& newSounds);
+
+	/** Rebuilds the table that the synth uses to find the sounds for a note.
+
+		The table is built from SynthesiserSound::appliesToNote() whenever the set of sounds
+		changes, so this only needs to be called if one of the sounds changes its mind about
+		which notes it applies to.
+	*/
+	void updateSoundLookup();
+
 	/** If set to true, then the synth will try to take over an existing voice if
 		it runs out and needs to play another note.
 
@@ -47621,6 +48817,66 @@ public:
 	*/
 	bool isNoteStealingEnabled() const				  { return shouldStealNotes; }
 
+	/** Makes the audio thread independent of any other threads that change the voices
+		or sounds.
+
+		In real-time-safe mode, the renderNextBlock() method (and the note and controller
+		methods it calls) never take the synth's lock or allocate memory. Instead, each call
+		to addVoice(), removeVoice(), addSound(), swapSounds(), etc. builds a complete new
+		set of voices and sounds, which the audio thread picks up at the start of its next
+		block. Voices and sounds that get removed are deleted later on the message thread,
+		once the audio thread has stopped using them.
+
+		The catch is that the render and note methods must then all be called from the
+		same thread (normally the audio thread), and that changes to the voices and sounds
+		only take effect when the next block gets rendered, so e.g. getNumVoices() returns
+		the number of voices that the synth will have, not the number it's currently
+		playing with. The same goes for setCurrentPlaybackSampleRate() and
+		setNumRenderThreads(), which are also passed to the audio thread this way.
+
+		This mustn't be called while a block is being rendered. A Timer is used to clean
+		up the old voices and sounds, so a message thread must be running.
+	*/
+	void setRealtimeSafeMode (bool shouldBeRealtimeSafe);
+
+	/** Returns true if real-time-safe mode is turned on.
+		@see setRealtimeSafeMode
+	*/
+	bool isRealtimeSafeMode() const noexcept			{ return realtimeUpdater != nullptr; }
+
+	/** Shares out the work of rendering the voices between some extra threads.
+
+		When enough voices are playing, renderNextBlock() hands them out to a set of worker
+		threads (see ParallelTaskRunner). Each voice renders into a buffer of its own, and
+		these buffers are then added to the output in voice order, so the result doesn't
+		depend on which thread rendered which voice. The calling thread renders voices as
+		well, and picks up any voices that the workers haven't got round to, so it never
+		waits for a worker to start; and if a worker that's already started a voice is held
+		up for longer than the block lasts, the next few blocks are rendered without the
+		workers. The block is still divided up at each midi event in the same way, so the
+		timing of the events isn't affected.
+
+		The numChannels and maximumBlockSize values, and the number of voices that the synth
+		has when this is called, are used to allocate the voices' buffers, so any block
+		that's longer than this, has a different number of channels, or has more voices
+		playing gets rendered in the normal way. Passing 0 for numThreads stops the threads,
+		and goes back to rendering everything on the calling thread.
+
+		While a voice is being rendered on one of these threads, it mustn't use anything
+		other than its own state and the sound it's playing.
+
+		Starting the threads is slow, so if the settings are the same as last time, this
+		does nothing. In real-time-safe mode, the new threads are handed to the audio
+		thread at the start of its next block, and the old ones are stopped later on the
+		message thread; otherwise, this takes the synth's lock while it swaps them over.
+	*/
+	void setNumRenderThreads (int numThreads, int numChannels, int maximumBlockSize);
+
+	/** Returns the number of extra threads that are used to render the voices.
+		@see setNumRenderThreads
+	*/
+	int getNumRenderThreads() const noexcept;
+
 	/** Triggers a note-on event.
 
 		The default method here will find all the sounds that want to be triggered by
@@ -47744,7 +49000,11 @@ protected:
 	/** Searches through the voices to find one that's not currently playing, and which
 		can play the given sound.
 
-		Returns 0 if all voices are busy and stealing isn't enabled.
+		Returns 0 if all voices are busy and stealing isn't enabled. If stealing is enabled,
+		this returns the voice that's been playing for the longest.
+
+		The synth keeps a list of its free voices and a heap of the busy ones ordered by
+		age, so as long as all the voices can play the sound, this doesn't need to search.
 
 		This can be overridden to implement custom voice-stealing algorithms.
 	*/
@@ -47764,14 +49024,53 @@ protected:
 
 private:
 
+	friend class SynthesiserVoice;
+	class RealtimeUpdater;
+	friend class RealtimeUpdater;
+	class ParallelRenderer;
+
 	double sampleRate;
 	uint32 lastNoteOnCounter;
 	bool shouldStealNotes;
 	BigInteger sustainPedalsDown;
 
+	// The voices that aren't playing are kept in a list, and the ones that are playing are
+	// kept in a heap with the oldest note at the top. Both of these are allocated when voices
+	// are added, so nothing needs to be allocated while notes are starting and stopping.
+	HeapBlock <SynthesiserVoice*> freeVoices, activeVoices;
+	int numFreeVoices, numActiveVoices;
+
+	// The playing voices are also linked into a list for each note and each midi channel
+	SynthesiserVoice* firstVoiceWithNote [128];
+	SynthesiserVoice* firstVoiceOnChannel [16];
+
+	// The sounds that apply to note n are noteSounds [noteSoundsStart [n]] up to
+	// noteSounds [noteSoundsStart [n + 1] - 1]
+	HeapBlock <SynthesiserSound*> noteSounds;
+	int noteSoundsStart [129];
+	int numNoteSoundsAllocated, numSoundsInLookup;
+
+	// (only used in real-time-safe mode)
+	ScopedPointer <RealtimeUpdater> realtimeUpdater;
+
+	// (only used if there are some render threads)
+	ScopedPointer <ParallelRenderer> parallelRenderer;
+	int numRenderThreads, renderThreadChannels, renderThreadBlockSize, renderThreadVoices;
+	bool isRenderingInParallel;
+
 	void handleMidiEvent (const MidiMessage& m);
+	void renderVoices (AudioSampleBuffer& outputBuffer, int startSample, int numSamples);
 	void stopVoice (SynthesiserVoice* voice, bool allowTailOff);
 
+	void updateVoiceLists();
+	void relinkVoices();
+	void checkVoiceLists();
+	void applyPendingConfiguration();
+	void voiceStarted (SynthesiserVoice* voice);
+	void voiceFinished (SynthesiserVoice* voice);
+	void moveUpHeap (int index) noexcept;
+	void moveDownHeap (int index) noexcept;
+
    #if JUCE_CATCH_DEPRECATED_CODE_MISUSE
 	// Note the new parameters for this method.
 	virtual int findFreeVoice (const bool) const { return 0; }
@@ -47784,11 +49083,83 @@ private:
 
 /*** End of inlined file: juce_Synthesiser.h ***/
 
+class SamplerStreamer;
+
+/**
+	The decoded audio that a SamplerSound plays.
+
+	Once it has been created this data never changes, so a single copy of it can be
+	shared by any number of sounds - the SampleCache uses this to avoid loading the
+	same file more than once.
+
+	@see SamplerSound, SampleCache
+*/
+class JUCE_API  SamplerSoundData  : public ReferenceCountedObject
+{
+public:
+
+	/** Reads audio from a source into memory.
+
+		@param source	   the audio to load. This object can be safely deleted by the
+								caller after this constructor returns
+		@param numSamplesToLoad the number of samples to read from the start of the source.
+								This is clipped to the source's length
+	*/
+	SamplerSoundData (AudioFormatReader& source, int numSamplesToLoad);
+
+	/** Destructor. */
+	~SamplerSoundData();
+
+	/** Returns the audio, which will have either one or two channels.
+		The buffer has a few extra samples of padding after getNumSamples(), so don't use its
+		size to find out how much audio there is.
+	*/
+	const AudioSampleBuffer& getAudioData() const noexcept	  { return buffer; }
+
+	/** Returns the number of samples that were loaded. */
+	int getNumSamples() const noexcept			  { return numSamples; }
+
+	/** Returns the length of the source that the data was loaded from.
+		This can be longer than getNumSamples() if only the start of it was loaded.
+	*/
+	int getSourceLength() const noexcept			{ return sourceLength; }
+
+	/** Returns the source's sample rate, or 0 if it couldn't be read. */
+	double getSampleRate() const noexcept			   { return sampleRate; }
+
+	/** Returns a copy of this data that has been converted to a different sample rate.
+
+		The first time a particular rate is asked for, this uses a high-quality filter to
+		convert the audio, which can take a while - so it's best called on a background thread.
+		After that, the same copy is returned, and it stays alive for as long as this
+		object does, so it's shared by all the sounds that use this data.
+
+		If the new rate is the same as this data's rate, this just returns the object itself.
+	*/
+	SamplerSoundData* getResampledVersion (double newSampleRate);
+
+	/** A pointer type that can be used to share the data. */
+	typedef ReferenceCountedObjectPtr <SamplerSoundData> Ptr;
+
+private:
+
+	AudioSampleBuffer buffer;
+	double sampleRate;
+	int numSamples, sourceLength;
+	ReferenceCountedArray <SamplerSoundData> resampledVersions;
+	CriticalSection resampleLock;
+
+	SamplerSoundData (const SamplerSoundData& source, double newSampleRate);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerSoundData);
+};
+
 /**
 	A subclass of SynthesiserSound that represents a sampled audio clip.
 
 	This is a pretty basic sampler, and just attempts to load the whole audio stream
-	into memory.
+	into memory. For long samples, a StreamingSamplerSound will only keep the start
+	of the sample in memory, and play the rest of it from disk.
 
 	To use it, create a Synthesiser, add some SamplerVoice objects to it, then
 	give it some SampledSound objects to play.
@@ -47825,6 +49196,26 @@ public:
 				  double releaseTimeSecs,
 				  double maxSampleLengthSeconds);
 
+	/** Creates a sound that plays some audio that has already been loaded.
+
+		This lets several sounds share the same data, e.g. one that was returned by the
+		SampleCache.
+
+		@param name	 a name for the sample
+		@param data	 the audio to play - this must not be null
+		@param midiNotes	the set of midi keys that this sound should be played on
+		@param midiNoteForNormalPitch   the midi note at which the sample should be played
+										with its natural rate
+		@param attackTimeSecs   the attack (fade-in) time, in seconds
+		@param releaseTimeSecs  the decay (fade-out) time, in seconds
+	*/
+	SamplerSound (const String& name,
+				  SamplerSoundData* data,
+				  const BigInteger& midiNotes,
+				  int midiNoteForNormalPitch,
+				  double attackTimeSecs,
+				  double releaseTimeSecs);
+
 	/** Destructor. */
 	~SamplerSound();
 
@@ -47834,17 +49225,64 @@ public:
 	/** Returns the audio sample data.
 		This could be 0 if there was a problem loading it.
 	*/
-	AudioSampleBuffer* getAudioData() const		 { return data; }
+	const AudioSampleBuffer* getAudioData() const	   { return data != nullptr ? &(data->getAudioData()) : nullptr; }
+
+	/** Returns the shared object that holds the sound's audio. */
+	SamplerSoundData* getSoundData() const noexcept	 { return data; }
+
+	/** Converts the sound's audio to the sample rate that it'll be played at.
+
+		A voice has to interpolate every sample of a sound whose rate doesn't match its
+		own, even at the sound's root note. After this has been called with the voices'
+		sample rate, notes at the root pitch are a straight copy of the data, and other
+		notes only need to be interpolated for the change in pitch.
+
+		The conversion can take a while, so this should be called on a background thread.
+		Voices carry on playing the original data until it has finished, and any notes that
+		are already playing when it finishes will stay with the data they started with.
+		The original data is kept, so it's cheap to switch back to it (or to any rate that
+		has already been used).
+
+		Sounds that only keep part of their audio in memory (i.e. a StreamingSamplerSound
+		that's longer than its preload time) can't be resampled, and will return false.
+
+		@see SamplerSoundData::getResampledVersion
+	*/
+	bool resampleTo (double newSampleRate);
 
 	bool appliesToNote (const int midiNoteNumber);
 	bool appliesToChannel (const int midiChannel);
 
+protected:
+
+	/** Creates a sound without loading any audio.
+		Subclasses that use this must call setSoundData() from their own constructor.
+	*/
+	SamplerSound (const String& name,
+				  const BigInteger& midiNotes,
+				  int midiNoteForNormalPitch);
+
+	/** Sets the audio that the sound plays.
+
+		@param data		 the audio data, which may only hold the start of the sound
+		@param totalLength	  the length that the sound should be played for - this can be
+								longer than the data if a subclass provides the rest
+		@param attackTimeSecs   the attack (fade-in) time, in seconds
+		@param releaseTimeSecs  the decay (fade-out) time, in seconds
+	*/
+	void setSoundData (SamplerSoundData* data,
+					   int totalLength,
+					   double attackTimeSecs,
+					   double releaseTimeSecs);
+
 private:
 
 	friend class SamplerVoice;
+	friend class SamplerStreamer;
 
 	String name;
-	ScopedPointer <AudioSampleBuffer> data;
+	SamplerSoundData::Ptr data;
+	Atomic <SamplerSoundData*> playbackData;
 	double sourceSampleRate;
 	BigInteger midiNotes;
 	int length, attackSamples, releaseSamples;
@@ -47887,12 +49325,63 @@ public:
 
 	void renderNextBlock (AudioSampleBuffer& outputBuffer, int startSample, int numSamples);
 
+	/** The methods that a SamplerVoice can use to interpolate between source samples. */
+	enum InterpolationMode
+	{
+		linearInterpolation = 0,	/**< The cheapest method, but it'll alias badly if a sample
+										 is pitched a long way from its root note. */
+		cubicInterpolation,	 /**< A 4-point cubic Hermite interpolator, which is smoother
+										 than linear but still not band-limited. */
+		sincInterpolation	   /**< A 32-point windowed-sinc interpolator, whose cutoff follows
+										 the pitch so that samples can be pitched up without aliasing.
+										 This is the best quality, but uses by far the most CPU. */
+	};
+
+	/** Changes the interpolation method that the voice uses.
+
+		This takes effect from the next note that the voice starts, and it's safe to call while
+		the voice is rendering on another thread. By default, a voice uses linearInterpolation.
+
+		The first switch to sincInterpolation creates the tables that it needs, unless
+		createInterpolationTables() has already done so, so if this might be called from the
+		audio thread (e.g. from a plugin parameter change), call createInterpolationTables()
+		beforehand.
+	*/
+	void setInterpolationMode (InterpolationMode newMode);
+
+	/** Creates the tables that sincInterpolation uses, if they don't already exist.
+
+		These are shared by all voices, and take a while to build, so this lets you get it out
+		of the way before playback starts.
+		@see setInterpolationMode
+	*/
+	static void createInterpolationTables();
+
+	/** Returns the interpolation method that was set with setInterpolationMode(). */
+	InterpolationMode getInterpolationMode() const noexcept	 { return (InterpolationMode) interpolationMode.get(); }
+
 private:
 
 	double pitchRatio;
 	double sourceSamplePosition;
 	float lgain, rgain, attackReleaseLevel, attackDelta, releaseDelta;
 	bool isInAttack, isInRelease;
+	Atomic<int> interpolationMode;  // (set from other threads, and read when a note starts)
+	InterpolationMode noteInterpolationMode;
+	int playbackLength;
+	const SamplerSoundData* noteData;
+
+	// state used while playing a StreamingSamplerSound
+	SamplerStreamer* streamer;
+	int streamIndex;
+	AudioSampleBuffer streamWindow;
+	int streamWindowStart, streamWindowSize;
+
+	bool renderSamples (const float* inL, const float* inR, int firstSampleInSource, int numAvailable,
+						float* outL, float* outR, int numSamples);
+	static int getNumInterpolationTaps (InterpolationMode mode, bool before) noexcept;
+	int fillStreamWindow (const SamplerSound& sound, int numSamples);
+	void closeStream();
 
 	JUCE_LEAK_DETECTOR (SamplerVoice);
 };
@@ -47901,6 +49390,233 @@ private:
 
 /*** End of inlined file: juce_Sampler.h ***/
 
+/**
+	A global cache of sample data that has been loaded from audio files.
+
+	If several synthesisers (or several instances of a plugin) in the same process load
+	the same files, this lets them all share one copy of the decoded audio, and means
+	that only the first one to load a file has to wait for it to be decoded.
+
+	Files are identified by their full path and their modification time, so if a file
+	is changed on disk, the next request for it will load the new version.
+
+	When data is no longer being used by any sounds, it's kept for a few seconds before
+	being released, so if a set of sounds is deleted and then reloaded, it won't need
+	to be read again.
+
+	@see SamplerSoundData, SamplerSound
+*/
+class JUCE_API  SampleCache
+{
+public:
+
+	/** Returns the data for a file, loading it if it's not already in the cache.
+
+		If the cache already contains the same number of samples loaded from this
+		file (and the file hasn't been modified since), that data is returned and the
+		reader isn't used. Otherwise this will read the samples from the reader, add
+		them to the cache, and return them.
+
+		This can be called from any thread.
+
+		@param file	 the file that the reader is reading
+		@param source	   a reader that has been opened on the file
+		@param numSamples   the number of samples to load from the start of the file
+	*/
+	static SamplerSoundData::Ptr getFromFile (const File& file,
+											  AudioFormatReader& source,
+											  int numSamples);
+
+	/** Checks the cache for data that was loaded from a file.
+
+		@returns the data, or null if the cache doesn't hold that number of samples
+				 loaded from the current version of the file
+	*/
+	static SamplerSoundData::Ptr getFromCache (const File& file, int numSamples);
+
+	/** Changes the amount of time before unused data will be removed from the cache.
+		By default this is about 5 seconds.
+	*/
+	static void setCacheTimeout (int millisecs);
+
+private:
+
+	class Pimpl;
+	friend class Pimpl;
+
+	SampleCache();
+	~SampleCache();
+
+	JUCE_DECLARE_NON_COPYABLE (SampleCache);
+};
+
+#endif   // __JUCE_SAMPLECACHE_JUCEHEADER__
+
+/*** End of inlined file: juce_SampleCache.h ***/
+
+
+#endif
+#ifndef __JUCE_SAMPLER_JUCEHEADER__
+
+#endif
+#ifndef __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
+
+/*** Start of inlined file: juce_StreamingSamplerSound.h ***/
+#ifndef __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
+#define __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
+
+class StreamingSamplerSound;
+
+/**
+	Feeds StreamingSamplerSounds to the SamplerVoices that are playing them.
+
+	A SamplerStreamer owns a fixed number of lock-free ring buffers ("streams"). When a
+	SamplerVoice starts playing a StreamingSamplerSound it claims one of these, and the
+	streamer then uses a TimeSliceThread to keep it topped-up from the sound's
+	AudioFormatReader, starting at the point where the sound's preloaded data ends.
+
+	All the buffers are allocated when the streamer is created, so the audio thread never
+	has to allocate or wait for the disk. You should create enough streams for the number
+	of voices that might be playing streamed sounds at once - if a voice can't get one,
+	it'll just play the part of the sound that's held in memory.
+
+	@see StreamingSamplerSound, SamplerVoice
+*/
+class JUCE_API  SamplerStreamer  : private TimeSliceClient
+{
+public:
+
+	/** Creates a streamer.
+
+		@param thread		   the thread that should do the reading. The streamer adds
+									itself to this thread, but it's up to the caller to start it
+		@param numStreams	   the maximum number of voices that can stream at once
+		@param samplesPerStream	 the size of each voice's ring buffer. This needs to hold
+									enough audio to ride out any delays in reading the disk
+	*/
+	SamplerStreamer (TimeSliceThread& thread,
+					 int numStreams,
+					 int samplesPerStream = 32768);
+
+	/** Destructor.
+		Any StreamingSamplerSounds that use this streamer must be deleted before it is.
+	*/
+	~SamplerStreamer();
+
+	/** Returns the number of times that a voice has run out of streamed data because
+		the disk couldn't keep up.
+	*/
+	int getNumUnderruns() const noexcept		{ return numUnderruns.get(); }
+
+private:
+
+	friend class SamplerVoice;
+	friend class StreamingSamplerSound;
+	class Stream;
+
+	TimeSliceThread& thread;
+	OwnedArray <Stream> streams;
+	AudioSampleBuffer readBuffer;
+	CriticalSection readLock;
+	Atomic <int> numUnderruns;
+
+	int openStream (const StreamingSamplerSound& sound);
+	int readFromStream (int streamIndex, AudioSampleBuffer& dest, int destStartSample, int numSamples);
+	void closeStream (int streamIndex);
+	void soundDeleted (const StreamingSamplerSound& sound);
+	bool fillStream (Stream& stream);
+	int useTimeSlice();
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerStreamer);
+};
+
+/**
+	A SamplerSound that only keeps the start of its sample in memory, and streams the
+	rest from disk as it plays.
+
+	This lets you use samples of any length without them all having to fit into memory.
+	The preloaded section is played while the SamplerStreamer fetches the rest, so it
+	needs to be long enough to cover the time it takes to read the first block from disk.
+
+	To play these, just give your Synthesiser some normal SamplerVoice objects.
+
+	@see SamplerStreamer, SamplerSound, SamplerVoice
+*/
+class JUCE_API  StreamingSamplerSound	: public SamplerSound
+{
+public:
+
+	/** Creates a streaming sound.
+
+		@param name		 a name for the sample
+		@param source	   the audio to play. This object will be deleted by the sound
+								when no longer needed, and mustn't be used by the caller after
+								being passed in
+		@param midiNotes	the set of midi keys that this sound should be played on
+		@param midiNoteForNormalPitch   the midi note at which the sample should be played
+										with its natural rate
+		@param attackTimeSecs   the attack (fade-in) time, in seconds
+		@param releaseTimeSecs  the decay (fade-out) time, in seconds
+		@param preloadTimeSecs  the length of audio to keep in memory, in seconds
+		@param streamer	 the streamer that will supply the rest of the audio. This
+								must not be deleted before the sound is
+	*/
+	StreamingSamplerSound (const String& name,
+						   AudioFormatReader* source,
+						   const BigInteger& midiNotes,
+						   int midiNoteForNormalPitch,
+						   double attackTimeSecs,
+						   double releaseTimeSecs,
+						   double preloadTimeSecs,
+						   SamplerStreamer& streamer);
+
+	/** Creates a streaming sound whose start has already been loaded.
+
+		This lets the preloaded part of the sound be shared, e.g. by getting it from
+		the SampleCache.
+
+		@param name		 a name for the sample
+		@param source	   the audio to play. This object will be deleted by the sound
+								when no longer needed, and mustn't be used by the caller after
+								being passed in
+		@param preloadedData	the start of the source's audio, which must have been read
+								from the same source
+		@param midiNotes	the set of midi keys that this sound should be played on
+		@param midiNoteForNormalPitch   the midi note at which the sample should be played
+										with its natural rate
+		@param attackTimeSecs   the attack (fade-in) time, in seconds
+		@param releaseTimeSecs  the decay (fade-out) time, in seconds
+		@param streamer	 the streamer that will supply the rest of the audio. This
+								must not be deleted before the sound is
+	*/
+	StreamingSamplerSound (const String& name,
+						   AudioFormatReader* source,
+						   SamplerSoundData* preloadedData,
+						   const BigInteger& midiNotes,
+						   int midiNoteForNormalPitch,
+						   double attackTimeSecs,
+						   double releaseTimeSecs,
+						   SamplerStreamer& streamer);
+
+	/** Destructor. */
+	~StreamingSamplerSound();
+
+private:
+
+	friend class SamplerVoice;
+	friend class SamplerStreamer;
+
+	ScopedPointer <AudioFormatReader> reader;
+	SamplerStreamer& streamer;
+	int preloadLength;
+
+	JUCE_LEAK_DETECTOR (StreamingSamplerSound);
+};
+
+#endif   // __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
+
+/*** End of inlined file: juce_StreamingSamplerSound.h ***/
+
 
 #endif
 #ifndef __JUCE_SYNTHESISER_JUCEHEADER__
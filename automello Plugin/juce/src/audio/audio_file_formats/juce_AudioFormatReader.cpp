@@ -49,11 +49,12 @@ AudioFormatReader::~AudioFormatReader()
     delete input;
 }
 
-bool AudioFormatReader::read (int* const* destSamples,
-                              int numDestChannels,
-                              int64 startSampleInSource,
-                              int numSamplesToRead,
-                              const bool fillLeftoverChannelsWithCopies)
+template <typename SampleType>
+bool AudioFormatReader::readInto (SampleType* const* destSamples,
+                                  int numDestChannels,
+                                  int64 startSampleInSource,
+                                  int numSamplesToRead,
+                                  const bool fillLeftoverChannelsWithCopies)
 {
     jassert (numDestChannels > 0); // you have to actually give this some channels to work with!
 
@@ -65,7 +66,7 @@ bool AudioFormatReader::read (int* const* destSamples,
 
         for (int i = numDestChannels; --i >= 0;)
             if (destSamples[i] != nullptr)
-                zeromem (destSamples[i], sizeof (int) * silence);
+                zeromem (destSamples[i], sizeof (SampleType) * silence);
 
         startOffsetInDestBuffer += silence;
         numSamplesToRead -= silence;
@@ -75,16 +76,16 @@ bool AudioFormatReader::read (int* const* destSamples,
     if (numSamplesToRead <= 0)
         return true;
 
-    if (! readSamples (const_cast<int**> (destSamples),
-                       jmin ((int) numChannels, numDestChannels), startOffsetInDestBuffer,
-                       startSampleInSource, numSamplesToRead))
+    if (! readSamplesInto (const_cast<SampleType**> (destSamples),
+                           jmin ((int) numChannels, numDestChannels), startOffsetInDestBuffer,
+                           startSampleInSource, numSamplesToRead))
         return false;
 
     if (numDestChannels > (int) numChannels)
     {
         if (fillLeftoverChannelsWithCopies)
         {
-            int* lastFullChannel = destSamples[0];
+            SampleType* lastFullChannel = destSamples[0];
 
             for (int i = (int) numChannels; --i > 0;)
             {
@@ -98,13 +99,58 @@ bool AudioFormatReader::read (int* const* destSamples,
             if (lastFullChannel != nullptr)
                 for (int i = numChannels; i < numDestChannels; ++i)
                     if (destSamples[i] != nullptr)
-                        memcpy (destSamples[i], lastFullChannel, sizeof (int) * numSamplesToRead);
+                        memcpy (destSamples[i], lastFullChannel, sizeof (SampleType) * numSamplesToRead);
         }
         else
         {
             for (int i = numChannels; i < numDestChannels; ++i)
                 if (destSamples[i] != nullptr)
-                    zeromem (destSamples[i], sizeof (int) * numSamplesToRead);
+                    zeromem (destSamples[i], sizeof (SampleType) * numSamplesToRead);
+        }
+    }
+
+    return true;
+}
+
+bool AudioFormatReader::read (int* const* destSamples,
+                              int numDestChannels,
+                              int64 startSampleInSource,
+                              int numSamplesToRead,
+                              const bool fillLeftoverChannelsWithCopies)
+{
+    return readInto (destSamples, numDestChannels, startSampleInSource,
+                     numSamplesToRead, fillLeftoverChannelsWithCopies);
+}
+
+bool AudioFormatReader::read (float* const* destSamples,
+                              int numDestChannels,
+                              int64 startSampleInSource,
+                              int numSamplesToRead,
+                              const bool fillLeftoverChannelsWithCopies)
+{
+    return readInto (destSamples, numDestChannels, startSampleInSource,
+                     numSamplesToRead, fillLeftoverChannelsWithCopies);
+}
+
+bool AudioFormatReader::readFloatSamples (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                          int64 startSampleInFile, int numSamples)
+{
+    // read the integer data into the destination buffers, and then convert it where it lies
+    if (! readSamples (reinterpret_cast <int**> (destSamples), numDestChannels, startOffsetInDestBuffer,
+                       startSampleInFile, numSamples))
+        return false;
+
+    if (! usesFloatingPointData)
+    {
+        const float multiplier = 1.0f / 0x7fffffff;
+
+        for (int j = numDestChannels; --j >= 0;)
+        {
+            float* const d = destSamples[j];
+
+            if (d != nullptr)
+                for (int i = startOffsetInDestBuffer; i < startOffsetInDestBuffer + numSamples; ++i)
+                    d[i] = *reinterpret_cast <int*> (d + i) * multiplier;
         }
     }
 
@@ -113,6 +113,21 @@ public:
                int numSamplesToRead,
                bool fillLeftoverChannelsWithCopies);
 
+    /** Reads samples from the stream, converting them to floating-point.
+
+        This works just like the other read() method, but always fills the destination
+        buffers with floats in the range -1.0 to 1.0, whatever format the source uses. Readers
+        that override readFloatSamples() can decode straight into these buffers, which avoids
+        the extra pass that's needed to convert the integer data that read() produces.
+
+        @see readFloatSamples
+    */
+    bool read (float* const* destSamples,
+               int numDestChannels,
+               int64 startSampleInSource,
+               int numSamplesToRead,
+               bool fillLeftoverChannelsWithCopies);
+
     /** Finds the highest and lowest sample levels from a section of the audio stream.
 
         This will read a block of samples from the stream, and measure the
@@ -215,6 +230,21 @@ public:
                               int64 startSampleInFile,
                               int numSamples) = 0;
 
+    /** Performs the low-level read operation, producing floating-point samples.
+
+        This has the same parameters as readSamples(), but the destination buffers must be
+        filled with floats in the range -1.0 to 1.0. The default implementation calls
+        readSamples() and then converts its output in-place, so subclasses that can produce
+        floats directly should override it.
+
+        Callers should use read() instead of calling this directly.
+    */
+    virtual bool readFloatSamples (float** destSamples,
+                                   int numDestChannels,
+                                   int startOffsetInDestBuffer,
+                                   int64 startSampleInFile,
+                                   int numSamples);
+
 
 protected:
     //==============================================================================
@@ -243,9 +273,48 @@ protected:
         }
     };
 
+    /** Used by AudioFormatReader subclasses to convert data directly into floats. */
+    template <class SourceSampleType, class SourceEndianness>
+    struct FloatReadHelper
+    {
+        typedef AudioData::Pointer <AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst> DestType;
+        typedef AudioData::Pointer <SourceSampleType, SourceEndianness, AudioData::Interleaved, AudioData::Const>               SourceType;
+
+        static void read (float** destData, int destOffset, int numDestChannels, const void* sourceData, int numSourceChannels, int numSamples) noexcept
+        {
+            for (int i = 0; i < numDestChannels; ++i)
+            {
+                if (destData[i] != nullptr)
+                {
+                    DestType dest (destData[i]);
+                    dest += destOffset;
+
+                    if (i < numSourceChannels)
+                        dest.convertSamples (SourceType (addBytesToPointer (sourceData, i * SourceType::getBytesPerSample()), numSourceChannels), numSamples);
+                    else
+                        dest.clearSamples (numSamples);
+                }
+            }
+        }
+    };
+
 private:
     String formatName;
 
+    template <typename SampleType>
+    bool readInto (SampleType* const* destSamples, int numDestChannels, int64 startSampleInSource,
+                   int numSamplesToRead, bool fillLeftoverChannelsWithCopies);
+
+    bool readSamplesInto (int** destSamples, int numDestChannels, int startOffsetInDestBuffer, int64 startSampleInFile, int numSamples)
+    {
+        return readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    bool readSamplesInto (float** destSamples, int numDestChannels, int startOffsetInDestBuffer, int64 startSampleInFile, int numSamples)
+    {
+        return readFloatSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioFormatReader);
 };
 
@@ -31,6 +31,8 @@ BEGIN_JUCE_NAMESPACE
 #include "juce_AudioThumbnailCache.h"
 #include "../../events/juce_MessageManager.h"
 #include "../../io/streams/juce_BufferedInputStream.h"
+#include "../dsp/juce_AudioSampleBuffer.h"
+#include "../dsp/juce_FloatVectorOperations.h"
 
 
 //==============================================================================
@@ -84,27 +86,41 @@ private:
 };
 
 //==============================================================================
-class AudioThumbnail::LevelDataSource   : public TimeSliceClient
+/*  The audio is scanned by a job on the cache's thread pool, so that lots of thumbnails
+    can be built at once. The cache's TimeSliceThread is only used to close the reader
+    again once it's no longer needed.
+*/
+class AudioThumbnail::LevelDataSource   : public TimeSliceClient,
+                                          public ThreadPoolJob
 {
 public:
     LevelDataSource (AudioThumbnail& owner_, AudioFormatReader* newReader, int64 hash)
-        : lengthInSamples (0), numSamplesFinished (0), sampleRate (0), numChannels (0),
-          hashCode (hash), owner (owner_), reader (newReader)
+        : ThreadPoolJob ("thumbnail"),
+          lengthInSamples (0), numSamplesFinished (0), sampleRate (0), numChannels (0),
+          hashCode (hash), owner (owner_), reader (newReader),
+          scanBuffer (2, 0)
     {
     }
 
     LevelDataSource (AudioThumbnail& owner_, InputSource* source_)
-        : lengthInSamples (0), numSamplesFinished (0), sampleRate (0), numChannels (0),
-          hashCode (source_->hashCode()), owner (owner_), source (source_)
+        : ThreadPoolJob ("thumbnail"),
+          lengthInSamples (0), numSamplesFinished (0), sampleRate (0), numChannels (0),
+          hashCode (source_->hashCode()), owner (owner_), source (source_),
+          scanBuffer (2, 0)
     {
     }
 
     ~LevelDataSource()
     {
+        owner.cache.scanningPool.removeJob (this, true, -1);
         owner.cache.removeTimeSliceClient (this);
     }
 
-    enum { timeBeforeDeletingReader = 1000 };
+    enum
+    {
+        timeBeforeDeletingReader = 1000,
+        blocksPerJobSlice = 8
+    };
 
     void initialise (int64 numSamplesFinished_)
     {
@@ -123,7 +139,7 @@ public:
             if (lengthInSamples <= 0 || isFullyLoaded())
                 reader = nullptr;
             else
-                owner.cache.addTimeSliceClient (this);
+                owner.cache.scanningPool.addJob (this);
         }
     }
 
@@ -157,34 +173,35 @@ public:
 
     int useTimeSlice()
     {
-        if (isFullyLoaded())
-        {
-            if (reader != nullptr && source != nullptr)
-                releaseResources();
+        if (isFullyLoaded() && reader != nullptr && source != nullptr)
+            releaseResources();
 
-            return -1;
-        }
-
-        bool justFinished = false;
+        return -1;
+    }
 
+    JobStatus runJob()
+    {
         {
             const ScopedLock sl (readerLock);
 
             createReader();
 
-            if (reader != nullptr)
-            {
-                if (! readNextBlock())
-                    return 0;
+            if (reader == nullptr)
+                return jobHasFinished;
 
-                justFinished = true;
-            }
-        }
+            // Each go only reads a few blocks, so that a long file can't hold up the
+            // thumbnails that are queued behind it.
+            for (int i = 0; i < blocksPerJobSlice; ++i)
+                if (shouldExit() || readNextBlock())
+                    break;
 
-        if (justFinished)
-            owner.cache.storeThumb (owner, hashCode);
+            if (! isFullyLoaded())
+                return shouldExit() ? jobHasFinished : jobNeedsRunningAgain;
+        }
 
-        return timeBeforeDeletingReader;
+        owner.cache.storeThumb (owner, hashCode);
+        owner.cache.addTimeSliceClient (this, timeBeforeDeletingReader);
+        return jobHasFinished;
     }
 
     bool isFullyLoaded() const noexcept
@@ -206,6 +223,7 @@ private:
     AudioThumbnail& owner;
     ScopedPointer <InputSource> source;
     ScopedPointer <AudioFormatReader> reader;
+    AudioSampleBuffer scanBuffer;
     CriticalSection readerLock;
 
     void createReader()
@@ -238,15 +256,25 @@ private:
                 HeapBlock<MinMaxValue> levelData (numThumbSamps * 2);
                 MinMaxValue* levels[2] = { levelData, levelData + numThumbSamps };
 
-                for (int i = 0; i < numThumbSamps; ++i)
-                {
-                    float lowestLeft, highestLeft, lowestRight, highestRight;
+                // The whole block is read in one go, rather than a read for each thumbnail
+                // sample, and a mono file gets its channel copied into both.
+                const int samplesPerThumbSample = owner.samplesPerThumbSample;
+                scanBuffer.setSize (2, numThumbSamps * samplesPerThumbSample, false, false, true);
 
-                    reader->readMaxLevels ((firstThumbIndex + i) * owner.samplesPerThumbSample, owner.samplesPerThumbSample,
-                                           lowestLeft, highestLeft, lowestRight, highestRight);
+                if (! reader->read (scanBuffer.getArrayOfChannels(), 2, firstThumbIndex * (int64) samplesPerThumbSample,
+                                    scanBuffer.getNumSamples(), true))
+                    scanBuffer.clear();
 
-                    levels[0][i].setFloat (lowestLeft, highestLeft);
-                    levels[1][i].setFloat (lowestRight, highestRight);
+                for (int chan = 0; chan < 2; ++chan)
+                {
+                    const float* const samples = scanBuffer.getSampleData (chan);
+
+                    for (int i = 0; i < numThumbSamps; ++i)
+                    {
+                        float low, high;
+                        FloatVectorOperations::findMinAndMax (samples + i * samplesPerThumbSample, samplesPerThumbSample, low, high);
+                        levels[chan][i].setFloat (low, high);
+                    }
                 }
 
                 {
@@ -698,7 +726,7 @@ void AudioThumbnail::addBlock (const int64 startSample, const AudioSampleBuffer&
             {
                 float low, high;
                 const int start = i * samplesPerThumbSample;
-                findMinAndMax (sourceData + start, jmin (samplesPerThumbSample, numSamples - start), low, high);
+                FloatVectorOperations::findMinAndMax (sourceData + start, jmin (samplesPerThumbSample, numSamples - start), low, high);
                 dest[i].setFloat (low, high);
             }
         }
@@ -30,6 +30,11 @@ BEGIN_JUCE_NAMESPACE
 #include "juce_AudioThumbnailCache.h"
 #include "../../io/streams/juce_MemoryInputStream.h"
 #include "../../io/streams/juce_MemoryOutputStream.h"
+#include "../../io/files/juce_FileOutputStream.h"
+#include "../../io/files/juce_MemoryMappedFile.h"
+#include "../../io/files/juce_TemporaryFile.h"
+#include "../../memory/juce_ByteOrder.h"
+#include "../../core/juce_SystemStats.h"
 
 
 //==============================================================================
@@ -43,15 +48,116 @@ struct ThumbnailCacheEntry
 };
 
 //==============================================================================
-AudioThumbnailCache::AudioThumbnailCache (const int maxNumThumbsToStore_)
+/*  The cache file starts with a header and a table of the thumbnails it contains,
+    sorted by hash code, followed by the data for each thumbnail in the format
+    written by AudioThumbnail::saveTo(). Everything is little-endian.
+
+    header:     "jthc", int32 version, int32 number of thumbnails, int32 (reserved)
+    table:      for each thumbnail: int64 hash, int64 offset of its data, int32 size
+                of its data, int32 (reserved)
+*/
+class AudioThumbnailCache::MappedCacheFile
+{
+public:
+    MappedCacheFile (const File& file)
+        : mappedFile (file, MemoryMappedFile::readOnly),
+          numThumbs (0),
+          valid (false)
+    {
+        const char* const data = static_cast <const char*> (mappedFile.getData());
+        const size_t size = mappedFile.getSize();
+
+        if (data != nullptr && size >= headerSize
+             && memcmp (data, "jthc", 4) == 0
+             && ByteOrder::littleEndianInt (data + 4) == currentVersion)
+        {
+            const int num = ByteOrder::littleEndianInt (data + 8);
+
+            if (num >= 0 && headerSize + num * (size_t) tableEntrySize <= size)
+            {
+                numThumbs = num;
+                valid = true;
+            }
+        }
+    }
+
+    enum
+    {
+        currentVersion = 2,     // (version 1 files were keyed without the files' modification times)
+        headerSize = 16,
+        tableEntrySize = 24
+    };
+
+    bool isValid() const noexcept           { return valid; }
+    int getNumThumbs() const noexcept       { return numThumbs; }
+
+    int64 getHash (const int index) const noexcept
+    {
+        return (int64) ByteOrder::littleEndianInt64 (getTableEntry (index));
+    }
+
+    /** Returns the thumbnail's data, or a null pointer if the table entry is bad. */
+    const void* getThumbData (const int index, size_t& size) const noexcept
+    {
+        const char* const entry = getTableEntry (index);
+        const int64 offset = (int64) ByteOrder::littleEndianInt64 (entry + 8);
+        size = (size_t) ByteOrder::littleEndianInt (entry + 16);
+
+        if (offset < 0 || offset + (int64) size > (int64) mappedFile.getSize())
+            return nullptr;
+
+        return static_cast <const char*> (mappedFile.getData()) + offset;
+    }
+
+    int indexOf (const int64 hash) const noexcept
+    {
+        int start = 0, end = numThumbs;
+
+        while (start < end)
+        {
+            const int mid = (start + end) / 2;
+            const int64 midHash = getHash (mid);
+
+            if (midHash == hash)
+                return mid;
+
+            if (midHash < hash)
+                start = mid + 1;
+            else
+                end = mid;
+        }
+
+        return -1;
+    }
+
+private:
+    MemoryMappedFile mappedFile;
+    int numThumbs;
+    bool valid;
+
+    const char* getTableEntry (const int index) const noexcept
+    {
+        jassert (isPositiveAndBelow (index, numThumbs));
+        return static_cast <const char*> (mappedFile.getData()) + headerSize + index * tableEntrySize;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (MappedCacheFile);
+};
+
+//==============================================================================
+AudioThumbnailCache::AudioThumbnailCache (const int maxNumThumbsToStore_, const int numThreadsForScanning)
     : TimeSliceThread ("thumb cache"),
-      maxNumThumbsToStore (maxNumThumbsToStore_)
+      maxNumThumbsToStore (maxNumThumbsToStore_),
+      scanningPool (numThreadsForScanning > 0 ? numThreadsForScanning
+                                              : SystemStats::getNumCpus()),
+      numUnsavedBytes (0)
 {
     startThread (2);
 }
 
 AudioThumbnailCache::~AudioThumbnailCache()
 {
+    saveCacheFile();
 }
 
 ThumbnailCacheEntry* AudioThumbnailCache::findThumbFor (const int64 hash) const
@@ -65,6 +171,8 @@ ThumbnailCacheEntry* AudioThumbnailCache::findThumbFor (const int64 hash) const
 
 bool AudioThumbnailCache::loadThumb (AudioThumbnail& thumb, const int64 hashCode)
 {
+    const ScopedLock sl (lock);
+
     ThumbnailCacheEntry* te = findThumbFor (hashCode);
 
     if (te != nullptr)
@@ -76,12 +184,57 @@ bool AudioThumbnailCache::loadThumb (AudioThumbnail& thumb, const int64 hashCode
         return true;
     }
 
+    // a thumbnail that's dropped out of memory before it could be saved will still be here
+    for (int i = unsavedThumbs.size(); --i >= 0;)
+    {
+        if (unsavedThumbs.getUnchecked(i)->hash == hashCode)
+        {
+            MemoryInputStream in (unsavedThumbs.getUnchecked(i)->data, false);
+            thumb.loadFrom (in);
+            return true;
+        }
+    }
+
+    if (mappedCacheFile != nullptr)
+    {
+        const int index = mappedCacheFile->indexOf (hashCode);
+
+        if (index >= 0)
+        {
+            size_t size;
+            const void* const data = mappedCacheFile->getThumbData (index, size);
+
+            if (data != nullptr)
+            {
+                MemoryInputStream in (data, size, false);
+                thumb.loadFrom (in);
+                return true;
+            }
+        }
+    }
+
     return false;
 }
 
 void AudioThumbnailCache::storeThumb (const AudioThumbnail& thumb,
                                       const int64 hashCode)
 {
+    bool needsSaving = false;
+
+    {
+        const ScopedLock sl (lock);
+        needsSaving = addThumb (thumb, hashCode);
+    }
+
+    // (this gets called by the scanning threads, so the file's written by whichever one
+    // fills up the batch, after it's let go of the lock)
+    if (needsSaving)
+        saveCacheFile();
+}
+
+bool AudioThumbnailCache::addThumb (const AudioThumbnail& thumb, const int64 hashCode)
+{
+
     ThumbnailCacheEntry* te = findThumbFor (hashCode);
 
     if (te == nullptr)
@@ -115,12 +268,185 @@ void AudioThumbnailCache::storeThumb (const AudioThumbnail& thumb,
 
     MemoryOutputStream out (te->data, false);
     thumb.saveTo (out);
+
+    if (cacheFile != File::nonexistent)
+    {
+        ThumbnailCacheEntry* const unsaved = new ThumbnailCacheEntry (*te);
+        unsavedThumbs.add (unsaved);
+        numUnsavedBytes += unsaved->data.getSize();
+
+        // The whole file gets rewritten each time, so the batches grow with the file
+        // to keep the amount of writing proportional to the amount of new data.
+        const size_t batchSize = jmax ((size_t) 4 * 1024 * 1024, (size_t) cacheFile.getSize() / 2);
+
+        return numUnsavedBytes >= batchSize;
+    }
+
+    return false;
 }
 
 void AudioThumbnailCache::clear()
 {
+    const ScopedLock sl (lock);
     thumbs.clear();
 }
 
+//==============================================================================
+bool AudioThumbnailCache::setCacheFile (const File& file)
+{
+    const ScopedLock csl (cacheFileLock);
+
+    if (cacheFile != File::nonexistent)
+        saveCacheFile();
+
+    const ScopedLock sl (lock);
+
+    cacheFile = file;
+    mappedCacheFile = nullptr;
+    unsavedThumbs.clear();
+    numUnsavedBytes = 0;
+
+    if (! file.existsAsFile())
+        return true;
+
+    mappedCacheFile = new MappedCacheFile (file);
+
+    if (mappedCacheFile->isValid())
+        return true;
+
+    mappedCacheFile = nullptr;
+    return false;
+}
+
+namespace ThumbnailCacheHelpers
+{
+    struct ThumbToSave
+    {
+        int64 hash;
+        const void* data;
+        size_t size;
+    };
+
+    class ThumbSorter
+    {
+    public:
+        static int compareElements (const ThumbToSave& first, const ThumbToSave& second) noexcept
+        {
+            return first.hash < second.hash ? -1 : (first.hash > second.hash ? 1 : 0);
+        }
+    };
+}
+
+bool AudioThumbnailCache::saveCacheFile()
+{
+    using namespace ThumbnailCacheHelpers;
+
+    // Only one thread can be saving or changing the file at a time, so the mapped file stays
+    // put while it's being written out. The unsaved thumbnails are only ever added to while
+    // this is going on, and their data doesn't change once they've been added, so a list of
+    // them can be taken under the lock and then written without it.
+    const ScopedLock csl (cacheFileLock);
+
+    Array <ThumbToSave> thumbsToSave;
+    int numThumbsBeingSaved;
+    size_t numBytesBeingSaved = 0;
+
+    {
+        const ScopedLock sl (lock);
+
+        if (cacheFile == File::nonexistent)
+            return false;
+
+        numThumbsBeingSaved = unsavedThumbs.size();
+
+        if (numThumbsBeingSaved == 0)
+            return true;
+
+        // The newest copy of each thumbnail is added first, and the sort keeps equal items
+        // in order, so any older copies can be skipped when the file is written.
+        for (int i = numThumbsBeingSaved; --i >= 0;)
+        {
+            const ThumbnailCacheEntry& te = *unsavedThumbs.getUnchecked(i);
+            const ThumbToSave t = { te.hash, te.data.getData(), te.data.getSize() };
+            thumbsToSave.add (t);
+            numBytesBeingSaved += t.size;
+        }
+    }
+
+    if (mappedCacheFile != nullptr)
+    {
+        for (int i = 0; i < mappedCacheFile->getNumThumbs(); ++i)
+        {
+            ThumbToSave t;
+            t.hash = mappedCacheFile->getHash (i);
+            t.data = mappedCacheFile->getThumbData (i, t.size);
+
+            if (t.data != nullptr)
+                thumbsToSave.add (t);
+        }
+    }
+
+    ThumbSorter sorter;
+    thumbsToSave.sort (sorter, true);
+
+    for (int i = thumbsToSave.size(); --i > 0;)
+        if (thumbsToSave.getReference (i).hash == thumbsToSave.getReference (i - 1).hash)
+            thumbsToSave.remove (i);
+
+    TemporaryFile tempFile (cacheFile);
+
+    {
+        FileOutputStream out (tempFile.getFile());
+
+        if (out.failedToOpen())
+            return false;
+
+        out.write ("jthc", 4);
+        out.writeInt (MappedCacheFile::currentVersion);
+        out.writeInt (thumbsToSave.size());
+        out.writeInt (0);
+
+        int64 offset = MappedCacheFile::headerSize + thumbsToSave.size() * (int64) MappedCacheFile::tableEntrySize;
+
+        for (int i = 0; i < thumbsToSave.size(); ++i)
+        {
+            const ThumbToSave& t = thumbsToSave.getReference (i);
+            out.writeInt64 (t.hash);
+            out.writeInt64 (offset);
+            out.writeInt ((int) t.size);
+            out.writeInt (0);
+            offset += t.size;
+        }
+
+        for (int i = 0; i < thumbsToSave.size(); ++i)
+            out.write (thumbsToSave.getReference (i).data, thumbsToSave.getReference (i).size);
+
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    const ScopedLock sl (lock);
+
+    // the old file has to be unmapped before it can be replaced
+    mappedCacheFile = nullptr;
+    const bool ok = tempFile.overwriteTargetFileWithTemporary();
+
+    mappedCacheFile = new MappedCacheFile (cacheFile);
+
+    if (! mappedCacheFile->isValid())
+        mappedCacheFile = nullptr;
+
+    // (any thumbnails that were added while the file was being written are left for next time)
+    if (ok)
+    {
+        unsavedThumbs.removeRange (0, numThumbsBeingSaved);
+        numUnsavedBytes -= numBytesBeingSaved;
+    }
+
+    return ok;
+}
+
 
 END_JUCE_NAMESPACE
@@ -27,6 +27,8 @@
 #define __JUCE_AUDIOTHUMBNAILCACHE_JUCEHEADER__
 
 #include "juce_AudioThumbnail.h"
+#include "../../threads/juce_ThreadPool.h"
+#include "../../io/files/juce_File.h"
 struct ThumbnailCacheEntry;
 
 
@@ -34,9 +36,12 @@ struct ThumbnailCacheEntry;
 /**
     An instance of this class is used to manage multiple AudioThumbnail objects.
 
-    The cache runs a single background thread that is shared by all the thumbnails
-    that need it, and it maintains a set of low-res previews in memory, to avoid
-    having to re-scan audio files too often.
+    The cache has a pool of background threads that is shared by all the thumbnails
+    that need it, so that many files can be scanned at once, and it maintains a set
+    of low-res previews in memory, to avoid having to re-scan audio files too often.
+
+    It can also keep its previews in a file with setCacheFile(), so that they're
+    available straight away the next time the application runs.
 
     @see AudioThumbnail
 */
@@ -48,8 +53,11 @@ public:
 
         The maxNumThumbsToStore parameter lets you specify how many previews should
         be kept in memory at once.
+
+        The numThreadsForScanning parameter sets how many audio files can be scanned
+        at the same time. If it's 0, one thread is used for each CPU core.
     */
-    explicit AudioThumbnailCache (int maxNumThumbsToStore);
+    explicit AudioThumbnailCache (int maxNumThumbsToStore, int numThreadsForScanning = 0);
 
     /** Destructor. */
     ~AudioThumbnailCache();
@@ -74,13 +82,55 @@ public:
     */
     void storeThumb (const AudioThumbnail& thumb, int64 hashCode);
 
+    //==============================================================================
+    /** Makes the cache keep its thumbnails in a file as well as in memory.
+
+        Any thumbnails that are already in the file can be loaded by the AudioThumbnail
+        objects that use this cache without scanning their audio again. The file is
+        memory-mapped rather than read, so even a cache holding thousands of thumbnails
+        opens instantly, and only the thumbnails that are actually used get paged in.
+
+        Newly generated thumbnails are added to the file in batches as they build up,
+        and when saveCacheFile() is called or the cache is deleted.
+
+        The thumbnails are looked up using the hash code of their source. A FileInputSource
+        includes the file's modification time in its hash, so a file gets rescanned if it's
+        changed, rather than using a thumbnail from before the change.
+
+        Passing File::nonexistent stops the cache from using a file. This returns false
+        if the file exists but isn't a cache file in the current format, in which case
+        it'll be replaced when the cache is next saved.
+
+        @see saveCacheFile
+    */
+    bool setCacheFile (const File& file);
+
+    /** Writes any thumbnails that have been added since the cache file was last saved.
+
+        The file is written without holding the lock that loadThumb() uses, so thumbnails
+        can still be loaded while it's being saved. Returns false if there's no cache file
+        or it couldn't be written.
+        @see setCacheFile
+    */
+    bool saveCacheFile();
+
 
 private:
     //==============================================================================
-    OwnedArray <ThumbnailCacheEntry> thumbs;
+    class MappedCacheFile;
+    friend class AudioThumbnail::LevelDataSource;
+
+    OwnedArray <ThumbnailCacheEntry> thumbs, unsavedThumbs;
     int maxNumThumbsToStore;
+    ThreadPool scanningPool;
+
+    File cacheFile;
+    ScopedPointer <MappedCacheFile> mappedCacheFile;
+    size_t numUnsavedBytes;
+    CriticalSection lock, cacheFileLock;
 
     ThumbnailCacheEntry* findThumbFor (int64 hash) const;
+    bool addThumb (const AudioThumbnail&, int64 hash);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioThumbnailCache);
 };
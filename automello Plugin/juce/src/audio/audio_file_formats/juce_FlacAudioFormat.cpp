@@ -141,9 +141,21 @@ public:
         reservoir.setSize (numChannels, 2 * info.max_blocksize, false, false, true);
     }
 
-    // returns the number of samples read
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                       int64 startSampleInFile, int numSamples)
+    {
+        return readData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    bool readFloatSamples (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                           int64 startSampleInFile, int numSamples)
+    {
+        return readData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    template <typename SampleType>
+    bool readData (SampleType** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                   int64 startSampleInFile, int numSamples)
     {
         using namespace FlacNamespace;
 
@@ -162,9 +174,9 @@ public:
 
                 for (int i = jmin (numDestChannels, reservoir.getNumChannels()); --i >= 0;)
                     if (destSamples[i] != nullptr)
-                        memcpy (destSamples[i] + startOffsetInDestBuffer,
-                                reservoir.getSampleData (i, (int) (startSampleInFile - reservoirStart)),
-                                sizeof (int) * num);
+                        copySamples (destSamples[i] + startOffsetInDestBuffer,
+                                     reinterpret_cast <const int*> (reservoir.getSampleData (i, (int) (startSampleInFile - reservoirStart))),
+                                     num);
 
                 startOffsetInDestBuffer += num;
                 startSampleInFile += num;
@@ -202,12 +214,26 @@ public:
             for (int i = numDestChannels; --i >= 0;)
                 if (destSamples[i] != nullptr)
                     zeromem (destSamples[i] + startOffsetInDestBuffer,
-                             sizeof (int) * numSamples);
+                             sizeof (SampleType) * (size_t) numSamples);
         }
 
         return true;
     }
 
+    // The reservoir holds the decoded samples as full-scale 32-bit integers
+    static void copySamples (int* dest, const int* src, const int num) noexcept
+    {
+        memcpy (dest, src, sizeof (int) * (size_t) num);
+    }
+
+    static void copySamples (float* dest, const int* src, const int num) noexcept
+    {
+        const float multiplier = 1.0f / 0x7fffffff;
+
+        for (int i = 0; i < num; ++i)
+            dest[i] = src[i] * multiplier;
+    }
+
     void useSamples (const FlacNamespace::FLAC__int32* const buffer[], int numSamples)
     {
         if (scanningForLength)
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_MemoryMappedAudioFormatReader.h"
+
+
+//==============================================================================
+MemoryMappedAudioFormatReader::MemoryMappedAudioFormatReader (const File& file_, const AudioFormatReader& details,
+                                                              const int64 dataChunkStart, const int64 dataChunkLength,
+                                                              const int bytesPerFrame_)
+    : AudioFormatReader (nullptr, details.getFormatName()),
+      file (file_),
+      sampleData (nullptr),
+      bytesPerFrame (bytesPerFrame_)
+{
+    sampleRate            = details.sampleRate;
+    bitsPerSample         = details.bitsPerSample;
+    numChannels           = details.numChannels;
+    usesFloatingPointData = details.usesFloatingPointData;
+    metadataValues        = details.metadataValues;
+
+    if (bytesPerFrame > 0 && dataChunkStart >= 0)
+    {
+        map = new MemoryMappedFile (file, MemoryMappedFile::readOnly);
+
+        const int64 fileSize = (int64) map->getSize();
+
+        if (map->getData() != nullptr && dataChunkStart < fileSize)
+        {
+            // if the file has been truncated, only use the frames that are really there
+            const int64 bytesAvailable = jmin (dataChunkLength, fileSize - dataChunkStart);
+
+            sampleData = static_cast <const char*> (map->getData()) + dataChunkStart;
+            lengthInSamples = bytesAvailable / bytesPerFrame;
+        }
+        else
+        {
+            map = nullptr;
+        }
+    }
+}
+
+MemoryMappedAudioFormatReader::~MemoryMappedAudioFormatReader()
+{
+}
+
+const void* MemoryMappedAudioFormatReader::sampleToPointer (const int64 sampleIndex) const noexcept
+{
+    if (sampleData == nullptr || sampleIndex < 0 || sampleIndex >= lengthInSamples)
+        return nullptr;
+
+    return sampleData + sampleIndex * bytesPerFrame;
+}
+
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
+#define __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
+
+#include "juce_AudioFormatReader.h"
+#include "../../io/files/juce_MemoryMappedFile.h"
+#include "../../memory/juce_ScopedPointer.h"
+
+
+//==============================================================================
+/**
+    A specialised type of AudioFormatReader that reads its samples directly from
+    a memory-mapped file, rather than through an InputStream.
+
+    Because the file is mapped into memory, the samples never have to be copied
+    through an intermediate buffer - they're pulled in lazily by the OS as they're
+    touched, so reading a file costs little more than the page-cache lookups. For
+    formats that store their samples uncompressed, this also lets you get a pointer
+    straight to the sample data with sampleToPointer(), and reading it as floats will
+    convert the raw data in a single pass.
+
+    To create one of these, use an AudioFormat method such as
+    WavAudioFormat::createMemoryMappedReader().
+
+    @see AudioFormatReader, MemoryMappedFile
+*/
+class JUCE_API  MemoryMappedAudioFormatReader  : public AudioFormatReader
+{
+protected:
+    //==============================================================================
+    /** Creates a MemoryMappedAudioFormatReader and maps the given file into memory.
+
+        @param file             the file to map
+        @param details          a reader that has already parsed the file's header - its
+                                format settings and metadata are copied into this one
+        @param dataChunkStart   the byte offset within the file of the first sample frame
+        @param dataChunkLength  the number of bytes of sample data that follow dataChunkStart.
+                                If the file turns out to be shorter than this, it'll be
+                                clipped to whatever is actually there
+        @param bytesPerFrame    the number of bytes used by one sample of all the channels
+    */
+    MemoryMappedAudioFormatReader (const File& file, const AudioFormatReader& details,
+                                   int64 dataChunkStart, int64 dataChunkLength, int bytesPerFrame);
+
+public:
+    /** Destructor. */
+    ~MemoryMappedAudioFormatReader();
+
+    //==============================================================================
+    /** Returns the file that is being read. */
+    const File& getFile() const noexcept                { return file; }
+
+    /** Returns true if the file was successfully mapped into memory.
+        If this is false, none of the read methods will return any data.
+    */
+    bool isMapped() const noexcept                      { return sampleData != nullptr; }
+
+    /** Returns the number of bytes that one frame (i.e. one sample of every channel)
+        occupies in the file.
+    */
+    int getBytesPerFrame() const noexcept               { return bytesPerFrame; }
+
+    /** Returns a pointer to the raw data for a given sample frame.
+
+        The data is in whatever format the file uses, with the channels interleaved - so
+        for a 32-bit floating point file this can be cast to a const float*, giving you
+        numChannels interleaved floats per frame without any copying at all.
+
+        This will return nullptr if the file isn't mapped or the sample index is out of range.
+    */
+    const void* sampleToPointer (int64 sampleIndex) const noexcept;
+
+    //==============================================================================
+    /** Mapped readers must convert their samples to floats straight from the mapped data,
+        rather than going through readSamples().
+        @see AudioFormatReader::readFloatSamples
+    */
+    virtual bool readFloatSamples (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                                   int64 startSampleInFile, int numSamples) = 0;
+
+protected:
+    //==============================================================================
+    /** Zeroes any part of a destination range that lies beyond the end of the file, and
+        returns the number of samples at the start of it that can actually be read.
+    */
+    template <typename SampleType>
+    int clearSamplesBeyondEnd (SampleType** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                               int64 startSampleInFile, int numSamples) const noexcept
+    {
+        const int numAvailable = (int) jlimit ((int64) 0, (int64) numSamples, lengthInSamples - startSampleInFile);
+
+        if (numAvailable < numSamples)
+            for (int i = numDestChannels; --i >= 0;)
+                if (destSamples[i] != nullptr)
+                    zeromem (destSamples[i] + startOffsetInDestBuffer + numAvailable,
+                             sizeof (SampleType) * (size_t) (numSamples - numAvailable));
+
+        return numAvailable;
+    }
+
+private:
+    //==============================================================================
+    const File file;
+    ScopedPointer<MemoryMappedFile> map;
+    const char* sampleData;
+    const int bytesPerFrame;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedAudioFormatReader);
+};
+
+
+#endif   // __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
@@ -206,6 +206,14 @@ public:
         return true;
     }
 
+    bool readFloatSamples (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                           int64 startSampleInFile, int numSamples)
+    {
+        // vorbis decodes to floats, so readSamples() already produces them
+        return readSamples (reinterpret_cast <int**> (destSamples), numDestChannels, startOffsetInDestBuffer,
+                            startSampleInFile, numSamples);
+    }
+
     //==============================================================================
     static size_t oggReadCallback (void* ptr, size_t size, size_t nmemb, void* datasource)
     {
@@ -33,6 +33,7 @@ BEGIN_JUCE_NAMESPACE
 #include "../../text/juce_LocalisedStrings.h"
 #include "../../io/files/juce_FileInputStream.h"
 #include "../../io/files/juce_TemporaryFile.h"
+#include "juce_MemoryMappedAudioFormatReader.h"
 
 
 //==============================================================================
@@ -471,7 +472,9 @@ public:
         : AudioFormatReader (in, TRANS (wavFormatName)),
           bwavChunkStart (0),
           bwavSize (0),
+          dataChunkStart (0),
           dataLength (0),
+          bytesPerFrame (0),
           isRF64 (false)
     {
         using namespace WavFileHelpers;
@@ -695,6 +698,56 @@ public:
     //==============================================================================
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
                       int64 startSampleInFile, int numSamples)
+    {
+        return readData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    bool readFloatSamples (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                           int64 startSampleInFile, int numSamples)
+    {
+        return readData (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+    }
+
+    // Converts a block of interleaved frames from the file into the destination format
+    static void copySampleData (const unsigned int bits, const bool isFloat,
+                                int** destSamples, int startOffsetInDestBuffer, int numDestChannels,
+                                const void* sourceData, int numSourceChannels, int numSamples) noexcept
+    {
+        switch (bits)
+        {
+            case 8:     ReadHelper<AudioData::Int32, AudioData::UInt8, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            case 16:    ReadHelper<AudioData::Int32, AudioData::Int16, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            case 24:    ReadHelper<AudioData::Int32, AudioData::Int24, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            case 32:    if (isFloat) ReadHelper<AudioData::Float32, AudioData::Float32, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples);
+                        else                       ReadHelper<AudioData::Int32, AudioData::Int32, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            default:    jassertfalse; break;
+        }
+    }
+
+    static void copySampleData (const unsigned int bits, const bool isFloat,
+                                float** destSamples, int startOffsetInDestBuffer, int numDestChannels,
+                                const void* sourceData, int numSourceChannels, int numSamples) noexcept
+    {
+        switch (bits)
+        {
+            case 8:     FloatReadHelper<AudioData::UInt8, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            case 16:    FloatReadHelper<AudioData::Int16, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            case 24:    FloatReadHelper<AudioData::Int24, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            case 32:    if (isFloat) FloatReadHelper<AudioData::Float32, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples);
+                        else                       FloatReadHelper<AudioData::Int32,   AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, sourceData, numSourceChannels, numSamples); break;
+            default:    jassertfalse; break;
+        }
+    }
+
+    int64 bwavChunkStart, bwavSize;
+    int64 dataChunkStart, dataLength;
+    int bytesPerFrame;
+
+private:
+    //==============================================================================
+    template <typename SampleType>
+    bool readData (SampleType** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                   int64 startSampleInFile, int numSamples)
     {
         jassert (destSamples != nullptr);
         const int64 samplesAvailable = lengthInSamples - startSampleInFile;
@@ -703,7 +756,7 @@ public:
         {
             for (int i = numDestChannels; --i >= 0;)
                 if (destSamples[i] != nullptr)
-                    zeromem (destSamples[i] + startOffsetInDestBuffer, sizeof (int) * numSamples);
+                    zeromem (destSamples[i] + startOffsetInDestBuffer, sizeof (SampleType) * numSamples);
 
             numSamples = (int) samplesAvailable;
         }
@@ -727,15 +780,8 @@ public:
                 zeromem (tempBuffer + bytesRead, numThisTime * bytesPerFrame - bytesRead);
             }
 
-            switch (bitsPerSample)
-            {
-                case 8:     ReadHelper<AudioData::Int32, AudioData::UInt8, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, tempBuffer, numChannels, numThisTime); break;
-                case 16:    ReadHelper<AudioData::Int32, AudioData::Int16, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, tempBuffer, numChannels, numThisTime); break;
-                case 24:    ReadHelper<AudioData::Int32, AudioData::Int24, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, tempBuffer, numChannels, numThisTime); break;
-                case 32:    if (usesFloatingPointData) ReadHelper<AudioData::Float32, AudioData::Float32, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, tempBuffer, numChannels, numThisTime);
-                            else                       ReadHelper<AudioData::Int32, AudioData::Int32, AudioData::LittleEndian>::read (destSamples, startOffsetInDestBuffer, numDestChannels, tempBuffer, numChannels, numThisTime); break;
-                default:    jassertfalse; break;
-            }
+            copySampleData (bitsPerSample, usesFloatingPointData, destSamples, startOffsetInDestBuffer,
+                            numDestChannels, tempBuffer, numChannels, numThisTime);
 
             startOffsetInDestBuffer += numThisTime;
             numSamples -= numThisTime;
@@ -744,17 +790,159 @@ public:
         return true;
     }
 
-    int64 bwavChunkStart, bwavSize;
-
-private:
     ScopedPointer<AudioData::Converter> converter;
-    int bytesPerFrame;
-    int64 dataChunkStart, dataLength;
     bool isRF64;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavAudioFormatReader);
 };
 
+//==============================================================================
+class MemoryMappedWavReader  : public MemoryMappedAudioFormatReader
+{
+public:
+    //==============================================================================
+    MemoryMappedWavReader (const File& file, const WavAudioFormatReader& reader)
+        : MemoryMappedAudioFormatReader (file, reader, reader.dataChunkStart,
+                                         reader.dataLength, reader.bytesPerFrame)
+    {
+    }
+
+    //==============================================================================
+    bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                      int64 startSampleInFile, int numSamples)
+    {
+        if (! isMapped())
+            return false;
+
+        const int numAvailable = clearSamplesBeyondEnd (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                                        startSampleInFile, numSamples);
+
+        if (numAvailable <= 0)
+            return true;
+
+        WavAudioFormatReader::copySampleData (bitsPerSample, usesFloatingPointData, destSamples, startOffsetInDestBuffer,
+                                              numDestChannels, sampleToPointer (startSampleInFile), numChannels, numAvailable);
+
+        return true;
+    }
+
+    bool readFloatSamples (float** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                           int64 startSampleInFile, int numSamples)
+    {
+        if (! isMapped())
+            return false;
+
+        const int numAvailable = clearSamplesBeyondEnd (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                                        startSampleInFile, numSamples);
+
+        if (numAvailable <= 0)
+            return true;
+
+        const void* const source = sampleToPointer (startSampleInFile);
+        int numDone = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        // the mono and stereo cases that sample libraries are nearly always stored in get
+        // converted four or eight frames at a time, and the loose ends are left for the
+        // generic code below
+        if (numChannels <= 2 && numDestChannels <= (int) numChannels)
+        {
+            float* const left  = destSamples[0] != nullptr ? destSamples[0] + startOffsetInDestBuffer : nullptr;
+            float* const right = (numDestChannels > 1 && destSamples[1] != nullptr) ? destSamples[1] + startOffsetInDestBuffer : nullptr;
+
+            if (bitsPerSample == 16)
+                numDone = convertInt16 (left, right, static_cast <const int16*> (source), numAvailable);
+            else if (bitsPerSample == 32 && usesFloatingPointData)
+                numDone = convertFloat32 (left, right, static_cast <const float*> (source), numAvailable);
+        }
+       #endif
+
+        if (numDone < numAvailable)
+        {
+            const void* const remainder = addBytesToPointer (source, numDone * getBytesPerFrame());
+            startOffsetInDestBuffer += numDone;
+
+            WavAudioFormatReader::copySampleData (bitsPerSample, usesFloatingPointData, destSamples, startOffsetInDestBuffer,
+                                                  numDestChannels, remainder, numChannels, numAvailable - numDone);
+        }
+
+        return true;
+    }
+
+private:
+    //==============================================================================
+   #if JUCE_USE_SSE_INTRINSICS
+    // These return the number of frames they've converted, which is always a multiple of
+    // the block size, so the caller has to finish off any that are left over.
+    int convertInt16 (float* const left, float* const right, const int16* const source, const int numSamples) const noexcept
+    {
+        const __m128 scale = _mm_set1_ps (1.0f / 0x8000);
+
+        if (numChannels == 1)
+        {
+            const int numBlocks = numSamples / 8;
+
+            if (left != nullptr)
+            {
+                for (int i = 0; i < numBlocks; ++i)
+                {
+                    const __m128i v = _mm_loadu_si128 (reinterpret_cast <const __m128i*> (source + i * 8));
+                    // (interleaving a vector with itself then shifting sign-extends each sample)
+                    _mm_storeu_ps (left + i * 8,     _mm_mul_ps (scale, _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16))));
+                    _mm_storeu_ps (left + i * 8 + 4, _mm_mul_ps (scale, _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_unpackhi_epi16 (v, v), 16))));
+                }
+            }
+
+            return numBlocks * 8;
+        }
+
+        const int numBlocks = numSamples / 4;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            const __m128i v = _mm_loadu_si128 (reinterpret_cast <const __m128i*> (source + i * 8));
+
+            if (left != nullptr)
+                _mm_storeu_ps (left + i * 4, _mm_mul_ps (scale, _mm_cvtepi32_ps (_mm_srai_epi32 (_mm_slli_epi32 (v, 16), 16))));
+
+            if (right != nullptr)
+                _mm_storeu_ps (right + i * 4, _mm_mul_ps (scale, _mm_cvtepi32_ps (_mm_srai_epi32 (v, 16))));
+        }
+
+        return numBlocks * 4;
+    }
+
+    int convertFloat32 (float* const left, float* const right, const float* const source, const int numSamples) const noexcept
+    {
+        if (numChannels == 1)
+        {
+            if (left != nullptr)
+                memcpy (left, source, sizeof (float) * (size_t) numSamples);
+
+            return numSamples;
+        }
+
+        const int numBlocks = numSamples / 4;
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            const __m128 a = _mm_loadu_ps (source + i * 8);
+            const __m128 b = _mm_loadu_ps (source + i * 8 + 4);
+
+            if (left != nullptr)
+                _mm_storeu_ps (left + i * 4, _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+
+            if (right != nullptr)
+                _mm_storeu_ps (right + i * 4, _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)));
+        }
+
+        return numBlocks * 4;
+    }
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedWavReader);
+};
+
 //==============================================================================
 class WavAudioFormatWriter  : public AudioFormatWriter
 {
@@ -1029,6 +1217,28 @@ AudioFormatReader* WavAudioFormat::createReaderFor (InputStream* sourceStream,
     return nullptr;
 }
 
+MemoryMappedAudioFormatReader* WavAudioFormat::createMemoryMappedReader (const File& file)
+{
+    FileInputStream* const fin = file.createInputStream();
+
+    if (fin == nullptr)
+        return nullptr;
+
+    // the header is parsed through a normal stream, but only the data chunk's position is
+    // kept - the stream is closed again before the file is mapped
+    const WavAudioFormatReader reader (fin);
+
+    if (reader.sampleRate > 0 && reader.bytesPerFrame > 0)
+    {
+        ScopedPointer <MemoryMappedWavReader> r (new MemoryMappedWavReader (file, reader));
+
+        if (r->isMapped())
+            return r.release();
+    }
+
+    return nullptr;
+}
+
 AudioFormatWriter* WavAudioFormat::createWriterFor (OutputStream* out, double sampleRate,
                                                     unsigned int numChannels, int bitsPerSample,
                                                     const StringPairArray& metadataValues, int /*qualityOptionIndex*/)
@@ -27,6 +27,7 @@
 #define __JUCE_WAVAUDIOFORMAT_JUCEHEADER__
 
 #include "juce_AudioFormat.h"
+#include "juce_MemoryMappedAudioFormatReader.h"
 
 
 //==============================================================================
@@ -128,6 +129,19 @@ public:
     AudioFormatReader* createReaderFor (InputStream* sourceStream,
                                         bool deleteStreamIfOpeningFails);
 
+    /** Creates a reader that maps a wav file into memory instead of reading it through a stream.
+
+        This parses the file's header, then maps the whole file, so that its samples can be
+        read without being copied through any intermediate buffers. The reader that's returned
+        can also give you a pointer to the raw sample data, or convert it straight to floats
+        with MemoryMappedAudioFormatReader::readFloatSamples().
+
+        Returns nullptr if the file isn't a valid wav file or couldn't be mapped (e.g. if
+        there isn't enough address space), in which case you can fall back to createReaderFor().
+        The caller is responsible for deleting the object that is returned.
+    */
+    MemoryMappedAudioFormatReader* createMemoryMappedReader (const File& file);
+
     AudioFormatWriter* createWriterFor (OutputStream* streamToWriteTo,
                                         double sampleRateToUse,
                                         unsigned int numberOfChannels,
@@ -33,12 +33,10 @@ BEGIN_JUCE_NAMESPACE
 //==============================================================================
 IIRFilterAudioSource::IIRFilterAudioSource (AudioSource* const inputSource,
                                             const bool deleteInputWhenDeleted)
-    : input (inputSource, deleteInputWhenDeleted)
+    : input (inputSource, deleteInputWhenDeleted),
+      cascade (2, 1)
 {
     jassert (inputSource != nullptr);
-
-    for (int i = 2; --i >= 0;)
-        iirFilters.add (new IIRFilter());
 }
 
 IIRFilterAudioSource::~IIRFilterAudioSource()  {}
@@ -46,8 +44,23 @@ IIRFilterAudioSource::~IIRFilterAudioSource()  {}
 //==============================================================================
 void IIRFilterAudioSource::setFilterParameters (const IIRFilter& newSettings)
 {
-    for (int i = iirFilters.size(); --i >= 0;)
-        iirFilters.getUnchecked(i)->copyCoefficientsFrom (newSettings);
+    cascade.setStage (0, newSettings);
+}
+
+void IIRFilterAudioSource::setNumStages (const int numStages)
+{
+    jassert (numStages > 0);
+    cascade.setSize (cascade.getNumChannels(), jmax (1, numStages));
+}
+
+void IIRFilterAudioSource::setStageParameters (const int stageIndex, const IIRFilter& newSettings)
+{
+    cascade.setStage (stageIndex, newSettings);
+}
+
+void IIRFilterAudioSource::setSmoothingLength (const int numSamples)
+{
+    cascade.setSmoothingLength (numSamples);
 }
 
 //==============================================================================
@@ -55,8 +68,7 @@ void IIRFilterAudioSource::prepareToPlay (int samplesPerBlockExpected, double sa
 {
     input->prepareToPlay (samplesPerBlockExpected, sampleRate);
 
-    for (int i = iirFilters.size(); --i >= 0;)
-        iirFilters.getUnchecked(i)->reset();
+    cascade.reset();
 }
 
 void IIRFilterAudioSource::releaseResources()
@@ -70,13 +82,10 @@ void IIRFilterAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& buff
 
     const int numChannels = bufferToFill.buffer->getNumChannels();
 
-    while (numChannels > iirFilters.size())
-        iirFilters.add (new IIRFilter (*iirFilters.getUnchecked (0)));
+    if (numChannels != cascade.getNumChannels())
+        cascade.setSize (numChannels, cascade.getNumStages());
 
-    for (int i = 0; i < numChannels; ++i)
-        iirFilters.getUnchecked(i)
-            ->processSamples (bufferToFill.buffer->getSampleData (i, bufferToFill.startSample),
-                              bufferToFill.numSamples);
+    cascade.processSamples (*bufferToFill.buffer, bufferToFill.startSample, bufferToFill.numSamples);
 }
 
 
@@ -27,14 +27,19 @@
 #define __JUCE_IIRFILTERAUDIOSOURCE_JUCEHEADER__
 
 #include "juce_AudioSource.h"
-#include "../dsp/juce_IIRFilter.h"
-#include "../../containers/juce_OwnedArray.h"
+#include "../dsp/juce_IIRFilterCascade.h"
 #include "../../memory/juce_OptionalScopedPointer.h"
 
 
 //==============================================================================
 /**
     An AudioSource that performs an IIR filter on another source.
+
+    The source can run a whole chain of filters, which are all applied to each of its
+    channels using an IIRFilterCascade. Changes to the filters' settings are smoothed,
+    so they can be made while the source is playing.
+
+    @see IIRFilterCascade
 */
 class JUCE_API  IIRFilterAudioSource  : public AudioSource
 {
@@ -53,9 +58,27 @@ public:
     ~IIRFilterAudioSource();
 
     //==============================================================================
-    /** Changes the filter to use the same parameters as the one being passed in. */
+    /** Changes the filter to use the same parameters as the one being passed in.
+        If there's more than one stage, this sets the first one.
+    */
     void setFilterParameters (const IIRFilter& newSettings);
 
+    /** Changes the number of filters that are applied one after another.
+        Any new stages are initially inactive. The default is one stage.
+    */
+    void setNumStages (int numStages);
+
+    /** Returns the number of stages of filtering. */
+    int getNumStages() const noexcept                       { return cascade.getNumStages(); }
+
+    /** Changes one of the stages to use the same parameters as the filter passed in. */
+    void setStageParameters (int stageIndex, const IIRFilter& newSettings);
+
+    /** Sets the number of samples over which changes to the filters are smoothed.
+        @see IIRFilterCascade::setSmoothingLength
+    */
+    void setSmoothingLength (int numSamples);
+
     //==============================================================================
     void prepareToPlay (int samplesPerBlockExpected, double sampleRate);
     void releaseResources();
@@ -64,7 +87,7 @@ public:
 private:
     //==============================================================================
     OptionalScopedPointer<AudioSource> input;
-    OwnedArray <IIRFilter> iirFilters;
+    IIRFilterCascade cascade;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IIRFilterAudioSource);
 };
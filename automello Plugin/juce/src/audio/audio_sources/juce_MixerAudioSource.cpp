@@ -28,20 +28,166 @@
 BEGIN_JUCE_NAMESPACE
 
 #include "juce_MixerAudioSource.h"
-#include "../../containers/juce_OwnedArray.h"
+#include "../../containers/juce_ReferenceCountedArray.h"
+#include "../../threads/juce_ParallelTaskRunner.h"
 
 
+//==============================================================================
+/*  Each change to the inputs publishes one of these, which the audio thread reads without
+    locking. Old lists are kept until the audio thread can't be using them any more (see
+    releaseOldLists()), so a list is never changed once it's been published.
+
+    When the inputs are rendered in parallel, every input except the first has a buffer to
+    render into (the first one renders straight into the output, as it would anyway).
+    These buffers are shared with the next list, so adding one input doesn't mean
+    reallocating all the others.
+*/
+class MixerAudioSource::InputList
+{
+public:
+    InputList (const Array <AudioSource*>& sources_, RenderThreads* const renderThreads_,
+               const int numChannels_, const int blockSize_, const InputList* const previous)
+        : sources (sources_),
+          renderThreads (renderThreads_),
+          numChannels (numChannels_),
+          blockSize (blockSize_),
+          renderCounterWhenRetired (0)
+    {
+        if (renderThreads != nullptr)
+        {
+            for (int i = 1; i < sources.size(); ++i)
+            {
+                RenderBuffer* buffer = nullptr;
+
+                if (previous != nullptr && previous->numChannels == numChannels && previous->blockSize == blockSize)
+                    buffer = previous->buffers [previous->sources.indexOf (sources.getUnchecked (i)) - 1];
+
+                buffers.add (buffer != nullptr ? buffer : new RenderBuffer (numChannels, blockSize));
+            }
+        }
+    }
+
+    AudioSampleBuffer& getBuffer (const int inputIndex) const noexcept
+    {
+        return buffers.getObjectPointerUnchecked (inputIndex - 1)->buffer;
+    }
+
+    //==============================================================================
+    struct RenderBuffer  : public ReferenceCountedObject
+    {
+        RenderBuffer (const int numChannels, const int numSamples)
+            : buffer (numChannels, numSamples)
+        {
+        }
+
+        AudioSampleBuffer buffer;
+    };
+
+    const Array <AudioSource*> sources;
+    ReferenceCountedArray <RenderBuffer> buffers;
+    RenderThreads* const renderThreads;
+    const int numChannels, blockSize;
+    int renderCounterWhenRetired;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (InputList);
+};
+
+//==============================================================================
+/*  Renders the inputs on several threads at once. Each input is one of the runner's tasks,
+    and the results are added up in input order once they've all finished, so it doesn't
+    matter which thread rendered which input.
+*/
+class MixerAudioSource::RenderThreads  : private ParallelTaskRunner::TaskList
+{
+public:
+    RenderThreads (const int numThreads)
+        : inputsToRender (nullptr),
+          infoToRender (nullptr),
+          runner ("Mixer render thread", numThreads)
+    {
+    }
+
+    int getNumThreads() const noexcept          { return runner.getNumThreads(); }
+
+    static bool canRender (const InputList& inputs, const AudioSourceChannelInfo& info) noexcept
+    {
+        return inputs.sources.size() > 1
+                && inputs.sources.size() <= (int) ParallelTaskRunner::maximumNumTasks
+                && info.numSamples <= inputs.blockSize
+                && info.buffer->getNumChannels() == inputs.numChannels;
+    }
+
+    void render (const InputList& inputs, const AudioSourceChannelInfo& info, const double sampleRate)
+    {
+        const int numInputs = inputs.sources.size();
+
+        inputsToRender = &inputs;
+        infoToRender = &info;
+
+        // There's no point in waiting for a worker for longer than the block will take to
+        // play, as the output's going to be late by then whatever happens.
+        runner.runTasks (*this, numInputs, sampleRate > 0 ? roundToInt (info.numSamples * 1000.0 / sampleRate) : 1);
+
+        // (the inputs are added up in the same order as MixerAudioSource::mixInputs() does it)
+        for (int i = 1; i < numInputs; ++i)
+        {
+            const AudioSampleBuffer& buffer = inputs.getBuffer (i);
+
+            for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+                info.buffer->addFrom (chan, info.startSample, buffer, chan, 0, info.numSamples);
+        }
+
+        inputsToRender = nullptr;
+        infoToRender = nullptr;
+    }
+
+private:
+    //==============================================================================
+    const InputList* inputsToRender;
+    const AudioSourceChannelInfo* infoToRender;
+    ParallelTaskRunner runner; // (declared last, so that the threads are stopped first)
+
+    void runTask (const int index)
+    {
+        AudioSource* const source = inputsToRender->sources.getUnchecked (index);
+
+        // the first input renders straight into the output, and the others into their own buffers
+        if (index == 0)
+        {
+            source->getNextAudioBlock (*infoToRender);
+        }
+        else
+        {
+            AudioSourceChannelInfo info;
+            info.buffer = &(inputsToRender->getBuffer (index));
+            info.startSample = 0;
+            info.numSamples = infoToRender->numSamples;
+
+            source->getNextAudioBlock (info);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (RenderThreads);
+};
+
 //==============================================================================
 MixerAudioSource::MixerAudioSource()
-    : tempBuffer (2, 0),
+    : currentInputs (new InputList (Array <AudioSource*>(), nullptr, 0, 0, nullptr)),
+      tempBuffer (2, 0),
       currentSampleRate (0.0),
-      bufferSizeExpected (0)
+      bufferSizeExpected (0),
+      renderChannels (0),
+      renderBlockSize (0)
 {
 }
 
 MixerAudioSource::~MixerAudioSource()
 {
     removeAllInputs();
+
+    delete currentInputs.exchange (nullptr);
+    renderThreads = nullptr;
 }
 
 //==============================================================================
@@ -65,6 +211,7 @@ void MixerAudioSource::addInputSource (AudioSource* input, const bool deleteWhen
 
         inputsToDelete.setBit (inputs.size(), deleteWhenRemoved);
         inputs.add (input);
+        publishInputs();
     }
 }
 
@@ -83,6 +230,8 @@ void MixerAudioSource::removeInputSource (AudioSource* input, const bool deleteI
             {
                 inputsToDelete.shiftBits (index, 1);
                 inputs.remove (index);
+                publishInputs();
+                releaseOldLists (true);
             }
         }
 
@@ -106,9 +255,77 @@ void MixerAudioSource::removeAllInputs()
         for (int i = inputs.size(); --i >= 0;)
             if (inputsToDelete[i])
                 toDelete.add (inputs.getUnchecked(i));
+
+        inputs.clear();
+        inputsToDelete.clear();
+        publishInputs();
+        releaseOldLists (true);
     }
 }
 
+//==============================================================================
+void MixerAudioSource::setNumRenderThreads (const int numThreads, const int numChannels, const int maximumBlockSize)
+{
+    // The new threads are started before taking the lock, and the old ones are stopped
+    // after releasing it, once the audio thread has stopped using them.
+    ScopedPointer <RenderThreads> newThreads;
+
+    if (numThreads > 0 && numChannels > 0 && maximumBlockSize > 0)
+        newThreads = new RenderThreads (numThreads);
+
+    const ScopedLock sl (lock);
+
+    renderThreads.swapWith (newThreads);
+    renderChannels = numChannels;
+    renderBlockSize = maximumBlockSize;
+
+    publishInputs();
+    releaseOldLists (true);
+}
+
+int MixerAudioSource::getNumRenderThreads() const noexcept
+{
+    return renderThreads != nullptr ? renderThreads->getNumThreads() : 0;
+}
+
+void MixerAudioSource::publishInputs()
+{
+    InputList* const oldList = currentInputs.get();
+
+    InputList* const newList = new InputList (inputs, renderThreads,
+                                              renderChannels, renderBlockSize, oldList);
+
+    currentInputs = newList;
+
+    oldList->renderCounterWhenRetired = renderCounter.get();
+    oldLists.add (oldList);
+
+    releaseOldLists (false);
+}
+
+void MixerAudioSource::releaseOldLists (const bool waitForAudioThread)
+{
+    // The render counter is odd while a block is being rendered. A list is safe to delete if
+    // the audio thread wasn't rendering when it was replaced, or if it's been in and out of
+    // getNextAudioBlock() since, because any later block will have picked up a newer list.
+    for (int i = oldLists.size(); --i >= 0;)
+    {
+        const int counterWhenRetired = oldLists.getUnchecked (i)->renderCounterWhenRetired;
+
+        if ((counterWhenRetired & 1) != 0)
+        {
+            if (! waitForAudioThread && renderCounter.get() == counterWhenRetired)
+                continue;
+
+            while (renderCounter.get() == counterWhenRetired)
+                Thread::sleep (1);
+        }
+
+        oldLists.remove (i);
+    }
+}
+
+//==============================================================================
 void MixerAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
     tempBuffer.setSize (2, samplesPerBlockExpected);
@@ -137,13 +354,27 @@ void MixerAudioSource::releaseResources()
 
 void MixerAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
-    const ScopedLock sl (lock);
+    ++renderCounter;
 
-    if (inputs.size() > 0)
+    const InputList& list = *currentInputs.get();
+
+    if (list.renderThreads != nullptr && RenderThreads::canRender (list, info))
+        list.renderThreads->render (list, info, currentSampleRate);
+    else
+        mixInputs (list, info);
+
+    ++renderCounter;
+}
+
+void MixerAudioSource::mixInputs (const InputList& list, const AudioSourceChannelInfo& info)
+{
+    const Array <AudioSource*>& sources = list.sources;
+
+    if (sources.size() > 0)
     {
-        inputs.getUnchecked(0)->getNextAudioBlock (info);
+        sources.getUnchecked(0)->getNextAudioBlock (info);
 
-        if (inputs.size() > 1)
+        if (sources.size() > 1)
         {
             tempBuffer.setSize (jmax (1, info.buffer->getNumChannels()),
                                 info.buffer->getNumSamples());
@@ -153,9 +384,9 @@ void MixerAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
             info2.numSamples = info.numSamples;
             info2.startSample = 0;
 
-            for (int i = 1; i < inputs.size(); ++i)
+            for (int i = 1; i < sources.size(); ++i)
             {
-                inputs.getUnchecked(i)->getNextAudioBlock (info2);
+                sources.getUnchecked(i)->getNextAudioBlock (info2);
 
                 for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
                     info.buffer->addFrom (chan, info.startSample, tempBuffer, chan, 0, info.numSamples);
@@ -168,4 +399,123 @@ void MixerAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../../utilities/juce_UnitTest.h"
+#include "../../maths/juce_Random.h"
+
+class MixerAudioSourceTests  : public UnitTest
+{
+public:
+    MixerAudioSourceTests() : UnitTest ("MixerAudioSource") {}
+
+    // produces the same stream of noise each time it's created with the same seed
+    class NoiseSource  : public AudioSource
+    {
+    public:
+        NoiseSource (const int seed)  : random (seed) {}
+
+        void prepareToPlay (int, double) {}
+        void releaseResources() {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info)
+        {
+            for (int chan = 0; chan < info.buffer->getNumChannels(); ++chan)
+                for (int i = 0; i < info.numSamples; ++i)
+                    info.buffer->getSampleData (chan, info.startSample)[i] = random.nextFloat() * 0.25f - 0.125f;
+        }
+
+    private:
+        Random random;
+    };
+
+    class RenderThread  : public Thread
+    {
+    public:
+        RenderThread (MixerAudioSource& mixer_)
+            : Thread ("Mixer test"), mixer (mixer_), buffer (2, 256), numBlocks (0)
+        {
+        }
+
+        void run()
+        {
+            AudioSourceChannelInfo info;
+            info.buffer = &buffer;
+            info.startSample = 0;
+            info.numSamples = buffer.getNumSamples();
+
+            while (! threadShouldExit())
+            {
+                mixer.getNextAudioBlock (info);
+                ++numBlocks;
+            }
+        }
+
+        MixerAudioSource& mixer;
+        AudioSampleBuffer buffer;
+        int numBlocks;
+    };
+
+    void runTest()
+    {
+        beginTest ("Parallel rendering");
+
+        MixerAudioSource serialMixer, parallelMixer;
+        parallelMixer.setNumRenderThreads (3, 2, 512);
+        expectEquals (parallelMixer.getNumRenderThreads(), 3);
+
+        for (int i = 0; i < 7; ++i)
+        {
+            serialMixer.addInputSource (new NoiseSource (i), true);
+            parallelMixer.addInputSource (new NoiseSource (i), true);
+        }
+
+        AudioSampleBuffer serialBuffer (2, 1000), parallelBuffer (2, 1000);
+        bool identical = true;
+
+        for (int start = 0, blockSize = 1; start < 1000; start += blockSize, blockSize = blockSize * 2 + 1)
+        {
+            AudioSourceChannelInfo info;
+            info.startSample = start;
+            info.numSamples = jmin (blockSize, 1000 - start);
+
+            info.buffer = &serialBuffer;
+            serialMixer.getNextAudioBlock (info);
+            info.buffer = &parallelBuffer;
+            parallelMixer.getNextAudioBlock (info);
+        }
+
+        for (int chan = 0; chan < 2; ++chan)
+            for (int i = 0; i < 1000; ++i)
+                identical = identical && serialBuffer.getSampleData (chan)[i] == parallelBuffer.getSampleData (chan)[i];
+
+        expect (identical);
+
+        beginTest ("Changing inputs while rendering");
+
+        RenderThread renderThread (parallelMixer);
+        renderThread.startThread();
+
+        for (int i = 0; i < 100; ++i)
+        {
+            NoiseSource* const source = new NoiseSource (i);
+            parallelMixer.addInputSource (source, false);
+            parallelMixer.removeInputSource (source, true);
+
+            if (i % 10 == 0)
+                parallelMixer.setNumRenderThreads (i % 3, 2, 256);
+        }
+
+        parallelMixer.removeAllInputs();
+        renderThread.stopThread (5000);
+
+        expect (renderThread.numBlocks > 0);
+    }
+};
+
+static MixerAudioSourceTests mixerAudioSourceTests;
+
+#endif
+
 END_JUCE_NAMESPACE
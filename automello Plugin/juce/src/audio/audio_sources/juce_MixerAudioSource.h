@@ -29,7 +29,10 @@
 #include "juce_AudioSource.h"
 #include "../../threads/juce_CriticalSection.h"
 #include "../../containers/juce_Array.h"
+#include "../../containers/juce_OwnedArray.h"
 #include "../../maths/juce_BigInteger.h"
+#include "../../memory/juce_Atomic.h"
+#include "../../memory/juce_ScopedPointer.h"
 
 
 //==============================================================================
@@ -39,6 +42,14 @@
     Input sources can be added and removed while the mixer is running as long as their
     prepareToPlay() and releaseResources() methods are called before and after adding
     them to the mixer.
+
+    The audio thread never has to wait for a lock while this happens: each change to the
+    inputs publishes a new copy of the list for getNextAudioBlock() to pick up, and the
+    methods that remove inputs wait until any block that might still be using the old
+    list has finished before they return. This means that inputs mustn't be removed
+    from inside the mixer's own getNextAudioBlock() call.
+
+    The inputs can also be rendered on several threads at once - see setNumRenderThreads().
 */
 class JUCE_API  MixerAudioSource  : public AudioSource
 {
@@ -87,6 +98,34 @@ public:
     */
     void removeAllInputs();
 
+    //==============================================================================
+    /** Shares out the work of rendering the inputs between some extra threads.
+
+        When there's more than one input, getNextAudioBlock() hands them out to a set of
+        worker threads, each input rendering into a buffer of its own, and these buffers
+        are added together once they're all finished. They're added in the same order as
+        they would have been without the threads, so the output is exactly the same. The
+        calling thread renders inputs as well, and picks up any that the workers haven't
+        got round to, so it never waits for a worker to start. If a worker that's already
+        started an input takes longer than the block lasts (as worked out from the rate
+        passed to prepareToPlay()), the next few blocks are rendered on the calling thread
+        alone.
+
+        The numChannels and maximumBlockSize values are used to allocate the inputs'
+        buffers, so any block that's longer than this or has a different number of channels
+        gets mixed on the calling thread in the normal way. Passing 0 for numThreads stops
+        the threads.
+
+        Each input is only ever called by one thread at a time, but inputs which share any
+        state with each other will need to protect it themselves.
+    */
+    void setNumRenderThreads (int numThreads, int numChannels, int maximumBlockSize);
+
+    /** Returns the number of extra threads that are used to render the inputs.
+        @see setNumRenderThreads
+    */
+    int getNumRenderThreads() const noexcept;
+
     //==============================================================================
     /** Implementation of the AudioSource method.
 
@@ -106,12 +145,23 @@ public:
 
 private:
     //==============================================================================
+    class InputList;
+    class RenderThreads;
+
     Array <AudioSource*> inputs;
     BigInteger inputsToDelete;
     CriticalSection lock;
+    Atomic <InputList*> currentInputs;
+    Atomic <int> renderCounter;
+    OwnedArray <InputList> oldLists;
+    ScopedPointer <RenderThreads> renderThreads;
     AudioSampleBuffer tempBuffer;
     double currentSampleRate;
-    int bufferSizeExpected;
+    int bufferSizeExpected, renderChannels, renderBlockSize;
+
+    void publishInputs();
+    void releaseOldLists (bool waitForAudioThread);
+    void mixInputs (const InputList&, const AudioSourceChannelInfo&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerAudioSource);
 };
@@ -28,8 +28,363 @@
 BEGIN_JUCE_NAMESPACE
 
 #include "juce_ResamplingAudioSource.h"
+#include "../../utilities/juce_DeletedAtShutdown.h"
+#include "../../core/juce_Singleton.h"
+#include "../../memory/juce_Atomic.h"
+#include "../dsp/juce_FloatVectorOperations.h"
 
 
+//==============================================================================
+namespace ResamplerHelpers
+{
+    // (the filters are all padded to a multiple of 8 taps, so these don't need to deal with leftovers)
+    static inline float dotProduct (const float* src, const float* c, int num) noexcept
+    {
+       #if JUCE_USE_AVX_INTRINSICS
+        __m256 total (_mm256_mul_ps (_mm256_loadu_ps (src), _mm256_loadu_ps (c)));
+
+        for (int i = 8; i < num; i += 8)
+            total = _mm256_add_ps (total, _mm256_mul_ps (_mm256_loadu_ps (src + i), _mm256_loadu_ps (c + i)));
+
+        __m128 s = _mm_add_ps (_mm256_castps256_ps128 (total), _mm256_extractf128_ps (total, 1));
+        s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+        return _mm_cvtss_f32 (_mm_add_ss (s, _mm_shuffle_ps (s, s, 1)));
+       #elif JUCE_USE_SSE_INTRINSICS
+        // two accumulators, so that the adds can overlap..
+        __m128 total1 (_mm_mul_ps (_mm_loadu_ps (src), _mm_loadu_ps (c)));
+        __m128 total2 (_mm_mul_ps (_mm_loadu_ps (src + 4), _mm_loadu_ps (c + 4)));
+
+        for (int i = 8; i < num; i += 8)
+        {
+            total1 = _mm_add_ps (total1, _mm_mul_ps (_mm_loadu_ps (src + i), _mm_loadu_ps (c + i)));
+            total2 = _mm_add_ps (total2, _mm_mul_ps (_mm_loadu_ps (src + i + 4), _mm_loadu_ps (c + i + 4)));
+        }
+
+        __m128 s = _mm_add_ps (total1, total2);
+        s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+        return _mm_cvtss_f32 (_mm_add_ss (s, _mm_shuffle_ps (s, s, 1)));
+       #elif JUCE_USE_ARM_NEON
+        float32x4_t total1 (vmulq_f32 (vld1q_f32 (src), vld1q_f32 (c)));
+        float32x4_t total2 (vmulq_f32 (vld1q_f32 (src + 4), vld1q_f32 (c + 4)));
+
+        for (int i = 8; i < num; i += 8)
+        {
+            total1 = vmlaq_f32 (total1, vld1q_f32 (src + i), vld1q_f32 (c + i));
+            total2 = vmlaq_f32 (total2, vld1q_f32 (src + i + 4), vld1q_f32 (c + i + 4));
+        }
+
+        const float32x4_t t (vaddq_f32 (total1, total2));
+        const float32x2_t s (vadd_f32 (vget_low_f32 (t), vget_high_f32 (t)));
+        return vget_lane_f32 (vpadd_f32 (s, s), 0);
+       #else
+        float total1 = 0, total2 = 0;
+
+        for (int i = 0; i < num; i += 2)
+        {
+            total1 += src[i] * c[i];
+            total2 += src[i + 1] * c[i + 1];
+        }
+
+        return total1 + total2;
+       #endif
+    }
+
+    // dest = c + d * fraction
+    static inline void interpolate (float* dest, const float* c, const float* d, const float fraction, int num) noexcept
+    {
+       #if JUCE_USE_AVX_INTRINSICS
+        const __m256 f (_mm256_set1_ps (fraction));
+
+        for (int i = 0; i < num; i += 8)
+            _mm256_storeu_ps (dest + i, _mm256_add_ps (_mm256_loadu_ps (c + i), _mm256_mul_ps (_mm256_loadu_ps (d + i), f)));
+       #elif JUCE_USE_SSE_INTRINSICS
+        const __m128 f (_mm_set1_ps (fraction));
+
+        for (int i = 0; i < num; i += 4)
+            _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (c + i), _mm_mul_ps (_mm_loadu_ps (d + i), f)));
+       #elif JUCE_USE_ARM_NEON
+        const float32x4_t f (vdupq_n_f32 (fraction));
+
+        for (int i = 0; i < num; i += 4)
+            vst1q_f32 (dest + i, vmlaq_f32 (vld1q_f32 (c + i), vld1q_f32 (d + i), f));
+       #else
+        for (int i = 0; i < num; ++i)
+            dest[i] = c[i] + d[i] * fraction;
+       #endif
+    }
+
+    static double besselI0 (const double x) noexcept
+    {
+        double total = 1.0, term = 1.0;
+
+        for (int i = 1; i < 50 && term > total * 1.0e-12; ++i)
+        {
+            const double t = x / (2.0 * i);
+            term *= t * t;
+            total += term;
+        }
+
+        return total;
+    }
+
+    struct QualitySettings
+    {
+        int numTaps, numPhases;
+        double cutoff, kaiserBeta;
+    };
+
+    // The cutoffs are chosen so that the top of each filter's transition band is at the
+    // Nyquist frequency. A Kaiser beta of 5 gives about 55dB of stop-band rejection, 7 gives
+    // about 70dB, and 9 about 90dB.
+    static const QualitySettings qualitySettings[] = { { 16, 64,  0.80, 5.0 },
+                                                       { 32, 128, 0.86, 7.0 },
+                                                       { 64, 256, 0.91, 9.0 } };
+
+    // The sample rates whose ratios get their own exact tables
+    static const int commonSampleRates[] = { 8000, 11025, 16000, 22050, 24000, 32000, 44100,
+                                             48000, 88200, 96000, 176400, 192000 };
+
+    static int greatestCommonDivisor (int a, int b) noexcept
+    {
+        while (b != 0)
+        {
+            const int t = a % b;
+            a = b;
+            b = t;
+        }
+
+        return a;
+    }
+}
+
+//==============================================================================
+/*  A table of Kaiser-windowed sinc coefficients for a set of equally-spaced fractional
+    positions between samples, along with the differences between neighbouring phases so
+    that positions in between them can be interpolated.
+
+    If the ratio that a filter was made for is one between two common sample rates, then
+    its number of phases is a multiple of the ratio's denominator, so every output sample
+    lands exactly on a phase, and the resampler can step through them without any
+    interpolation or rounding errors.
+
+    The filters are shared, and aren't deleted until shutdown. Making one takes a while, so
+    they're all made in advance by the methods that get called before playback starts, and
+    the audio thread only ever looks up the ones that already exist.
+*/
+class ResamplingAudioSource::Filter
+{
+public:
+    Filter (const int numTaps_, const int numPhases_, const double cutoff_, const double kaiserBeta, const int exactStep_)
+        : numTaps (numTaps_),
+          numTapsBefore (numTaps_ / 2 - 1),
+          numTapsAfter (numTaps_ / 2),
+          numPhases (numPhases_),
+          exactStep (exactStep_),
+          cutoff (cutoff_),
+          coefficients ((size_t) ((numPhases_ + 1) * numTaps_)),
+          deltas ((size_t) ((numPhases_ + 1) * numTaps_))
+    {
+        jassert (numTaps % 8 == 0 && numTaps <= maxNumTaps);
+
+        const double window = numTaps / 2;
+        const double windowScale = 1.0 / ResamplerHelpers::besselI0 (kaiserBeta);
+
+        for (int phase = 0; phase <= numPhases; ++phase)
+        {
+            float* const c = coefficients + phase * numTaps;
+            double total = 0;
+
+            for (int i = 0; i < numTaps; ++i)
+            {
+                const double x = (i - numTapsBefore) - phase / (double) numPhases;
+                const double w = x / window;
+                const double kaiser = w * w < 1.0 ? ResamplerHelpers::besselI0 (kaiserBeta * std::sqrt (1.0 - w * w)) * windowScale : 0.0;
+                const double sinc = x == 0 ? 1.0 : std::sin (double_Pi * cutoff * x) / (double_Pi * cutoff * x);
+
+                c[i] = (float) (sinc * kaiser);
+                total += c[i];
+            }
+
+            // normalise each phase so that it has unity gain at DC
+            for (int i = 0; i < numTaps; ++i)
+                c[i] = (float) (c[i] / total);
+        }
+
+        for (int i = 0; i < numPhases * numTaps; ++i)
+            deltas[i] = coefficients [i + numTaps] - coefficients[i];
+
+        for (int i = 0; i < numTaps; ++i)
+            deltas [numPhases * numTaps + i] = 0;
+    }
+
+    const float* getPhase (const int phase) const noexcept
+    {
+        return coefficients + phase * numTaps;
+    }
+
+    void getCoefficients (const double fraction, float* const dest) const noexcept
+    {
+        const double phasePosition = fraction * numPhases;
+        const int phase = jlimit (0, numPhases, (int) phasePosition);
+
+        ResamplerHelpers::interpolate (dest, coefficients + phase * numTaps, deltas + phase * numTaps,
+                                       (float) (phasePosition - phase), numTaps);
+    }
+
+    bool isExactFor (const double ratio) const noexcept
+    {
+        return exactStep > 0 && std::abs (exactStep - ratio * numPhases) < 1.0e-6;
+    }
+
+    //==============================================================================
+    /*  Returns the filter to use for a ratio. If createIfNeeded is false, this doesn't lock
+        or allocate anything, and if there's no exact filter for the ratio, it falls back on
+        the approximate one that createFiltersFor() will have made (returning null if that
+        hasn't been called for this quality).
+    */
+    static const Filter* getFor (const Quality quality, const double ratio, const bool createIfNeeded)
+    {
+        using namespace ResamplerHelpers;
+        const QualitySettings& settings = qualitySettings [jlimit (0, 2, (int) quality)];
+
+        // see whether this is the ratio between two common sample rates..
+        for (int i = 0; i < numElementsInArray (commonSampleRates); ++i)
+        {
+            for (int j = 0; j < numElementsInArray (commonSampleRates); ++j)
+            {
+                if (std::abs (commonSampleRates[i] - ratio * commonSampleRates[j]) < 1.0e-6)
+                {
+                    const int divisor = greatestCommonDivisor (commonSampleRates[i], commonSampleRates[j]);
+                    const int denominator = commonSampleRates[j] / divisor;
+                    const int multiple = (settings.numPhases + denominator - 1) / denominator;
+
+                    const Filter* const exactFilter = getFor (settings, ratio, denominator * multiple,
+                                                              (commonSampleRates[i] / divisor) * multiple,
+                                                              createIfNeeded);
+                    if (exactFilter != nullptr)
+                        return exactFilter;
+
+                    return getFor (settings, ratio, settings.numPhases, 0, createIfNeeded);
+                }
+            }
+        }
+
+        return getFor (settings, ratio, settings.numPhases, 0, createIfNeeded);
+    }
+
+    /*  Makes all the approximate filters that a quality can need, so that there's one for
+        any ratio that the audio thread might ask for.
+    */
+    static void createFiltersFor (const Quality quality)
+    {
+        const ResamplerHelpers::QualitySettings& settings = ResamplerHelpers::qualitySettings [jlimit (0, 2, (int) quality)];
+
+        for (int i = 0; i <= maxQuarterOctaves; ++i)
+            getFor (settings, std::pow (2.0, i / 4.0), settings.numPhases, 0, true);
+    }
+
+    enum { maxNumTaps = 256, historySize = maxNumTaps / 2, maxQuarterOctaves = 12 };
+
+    const int numTaps, numTapsBefore, numTapsAfter, numPhases, exactStep;
+    const double cutoff;
+
+private:
+    HeapBlock<float> coefficients, deltas;
+
+    static const Filter* getFor (const ResamplerHelpers::QualitySettings& settings, const double ratio,
+                                 const int numPhases, const int step, const bool createIfNeeded)
+    {
+        // when down-sampling, the cutoff needs to come down to the new Nyquist frequency. For
+        // any other ratio, this is rounded up to a quarter of an octave, so that a ratio that's
+        // being swept only ever needs one of the tables that createFiltersFor() makes.
+        double scale = 1.0;
+
+        if (ratio > 1.0)
+            scale = step > 0 ? ratio
+                             : std::pow (2.0, jmin ((int) maxQuarterOctaves,
+                                                    (int) std::ceil (4.0 * std::log (ratio) / std::log (2.0) - 0.001)) / 4.0);
+
+        const int numTaps = jmin ((int) maxNumTaps, 8 * (int) std::ceil (settings.numTaps * jmin (4.0, scale) / 8.0));
+        const double cutoff = settings.cutoff / scale;
+
+        if (createIfNeeded)
+            return Cache::getInstance()->get (numTaps, numPhases, cutoff, settings.kaiserBeta, step);
+
+        const Cache* const cache = Cache::getInstanceWithoutCreating();
+        return cache != nullptr ? cache->find (numTaps, numPhases, cutoff, step) : nullptr;
+    }
+
+    //==============================================================================
+    /*  The filters are kept in a fixed-size array that only ever gets added to, so the audio
+        thread can search it without taking the lock.
+    */
+    class Cache  : public DeletedAtShutdown
+    {
+    public:
+        Cache() : numFilters (0) {}
+
+        ~Cache()
+        {
+            for (int i = numFilters; --i >= 0;)
+                delete filters[i].get();
+
+            clearSingletonInstance();
+        }
+
+        juce_DeclareSingleton (Cache, false);
+
+        const Filter* find (const int numTaps, const int numPhases, const double cutoff, const int exactStep) const noexcept
+        {
+            for (int i = 0; i < maxNumFilters; ++i)
+            {
+                const Filter* const f = filters[i].get();
+
+                if (f == nullptr)
+                    break;
+
+                if (f->numTaps == numTaps && f->numPhases == numPhases
+                     && f->exactStep == exactStep && f->cutoff == cutoff)
+                    return f;
+            }
+
+            return nullptr;
+        }
+
+        const Filter* get (const int numTaps, const int numPhases, const double cutoff, const double kaiserBeta, const int exactStep)
+        {
+            const ScopedLock sl (lock);
+
+            const Filter* const existing = find (numTaps, numPhases, cutoff, exactStep);
+
+            if (existing != nullptr)
+                return existing;
+
+            // (there's room for the approximate filters and every exact ratio at every quality)
+            jassert (numFilters < maxNumFilters);
+
+            if (numFilters >= maxNumFilters)
+                return nullptr;
+
+            Filter* const f = new Filter (numTaps, numPhases, cutoff, kaiserBeta, exactStep);
+            filters [numFilters++] = f;
+            return f;
+        }
+
+    private:
+        enum { maxNumFilters = 512 };
+
+        Atomic<Filter*> filters [maxNumFilters];
+        int numFilters;
+        CriticalSection lock;
+
+        JUCE_DECLARE_NON_COPYABLE (Cache);
+    };
+
+    JUCE_DECLARE_NON_COPYABLE (Filter);
+};
+
+juce_ImplementSingleton (ResamplingAudioSource::Filter::Cache);
+
 //==============================================================================
 ResamplingAudioSource::ResamplingAudioSource (AudioSource* const inputSource,
                                               const bool deleteInputWhenDeleted,
@@ -37,11 +392,18 @@ ResamplingAudioSource::ResamplingAudioSource (AudioSource* const inputSource,
     : input (inputSource, deleteInputWhenDeleted),
       ratio (1.0),
       lastRatio (1.0),
+      quality (mediumQuality),
+      filter (Filter::getFor (mediumQuality, 1.0, true)),
+      filterInUse (filter),
       buffer (numChannels_, 0),
-      sampsInBuffer (0),
-      numChannels (numChannels_)
+      bufferPos (Filter::historySize),
+      bufferEnd (Filter::historySize),
+      subSampleOffset (0.0),
+      numChannels (numChannels_),
+      coefficients ((size_t) Filter::maxNumTaps)
 {
     jassert (input != nullptr);
+    Filter::createFiltersFor (mediumQuality);
 }
 
 ResamplingAudioSource::~ResamplingAudioSource() {}
@@ -50,28 +412,55 @@ void ResamplingAudioSource::setResamplingRatio (const double samplesInPerOutputS
 {
     jassert (samplesInPerOutputSample > 0);
 
+    const double newRatio = jmax (0.0, samplesInPerOutputSample);
+
+    // (this may be getting called on the audio thread, so it only looks for a filter that's
+    // already been made)
+    const Filter* const newFilter = Filter::getFor (quality, newRatio, false);
+
     const SpinLock::ScopedLockType sl (ratioLock);
-    ratio = jmax (0.0, samplesInPerOutputSample);
+    ratio = newRatio;
+
+    if (newFilter != nullptr)
+        filter = newFilter;
+}
+
+void ResamplingAudioSource::setQuality (const Quality newQuality)
+{
+    if (quality != newQuality)
+    {
+        Filter::createFiltersFor (newQuality);
+        const Filter* const newFilter = Filter::getFor (newQuality, ratio, true);
+
+        const SpinLock::ScopedLockType sl (ratioLock);
+        quality = newQuality;
+        filter = newFilter;
+    }
 }
 
 void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected,
                                            double sampleRate)
 {
+    // (this is where an exact filter gets made, if the ratio has been changed to a new one)
+    Filter::createFiltersFor (quality);
+    const Filter* const newFilter = Filter::getFor (quality, ratio, true);
+
     const SpinLock::ScopedLockType sl (ratioLock);
 
+    filter = newFilter;
+    filterInUse = newFilter;
+
     input->prepareToPlay (samplesPerBlockExpected, sampleRate);
 
-    buffer.setSize (numChannels, roundToInt (samplesPerBlockExpected * ratio) + 32);
+    buffer.setSize (numChannels, Filter::historySize + roundToInt (samplesPerBlockExpected * ratio) + Filter::maxNumTaps + 32);
     buffer.clear();
-    sampsInBuffer = 0;
-    bufferPos = 0;
+    bufferPos = Filter::historySize;
+    bufferEnd = Filter::historySize;
     subSampleOffset = 0.0;
+    lastRatio = ratio;
 
-    filterStates.calloc (numChannels);
-    srcBuffers.calloc (numChannels);
-    destBuffers.calloc (numChannels);
-    createLowPass (ratio);
-    resetFilters();
+    srcBuffers.calloc ((size_t) numChannels);
+    destBuffers.calloc ((size_t) numChannels);
 }
 
 void ResamplingAudioSource::releaseResources()
@@ -80,189 +469,178 @@ void ResamplingAudioSource::releaseResources()
     buffer.setSize (numChannels, 0);
 }
 
-void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
+void ResamplingAudioSource::fillBuffer (const int numNeeded)
 {
-    double localRatio;
+    // The buffer holds a run of input samples, with enough history before bufferPos
+    // for the longest filter. Whatever's older than that is dropped by moving the rest
+    // of the data back to the start.
+    const int numToDrop = bufferPos - Filter::historySize;
 
+    if (numToDrop > 0)
     {
-        const SpinLock::ScopedLockType sl (ratioLock);
-        localRatio = ratio;
-    }
+        for (int i = numChannels; --i >= 0;)
+        {
+            float* const data = buffer.getSampleData (i);
+            memmove (data, data + numToDrop, sizeof (float) * (size_t) (bufferEnd - numToDrop));
+        }
 
-    if (lastRatio != localRatio)
-    {
-        createLowPass (localRatio);
-        lastRatio = localRatio;
+        bufferPos -= numToDrop;
+        bufferEnd -= numToDrop;
     }
 
-    const int sampsNeeded = roundToInt (info.numSamples * localRatio) + 2;
+    const int end = bufferPos + numNeeded;
 
-    int bufferSize = buffer.getNumSamples();
+    // (getNextAudioBlock() splits up its blocks so that this can't happen, unless the ratio
+    // is so high that a single output sample needs more input than the buffer holds)
+    if (end > buffer.getNumSamples())
+        buffer.setSize (numChannels, end + 32, true, true);
 
-    if (bufferSize < sampsNeeded + 8)
+    if (end > bufferEnd)
     {
-        bufferPos %= bufferSize;
-        bufferSize = sampsNeeded + 32;
-        buffer.setSize (buffer.getNumChannels(), bufferSize, true, true);
-    }
+        AudioSourceChannelInfo readInfo;
+        readInfo.buffer = &buffer;
+        readInfo.startSample = bufferEnd;
+        readInfo.numSamples = end - bufferEnd;
 
-    bufferPos %= bufferSize;
+        input->getNextAudioBlock (readInfo);
+        bufferEnd = end;
+    }
+}
 
-    int endOfBufferPos = bufferPos + sampsInBuffer;
-    const int channelsToProcess = jmin (numChannels, info.buffer->getNumChannels());
+void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
+{
+    double localRatio = lastRatio;
+    const Filter* localFilter = filterInUse;
 
-    while (sampsNeeded > sampsInBuffer)
     {
-        endOfBufferPos %= bufferSize;
-
-        int numToDo = jmin (sampsNeeded - sampsInBuffer,
-                            bufferSize - endOfBufferPos);
+        // (if another thread is in the middle of changing the ratio, the change gets picked
+        // up in the next block rather than waiting for it)
+        const GenericScopedTryLock <SpinLock> sl (ratioLock);
 
-        AudioSourceChannelInfo readInfo;
-        readInfo.buffer = &buffer;
-        readInfo.numSamples = numToDo;
-        readInfo.startSample = endOfBufferPos;
+        if (sl.isLocked())
+        {
+            localRatio = ratio;
+            localFilter = filter;
+        }
+    }
 
-        input->getNextAudioBlock (readInfo);
+    filterInUse = localFilter;
 
-        if (localRatio > 1.0001)
-        {
-            // for down-sampling, pre-apply the filter..
+    const int numSamples = info.numSamples;
 
-            for (int i = channelsToProcess; --i >= 0;)
-                applyFilter (buffer.getSampleData (i, endOfBufferPos), numToDo, filterStates[i]);
-        }
+    if (numSamples <= 0)
+        return;
 
-        sampsInBuffer += numToDo;
-        endOfBufferPos += numToDo;
-    }
+    // if the ratio has changed, it gets ramped from the old value over the course of this block
+    const double startRatio = lastRatio;
+    const double ratioDelta = (localRatio - startRatio) / numSamples;
+    lastRatio = localRatio;
 
-    for (int channel = 0; channel < channelsToProcess; ++channel)
-    {
-        destBuffers[channel] = info.buffer->getSampleData (channel, info.startSample);
-        srcBuffers[channel] = buffer.getSampleData (channel, 0);
-    }
+    // The buffer's size was set by prepareToPlay(), so if this block needs more input than
+    // that (because the block or the ratio is bigger than it was then), it's done in pieces
+    const double maxRatio = jmax (startRatio, localRatio);
+    const int maxInputPerPiece = buffer.getNumSamples() - Filter::historySize - localFilter->numTapsAfter - 4;
+    const int maxSamplesPerPiece = maxRatio > 0 ? jmax (1, (int) (maxInputPerPiece / maxRatio))
+                                                : numSamples;
 
-    int nextPos = (bufferPos + 1) % bufferSize;
-    for (int m = info.numSamples; --m >= 0;)
+    for (int done = 0; done < numSamples;)
     {
-        const float alpha = (float) subSampleOffset;
-        const float invAlpha = 1.0f - alpha;
+        const int numThisTime = jmin (numSamples - done, maxSamplesPerPiece);
 
-        for (int channel = 0; channel < channelsToProcess; ++channel)
-            *destBuffers[channel]++ = srcBuffers[channel][bufferPos] * invAlpha + srcBuffers[channel][nextPos] * alpha;
+        renderSamples (*info.buffer, info.startSample + done, numThisTime,
+                       startRatio + ratioDelta * done, ratioDelta, *localFilter);
 
-        subSampleOffset += localRatio;
+        done += numThisTime;
+    }
+}
 
-        jassert (sampsInBuffer > 0);
+void ResamplingAudioSource::renderSamples (AudioSampleBuffer& dest, const int startSample, const int numSamples,
+                                           const double startRatio, const double ratioDelta, const Filter& localFilter)
+{
+    const double totalMovement = numSamples * startRatio + ratioDelta * numSamples * (numSamples + 1) * 0.5;
+    const int channelsToProcess = jmin (numChannels, dest.getNumChannels());
 
-        while (subSampleOffset >= 1.0)
-        {
-            if (++bufferPos >= bufferSize)
-                bufferPos = 0;
+    if (ratioDelta == 0 && startRatio == 1.0 && subSampleOffset == 0)
+    {
+        // nothing to do but copy the input across..
+        fillBuffer (numSamples);
 
-            --sampsInBuffer;
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+            FloatVectorOperations::copy (dest.getSampleData (channel, startSample),
+                                         buffer.getSampleData (channel, bufferPos), numSamples);
 
-            nextPos = (bufferPos + 1) % bufferSize;
-            subSampleOffset -= 1.0;
-        }
+        bufferPos += numSamples;
+        return;
     }
 
-    if (localRatio < 0.9999)
+    const int numTaps = localFilter.numTaps;
+    fillBuffer ((int) (subSampleOffset + totalMovement) + localFilter.numTapsAfter + 2);
+
+    for (int channel = 0; channel < channelsToProcess; ++channel)
     {
-        // for up-sampling, apply the filter after transposing..
-        for (int i = channelsToProcess; --i >= 0;)
-            applyFilter (info.buffer->getSampleData (i, info.startSample), info.numSamples, filterStates[i]);
+        destBuffers[channel] = dest.getSampleData (channel, startSample);
+        srcBuffers[channel] = buffer.getSampleData (channel, bufferPos - localFilter.numTapsBefore);
     }
-    else if (localRatio <= 1.0001)
-    {
-        // if the filter's not currently being applied, keep it stoked with the last couple of samples to avoid discontinuities
-        for (int i = channelsToProcess; --i >= 0;)
-        {
-            const float* const endOfBuffer = info.buffer->getSampleData (i, info.startSample + info.numSamples - 1);
-            FilterState& fs = filterStates[i];
 
-            if (info.numSamples > 1)
-            {
-                fs.y2 = fs.x2 = *(endOfBuffer - 1);
-            }
-            else
-            {
-                fs.y2 = fs.y1;
-                fs.x2 = fs.x1;
-            }
+    int index = 0;
 
-            fs.y1 = fs.x1 = *endOfBuffer;
+    if (ratioDelta == 0 && localFilter.isExactFor (startRatio))
+    {
+        // the ratio is one of the common ones, so each output sample falls exactly on one of
+        // the filter's phases, and the position can be stepped with integers..
+        const int numPhases = localFilter.numPhases;
+        const int wholeStep = localFilter.exactStep / numPhases;
+        const int phaseStep = localFilter.exactStep % numPhases;
+        int phase = roundToInt (subSampleOffset * numPhases);
+
+        if (phase >= numPhases)
+        {
+            phase -= numPhases;
+            ++index;
         }
-    }
 
-    jassert (sampsInBuffer >= 0);
-}
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float* const c = localFilter.getPhase (phase);
 
-void ResamplingAudioSource::createLowPass (const double frequencyRatio)
-{
-    const double proportionalRate = (frequencyRatio > 1.0) ? 0.5 / frequencyRatio
-                                                           : 0.5 * frequencyRatio;
-
-    const double n = 1.0 / std::tan (double_Pi * jmax (0.001, proportionalRate));
-    const double nSquared = n * n;
-    const double c1 = 1.0 / (1.0 + std::sqrt (2.0) * n + nSquared);
-
-    setFilterCoefficients (c1,
-                           c1 * 2.0f,
-                           c1,
-                           1.0,
-                           c1 * 2.0 * (1.0 - nSquared),
-                           c1 * (1.0 - std::sqrt (2.0) * n + nSquared));
-}
+            for (int channel = 0; channel < channelsToProcess; ++channel)
+                destBuffers[channel][i] = ResamplerHelpers::dotProduct (srcBuffers[channel] + index, c, numTaps);
 
-void ResamplingAudioSource::setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6)
-{
-    const double a = 1.0 / c4;
-
-    c1 *= a;
-    c2 *= a;
-    c3 *= a;
-    c5 *= a;
-    c6 *= a;
-
-    coefficients[0] = c1;
-    coefficients[1] = c2;
-    coefficients[2] = c3;
-    coefficients[3] = c4;
-    coefficients[4] = c5;
-    coefficients[5] = c6;
-}
+            index += wholeStep;
+            phase += phaseStep;
 
-void ResamplingAudioSource::resetFilters()
-{
-    filterStates.clear (numChannels);
-}
+            if (phase >= numPhases)
+            {
+                phase -= numPhases;
+                ++index;
+            }
+        }
 
-void ResamplingAudioSource::applyFilter (float* samples, int num, FilterState& fs)
-{
-    while (--num >= 0)
+        subSampleOffset = phase / (double) numPhases;
+    }
+    else
     {
-        const double in = *samples;
+        double position = subSampleOffset;
+        double currentRatio = startRatio;
 
-        double out = coefficients[0] * in
-                     + coefficients[1] * fs.x1
-                     + coefficients[2] * fs.x2
-                     - coefficients[4] * fs.y1
-                     - coefficients[5] * fs.y2;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            index = (int) position;
+            localFilter.getCoefficients (position - index, coefficients);
 
-       #if JUCE_INTEL
-        if (! (out < -1.0e-8 || out > 1.0e-8))
-            out = 0;
-       #endif
+            for (int channel = 0; channel < channelsToProcess; ++channel)
+                destBuffers[channel][i] = ResamplerHelpers::dotProduct (srcBuffers[channel] + index, coefficients, numTaps);
 
-        fs.x2 = fs.x1;
-        fs.x1 = in;
-        fs.y2 = fs.y1;
-        fs.y1 = out;
+            currentRatio += ratioDelta;
+            position += currentRatio;
+        }
 
-        *samples++ = (float) out;
+        index = (int) position;
+        subSampleOffset = position - index;
     }
+
+    bufferPos += index;
+    jassert (bufferPos <= bufferEnd);
 }
 
 END_JUCE_NAMESPACE
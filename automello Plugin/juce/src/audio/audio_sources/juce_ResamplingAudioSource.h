@@ -28,6 +28,7 @@
 
 #include "juce_AudioSource.h"
 #include "../../threads/juce_SpinLock.h"
+#include "../../memory/juce_HeapBlock.h"
 #include "../../memory/juce_OptionalScopedPointer.h"
 
 
@@ -35,6 +36,12 @@
 /**
     A type of AudioSource that takes an input source and changes its sample rate.
 
+    The conversion uses a polyphase windowed-sinc filter, whose length depends on the
+    quality that's selected with setQuality(). The filter's cutoff follows the ratio, so
+    that down-sampling doesn't alias, and the ratio can be changed while the source is
+    playing: each change is ramped over the course of the next block, so it can be used
+    for varispeed effects as well as for sample rate conversion.
+
     @see AudioSource
 */
 class JUCE_API  ResamplingAudioSource  : public AudioSource
@@ -71,6 +78,33 @@ public:
     */
     double getResamplingRatio() const noexcept                  { return ratio; }
 
+    //==============================================================================
+    /** The different filter lengths that the resampler can use. */
+    enum Quality
+    {
+        lowQuality = 0,     /**< A 16-point filter, which is cheap, but lets a little aliasing through. */
+        mediumQuality,      /**< A 32-point filter, with about 70dB of stop-band rejection. */
+        highQuality         /**< A 64-point filter, with about 90dB of stop-band rejection. */
+    };
+
+    /** Changes the length of filter that's used.
+
+        When down-sampling, the filter is made longer in proportion to the ratio (up to
+        four times), so that its transition band stays the same width.
+
+        The filter tables are shared between all the resamplers that use them. This method
+        and prepareToPlay() make all the tables that the quality needs, so the ratio can be
+        changed while the source is playing without any of them having to be made on the
+        audio thread. If the ratio is the one between two common sample rates, an exact table
+        is used for it, but only if the ratio was set before this or prepareToPlay() was called.
+    */
+    void setQuality (Quality newQuality);
+
+    /** Returns the quality that's currently being used.
+        @see setQuality
+    */
+    Quality getQuality() const noexcept                         { return quality; }
+
     //==============================================================================
     void prepareToPlay (int samplesPerBlockExpected, double sampleRate);
     void releaseResources();
@@ -78,28 +112,25 @@ public:
 
 private:
     //==============================================================================
+    class Filter;
+
     OptionalScopedPointer<AudioSource> input;
     double ratio, lastRatio;
+    Quality quality;
+    const Filter* filter;
+    const Filter* filterInUse;
     AudioSampleBuffer buffer;
-    int bufferPos, sampsInBuffer;
+    int bufferPos, bufferEnd;
     double subSampleOffset;
-    double coefficients[6];
     SpinLock ratioLock;
     const int numChannels;
-    HeapBlock<float*> destBuffers, srcBuffers;
-
-    void setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6);
-    void createLowPass (double proportionalRate);
-
-    struct FilterState
-    {
-        double x1, x2, y1, y2;
-    };
-
-    HeapBlock<FilterState> filterStates;
-    void resetFilters();
+    HeapBlock<float*> destBuffers;
+    HeapBlock<const float*> srcBuffers;
+    HeapBlock<float> coefficients;
 
-    void applyFilter (float* samples, int num, FilterState& fs);
+    void fillBuffer (int numNeeded);
+    void renderSamples (AudioSampleBuffer&, int startSample, int numSamples,
+                        double startRatio, double ratioDelta, const Filter&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResamplingAudioSource);
 };
@@ -53,6 +53,24 @@ bool AudioIODevice::showControlPanel()
     return false;
 }
 
+int AudioIODevice::getXRunCount() const noexcept
+{
+    return -1;
+}
+
+AudioIODevice::CallbackStatistics::CallbackStatistics() noexcept
+    : numCallbacks (0),
+      numLateCallbacks (0),
+      averageMilliseconds (0),
+      maximumMilliseconds (0)
+{
+}
+
+bool AudioIODevice::getCallbackStatistics (CallbackStatistics&) const
+{
+    return false;
+}
+
 //==============================================================================
 void AudioIODeviceCallback::audioDeviceError (const String&) {}
 
@@ -305,6 +305,32 @@ public:
     */
     virtual int getInputLatencyInSamples() = 0;
 
+    //==============================================================================
+    /** Returns the number of times that the device has had to recover from a buffer
+        underrun or overrun since it was opened, or -1 if it doesn't keep count of them.
+    */
+    virtual int getXRunCount() const noexcept;
+
+    /** Timing details for the callbacks that a device has made.
+        @see getCallbackStatistics
+    */
+    struct JUCE_API  CallbackStatistics
+    {
+        CallbackStatistics() noexcept;
+
+        int numCallbacks;               /**< The number of callbacks made since the device was opened. */
+        int numLateCallbacks;           /**< The number of callbacks that took longer than the duration of their block. */
+        double averageMilliseconds;     /**< The average time spent inside the callback. */
+        double maximumMilliseconds;     /**< The longest time spent inside the callback. */
+    };
+
+    /** Fills in some timing details for the callbacks that the device has made since
+        it was opened.
+
+        Returns false if the device doesn't keep track of these.
+    */
+    virtual bool getCallbackStatistics (CallbackStatistics& result) const;
+
 
     //==============================================================================
     /** True if this device can show a pop-up control panel for editing its settings.
@@ -72,6 +72,7 @@ AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ASIO()
 
 #if ! (JUCE_LINUX && JUCE_ALSA)
 AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSA()            { return nullptr; }
+AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSALowLatency()  { return nullptr; }
 #endif
 
 #if ! (JUCE_LINUX && JUCE_JACK)
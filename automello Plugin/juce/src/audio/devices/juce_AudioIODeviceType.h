@@ -163,6 +163,11 @@ public:
     static AudioIODeviceType* createAudioIODeviceType_ASIO();
     /** Creates an ALSA device type if it's available on this platform, or returns null. */
     static AudioIODeviceType* createAudioIODeviceType_ALSA();
+    /** Creates an ALSA device type that transfers audio through the devices' mmapped buffers
+        and runs its thread with SCHED_FIFO priority, if it's available on this platform, or
+        returns null.
+    */
+    static AudioIODeviceType* createAudioIODeviceType_ALSALowLatency();
     /** Creates a JACK device type if it's available on this platform, or returns null. */
     static AudioIODeviceType* createAudioIODeviceType_JACK();
     /** Creates an Android device type if it's available on this platform, or returns null. */
@@ -0,0 +1,318 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_AudioBufferPool.h"
+
+
+//==============================================================================
+// Every block is preceded by one of these, so that it can be returned to the right
+// place without the caller needing to know where it came from.
+struct AudioBufferPool::BlockHeader
+{
+    void* allocation;           // the pointer that malloc actually returned
+    AudioBufferPool* owner;     // null for blocks that weren't reserved in a pool
+    int sizeClass, slot;
+};
+
+//==============================================================================
+AudioBufferPool::AudioBufferPool()
+{
+    for (int i = 0; i < numSizeClasses; ++i)
+        for (int j = 0; j < maxBlocksPerSizeClass; ++j)
+            blocks[i][j] = nullptr;
+}
+
+AudioBufferPool::~AudioBufferPool()
+{
+    for (int i = 0; i < numSizeClasses; ++i)
+    {
+        for (int j = 0; j < maxBlocksPerSizeClass; ++j)
+        {
+            // if this fails, you've deleted the pool while a buffer is still using one of its blocks!
+            jassert (slotStates[i][j].get() != slotInUse);
+
+            freeBlock (blocks[i][j]);
+        }
+    }
+}
+
+//==============================================================================
+int AudioBufferPool::getSizeClassFor (const size_t numBytes) noexcept
+{
+    int sizeClass = 0;
+
+    while (sizeClass < numSizeClasses && (((size_t) 1) << (sizeClass + minSizeClassBits)) < numBytes)
+        ++sizeClass;
+
+    return sizeClass;
+}
+
+void* AudioBufferPool::allocateBlock (const size_t numBytes, AudioBufferPool* const owner,
+                                      const int sizeClass, const int slot) noexcept
+{
+    static_jassert (sizeof (BlockHeader) <= blockAlignment);
+
+    void* const allocation = ::malloc (numBytes + 2 * blockAlignment - 1);
+
+    if (allocation == nullptr)
+        return nullptr;
+
+    const pointer_sized_int start = reinterpret_cast <pointer_sized_int> (allocation) + 2 * blockAlignment - 1;
+    char* const block = reinterpret_cast <char*> (start & ~(pointer_sized_int) (blockAlignment - 1));
+
+    BlockHeader* const header = reinterpret_cast <BlockHeader*> (block - blockAlignment);
+    header->allocation = allocation;
+    header->owner = owner;
+    header->sizeClass = sizeClass;
+    header->slot = slot;
+
+    return block;
+}
+
+void AudioBufferPool::freeBlock (void* const block) noexcept
+{
+    if (block != nullptr)
+        ::free (reinterpret_cast <BlockHeader*> (static_cast <char*> (block) - blockAlignment)->allocation);
+}
+
+//==============================================================================
+void AudioBufferPool::reserve (const size_t numBytes, const int numBlocks)
+{
+    const int sizeClass = getSizeClassFor (numBytes);
+
+    // that's too big a block for the pool to hold!
+    jassert (sizeClass < numSizeClasses);
+    // there's a limit to how many blocks of each size the pool can hold
+    jassert (numBlocks <= maxBlocksPerSizeClass);
+
+    if (sizeClass >= numSizeClasses)
+        return;
+
+    // (blocks that are currently in use don't count, as they may not be given back in time)
+    int numFree = 0;
+
+    for (int i = 0; i < maxBlocksPerSizeClass; ++i)
+        if (slotStates[sizeClass][i].get() == slotFree)
+            ++numFree;
+
+    for (int i = 0; i < maxBlocksPerSizeClass && numFree < numBlocks; ++i)
+    {
+        Atomic<int>& state = slotStates[sizeClass][i];
+
+        if (state.compareAndSetBool (slotBusy, slotEmpty))
+        {
+            void* const block = allocateBlock (((size_t) 1) << (sizeClass + minSizeClassBits), this, sizeClass, i);
+
+            if (block == nullptr)
+            {
+                state.compareAndSetBool (slotEmpty, slotBusy);
+                break;
+            }
+
+            blocks[sizeClass][i] = block;
+            state.compareAndSetBool (slotFree, slotBusy);
+            ++numFree;
+        }
+    }
+}
+
+void AudioBufferPool::releaseUnusedBlocks()
+{
+    for (int i = 0; i < numSizeClasses; ++i)
+    {
+        for (int j = 0; j < maxBlocksPerSizeClass; ++j)
+        {
+            Atomic<int>& state = slotStates[i][j];
+
+            // (once a slot's marked as busy, no other thread will touch it)
+            if (state.compareAndSetBool (slotBusy, slotFree))
+            {
+                freeBlock (blocks[i][j]);
+                blocks[i][j] = nullptr;
+                state.compareAndSetBool (slotEmpty, slotBusy);
+            }
+        }
+    }
+}
+
+//==============================================================================
+void* AudioBufferPool::takeFreeBlock (const int sizeClass) noexcept
+{
+    for (int i = 0; i < maxBlocksPerSizeClass; ++i)
+    {
+        Atomic<int>& state = slotStates[sizeClass][i];
+
+        if (state.get() == slotFree && state.compareAndSetBool (slotInUse, slotFree))
+            return blocks[sizeClass][i];
+    }
+
+    return nullptr;
+}
+
+void* AudioBufferPool::allocate (const size_t numBytes) noexcept
+{
+    const int sizeClass = getSizeClassFor (numBytes);
+
+    // If there's nothing free of the right size, a somewhat bigger block is still better than a
+    // trip to the heap, as this may well be happening on the audio thread. (But tiny requests
+    // aren't allowed to tie up big blocks that something else might be waiting for).
+    for (int i = sizeClass; i < jmin (sizeClass + maxSizeClassesToSearch, (int) numSizeClasses); ++i)
+    {
+        void* const block = takeFreeBlock (i);
+
+        if (block != nullptr)
+            return block;
+    }
+
+    ++numHeapAllocations;
+    return allocateBlock (numBytes, nullptr, 0, 0);
+}
+
+void AudioBufferPool::release (void* const block) noexcept
+{
+    if (block != nullptr)
+    {
+        const BlockHeader* const header = reinterpret_cast <const BlockHeader*> (static_cast <char*> (block) - blockAlignment);
+
+        if (header->owner == nullptr)
+        {
+            freeBlock (block);
+        }
+        else if (! header->owner->slotStates [header->sizeClass][header->slot].compareAndSetBool (slotFree, slotInUse))
+        {
+            jassertfalse;   // has this block been released twice?
+        }
+    }
+}
+
+//==============================================================================
+void AudioBufferPool::Block::allocate (AudioBufferPool* const pool, const size_t numBytes, const bool initialiseToZero)
+{
+    free();
+
+    data = static_cast <char*> (pool != nullptr ? pool->allocate (numBytes)
+                                                : allocateBlock (numBytes, nullptr, 0, 0));
+
+    if (initialiseToZero && data != nullptr)
+        zeromem (data, numBytes);
+}
+
+void AudioBufferPool::Block::free() noexcept
+{
+    AudioBufferPool::release (data);
+    data = nullptr;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../../utilities/juce_UnitTest.h"
+#include "juce_AudioSampleBuffer.h"
+
+class AudioBufferPoolTests  : public UnitTest
+{
+public:
+    AudioBufferPoolTests() : UnitTest ("AudioBufferPool") {}
+
+    void runTest()
+    {
+        beginTest ("Reserved blocks");
+
+        {
+            AudioBufferPool pool;
+            pool.reserveForBuffers (2, 512, 3);
+
+            AudioSampleBuffer b1 (1, 1), b2 (1, 1), b3 (1, 1), b4 (1, 1);
+            b1.setBufferPool (&pool);
+            b2.setBufferPool (&pool);
+            b3.setBufferPool (&pool);
+            b4.setBufferPool (&pool);
+
+            b1.setSize (2, 512);
+            b2.setSize (2, 300);
+            b1.setSize (1, 400);
+            b2.setSize (2, 512, true);
+            b3.setSize (2, 512);
+            expectEquals (pool.getNumHeapAllocations(), 0);
+
+            for (int i = 0; i < 2; ++i)
+            {
+                expect ((reinterpret_cast <pointer_sized_int> (b2.getSampleData (i)) & 31) == 0);
+                expect ((reinterpret_cast <pointer_sized_int> (b3.getSampleData (i)) & 31) == 0);
+            }
+
+            // a fourth buffer won't fit..
+            b4.setSize (2, 512);
+            expectEquals (pool.getNumHeapAllocations(), 1);
+
+            // ..until one of the others goes back to using the heap
+            b1.setBufferPool (nullptr);
+            b1.setSize (1, 1);
+            b4.setSize (2, 500);
+            expectEquals (pool.getNumHeapAllocations(), 1);
+
+            b3.setBufferPool (nullptr);
+            b3.setSize (1, 1);
+            pool.releaseUnusedBlocks();
+            b1.setBufferPool (&pool);
+            b1.setSize (2, 256);
+            expectEquals (pool.getNumHeapAllocations(), 2);
+        }
+
+        beginTest ("Reserving while blocks are in use");
+
+        {
+            AudioBufferPool pool;
+            pool.reserve (1024, 1);
+
+            AudioBufferPool::Block block1, block2;
+            block1.allocate (&pool, 1024, false);
+
+            // (the block that's in use mustn't count towards the new reservation)
+            pool.reserve (1024, 1);
+            block2.allocate (&pool, 1024, false);
+            expectEquals (pool.getNumHeapAllocations(), 0);
+        }
+
+        beginTest ("Heap blocks");
+
+        {
+            AudioBufferPool::Block block;
+            block.allocate (nullptr, 1000, true);
+            expect ((reinterpret_cast <pointer_sized_int> (block.getData()) & 31) == 0);
+            expect (block[999] == 0);
+        }
+    }
+};
+
+static AudioBufferPoolTests audioBufferPoolTests;
+
+#endif
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
+#define __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
+
+#include "../../memory/juce_Atomic.h"
+
+
+//==============================================================================
+/**
+    A pool of pre-allocated memory blocks that AudioSampleBuffers can be allocated from
+    without going to the system allocator.
+
+    Blocks are grouped into power-of-two size classes. You reserve some blocks before
+    the audio starts (typically in a prepareToPlay() method), and then any buffer that
+    has been given the pool with AudioSampleBuffer::setBufferPool() will take its memory
+    from these blocks when it gets resized. Taking and returning a block is lock-free, so
+    it's safe to do on the audio thread.
+
+    If a request can't be met from the reserved blocks, the pool falls back to a normal
+    heap allocation, and getNumHeapAllocations() counts how often that's happened.
+
+    The pool must outlive any buffers that are using it.
+
+    @see AudioSampleBuffer
+*/
+class JUCE_API  AudioBufferPool
+{
+public:
+    //==============================================================================
+    /** Creates an empty pool. */
+    AudioBufferPool();
+
+    /** Destructor.
+        All the blocks must have been returned to the pool before it's deleted.
+    */
+    ~AudioBufferPool();
+
+    //==============================================================================
+    /** Makes sure the pool contains at least the given number of free blocks that can
+        each hold numBytes.
+
+        Blocks that are in use when this is called aren't counted, so it'll add more if
+        some of the existing ones are still being used by buffers.
+
+        This allocates memory, so call it before the audio starts rather than on the
+        audio thread.
+    */
+    void reserve (size_t numBytes, int numBlocks);
+
+    /** Makes sure there are enough blocks for the given number of AudioSampleBuffers
+        of this size to be allocated from the pool at the same time.
+    */
+    void reserveForBuffers (int numChannels, int numSamples, int numBuffers);
+
+    /** Frees any reserved blocks that aren't currently in use.
+        This is safe to call while other threads are using the pool.
+    */
+    void releaseUnusedBlocks();
+
+    /** Returns the number of allocations that couldn't be met from the reserved blocks,
+        and which had to use the heap instead.
+    */
+    int getNumHeapAllocations() const noexcept      { return numHeapAllocations.get(); }
+
+    //==============================================================================
+    /** The alignment of all the blocks that are handed out. */
+    enum { blockAlignment = 32 };
+
+    /** Takes a block of at least numBytes from the pool.
+        If no suitable block is free, this will allocate one from the heap.
+    */
+    void* allocate (size_t numBytes) noexcept;
+
+    /** Returns a block to whichever pool it came from.
+        This also works for blocks that were allocated from the heap, and does nothing
+        if the pointer is null.
+    */
+    static void release (void* block) noexcept;
+
+    //==============================================================================
+    /**
+        Holds a block of memory that comes either from an AudioBufferPool or from the heap.
+
+        This behaves like a HeapBlock<char>, but all the memory it allocates is aligned
+        to blockAlignment bytes.
+    */
+    class JUCE_API  Block
+    {
+    public:
+        Block() noexcept : data (nullptr)   {}
+        ~Block()                            { free(); }
+
+        /** Frees any existing data and allocates a new block, taking it from the given
+            pool if it's not null, or from the heap otherwise.
+        */
+        void allocate (AudioBufferPool* pool, size_t numBytes, bool initialiseToZero);
+
+        /** Frees the data, if any. */
+        void free() noexcept;
+
+        /** Swaps the data with another block. */
+        void swapWith (Block& other) noexcept       { std::swap (data, other.data); }
+
+        /** Clears the first numBytes of the data. */
+        void clear (size_t numBytes) noexcept       { zeromem (data, numBytes); }
+
+        inline operator char*() const noexcept      { return data; }
+        inline char* getData() const noexcept       { return data; }
+
+    private:
+        char* data;
+
+        JUCE_DECLARE_NON_COPYABLE (Block);
+    };
+
+private:
+    //==============================================================================
+    enum
+    {
+        minSizeClassBits = 8,
+        numSizeClasses = 24,
+        maxBlocksPerSizeClass = 64,
+        maxSizeClassesToSearch = 4
+    };
+
+    enum SlotState
+    {
+        slotEmpty = 0,
+        slotBusy,
+        slotFree,
+        slotInUse
+    };
+
+    struct BlockHeader;
+
+    Atomic<int> slotStates [numSizeClasses][maxBlocksPerSizeClass];
+    void* volatile blocks [numSizeClasses][maxBlocksPerSizeClass];
+    Atomic<int> numHeapAllocations;
+
+    static int getSizeClassFor (size_t numBytes) noexcept;
+    static void* allocateBlock (size_t numBytes, AudioBufferPool* owner, int sizeClass, int slot) noexcept;
+    static void freeBlock (void* block) noexcept;
+    void* takeFreeBlock (int sizeClass) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE (AudioBufferPool);
+};
+
+
+#endif   // __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
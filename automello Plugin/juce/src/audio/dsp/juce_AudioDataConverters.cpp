@@ -498,6 +498,49 @@ public:
         {
             test (unitTest, false);
             test (unitTest, true);
+            testBlockConversion (unitTest, 1);
+            testBlockConversion (unitTest, 3);
+        }
+
+        // Converting a whole block (which may be done with vector instructions) must give exactly
+        // the same result as converting the samples one at a time.
+        static void testBlockConversion (UnitTest& unitTest, const int numChannels)
+        {
+            typedef AudioData::Pointer<F1, E1, AudioData::Interleaved, AudioData::NonConst> SourceType;
+            typedef AudioData::Pointer<F2, E2, AudioData::Interleaved, AudioData::NonConst> DestType;
+
+            const int numSamples = 255;
+            int32 original [numSamples * 3], blockConverted [numSamples * 3], sampleConverted [numSamples * 3];
+            zeromem (original, sizeof (original));
+            zeromem (blockConverted, sizeof (blockConverted));
+            zeromem (sampleConverted, sizeof (sampleConverted));
+
+            {
+                SourceType d (original, numChannels);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    if ((i & 1) == 0)
+                        d.setAsFloat (Random::getSystemRandom().nextFloat() * 2.2f - 1.1f);
+                    else
+                        d.setAsInt32 (Random::getSystemRandom().nextInt());
+
+                    ++d;
+                }
+            }
+
+            DestType (blockConverted, numChannels).convertSamples (SourceType (original, numChannels), numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                SourceType source (original, numChannels);
+                DestType dest (sampleConverted, numChannels);
+                source += i;
+                dest += i;
+                dest.convertSamples (source, 1);
+            }
+
+            unitTest.expect (memcmp (blockConverted, sampleConverted, sizeof (blockConverted)) == 0);
         }
 
         static void test (UnitTest& unitTest, bool inPlace)
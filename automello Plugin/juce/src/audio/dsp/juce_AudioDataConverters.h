@@ -96,6 +96,107 @@ public:
      class NativeEndian   : public LittleEndian  {};
     #endif
 
+    //==============================================================================
+   #if JUCE_USE_SSE_INTRINSICS
+    enum { hasVectorConversions = 1 };
+
+    /** Shared code for the sample formats' vectorised conversions, which work on four
+        samples at a time, held as either full-scale 32-bit ints or floats.
+    */
+    struct VectorHelpers
+    {
+        static inline __m128i swapBytes16 (__m128i v) noexcept
+        {
+            return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+        }
+
+        static inline __m128i swapBytes32 (__m128i v) noexcept
+        {
+            v = swapBytes16 (v);
+            return _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1)), _MM_SHUFFLE (2, 3, 0, 1));
+        }
+
+        static inline __m128 int32ToFloat (__m128i v) noexcept
+        {
+            return _mm_mul_ps (_mm_cvtepi32_ps (v), _mm_set1_ps (1.0f / 2147483648.0f));
+        }
+
+        // For samples that aren't contiguous, the values are moved one at a time using the
+        // scalar methods, and only the arithmetic is vectorised
+        template <class SampleFormatType, int bigEndian>
+        static inline int32 getInt32 (const char* src) noexcept
+        {
+            SampleFormatType s (const_cast <char*> (src));
+            return bigEndian ? s.getAsInt32BE() : s.getAsInt32LE();
+        }
+
+        template <class SampleFormatType, int bigEndian>
+        static inline void setInt32 (char* dest, __m128i v) noexcept
+        {
+            SampleFormatType s (dest);
+            if (bigEndian)  s.setAsInt32BE (_mm_cvtsi128_si32 (v));
+            else            s.setAsInt32LE (_mm_cvtsi128_si32 (v));
+        }
+
+        template <class SampleFormatType, int bigEndian>
+        static inline __m128i gatherInt32 (const char* src, const int stride) noexcept
+        {
+            return _mm_set_epi32 (getInt32 <SampleFormatType, bigEndian> (src + 3 * stride),
+                                  getInt32 <SampleFormatType, bigEndian> (src + 2 * stride),
+                                  getInt32 <SampleFormatType, bigEndian> (src + stride),
+                                  getInt32 <SampleFormatType, bigEndian> (src));
+        }
+
+        template <class SampleFormatType, int bigEndian>
+        static inline void scatterInt32 (char* dest, const int stride, __m128i values) noexcept
+        {
+            setInt32 <SampleFormatType, bigEndian> (dest, values);
+            setInt32 <SampleFormatType, bigEndian> (dest + stride, _mm_srli_si128 (values, 4));
+            setInt32 <SampleFormatType, bigEndian> (dest + 2 * stride, _mm_srli_si128 (values, 8));
+            setInt32 <SampleFormatType, bigEndian> (dest + 3 * stride, _mm_srli_si128 (values, 12));
+        }
+
+        template <int bigEndian>
+        static inline __m128 gatherFloat (const char* src, const int stride) noexcept
+        {
+            return _mm_castsi128_ps (_mm_set_epi32 (getFloatBits <bigEndian> (src + 3 * stride),
+                                                    getFloatBits <bigEndian> (src + 2 * stride),
+                                                    getFloatBits <bigEndian> (src + stride),
+                                                    getFloatBits <bigEndian> (src)));
+        }
+
+        template <int bigEndian>
+        static inline void scatterFloat (char* dest, const int stride, __m128 values) noexcept
+        {
+            const __m128i v (_mm_castps_si128 (values));
+            setFloatBits <bigEndian> (dest, v);
+            setFloatBits <bigEndian> (dest + stride, _mm_srli_si128 (v, 4));
+            setFloatBits <bigEndian> (dest + 2 * stride, _mm_srli_si128 (v, 8));
+            setFloatBits <bigEndian> (dest + 3 * stride, _mm_srli_si128 (v, 12));
+        }
+
+    private:
+        // (float samples are moved as raw bits, so that the compiler doesn't bounce them through memory)
+        template <int bigEndian>
+        static inline int32 getFloatBits (const char* src) noexcept
+        {
+            const int32 v = *reinterpret_cast <const int32*> (src);
+            return bigEndian ? (int32) ByteOrder::swapIfLittleEndian ((uint32) v)
+                             : (int32) ByteOrder::swapIfBigEndian ((uint32) v);
+        }
+
+        template <int bigEndian>
+        static inline void setFloatBits (char* dest, __m128i v) noexcept
+        {
+            const uint32 n = (uint32) _mm_cvtsi128_si32 (v);
+            *reinterpret_cast <uint32*> (dest) = bigEndian ? ByteOrder::swapIfLittleEndian (n)
+                                                          : ByteOrder::swapIfBigEndian (n);
+        }
+    };
+   #else
+    enum { hasVectorConversions = 0 };
+   #endif
+
     //==============================================================================
     class Int8
     {
@@ -119,7 +220,7 @@ public:
         inline void copyFromSameType (Int8& source) noexcept    { *data = *source.data; }
 
         int8* data;
-        enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0 };
+        enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0, canUseVectors = 0 };
     };
 
     class UInt8
@@ -144,7 +245,7 @@ public:
         inline void copyFromSameType (UInt8& source) noexcept   { *data = *source.data; }
 
         uint8* data;
-        enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0 };
+        enum { bytesPerSample = 1, maxValue = 0x7f, resolution = (1 << 24), isFloat = 0, canUseVectors = 0 };
     };
 
     class Int16
@@ -169,7 +270,35 @@ public:
         inline void copyFromSameType (Int16& source) noexcept   { *data = *source.data; }
 
         uint16* data;
-        enum { bytesPerSample = 2, maxValue = 0x7fff, resolution = (1 << 16), isFloat = 0 };
+        enum { bytesPerSample = 2, maxValue = 0x7fff, resolution = (1 << 16), isFloat = 0, canUseVectors = hasVectorConversions };
+
+       #if JUCE_USE_SSE_INTRINSICS
+        template <int bigEndian>
+        static inline __m128i loadInt32 (const char* src, const int stride) noexcept
+        {
+            if (stride != bytesPerSample)
+                return VectorHelpers::gatherInt32 <Int16, bigEndian> (src, stride);
+
+            __m128i v = _mm_loadl_epi64 (reinterpret_cast <const __m128i*> (src));
+            if (bigEndian) v = VectorHelpers::swapBytes16 (v);
+            return _mm_unpacklo_epi16 (_mm_setzero_si128(), v);
+        }
+
+        template <int bigEndian>
+        static inline __m128 loadFloat (const char* src, const int stride) noexcept    { return VectorHelpers::int32ToFloat (loadInt32 <bigEndian> (src, stride)); }
+
+        template <int bigEndian>
+        static inline void storeInt32 (char* dest, const int stride, __m128i v) noexcept
+        {
+            if (stride != bytesPerSample)
+                return VectorHelpers::scatterInt32 <Int16, bigEndian> (dest, stride, v);
+
+            v = _mm_srai_epi32 (v, 16);
+            v = _mm_packs_epi32 (v, v);
+            if (bigEndian) v = VectorHelpers::swapBytes16 (v);
+            _mm_storel_epi64 (reinterpret_cast <__m128i*> (dest), v);
+        }
+       #endif
     };
 
     class Int24
@@ -194,7 +323,19 @@ public:
         inline void copyFromSameType (Int24& source) noexcept   { data[0] = source.data[0]; data[1] = source.data[1]; data[2] = source.data[2]; }
 
         char* data;
-        enum { bytesPerSample = 3, maxValue = 0x7fffff, resolution = (1 << 8), isFloat = 0 };
+        enum { bytesPerSample = 3, maxValue = 0x7fffff, resolution = (1 << 8), isFloat = 0, canUseVectors = hasVectorConversions };
+
+       #if JUCE_USE_SSE_INTRINSICS
+        // (without SSSE3's byte shuffles, there's no quick way to unpack 24-bit values)
+        template <int bigEndian>
+        static inline __m128i loadInt32 (const char* src, const int stride) noexcept        { return VectorHelpers::gatherInt32 <Int24, bigEndian> (src, stride); }
+
+        template <int bigEndian>
+        static inline __m128 loadFloat (const char* src, const int stride) noexcept         { return VectorHelpers::int32ToFloat (loadInt32 <bigEndian> (src, stride)); }
+
+        template <int bigEndian>
+        static inline void storeInt32 (char* dest, const int stride, __m128i v) noexcept    { VectorHelpers::scatterInt32 <Int24, bigEndian> (dest, stride, v); }
+       #endif
     };
 
     class Int32
@@ -219,7 +360,31 @@ public:
         inline void copyFromSameType (Int32& source) noexcept   { *data = *source.data; }
 
         uint32* data;
-        enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = 1, isFloat = 0 };
+        enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = 1, isFloat = 0, canUseVectors = hasVectorConversions };
+
+       #if JUCE_USE_SSE_INTRINSICS
+        template <int bigEndian>
+        static inline __m128i loadInt32 (const char* src, const int stride) noexcept
+        {
+            if (stride != bytesPerSample)
+                return VectorHelpers::gatherInt32 <Int32, bigEndian> (src, stride);
+
+            const __m128i v = _mm_loadu_si128 (reinterpret_cast <const __m128i*> (src));
+            return bigEndian ? VectorHelpers::swapBytes32 (v) : v;
+        }
+
+        template <int bigEndian>
+        static inline __m128 loadFloat (const char* src, const int stride) noexcept    { return VectorHelpers::int32ToFloat (loadInt32 <bigEndian> (src, stride)); }
+
+        template <int bigEndian>
+        static inline void storeInt32 (char* dest, const int stride, __m128i v) noexcept
+        {
+            if (stride != bytesPerSample)
+                return VectorHelpers::scatterInt32 <Int32, bigEndian> (dest, stride, v);
+
+            _mm_storeu_si128 (reinterpret_cast <__m128i*> (dest), bigEndian ? VectorHelpers::swapBytes32 (v) : v);
+        }
+       #endif
     };
 
     class Float32
@@ -251,7 +416,44 @@ public:
         inline void copyFromSameType (Float32& source) noexcept { *data = *source.data; }
 
         float* data;
-        enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = (1 << 8), isFloat = 1 };
+        enum { bytesPerSample = 4, maxValue = 0x7fffffff, resolution = (1 << 8), isFloat = 1, canUseVectors = hasVectorConversions };
+
+       #if JUCE_USE_SSE_INTRINSICS
+        template <int bigEndian>
+        static inline __m128 loadFloat (const char* src, const int stride) noexcept
+        {
+            if (stride != bytesPerSample)
+                return VectorHelpers::gatherFloat <bigEndian> (src, stride);
+
+            if (bigEndian)
+                return _mm_castsi128_ps (VectorHelpers::swapBytes32 (_mm_loadu_si128 (reinterpret_cast <const __m128i*> (src))));
+
+            return _mm_loadu_ps (reinterpret_cast <const float*> (src));
+        }
+
+        template <int bigEndian>
+        static inline __m128i loadInt32 (const char* src, const int stride) noexcept
+        {
+            // (this has to be done in double precision to match getAsInt32())
+            const __m128 v = loadFloat <bigEndian> (src, stride);
+            const __m128d one (_mm_set1_pd (1.0)), minusOne (_mm_set1_pd (-1.0)), scale (_mm_set1_pd ((double) maxValue));
+            const __m128d lo (_mm_mul_pd (scale, _mm_min_pd (one, _mm_max_pd (minusOne, _mm_cvtps_pd (v)))));
+            const __m128d hi (_mm_mul_pd (scale, _mm_min_pd (one, _mm_max_pd (minusOne, _mm_cvtps_pd (_mm_movehl_ps (v, v))))));
+            return _mm_unpacklo_epi64 (_mm_cvtpd_epi32 (lo), _mm_cvtpd_epi32 (hi));
+        }
+
+        template <int bigEndian>
+        static inline void storeFloat (char* dest, const int stride, __m128 v) noexcept
+        {
+            if (stride != bytesPerSample)
+                return VectorHelpers::scatterFloat <bigEndian> (dest, stride, v);
+
+            if (bigEndian)
+                _mm_storeu_si128 (reinterpret_cast <__m128i*> (dest), VectorHelpers::swapBytes32 (_mm_castps_si128 (v)));
+            else
+                _mm_storeu_ps (reinterpret_cast <float*> (dest), v);
+        }
+       #endif
     };
 
     //==============================================================================
@@ -301,6 +503,76 @@ public:
         static inline void* toVoidPtr (VoidType* v) noexcept { return const_cast<void*> (v); }
         enum { isConst = 1 };
     };
+
+    //==============================================================================
+    // Pointer::convertSamples() uses these to do as much of a conversion as it can four
+    // samples at a time, when both formats provide vectorised load and store methods.
+    // They return the number of samples converted, and leave the remainder to the caller.
+    template <int canUseVectors, int dummy = 0>
+    struct VectorConverter
+    {
+        template <class DestPointerType, class SourcePointerType>
+        static inline int convert (const DestPointerType&, const SourcePointerType&, int) noexcept    { return 0; }
+    };
+
+   #if JUCE_USE_SSE_INTRINSICS
+    template <int destIsFloat, int dummy = 0>
+    struct VectorTransfer
+    {
+        template <class DestFormat, int destBigEndian, class SourceFormat, int sourceBigEndian>
+        static inline void transfer (char* dest, int destStride, const char* source, int sourceStride) noexcept
+        {
+            DestFormat::template storeInt32 <destBigEndian> (dest, destStride, SourceFormat::template loadInt32 <sourceBigEndian> (source, sourceStride));
+        }
+    };
+
+    template <int dummy>
+    struct VectorTransfer <1, dummy>
+    {
+        template <class DestFormat, int destBigEndian, class SourceFormat, int sourceBigEndian>
+        static inline void transfer (char* dest, int destStride, const char* source, int sourceStride) noexcept
+        {
+            DestFormat::template storeFloat <destBigEndian> (dest, destStride, SourceFormat::template loadFloat <sourceBigEndian> (source, sourceStride));
+        }
+    };
+
+    template <int dummy>
+    struct VectorConverter <1, dummy>
+    {
+        template <class DestPointerType, class SourcePointerType>
+        static int convert (const DestPointerType& dest, const SourcePointerType& source, const int numSamples) noexcept
+        {
+            typedef typename DestPointerType::FormatType DestFormat;
+            typedef typename SourcePointerType::FormatType SourceFormat;
+
+            char* d = static_cast <char*> (const_cast <void*> (dest.getRawData()));
+            const char* s = static_cast <const char*> (source.getRawData());
+            const int destStride = dest.getNumBytesBetweenSamples();
+            const int sourceStride = source.getNumBytesBetweenSamples();
+
+            // When the samples aren't contiguous they have to be moved one at a time, which
+            // costs more than the vectorising saves, unless the clipping and rounding of a
+            // conversion to an integer format is involved
+            if (DestFormat::isFloat && (destStride != (int) DestFormat::bytesPerSample
+                                         || sourceStride != (int) SourceFormat::bytesPerSample))
+                return 0;
+
+            const int numBlocks = numSamples / 4;
+
+            for (int i = numBlocks; --i >= 0;)
+            {
+                VectorTransfer <DestFormat::isFloat>::template transfer <DestFormat, DestPointerType::EndiannessType::isBigEndian,
+                                                                         SourceFormat, SourcePointerType::EndiannessType::isBigEndian>
+                    (d, destStride, s, sourceStride);
+
+                d += 4 * destStride;
+                s += 4 * sourceStride;
+            }
+
+            return numBlocks * 4;
+        }
+    };
+   #endif
   #endif
 
     //==============================================================================
@@ -335,6 +607,10 @@ public:
     class Pointer
     {
     public:
+        /** The sample format and endianness that this pointer was declared with. */
+        typedef SampleFormat FormatType;
+        typedef Endianness EndiannessType;
+
         //==============================================================================
         /** Creates a non-interleaved pointer from some raw data in the appropriate format.
             This constructor is only used if you've specified the AudioData::NonInterleaved option -
@@ -445,6 +721,12 @@ public:
 
             if (source.getRawData() != getRawData() || source.getNumBytesBetweenSamples() >= getNumBytesBetweenSamples())
             {
+                const int numDone = VectorConverter <SampleFormat::canUseVectors && OtherPointerType::FormatType::canUseVectors>
+                                        ::convert (dest, source, numSamples);
+                dest += numDone;
+                source += numDone;
+                numSamples -= numDone;
+
                 while (--numSamples >= 0)
                 {
                     Endianness::copyFrom (dest.data, source);
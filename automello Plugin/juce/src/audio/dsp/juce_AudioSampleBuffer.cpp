@@ -28,15 +28,63 @@
 BEGIN_JUCE_NAMESPACE
 
 #include "juce_AudioSampleBuffer.h"
+#include "juce_FloatVectorOperations.h"
 #include "../audio_file_formats/juce_AudioFormatReader.h"
 #include "../audio_file_formats/juce_AudioFormatWriter.h"
 
 
+//==============================================================================
+namespace AudioSampleBufferHelpers
+{
+    // Each channel is padded and aligned to a 32-byte boundary, which suits both the
+    // SSE and AVX code in FloatVectorOperations.
+    enum { channelAlignment = 32, samplesPerAlignedBlock = channelAlignment / sizeof (float) };
+
+    inline int getPaddedNumSamples (const int numSamples) noexcept
+    {
+        return (numSamples + samplesPerAlignedBlock - 1) & ~(samplesPerAlignedBlock - 1);
+    }
+
+    inline size_t getNumBytesNeeded (const int numChannels, const int numSamples) noexcept
+    {
+        return (numChannels + 1) * sizeof (float*)
+                + numChannels * getPaddedNumSamples (numSamples) * sizeof (float)
+                + channelAlignment;
+    }
+
+    // Lays out a block of getNumBytesNeeded() bytes as a null-terminated channel list
+    // followed by the channels themselves.
+    float** setChannelPointers (char* const data, const int numChannels, const int numSamples) noexcept
+    {
+        float** const channels = reinterpret_cast <float**> (data);
+        const pointer_sized_int channelListEnd = reinterpret_cast <pointer_sized_int> (data + (numChannels + 1) * sizeof (float*));
+        float* chan = reinterpret_cast <float*> ((channelListEnd + channelAlignment - 1) & ~(pointer_sized_int) (channelAlignment - 1));
+        const int paddedNumSamples = getPaddedNumSamples (numSamples);
+
+        for (int i = 0; i < numChannels; ++i)
+        {
+            channels[i] = chan;
+            chan += paddedNumSamples;
+        }
+
+        channels [numChannels] = 0;
+        return channels;
+    }
+}
+
+// (this lives here rather than with the rest of the pool, as it needs to know how the
+// buffers lay out their data)
+void AudioBufferPool::reserveForBuffers (const int numChannels, const int numSamples, const int numBuffers)
+{
+    reserve (AudioSampleBufferHelpers::getNumBytesNeeded (numChannels, numSamples), numBuffers);
+}
+
 //==============================================================================
 AudioSampleBuffer::AudioSampleBuffer (const int numChannels_,
                                       const int numSamples) noexcept
   : numChannels (numChannels_),
-    size (numSamples)
+    size (numSamples),
+    pool (nullptr)
 {
     jassert (numSamples >= 0);
     jassert (numChannels_ > 0);
@@ -46,7 +94,8 @@ AudioSampleBuffer::AudioSampleBuffer (const int numChannels_,
 
 AudioSampleBuffer::AudioSampleBuffer (const AudioSampleBuffer& other) noexcept
   : numChannels (other.numChannels),
-    size (other.size)
+    size (other.size),
+    pool (nullptr)
 {
     allocateData();
     const size_t numBytes = size * sizeof (float);
@@ -57,19 +106,9 @@ AudioSampleBuffer::AudioSampleBuffer (const AudioSampleBuffer& other) noexcept
 
 void AudioSampleBuffer::allocateData()
 {
-    const size_t channelListSize = (numChannels + 1) * sizeof (float*);
-    allocatedBytes = (int) (numChannels * size * sizeof (float) + channelListSize + 32);
-    allocatedData.malloc (allocatedBytes);
-    channels = reinterpret_cast <float**> (allocatedData.getData());
-
-    float* chan = (float*) (allocatedData + channelListSize);
-    for (int i = 0; i < numChannels; ++i)
-    {
-        channels[i] = chan;
-        chan += size;
-    }
-
-    channels [numChannels] = 0;
+    allocatedBytes = AudioSampleBufferHelpers::getNumBytesNeeded (numChannels, size);
+    allocatedData.allocate (pool, allocatedBytes, false);
+    channels = AudioSampleBufferHelpers::setChannelPointers (allocatedData, numChannels, size);
 }
 
 AudioSampleBuffer::AudioSampleBuffer (float** dataToReferTo,
@@ -77,7 +116,8 @@ AudioSampleBuffer::AudioSampleBuffer (float** dataToReferTo,
                                       const int numSamples) noexcept
     : numChannels (numChannels_),
       size (numSamples),
-      allocatedBytes (0)
+      allocatedBytes (0),
+      pool (nullptr)
 {
     jassert (numChannels_ > 0);
     allocateChannels (dataToReferTo, 0);
@@ -89,7 +129,8 @@ AudioSampleBuffer::AudioSampleBuffer (float** dataToReferTo,
                                       const int numSamples) noexcept
     : numChannels (numChannels_),
       size (numSamples),
-      allocatedBytes (0)
+      allocatedBytes (0),
+      pool (nullptr)
 {
     jassert (numChannels_ > 0);
     allocateChannels (dataToReferTo, startSample);
@@ -119,7 +160,7 @@ void AudioSampleBuffer::allocateChannels (float** const dataToReferTo, int offse
     }
     else
     {
-        allocatedData.malloc (numChannels + 1, sizeof (float*));
+        allocatedData.allocate (pool, (numChannels + 1) * sizeof (float*), false);
         channels = reinterpret_cast <float**> (allocatedData.getData());
     }
 
@@ -163,28 +204,23 @@ void AudioSampleBuffer::setSize (const int newNumChannels,
 
     if (newNumSamples != size || newNumChannels != numChannels)
     {
-        const size_t channelListSize = (newNumChannels + 1) * sizeof (float*);
-        const size_t newTotalBytes = (newNumChannels * newNumSamples * sizeof (float)) + channelListSize + 32;
+        const size_t newTotalBytes = AudioSampleBufferHelpers::getNumBytesNeeded (newNumChannels, newNumSamples);
 
         if (keepExistingContent)
         {
-            HeapBlock <char> newData;
-            newData.allocate (newTotalBytes, clearExtraSpace);
+            AudioBufferPool::Block newData;
+            newData.allocate (pool, newTotalBytes, clearExtraSpace);
 
             const int numChansToCopy = jmin (numChannels, newNumChannels);
             const size_t numBytesToCopy = sizeof (float) * jmin (newNumSamples, size);
 
-            float** const newChannels = reinterpret_cast <float**> (newData.getData());
-            float* newChan = reinterpret_cast <float*> (newData + channelListSize);
+            float** const newChannels = AudioSampleBufferHelpers::setChannelPointers (newData, newNumChannels, newNumSamples);
+
             for (int i = 0; i < numChansToCopy; ++i)
-            {
-                memcpy (newChan, channels[i], numBytesToCopy);
-                newChannels[i] = newChan;
-                newChan += newNumSamples;
-            }
+                memcpy (newChannels[i], channels[i], numBytesToCopy);
 
             allocatedData.swapWith (newData);
-            allocatedBytes = (int) newTotalBytes;
+            allocatedBytes = newTotalBytes;
             channels = newChannels;
         }
         else
@@ -197,19 +233,12 @@ void AudioSampleBuffer::setSize (const int newNumChannels,
             else
             {
                 allocatedBytes = newTotalBytes;
-                allocatedData.allocate (newTotalBytes, clearExtraSpace);
-                channels = reinterpret_cast <float**> (allocatedData.getData());
+                allocatedData.allocate (pool, newTotalBytes, clearExtraSpace);
             }
 
-            float* chan = reinterpret_cast <float*> (allocatedData + channelListSize);
-            for (int i = 0; i < newNumChannels; ++i)
-            {
-                channels[i] = chan;
-                chan += newNumSamples;
-            }
+            channels = AudioSampleBufferHelpers::setChannelPointers (allocatedData, newNumChannels, newNumSamples);
         }
 
-        channels [newNumChannels] = 0;
         size = newNumSamples;
         numChannels = newNumChannels;
     }
@@ -253,14 +282,9 @@ void AudioSampleBuffer::applyGain (const int channel,
         float* d = channels [channel] + startSample;
 
         if (gain == 0.0f)
-        {
-            zeromem (d, sizeof (float) * numSamples);
-        }
+            FloatVectorOperations::clear (d, numSamples);
         else
-        {
-            while (--numSamples >= 0)
-                *d++ *= gain;
-        }
+            FloatVectorOperations::multiply (d, gain, numSamples);
     }
 }
 
@@ -279,14 +303,8 @@ void AudioSampleBuffer::applyGainRamp (const int channel,
         jassert (isPositiveAndBelow (channel, numChannels));
         jassert (startSample >= 0 && startSample + numSamples <= size);
 
-        const float increment = (endGain - startGain) / numSamples;
-        float* d = channels [channel] + startSample;
-
-        while (--numSamples >= 0)
-        {
-            *d++ *= startGain;
-            startGain += increment;
-        }
+        FloatVectorOperations::multiplyWithRamp (channels [channel] + startSample, startGain,
+                                                 (endGain - startGain) / numSamples, numSamples);
     }
 }
 
@@ -318,15 +336,9 @@ void AudioSampleBuffer::addFrom (const int destChannel,
         const float* s  = source.channels [sourceChannel] + sourceStartSample;
 
         if (gain != 1.0f)
-        {
-            while (--numSamples >= 0)
-                *d++ += gain * *s++;
-        }
+            FloatVectorOperations::addWithMultiply (d, s, gain, numSamples);
         else
-        {
-            while (--numSamples >= 0)
-                *d++ += *s++;
-        }
+            FloatVectorOperations::add (d, s, numSamples);
     }
 }
 
@@ -345,15 +357,9 @@ void AudioSampleBuffer::addFrom (const int destChannel,
         float* d = channels [destChannel] + destStartSample;
 
         if (gain != 1.0f)
-        {
-            while (--numSamples >= 0)
-                *d++ += gain * *source++;
-        }
+            FloatVectorOperations::addWithMultiply (d, source, gain, numSamples);
         else
-        {
-            while (--numSamples >= 0)
-                *d++ += *source++;
-        }
+            FloatVectorOperations::add (d, source, numSamples);
     }
 }
 
@@ -380,14 +386,8 @@ void AudioSampleBuffer::addFromWithRamp (const int destChannel,
     {
         if (numSamples > 0 && (startGain != 0.0f || endGain != 0.0f))
         {
-            const float increment = (endGain - startGain) / numSamples;
-            float* d = channels [destChannel] + destStartSample;
-
-            while (--numSamples >= 0)
-            {
-                *d++ += startGain * *source++;
-                startGain += increment;
-            }
+            FloatVectorOperations::addWithRamp (channels [destChannel] + destStartSample, source, startGain,
+                                                (endGain - startGain) / numSamples, numSamples);
         }
     }
 }
@@ -447,14 +447,9 @@ void AudioSampleBuffer::copyFrom (const int destChannel,
         if (gain != 1.0f)
         {
             if (gain == 0)
-            {
-                zeromem (d, sizeof (float) * numSamples);
-            }
+                FloatVectorOperations::clear (d, numSamples);
             else
-            {
-                while (--numSamples >= 0)
-                    *d++ = gain * *source++;
-            }
+                FloatVectorOperations::copyWithMultiply (d, source, gain, numSamples);
         }
         else
         {
@@ -486,14 +481,8 @@ void AudioSampleBuffer::copyFromWithRamp (const int destChannel,
     {
         if (numSamples > 0 && (startGain != 0.0f || endGain != 0.0f))
         {
-            const float increment = (endGain - startGain) / numSamples;
-            float* d = channels [destChannel] + destStartSample;
-
-            while (--numSamples >= 0)
-            {
-                *d++ = startGain * *source++;
-                startGain += increment;
-            }
+            FloatVectorOperations::copyWithRamp (channels [destChannel] + destStartSample, source, startGain,
+                                                 (endGain - startGain) / numSamples, numSamples);
         }
     }
 }
@@ -507,7 +496,7 @@ void AudioSampleBuffer::findMinMax (const int channel,
     jassert (isPositiveAndBelow (channel, numChannels));
     jassert (startSample >= 0 && startSample + numSamples <= size);
 
-    findMinAndMax (channels [channel] + startSample, numSamples, minVal, maxVal);
+    FloatVectorOperations::findMinAndMax (channels [channel] + startSample, numSamples, minVal, maxVal);
 }
 
 float AudioSampleBuffer::getMagnitude (const int channel,
@@ -544,16 +533,7 @@ float AudioSampleBuffer::getRMSLevel (const int channel,
     if (numSamples <= 0 || channel < 0 || channel >= numChannels)
         return 0.0f;
 
-    const float* const data = channels [channel] + startSample;
-    double sum = 0.0;
-
-    for (int i = 0; i < numSamples; ++i)
-    {
-        const float sample = data [i];
-        sum += sample * sample;
-    }
-
-    return (float) std::sqrt (sum / numSamples);
+    return (float) std::sqrt (FloatVectorOperations::sumOfSquares (channels [channel] + startSample, numSamples) / numSamples);
 }
 
 void AudioSampleBuffer::readFromAudioReader (AudioFormatReader* reader,
@@ -568,44 +548,28 @@ void AudioSampleBuffer::readFromAudioReader (AudioFormatReader* reader,
 
     if (numSamples > 0)
     {
-        int* chans[3];
+        float* chans[3];
 
         if (useLeftChan == useRightChan)
         {
-            chans[0] = reinterpret_cast<int*> (getSampleData (0, startSample));
-            chans[1] = (reader->numChannels > 1 && getNumChannels() > 1) ? reinterpret_cast<int*> (getSampleData (1, startSample)) : 0;
+            chans[0] = getSampleData (0, startSample);
+            chans[1] = (reader->numChannels > 1 && getNumChannels() > 1) ? getSampleData (1, startSample) : nullptr;
         }
         else if (useLeftChan || (reader->numChannels == 1))
         {
-            chans[0] = reinterpret_cast<int*> (getSampleData (0, startSample));
+            chans[0] = getSampleData (0, startSample);
             chans[1] = nullptr;
         }
         else if (useRightChan)
         {
             chans[0] = nullptr;
-            chans[1] = reinterpret_cast<int*> (getSampleData (0, startSample));
+            chans[1] = getSampleData (0, startSample);
         }
 
         chans[2] = nullptr;
 
         reader->read (chans, 2, readerStartSample, numSamples, true);
 
-        if (! reader->usesFloatingPointData)
-        {
-            for (int j = 0; j < 2; ++j)
-            {
-                float* const d = reinterpret_cast <float*> (chans[j]);
-
-                if (d != nullptr)
-                {
-                    const float multiplier = 1.0f / 0x7fffffff;
-
-                    for (int i = 0; i < numSamples; ++i)
-                        d[i] = *reinterpret_cast<int*> (d + i) * multiplier;
-                }
-            }
-        }
-
         if (numChannels > 1 && (chans[0] == nullptr || chans[1] == nullptr))
         {
             // if this is a stereo buffer and the source was mono, dupe the first channel..
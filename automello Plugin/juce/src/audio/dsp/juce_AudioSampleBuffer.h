@@ -27,6 +27,7 @@
 #define __JUCE_AUDIOSAMPLEBUFFER_JUCEHEADER__
 
 #include "../../memory/juce_HeapBlock.h"
+#include "juce_AudioBufferPool.h"
 class AudioFormatReader;
 class AudioFormatWriter;
 
@@ -202,6 +203,16 @@ public:
                            int numChannels,
                            int numSamples) noexcept;
 
+    /** Makes the buffer take any memory that it allocates from now on from a pool.
+
+        This doesn't move the buffer's current data - that'll only happen when it's next
+        resized. Passing nullptr makes it go back to using the heap. The pool must stay
+        alive for as long as the buffer uses any of its blocks.
+
+        @see AudioBufferPool
+    */
+    void setBufferPool (AudioBufferPool* poolToUse) noexcept    { pool = poolToUse; }
+
     //==============================================================================
     /** Clears all the samples in all channels. */
     void clear() noexcept;
@@ -446,7 +457,8 @@ private:
     int numChannels, size;
     size_t allocatedBytes;
     float** channels;
-    HeapBlock <char> allocatedData;
+    AudioBufferPool::Block allocatedData;
+    AudioBufferPool* pool;
     float* preallocatedChannelSpace [32];
 
     void allocateData();
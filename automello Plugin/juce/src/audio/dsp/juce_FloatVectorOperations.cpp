@@ -0,0 +1,750 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_FloatVectorOperations.h"
+
+// AVX code can be compiled into an SSE2 build with GCC and Clang, and chosen at runtime
+#if JUCE_USE_SSE_INTRINSICS && ! JUCE_USE_AVX_INTRINSICS && JUCE_INTEL \
+     && (defined (__clang__) || (JUCE_GCC && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+ #define JUCE_FLOATVECTOROPS_RUNTIME_AVX 1
+ #include <immintrin.h>
+ #define JUCE_AVX_FUNCTION  __attribute__ ((target ("avx")))
+#elif JUCE_USE_AVX_INTRINSICS
+ #define JUCE_AVX_FUNCTION
+#endif
+
+
+//==============================================================================
+namespace FloatVectorHelpers
+{
+    inline void findMinAndMaxOfValues (const float* src, int num, float& minResult, float& maxResult) noexcept
+    {
+        findMinAndMax (src, num, minResult, maxResult);
+    }
+
+    struct ScalarOps
+    {
+        static void copyWithMultiply (float* dest, const float* src, const float multiplier, int num) noexcept
+        {
+            while (--num >= 0)
+                *dest++ = multiplier * *src++;
+        }
+
+        static void copyWithRamp (float* dest, const float* src, float gain, const float increment, int num) noexcept
+        {
+            while (--num >= 0)
+            {
+                *dest++ = gain * *src++;
+                gain += increment;
+            }
+        }
+
+        static void add (float* dest, const float* src, int num) noexcept
+        {
+            while (--num >= 0)
+                *dest++ += *src++;
+        }
+
+        static void addWithMultiply (float* dest, const float* src, const float multiplier, int num) noexcept
+        {
+            while (--num >= 0)
+                *dest++ += multiplier * *src++;
+        }
+
+        static void addWithRamp (float* dest, const float* src, float gain, const float increment, int num) noexcept
+        {
+            while (--num >= 0)
+            {
+                *dest++ += gain * *src++;
+                gain += increment;
+            }
+        }
+
+        static void multiply (float* dest, const float multiplier, int num) noexcept
+        {
+            while (--num >= 0)
+                *dest++ *= multiplier;
+        }
+
+        static void multiplyWithRamp (float* dest, float gain, const float increment, int num) noexcept
+        {
+            while (--num >= 0)
+            {
+                *dest++ *= gain;
+                gain += increment;
+            }
+        }
+
+        static void findMinAndMax (const float* src, int num, float& minResult, float& maxResult) noexcept
+        {
+            findMinAndMaxOfValues (src, num, minResult, maxResult);
+        }
+
+        static double sumOfSquares (const float* src, int num) noexcept
+        {
+            double sum = 0.0;
+
+            while (--num >= 0)
+            {
+                const float sample = *src++;
+                sum += sample * sample;
+            }
+
+            return sum;
+        }
+    };
+
+    //==============================================================================
+    // The vectorised versions process as many whole vectors as they can, and leave any
+    // remaining values to the scalar code. The ramps restart from an exact gain for the
+    // leftovers, rather than carrying on accumulating the increment.
+   #if JUCE_USE_SSE_INTRINSICS
+    struct SSEOps
+    {
+        static inline __m128 rampStart (const float gain, const float increment) noexcept
+        {
+            return _mm_add_ps (_mm_set1_ps (gain), _mm_mul_ps (_mm_set1_ps (increment), _mm_setr_ps (0.0f, 1.0f, 2.0f, 3.0f)));
+        }
+
+        static void copyWithMultiply (float* dest, const float* src, const float multiplier, const int num) noexcept
+        {
+            const __m128 m (_mm_set1_ps (multiplier));
+
+            for (int i = num >> 2; --i >= 0;)
+            {
+                _mm_storeu_ps (dest, _mm_mul_ps (m, _mm_loadu_ps (src)));
+                dest += 4;
+                src += 4;
+            }
+
+            ScalarOps::copyWithMultiply (dest, src, multiplier, num & 3);
+        }
+
+        static void copyWithRamp (float* dest, const float* src, const float gain, const float increment, const int num) noexcept
+        {
+            __m128 g (rampStart (gain, increment));
+            const __m128 step (_mm_set1_ps (increment * 4.0f));
+
+            for (int i = num >> 2; --i >= 0;)
+            {
+                _mm_storeu_ps (dest, _mm_mul_ps (g, _mm_loadu_ps (src)));
+                g = _mm_add_ps (g, step);
+                dest += 4;
+                src += 4;
+            }
+
+            ScalarOps::copyWithRamp (dest, src, gain + increment * (num & ~3), increment, num & 3);
+        }
+
+        static void add (float* dest, const float* src, const int num) noexcept
+        {
+            for (int i = num >> 2; --i >= 0;)
+            {
+                _mm_storeu_ps (dest, _mm_add_ps (_mm_loadu_ps (dest), _mm_loadu_ps (src)));
+                dest += 4;
+                src += 4;
+            }
+
+            ScalarOps::add (dest, src, num & 3);
+        }
+
+        static void addWithMultiply (float* dest, const float* src, const float multiplier, const int num) noexcept
+        {
+            const __m128 m (_mm_set1_ps (multiplier));
+
+            for (int i = num >> 2; --i >= 0;)
+            {
+                _mm_storeu_ps (dest, _mm_add_ps (_mm_loadu_ps (dest), _mm_mul_ps (m, _mm_loadu_ps (src))));
+                dest += 4;
+                src += 4;
+            }
+
+            ScalarOps::addWithMultiply (dest, src, multiplier, num & 3);
+        }
+
+        static void addWithRamp (float* dest, const float* src, const float gain, const float increment, const int num) noexcept
+        {
+            __m128 g (rampStart (gain, increment));
+            const __m128 step (_mm_set1_ps (increment * 4.0f));
+
+            for (int i = num >> 2; --i >= 0;)
+            {
+                _mm_storeu_ps (dest, _mm_add_ps (_mm_loadu_ps (dest), _mm_mul_ps (g, _mm_loadu_ps (src))));
+                g = _mm_add_ps (g, step);
+                dest += 4;
+                src += 4;
+            }
+
+            ScalarOps::addWithRamp (dest, src, gain + increment * (num & ~3), increment, num & 3);
+        }
+
+        static void multiply (float* dest, const float multiplier, const int num) noexcept
+        {
+            const __m128 m (_mm_set1_ps (multiplier));
+
+            for (int i = num >> 2; --i >= 0;)
+            {
+                _mm_storeu_ps (dest, _mm_mul_ps (m, _mm_loadu_ps (dest)));
+                dest += 4;
+            }
+
+            ScalarOps::multiply (dest, multiplier, num & 3);
+        }
+
+        static void multiplyWithRamp (float* dest, const float gain, const float increment, const int num) noexcept
+        {
+            __m128 g (rampStart (gain, increment));
+            const __m128 step (_mm_set1_ps (increment * 4.0f));
+
+            for (int i = num >> 2; --i >= 0;)
+            {
+                _mm_storeu_ps (dest, _mm_mul_ps (g, _mm_loadu_ps (dest)));
+                g = _mm_add_ps (g, step);
+                dest += 4;
+            }
+
+            ScalarOps::multiplyWithRamp (dest, gain + increment * (num & ~3), increment, num & 3);
+        }
+
+        static void findMinAndMax (const float* src, const int num, float& minResult, float& maxResult) noexcept
+        {
+            if (num < 8)
+            {
+                ScalarOps::findMinAndMax (src, num, minResult, maxResult);
+                return;
+            }
+
+            __m128 mn (_mm_loadu_ps (src));
+            __m128 mx (mn);
+
+            for (int i = (num >> 2) - 1; --i >= 0;)
+            {
+                src += 4;
+                const __m128 v (_mm_loadu_ps (src));
+                mn = _mm_min_ps (mn, v);
+                mx = _mm_max_ps (mx, v);
+            }
+
+            float mins[4], maxs[4];
+            _mm_storeu_ps (mins, mn);
+            _mm_storeu_ps (maxs, mx);
+
+            src += 4;
+            for (int i = num & 3; --i >= 0;)
+            {
+                mins[i] = jmin (mins[i], src[i]);
+                maxs[i] = jmax (maxs[i], src[i]);
+            }
+
+            minResult = jmin (mins[0], mins[1], mins[2], mins[3]);
+            maxResult = jmax (maxs[0], maxs[1], maxs[2], maxs[3]);
+        }
+
+        static double sumOfSquares (const float* src, const int num) noexcept
+        {
+            __m128d sum1 (_mm_setzero_pd()), sum2 (_mm_setzero_pd());
+
+            for (int i = num >> 2; --i >= 0;)
+            {
+                const __m128 v (_mm_loadu_ps (src));
+                const __m128d lo (_mm_cvtps_pd (v));
+                const __m128d hi (_mm_cvtps_pd (_mm_movehl_ps (v, v)));
+                sum1 = _mm_add_pd (sum1, _mm_mul_pd (lo, lo));
+                sum2 = _mm_add_pd (sum2, _mm_mul_pd (hi, hi));
+                src += 4;
+            }
+
+            double sums[2];
+            _mm_storeu_pd (sums, _mm_add_pd (sum1, sum2));
+            return sums[0] + sums[1] + ScalarOps::sumOfSquares (src, num & 3);
+        }
+    };
+   #endif
+
+   #ifdef JUCE_AVX_FUNCTION
+    struct AVXOps
+    {
+        static inline JUCE_AVX_FUNCTION __m256 rampStart (const float gain, const float increment) noexcept
+        {
+            return _mm256_add_ps (_mm256_set1_ps (gain),
+                                  _mm256_mul_ps (_mm256_set1_ps (increment), _mm256_setr_ps (0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)));
+        }
+
+        static JUCE_AVX_FUNCTION void copyWithMultiply (float* dest, const float* src, const float multiplier, const int num) noexcept
+        {
+            const __m256 m (_mm256_set1_ps (multiplier));
+
+            for (int i = num >> 3; --i >= 0;)
+            {
+                _mm256_storeu_ps (dest, _mm256_mul_ps (m, _mm256_loadu_ps (src)));
+                dest += 8;
+                src += 8;
+            }
+
+            ScalarOps::copyWithMultiply (dest, src, multiplier, num & 7);
+        }
+
+        static JUCE_AVX_FUNCTION void copyWithRamp (float* dest, const float* src, const float gain, const float increment, const int num) noexcept
+        {
+            __m256 g (rampStart (gain, increment));
+            const __m256 step (_mm256_set1_ps (increment * 8.0f));
+
+            for (int i = num >> 3; --i >= 0;)
+            {
+                _mm256_storeu_ps (dest, _mm256_mul_ps (g, _mm256_loadu_ps (src)));
+                g = _mm256_add_ps (g, step);
+                dest += 8;
+                src += 8;
+            }
+
+            ScalarOps::copyWithRamp (dest, src, gain + increment * (num & ~7), increment, num & 7);
+        }
+
+        static JUCE_AVX_FUNCTION void add (float* dest, const float* src, const int num) noexcept
+        {
+            for (int i = num >> 3; --i >= 0;)
+            {
+                _mm256_storeu_ps (dest, _mm256_add_ps (_mm256_loadu_ps (dest), _mm256_loadu_ps (src)));
+                dest += 8;
+                src += 8;
+            }
+
+            ScalarOps::add (dest, src, num & 7);
+        }
+
+        static JUCE_AVX_FUNCTION void addWithMultiply (float* dest, const float* src, const float multiplier, const int num) noexcept
+        {
+            const __m256 m (_mm256_set1_ps (multiplier));
+
+            for (int i = num >> 3; --i >= 0;)
+            {
+                _mm256_storeu_ps (dest, _mm256_add_ps (_mm256_loadu_ps (dest), _mm256_mul_ps (m, _mm256_loadu_ps (src))));
+                dest += 8;
+                src += 8;
+            }
+
+            ScalarOps::addWithMultiply (dest, src, multiplier, num & 7);
+        }
+
+        static JUCE_AVX_FUNCTION void addWithRamp (float* dest, const float* src, const float gain, const float increment, const int num) noexcept
+        {
+            __m256 g (rampStart (gain, increment));
+            const __m256 step (_mm256_set1_ps (increment * 8.0f));
+
+            for (int i = num >> 3; --i >= 0;)
+            {
+                _mm256_storeu_ps (dest, _mm256_add_ps (_mm256_loadu_ps (dest), _mm256_mul_ps (g, _mm256_loadu_ps (src))));
+                g = _mm256_add_ps (g, step);
+                dest += 8;
+                src += 8;
+            }
+
+            ScalarOps::addWithRamp (dest, src, gain + increment * (num & ~7), increment, num & 7);
+        }
+
+        static JUCE_AVX_FUNCTION void multiply (float* dest, const float multiplier, const int num) noexcept
+        {
+            const __m256 m (_mm256_set1_ps (multiplier));
+
+            for (int i = num >> 3; --i >= 0;)
+            {
+                _mm256_storeu_ps (dest, _mm256_mul_ps (m, _mm256_loadu_ps (dest)));
+                dest += 8;
+            }
+
+            ScalarOps::multiply (dest, multiplier, num & 7);
+        }
+
+        static JUCE_AVX_FUNCTION void multiplyWithRamp (float* dest, const float gain, const float increment, const int num) noexcept
+        {
+            __m256 g (rampStart (gain, increment));
+            const __m256 step (_mm256_set1_ps (increment * 8.0f));
+
+            for (int i = num >> 3; --i >= 0;)
+            {
+                _mm256_storeu_ps (dest, _mm256_mul_ps (g, _mm256_loadu_ps (dest)));
+                g = _mm256_add_ps (g, step);
+                dest += 8;
+            }
+
+            ScalarOps::multiplyWithRamp (dest, gain + increment * (num & ~7), increment, num & 7);
+        }
+
+        static JUCE_AVX_FUNCTION void findMinAndMax (const float* src, const int num, float& minResult, float& maxResult) noexcept
+        {
+            if (num < 16)
+            {
+                ScalarOps::findMinAndMax (src, num, minResult, maxResult);
+                return;
+            }
+
+            __m256 mn (_mm256_loadu_ps (src));
+            __m256 mx (mn);
+
+            for (int i = (num >> 3) - 1; --i >= 0;)
+            {
+                src += 8;
+                const __m256 v (_mm256_loadu_ps (src));
+                mn = _mm256_min_ps (mn, v);
+                mx = _mm256_max_ps (mx, v);
+            }
+
+            float mins[8], maxs[8];
+            _mm256_storeu_ps (mins, mn);
+            _mm256_storeu_ps (maxs, mx);
+
+            src += 8;
+            for (int i = num & 7; --i >= 0;)
+            {
+                mins[i] = jmin (mins[i], src[i]);
+                maxs[i] = jmax (maxs[i], src[i]);
+            }
+
+            minResult = mins[0];
+            maxResult = maxs[0];
+
+            for (int i = 1; i < 8; ++i)
+            {
+                minResult = jmin (minResult, mins[i]);
+                maxResult = jmax (maxResult, maxs[i]);
+            }
+        }
+
+        static JUCE_AVX_FUNCTION double sumOfSquares (const float* src, const int num) noexcept
+        {
+            __m256d sum1 (_mm256_setzero_pd()), sum2 (_mm256_setzero_pd());
+
+            for (int i = num >> 3; --i >= 0;)
+            {
+                const __m256d lo (_mm256_cvtps_pd (_mm_loadu_ps (src)));
+                const __m256d hi (_mm256_cvtps_pd (_mm_loadu_ps (src + 4)));
+                sum1 = _mm256_add_pd (sum1, _mm256_mul_pd (lo, lo));
+                sum2 = _mm256_add_pd (sum2, _mm256_mul_pd (hi, hi));
+                src += 8;
+            }
+
+            double sums[4];
+            _mm256_storeu_pd (sums, _mm256_add_pd (sum1, sum2));
+            return sums[0] + sums[1] + sums[2] + sums[3] + ScalarOps::sumOfSquares (src, num & 7);
+        }
+    };
+   #endif
+
+    //==============================================================================
+    struct Implementation
+    {
+        FloatVectorOperations::InstructionSet instructionSet;
+        void (*copyWithMultiply) (float*, const float*, float, int);
+        void (*copyWithRamp) (float*, const float*, float, float, int);
+        void (*add) (float*, const float*, int);
+        void (*addWithMultiply) (float*, const float*, float, int);
+        void (*addWithRamp) (float*, const float*, float, float, int);
+        void (*multiply) (float*, float, int);
+        void (*multiplyWithRamp) (float*, float, float, int);
+        void (*findMinAndMax) (const float*, int, float&, float&);
+        double (*sumOfSquares) (const float*, int);
+    };
+
+    template <class Ops, FloatVectorOperations::InstructionSet instructionSet>
+    const Implementation* getImplementation() noexcept
+    {
+        static const Implementation implementation =
+        {
+            instructionSet, &Ops::copyWithMultiply, &Ops::copyWithRamp, &Ops::add, &Ops::addWithMultiply,
+            &Ops::addWithRamp, &Ops::multiply, &Ops::multiplyWithRamp, &Ops::findMinAndMax, &Ops::sumOfSquares
+        };
+
+        return &implementation;
+    }
+
+    const Implementation* getImplementation (const FloatVectorOperations::InstructionSet instructionSet) noexcept
+    {
+        switch (instructionSet)
+        {
+           #ifdef JUCE_AVX_FUNCTION
+            case FloatVectorOperations::avx:    return getImplementation <AVXOps, FloatVectorOperations::avx>();
+           #endif
+           #if JUCE_USE_SSE_INTRINSICS
+            case FloatVectorOperations::sse2:   return getImplementation <SSEOps, FloatVectorOperations::sse2>();
+           #endif
+            case FloatVectorOperations::scalar: return getImplementation <ScalarOps, FloatVectorOperations::scalar>();
+            default:                            break;
+        }
+
+        return nullptr;
+    }
+
+    // (this is picked the first time it's needed - a race here is harmless, as any
+    // threads involved would all make the same choice)
+    const Implementation* currentImplementation = nullptr;
+
+    inline const Implementation& getCurrentImplementation() noexcept
+    {
+        if (currentImplementation == nullptr)
+            currentImplementation = getImplementation (FloatVectorOperations::getBestAvailableInstructionSet());
+
+        return *currentImplementation;
+    }
+}
+
+//==============================================================================
+void JUCE_CALLTYPE FloatVectorOperations::clear (float* dest, int numValues) noexcept
+{
+    zeromem (dest, numValues * sizeof (float));
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::copy (float* dest, const float* src, int numValues) noexcept
+{
+    memcpy (dest, src, numValues * sizeof (float));
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (float* dest, const float* src, float multiplier, int numValues) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().copyWithMultiply (dest, src, multiplier, numValues);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::copyWithRamp (float* dest, const float* src, float startGain, float gainIncrement, int numValues) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().copyWithRamp (dest, src, startGain, gainIncrement, numValues);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src, int numValues) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().add (dest, src, numValues);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const float* src, float multiplier, int numValues) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().addWithMultiply (dest, src, multiplier, numValues);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::addWithRamp (float* dest, const float* src, float startGain, float gainIncrement, int numValues) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().addWithRamp (dest, src, startGain, gainIncrement, numValues);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, float multiplier, int numValues) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().multiply (dest, multiplier, numValues);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::multiplyWithRamp (float* dest, float startGain, float gainIncrement, int numValues) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().multiplyWithRamp (dest, startGain, gainIncrement, numValues);
+}
+
+void JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* src, int numValues, float& minResult, float& maxResult) noexcept
+{
+    FloatVectorHelpers::getCurrentImplementation().findMinAndMax (src, numValues, minResult, maxResult);
+}
+
+double JUCE_CALLTYPE FloatVectorOperations::sumOfSquares (const float* src, int numValues) noexcept
+{
+    return FloatVectorHelpers::getCurrentImplementation().sumOfSquares (src, numValues);
+}
+
+//==============================================================================
+FloatVectorOperations::InstructionSet JUCE_CALLTYPE FloatVectorOperations::getInstructionSet() noexcept
+{
+    return FloatVectorHelpers::getCurrentImplementation().instructionSet;
+}
+
+bool JUCE_CALLTYPE FloatVectorOperations::setInstructionSet (const InstructionSet newInstructionSet) noexcept
+{
+    if (newInstructionSet > getBestAvailableInstructionSet())
+        return false;
+
+    const FloatVectorHelpers::Implementation* const implementation = FloatVectorHelpers::getImplementation (newInstructionSet);
+
+    if (implementation == nullptr)
+        return false;
+
+    FloatVectorHelpers::currentImplementation = implementation;
+    return true;
+}
+
+FloatVectorOperations::InstructionSet JUCE_CALLTYPE FloatVectorOperations::getBestAvailableInstructionSet() noexcept
+{
+   #if JUCE_USE_AVX_INTRINSICS
+    return avx;
+   #else
+    #if JUCE_FLOATVECTOROPS_RUNTIME_AVX
+     // (this uses the compiler's own CPU check rather than SystemStats, because that
+     // doesn't allocate or read any files, so it's safe on an audio thread)
+     __builtin_cpu_init();
+
+     if (__builtin_cpu_supports ("avx"))
+         return avx;
+    #endif
+
+    #if JUCE_USE_SSE_INTRINSICS
+     return sse2;
+    #else
+     return scalar;
+    #endif
+   #endif
+}
+
+//==============================================================================
+ScopedNoDenormals::ScopedNoDenormals() noexcept
+    : previousState (0)
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    // (the flush-to-zero and denormals-are-zero bits)
+    previousState = (pointer_sized_int) _mm_getcsr();
+    _mm_setcsr ((unsigned int) previousState | 0x8040);
+   #elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+    // (the flush-to-zero bit)
+    uint64 fpcr;
+    asm volatile ("mrs %0, fpcr" : "=r" (fpcr));
+    previousState = (pointer_sized_int) fpcr;
+    asm volatile ("msr fpcr, %0" : : "r" (fpcr | (1 << 24)));
+   #endif
+}
+
+ScopedNoDenormals::~ScopedNoDenormals() noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS
+    _mm_setcsr ((unsigned int) previousState);
+   #elif JUCE_USE_ARM_NEON && defined (__aarch64__)
+    asm volatile ("msr fpcr, %0" : : "r" ((uint64) previousState));
+   #endif
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../../utilities/juce_UnitTest.h"
+#include "../../maths/juce_Random.h"
+
+class FloatVectorOperationsTests  : public UnitTest
+{
+public:
+    FloatVectorOperationsTests() : UnitTest ("FloatVectorOperations") {}
+
+    void runTest()
+    {
+        const InstructionSet originalInstructionSet = FloatVectorOperations::getInstructionSet();
+
+        for (int set = FloatVectorOperations::sse2; set <= FloatVectorOperations::avx; ++set)
+        {
+            if (FloatVectorOperations::setInstructionSet ((InstructionSet) set))
+            {
+                beginTest (set == FloatVectorOperations::avx ? "AVX" : "SSE2");
+
+                // (odd lengths and offsets, to exercise the unaligned and leftover values)
+                for (int num = 0; num < 70; num += (num < 20 ? 1 : 7))
+                    for (int offset = 0; offset < 3; ++offset)
+                        testAgainstScalar ((InstructionSet) set, num, offset);
+            }
+        }
+
+        FloatVectorOperations::setInstructionSet (originalInstructionSet);
+    }
+
+private:
+    typedef FloatVectorOperations::InstructionSet InstructionSet;
+
+    void testAgainstScalar (const InstructionSet set, const int num, const int offset)
+    {
+        HeapBlock<float> srcBlock (num + 3), originalBlock (num + 3), d1Block (num + 3), d2Block (num + 3);
+        float* const src = srcBlock + offset;
+        float* const original = originalBlock + offset;
+        float* const d1 = d1Block + offset;
+        float* const d2 = d2Block + offset;
+
+        Random r (num * 3 + offset);
+        for (int i = 0; i < num; ++i)
+        {
+            src[i] = r.nextFloat() * 2.0f - 1.0f;
+            original[i] = r.nextFloat() * 2.0f - 1.0f;
+        }
+
+        for (int operation = 0; operation < numOperations; ++operation)
+        {
+            memcpy (d1, original, num * sizeof (float));
+            memcpy (d2, original, num * sizeof (float));
+
+            FloatVectorOperations::setInstructionSet (FloatVectorOperations::scalar);
+            performOperation (operation, d1, src, num);
+            FloatVectorOperations::setInstructionSet (set);
+            performOperation (operation, d2, src, num);
+
+            expectMatching (d1, d2, num);
+        }
+
+        float mn1, mx1, mn2, mx2;
+        FloatVectorOperations::setInstructionSet (FloatVectorOperations::scalar);
+        FloatVectorOperations::findMinAndMax (src, num, mn1, mx1);
+        const double sum1 = FloatVectorOperations::sumOfSquares (src, num);
+
+        FloatVectorOperations::setInstructionSet (set);
+        FloatVectorOperations::findMinAndMax (src, num, mn2, mx2);
+        const double sum2 = FloatVectorOperations::sumOfSquares (src, num);
+
+        expect (mn1 == mn2 && mx1 == mx2);
+        expect (std::abs (sum1 - sum2) <= 1.0e-6 * (1.0 + sum1));
+    }
+
+    enum { numOperations = 7 };
+
+    static void performOperation (const int operation, float* dest, const float* src, const int num)
+    {
+        switch (operation)
+        {
+            case 0:   FloatVectorOperations::copyWithMultiply (dest, src, 0.7f, num); break;
+            case 1:   FloatVectorOperations::copyWithRamp (dest, src, 0.2f, 0.01f, num); break;
+            case 2:   FloatVectorOperations::add (dest, src, num); break;
+            case 3:   FloatVectorOperations::addWithMultiply (dest, src, -1.3f, num); break;
+            case 4:   FloatVectorOperations::addWithRamp (dest, src, 1.0f, -0.02f, num); break;
+            case 5:   FloatVectorOperations::multiply (dest, 0.9f, num); break;
+            case 6:   FloatVectorOperations::multiplyWithRamp (dest, 0.5f, 0.003f, num); break;
+            default:  jassertfalse; break;
+        }
+    }
+
+    void expectMatching (const float* d1, const float* d2, const int num)
+    {
+        // (the vectorised ramps accumulate their gains differently, so can be out by a rounding error)
+        for (int i = 0; i < num; ++i)
+        {
+            if (std::abs (d1[i] - d2[i]) > 1.0e-5f * (1.0f + std::abs (d1[i])))
+            {
+                expect (false, "mismatch at " + String (i) + " of " + String (num));
+                return;
+            }
+        }
+    }
+};
+
+static FloatVectorOperationsTests floatVectorOperationsTests;
+
+#endif
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
+#define __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
+
+
+//==============================================================================
+/**
+    A collection of simple vector operations on arrays of floats, accelerated with
+    SIMD instructions where possible.
+
+    The best instruction set that the CPU supports is picked at runtime, so for example
+    an SSE2 build made with GCC or Clang will use AVX when it's running on a machine that
+    has it. The arrays don't need to be aligned, although the operations run fastest on
+    32-byte aligned data, which is what AudioSampleBuffer allocates.
+
+    @see AudioSampleBuffer
+*/
+class JUCE_API  FloatVectorOperations
+{
+public:
+    //==============================================================================
+    /** Clears a vector of floats. */
+    static void JUCE_CALLTYPE clear (float* dest, int numValues) noexcept;
+
+    /** Copies a vector of floats. */
+    static void JUCE_CALLTYPE copy (float* dest, const float* src, int numValues) noexcept;
+
+    /** Copies a vector of floats, multiplying each value by a given multiplier. */
+    static void JUCE_CALLTYPE copyWithMultiply (float* dest, const float* src, float multiplier, int numValues) noexcept;
+
+    /** Copies a vector of floats, multiplying them by a gain that starts at startGain and
+        changes by gainIncrement after each value.
+    */
+    static void JUCE_CALLTYPE copyWithRamp (float* dest, const float* src, float startGain, float gainIncrement, int numValues) noexcept;
+
+    /** Adds the source values to the destination values. */
+    static void JUCE_CALLTYPE add (float* dest, const float* src, int numValues) noexcept;
+
+    /** Multiplies each source value by the given multiplier, and adds it to the destination value. */
+    static void JUCE_CALLTYPE addWithMultiply (float* dest, const float* src, float multiplier, int numValues) noexcept;
+
+    /** Adds the source values to the destination values, multiplying them by a gain that starts
+        at startGain and changes by gainIncrement after each value.
+    */
+    static void JUCE_CALLTYPE addWithRamp (float* dest, const float* src, float startGain, float gainIncrement, int numValues) noexcept;
+
+    /** Multiplies each of the destination values by a fixed multiplier. */
+    static void JUCE_CALLTYPE multiply (float* dest, float multiplier, int numValues) noexcept;
+
+    /** Multiplies the destination values by a gain that starts at startGain and changes by
+        gainIncrement after each value.
+    */
+    static void JUCE_CALLTYPE multiplyWithRamp (float* dest, float startGain, float gainIncrement, int numValues) noexcept;
+
+    /** Finds the lowest and highest values in a vector.
+        If numValues is 0, both results will be 0.
+    */
+    static void JUCE_CALLTYPE findMinAndMax (const float* src, int numValues, float& minResult, float& maxResult) noexcept;
+
+    /** Returns the sum of the squares of the values in a vector, accumulated in double precision. */
+    static double JUCE_CALLTYPE sumOfSquares (const float* src, int numValues) noexcept;
+
+    //==============================================================================
+    /** The instruction sets that the operations can be performed with. */
+    enum InstructionSet
+    {
+        scalar,     /**< Plain C++ loops. */
+        sse2,       /**< 128-bit SSE2 vectors. */
+        avx         /**< 256-bit AVX vectors. */
+    };
+
+    /** Returns the instruction set that's currently being used. */
+    static InstructionSet JUCE_CALLTYPE getInstructionSet() noexcept;
+
+    /** Forces the operations to use a particular instruction set.
+
+        This is intended for testing and benchmarking, and shouldn't be called while any other
+        threads might be using these functions. It returns false (and changes nothing) if the
+        instruction set isn't supported by this build or this CPU.
+    */
+    static bool JUCE_CALLTYPE setInstructionSet (InstructionSet newInstructionSet) noexcept;
+
+    /** Returns the best instruction set that this build can use on this CPU. */
+    static InstructionSet JUCE_CALLTYPE getBestAvailableInstructionSet() noexcept;
+};
+
+//==============================================================================
+/**
+    While this object is in scope, the CPU treats denormalised floating point values as
+    zero, both as inputs and as results.
+
+    Recursive filters and feedback loops can produce values that decay into the denormal
+    range when their input goes quiet, and on many CPUs, arithmetic with these is much
+    slower. Create one of these on the stack around the processing code to avoid this.
+    It only affects the calling thread, and the previous mode is restored when it's deleted.
+
+    On CPUs where this isn't supported, it does nothing.
+*/
+class JUCE_API  ScopedNoDenormals
+{
+public:
+    ScopedNoDenormals() noexcept;
+    ~ScopedNoDenormals() noexcept;
+
+private:
+    pointer_sized_int previousState;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedNoDenormals);
+};
+
+
+#endif   // __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
@@ -142,6 +142,8 @@ protected:
     float coefficients[6];
     float x1, x2, y1, y2;
 
+    friend class IIRFilterCascade;
+
     // (use the copyCoefficientsFrom() method instead of this operator)
     IIRFilter& operator= (const IIRFilter&);
     JUCE_LEAK_DETECTOR (IIRFilter);
@@ -0,0 +1,633 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_IIRFilterCascade.h"
+#include "juce_FloatVectorOperations.h"
+
+
+//==============================================================================
+namespace IIRFilterCascadeHelpers
+{
+    // These wrap up the vector operations that the filters need. As well as the arithmetic,
+    // they can gather a sample from each of a set of channels into the lanes of a vector,
+    // and shift a vector along by one lane, which is how the stages are pipelined.
+    struct ScalarOps
+    {
+        typedef float Type;
+        enum { numLanes = 1 };
+
+        static inline Type load (const float* src) noexcept                         { return *src; }
+        static inline void store (float* dest, Type v) noexcept                     { *dest = v; }
+        static inline Type expand (float v) noexcept                                { return v; }
+        static inline Type add (Type a, Type b) noexcept                            { return a + b; }
+        static inline Type sub (Type a, Type b) noexcept                            { return a - b; }
+        static inline Type mul (Type a, Type b) noexcept                            { return a * b; }
+        static inline Type gather (float* const* src, int i) noexcept               { return src[0][i]; }
+        static inline void scatter (float* const* dest, int i, Type v) noexcept     { dest[0][i] = v; }
+        static inline Type shiftIn (Type, float first) noexcept                     { return first; }
+        static inline float getLastLane (Type v) noexcept                           { return v; }
+        static inline Type laneMask (int, int) noexcept                             { return 0; }
+        static inline Type select (Type, Type a, Type) noexcept                     { return a; }
+    };
+
+   #if JUCE_USE_SSE_INTRINSICS
+    struct SSEOps
+    {
+        typedef __m128 Type;
+        enum { numLanes = 4 };
+
+        static inline Type load (const float* src) noexcept             { return _mm_loadu_ps (src); }
+        static inline void store (float* dest, Type v) noexcept         { _mm_storeu_ps (dest, v); }
+        static inline Type expand (float v) noexcept                    { return _mm_set1_ps (v); }
+        static inline Type add (Type a, Type b) noexcept                { return _mm_add_ps (a, b); }
+        static inline Type sub (Type a, Type b) noexcept                { return _mm_sub_ps (a, b); }
+        static inline Type mul (Type a, Type b) noexcept                { return _mm_mul_ps (a, b); }
+        static inline float getLastLane (Type v) noexcept               { return _mm_cvtss_f32 (_mm_shuffle_ps (v, v, _MM_SHUFFLE (3, 3, 3, 3))); }
+
+        static inline Type gather (float* const* src, int i) noexcept
+        {
+            return _mm_setr_ps (src[0][i], src[1][i], src[2][i], src[3][i]);
+        }
+
+        static inline void scatter (float* const* dest, int i, Type v) noexcept
+        {
+            float values [numLanes];
+            _mm_storeu_ps (values, v);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                dest[lane][i] = values[lane];
+        }
+
+        // returns { first, v[0], v[1], v[2] }
+        static inline Type shiftIn (Type v, float first) noexcept
+        {
+            return _mm_move_ss (_mm_shuffle_ps (v, v, _MM_SHUFFLE (2, 1, 0, 0)), _mm_set_ss (first));
+        }
+
+        // returns a mask with the lanes from start up to (but not including) end set
+        static inline Type laneMask (int start, int end) noexcept
+        {
+            return _mm_castsi128_ps (_mm_setr_epi32 (start <= 0 && end > 0 ? -1 : 0, start <= 1 && end > 1 ? -1 : 0,
+                                                     start <= 2 && end > 2 ? -1 : 0, start <= 3 && end > 3 ? -1 : 0));
+        }
+
+        static inline Type select (Type mask, Type a, Type b) noexcept
+        {
+            return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b));
+        }
+    };
+
+    typedef SSEOps VectorOps;
+
+   #elif JUCE_USE_ARM_NEON
+    struct NeonOps
+    {
+        typedef float32x4_t Type;
+        enum { numLanes = 4 };
+
+        static inline Type load (const float* src) noexcept             { return vld1q_f32 (src); }
+        static inline void store (float* dest, Type v) noexcept         { vst1q_f32 (dest, v); }
+        static inline Type expand (float v) noexcept                    { return vdupq_n_f32 (v); }
+        static inline Type add (Type a, Type b) noexcept                { return vaddq_f32 (a, b); }
+        static inline Type sub (Type a, Type b) noexcept                { return vsubq_f32 (a, b); }
+        static inline Type mul (Type a, Type b) noexcept                { return vmulq_f32 (a, b); }
+        static inline float getLastLane (Type v) noexcept               { return vgetq_lane_f32 (v, 3); }
+        static inline Type shiftIn (Type v, float first) noexcept       { return vextq_f32 (vdupq_n_f32 (first), v, 3); }
+
+        static inline Type gather (float* const* src, int i) noexcept
+        {
+            const float values[] = { src[0][i], src[1][i], src[2][i], src[3][i] };
+            return vld1q_f32 (values);
+        }
+
+        static inline void scatter (float* const* dest, int i, Type v) noexcept
+        {
+            float values [numLanes];
+            vst1q_f32 (values, v);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                dest[lane][i] = values[lane];
+        }
+
+        static inline Type laneMask (int start, int end) noexcept
+        {
+            const uint32_t bits[] = { start <= 0 && end > 0 ? 0xffffffffu : 0, start <= 1 && end > 1 ? 0xffffffffu : 0,
+                                      start <= 2 && end > 2 ? 0xffffffffu : 0, start <= 3 && end > 3 ? 0xffffffffu : 0 };
+            return vreinterpretq_f32_u32 (vld1q_u32 (bits));
+        }
+
+        static inline Type select (Type mask, Type a, Type b) noexcept
+        {
+            return vreinterpretq_f32_u32 (vbslq_u32 (vreinterpretq_u32_f32 (mask), vreinterpretq_u32_f32 (a), vreinterpretq_u32_f32 (b)));
+        }
+    };
+
+    typedef NeonOps VectorOps;
+
+   #else
+    typedef ScalarOps VectorOps;
+   #endif
+
+    enum { numLanes = VectorOps::numLanes, maxChunkSize = 256 };
+
+    static inline int roundUpToLanes (const int n) noexcept
+    {
+        return ((n + numLanes - 1) / numLanes) * numLanes;
+    }
+
+    // runs one transposed direct form II biquad, whose state is kept in memory
+    template <class Ops>
+    static inline typename Ops::Type processStage (const typename Ops::Type x, float* const s1, float* const s2,
+                                                   const float b0, const float b1, const float b2,
+                                                   const float a1, const float a2) noexcept
+    {
+        typedef typename Ops::Type Type;
+
+        const Type y (Ops::add (Ops::mul (Ops::expand (b0), x), Ops::load (s1)));
+        Ops::store (s1, Ops::add (Ops::sub (Ops::mul (Ops::expand (b1), x), Ops::mul (Ops::expand (a1), y)), Ops::load (s2)));
+        Ops::store (s2, Ops::sub (Ops::mul (Ops::expand (b2), x), Ops::mul (Ops::expand (a2), y)));
+        return y;
+    }
+}
+
+//==============================================================================
+IIRFilterCascade::IIRFilterCascade (const int numChannels_, const int numStages_)
+    : numChannels (0),
+      numStages (0),
+      channelsInLanes (true),
+      numStagesAllocated (0),
+      numRampSamplesLeft (0),
+      smoothingLength (128)
+{
+    silence.calloc ((size_t) IIRFilterCascadeHelpers::maxChunkSize);
+    setSize (numChannels_, numStages_);
+}
+
+IIRFilterCascade::~IIRFilterCascade()
+{
+}
+
+//==============================================================================
+void IIRFilterCascade::setSize (const int newNumChannels, const int newNumStages)
+{
+    using namespace IIRFilterCascadeHelpers;
+    jassert (newNumChannels >= 0 && newNumStages >= 0);
+
+    // The stages are padded to a whole number of vectors with ones that do nothing,
+    // so that the pipelined version doesn't need to deal with a partial vector.
+    const int newNumStagesAllocated = jmax ((int) numLanes, roundUpToLanes (newNumStages));
+    const size_t numCoefficientValues = (size_t) (numCoefficients * newNumStagesAllocated);
+
+    HeapBlock<float> newCoefficients, newTargets, newDeltas;
+    newCoefficients.calloc (numCoefficientValues);
+    newTargets.calloc (numCoefficientValues);
+    newDeltas.calloc (numCoefficientValues);
+
+    for (int i = 0; i < newNumStagesAllocated; ++i)
+        newCoefficients[i] = newTargets[i] = 1.0f;   // b0 = 1 makes a stage pass its input through
+
+    const size_t numStateValues = (size_t) (roundUpToLanes (newNumChannels) * newNumStagesAllocated);
+    HeapBlock<float> newState1, newState2;
+    newState1.calloc (numStateValues);
+    newState2.calloc (numStateValues);
+
+    const ScopedLock sl (processLock);
+
+    for (int k = 0; k < numCoefficients; ++k)
+    {
+        for (int i = jmin (numStages, newNumStages); --i >= 0;)
+        {
+            newCoefficients [k * newNumStagesAllocated + i] = coefficients [k * numStagesAllocated + i];
+            newTargets [k * newNumStagesAllocated + i] = targets [k * numStagesAllocated + i];
+            newDeltas [k * newNumStagesAllocated + i] = deltas [k * numStagesAllocated + i];
+        }
+    }
+
+    coefficients.swapWith (newCoefficients);
+    targets.swapWith (newTargets);
+    deltas.swapWith (newDeltas);
+    state1.swapWith (newState1);
+    state2.swapWith (newState2);
+
+    numChannels = newNumChannels;
+    numStages = newNumStages;
+    numStagesAllocated = newNumStagesAllocated;
+
+    // Each lane can either hold a different channel or a different stage - this picks
+    // whichever of the two would leave fewer of the lanes empty.
+    channelsInLanes = numChannels * roundUpToLanes (numStages) >= numStages * roundUpToLanes (numChannels);
+}
+
+void IIRFilterCascade::setStage (const int stageIndex, const IIRFilter& newSettings) noexcept
+{
+    float newValues [numCoefficients];
+
+    {
+        const ScopedLock sl (newSettings.processLock);
+
+        if (newSettings.active)
+        {
+            newValues[0] = newSettings.coefficients[0];
+            newValues[1] = newSettings.coefficients[1];
+            newValues[2] = newSettings.coefficients[2];
+            newValues[3] = newSettings.coefficients[4];
+            newValues[4] = newSettings.coefficients[5];
+        }
+        else
+        {
+            newValues[0] = 1.0f;
+            newValues[1] = newValues[2] = newValues[3] = newValues[4] = 0;
+        }
+    }
+
+    const ScopedLock sl (processLock);
+
+    if (isPositiveAndBelow (stageIndex, numStages))
+    {
+        for (int k = 0; k < numCoefficients; ++k)
+            targets [k * numStagesAllocated + stageIndex] = newValues[k];
+
+        // The stages that are already ramping carry on towards their targets, but over the
+        // new ramp's length. (Any filter whose coefficients are a straight-line mix of two
+        // stable filters' is stable too, so the ramps can't make a filter blow up).
+        const int numValues = numCoefficients * numStagesAllocated;
+
+        if (smoothingLength > 0)
+        {
+            const float scale = 1.0f / smoothingLength;
+
+            for (int i = 0; i < numValues; ++i)
+                deltas[i] = (targets[i] - coefficients[i]) * scale;
+
+            numRampSamplesLeft = smoothingLength;
+        }
+        else
+        {
+            memcpy (coefficients, targets, sizeof (float) * (size_t) numValues);
+            numRampSamplesLeft = 0;
+        }
+    }
+    else
+    {
+        jassertfalse;
+    }
+}
+
+void IIRFilterCascade::setSmoothingLength (const int numSamples) noexcept
+{
+    const ScopedLock sl (processLock);
+    smoothingLength = jmax (0, numSamples);
+}
+
+void IIRFilterCascade::reset() noexcept
+{
+    const ScopedLock sl (processLock);
+
+    const size_t numStateValues = (size_t) (IIRFilterCascadeHelpers::roundUpToLanes (numChannels) * numStagesAllocated);
+    state1.clear (numStateValues);
+    state2.clear (numStateValues);
+
+    memcpy (coefficients, targets, sizeof (float) * (size_t) (numCoefficients * numStagesAllocated));
+    numRampSamplesLeft = 0;
+}
+
+//==============================================================================
+void IIRFilterCascade::processSamples (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept
+{
+    using namespace IIRFilterCascadeHelpers;
+    jassert (buffer.getNumChannels() >= numChannels);
+    jassert (startSample >= 0 && startSample + numSamples <= buffer.getNumSamples());
+
+    const ScopedLock sl (processLock);
+
+    if (numChannels == 0 || numStages == 0 || buffer.getNumChannels() < numChannels)
+        return;
+
+    // (this stops the filters' tails from slowing down to a crawl as they die away)
+    const ScopedNoDenormals noDenormals;
+
+    // the block is done in chunks so that a spare lane can be pointed at the silence
+    // buffer, which is a fixed size
+    while (numSamples > 0)
+    {
+        const int numThisTime = jmin (numSamples, (int) maxChunkSize);
+
+        if (channelsInLanes)
+        {
+            processChannelsInLanes <VectorOps> (buffer, startSample, numThisTime);
+            updateRamp (numThisTime);
+        }
+        else
+        {
+            processStagesInLanes <VectorOps> (buffer, startSample, numThisTime);
+            updateRamp (numThisTime + numLanes - 1);
+        }
+
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+    }
+
+    flushDenormals();
+}
+
+template <class Ops>
+void IIRFilterCascade::processChannelsInLanes (AudioSampleBuffer& buffer, const int startSample, const int numSamples) noexcept
+{
+    using namespace IIRFilterCascadeHelpers;
+    typedef typename Ops::Type Type;
+    enum { numLanes = Ops::numLanes };
+
+    const float* const b0 = coefficients;
+    const float* const b1 = b0 + numStagesAllocated;
+    const float* const b2 = b1 + numStagesAllocated;
+    const float* const a1 = b2 + numStagesAllocated;
+    const float* const a2 = a1 + numStagesAllocated;
+    const int offsetToTargets = (int) (targets - coefficients);
+    const int offsetToDeltas = (int) (deltas - coefficients);
+
+    for (int firstChannel = 0; firstChannel < numChannels; firstChannel += numLanes)
+    {
+        float* channels [numLanes];
+
+        for (int lane = 0; lane < numLanes; ++lane)
+            channels[lane] = firstChannel + lane < numChannels ? buffer.getSampleData (firstChannel + lane, startSample)
+                                                               : silence.getData();
+
+        float* const groupState1 = state1 + firstChannel * numStagesAllocated;
+        float* const groupState2 = state2 + firstChannel * numStagesAllocated;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            Type x (Ops::gather (channels, i));
+            float* s1 = groupState1;
+            float* s2 = groupState2;
+
+            if (i + 1 < numRampSamplesLeft)
+            {
+                const float proportion = (float) (i + 1);
+
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    x = processStage <Ops> (x, s1, s2,
+                                            b0[stage] + b0[stage + offsetToDeltas] * proportion,
+                                            b1[stage] + b1[stage + offsetToDeltas] * proportion,
+                                            b2[stage] + b2[stage + offsetToDeltas] * proportion,
+                                            a1[stage] + a1[stage + offsetToDeltas] * proportion,
+                                            a2[stage] + a2[stage + offsetToDeltas] * proportion);
+                    s1 += numLanes;
+                    s2 += numLanes;
+                }
+            }
+            else
+            {
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    x = processStage <Ops> (x, s1, s2,
+                                            b0[stage + offsetToTargets], b1[stage + offsetToTargets], b2[stage + offsetToTargets],
+                                            a1[stage + offsetToTargets], a2[stage + offsetToTargets]);
+                    s1 += numLanes;
+                    s2 += numLanes;
+                }
+            }
+
+            Ops::scatter (channels, i, x);
+        }
+    }
+}
+
+template <class Ops>
+void IIRFilterCascade::processStagesInLanes (AudioSampleBuffer& buffer, const int startSample, const int numSamples) noexcept
+{
+    typedef typename Ops::Type Type;
+    enum { numLanes = Ops::numLanes };
+
+    // Each lane runs a different stage, and each stage's output is shifted into the next
+    // lane to become the following stage's input on the next step. So at step n, the first
+    // lane is working on sample n, the second on sample n - 1, and so on, and it takes
+    // (numLanes - 1) extra steps to get the last samples out of the pipeline. During those
+    // steps at either end, the lanes that don't have a sample to work on are masked off
+    // so that their state doesn't change.
+    const int numSteps = numSamples + numLanes - 1;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        float* const data = buffer.getSampleData (channel, startSample);
+
+        for (int firstStage = 0; firstStage < numStages; firstStage += numLanes)
+        {
+            const float* const c = coefficients + firstStage;
+            const float* const d = deltas + firstStage;
+            const float* const t = targets + firstStage;
+            const int n = numStagesAllocated;
+
+            Type b0 (Ops::load (c)), b1 (Ops::load (c + n)), b2 (Ops::load (c + 2 * n)), a1 (Ops::load (c + 3 * n)), a2 (Ops::load (c + 4 * n));
+            float* const stateBase1 = state1 + channel * numStagesAllocated + firstStage;
+            float* const stateBase2 = state2 + channel * numStagesAllocated + firstStage;
+            Type s1 (Ops::load (stateBase1)), s2 (Ops::load (stateBase2));
+            Type y (Ops::expand (0));
+
+            for (int step = 0; step < numSteps; ++step)
+            {
+                if (step < numRampSamplesLeft)
+                {
+                    if (step + 1 < numRampSamplesLeft)
+                    {
+                        b0 = Ops::add (b0, Ops::load (d));          b1 = Ops::add (b1, Ops::load (d + n));
+                        b2 = Ops::add (b2, Ops::load (d + 2 * n));  a1 = Ops::add (a1, Ops::load (d + 3 * n));
+                        a2 = Ops::add (a2, Ops::load (d + 4 * n));
+                    }
+                    else
+                    {
+                        b0 = Ops::load (t);           b1 = Ops::load (t + n);         b2 = Ops::load (t + 2 * n);
+                        a1 = Ops::load (t + 3 * n);   a2 = Ops::load (t + 4 * n);
+                    }
+                }
+
+                const Type x (Ops::shiftIn (y, step < numSamples ? data [step] : 0.0f));
+                y = Ops::add (Ops::mul (b0, x), s1);
+                const Type newS1 (Ops::add (Ops::sub (Ops::mul (b1, x), Ops::mul (a1, y)), s2));
+                const Type newS2 (Ops::sub (Ops::mul (b2, x), Ops::mul (a2, y)));
+
+                if (step < numLanes - 1 || step >= numSamples)
+                {
+                    const Type mask (Ops::laneMask (step - numSamples + 1, step + 1));
+                    s1 = Ops::select (mask, newS1, s1);
+                    s2 = Ops::select (mask, newS2, s2);
+                }
+                else
+                {
+                    s1 = newS1;
+                    s2 = newS2;
+                }
+
+                if (step >= numLanes - 1)
+                    data [step - (numLanes - 1)] = Ops::getLastLane (y);
+            }
+
+            Ops::store (stateBase1, s1);
+            Ops::store (stateBase2, s2);
+        }
+    }
+}
+
+void IIRFilterCascade::updateRamp (const int numSteps) noexcept
+{
+    if (numRampSamplesLeft > 0)
+    {
+        const int numValues = numCoefficients * numStagesAllocated;
+
+        if (numSteps >= numRampSamplesLeft)
+        {
+            memcpy (coefficients, targets, sizeof (float) * (size_t) numValues);
+            numRampSamplesLeft = 0;
+        }
+        else
+        {
+            FloatVectorOperations::addWithMultiply (coefficients, deltas, (float) numSteps, numValues);
+            numRampSamplesLeft -= numSteps;
+        }
+    }
+}
+
+void IIRFilterCascade::flushDenormals() noexcept
+{
+    const int numStateValues = IIRFilterCascadeHelpers::roundUpToLanes (numChannels) * numStagesAllocated;
+
+    for (int i = 0; i < numStateValues; ++i)
+    {
+        if (! (state1[i] < -1.0e-15f || state1[i] > 1.0e-15f))  state1[i] = 0;
+        if (! (state2[i] < -1.0e-15f || state2[i] > 1.0e-15f))  state2[i] = 0;
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../../utilities/juce_UnitTest.h"
+#include "../../maths/juce_Random.h"
+
+class IIRFilterCascadeTests  : public UnitTest
+{
+public:
+    IIRFilterCascadeTests() : UnitTest ("IIRFilterCascade") {}
+
+    static void setUpFilter (IIRFilter& filter, const int index)
+    {
+        switch (index % 4)
+        {
+            case 0:     filter.makeLowPass (44100.0, 12000.0 - 500.0 * index); break;
+            case 1:     filter.makeBandPass (44100.0, 300.0 * (index + 1), 1.5, 2.0f); break;
+            case 2:     filter.makeHighShelf (44100.0, 5000.0, 0.7, 0.5f); break;
+            default:    filter.makeHighPass (44100.0, 20.0 * (index + 1)); break;
+        }
+    }
+
+    // runs a cascade against a chain of IIRFilters, in blocks of awkward sizes
+    void compareWithFilters (const int numChannels, const int numStages)
+    {
+        beginTest ("Channels: " + String (numChannels) + ", stages: " + String (numStages));
+
+        IIRFilterCascade cascade (numChannels, numStages);
+        cascade.setSmoothingLength (0);
+        OwnedArray<IIRFilter> filters;
+
+        for (int i = 0; i < numChannels * numStages; ++i)
+        {
+            IIRFilter* const filter = new IIRFilter();
+            setUpFilter (*filter, i % numStages);
+            filters.add (filter);
+
+            if (i < numStages)
+                cascade.setStage (i, *filter);
+        }
+
+        AudioSampleBuffer buffer (numChannels, 1000);
+        Random r (0x1234);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.getSampleData (channel)[i] = r.nextFloat() * 2.0f - 1.0f;
+
+        AudioSampleBuffer expected (buffer);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int stage = 0; stage < numStages; ++stage)
+                filters [channel * numStages + stage]->processSamples (expected.getSampleData (channel), expected.getNumSamples());
+
+        for (int start = 0, blockSize = 1; start < buffer.getNumSamples(); start += blockSize, blockSize = blockSize * 2 + 1)
+            cascade.processSamples (buffer, start, jmin (blockSize, buffer.getNumSamples() - start));
+
+        float maxError = 0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                maxError = jmax (maxError, std::abs (buffer.getSampleData (channel)[i] - expected.getSampleData (channel)[i]));
+
+        expect (maxError < 1.0e-3f, "error: " + String (maxError));
+    }
+
+    void runTest()
+    {
+        compareWithFilters (1, 1);
+        compareWithFilters (2, 1);
+        compareWithFilters (2, 7);
+        compareWithFilters (5, 2);
+        compareWithFilters (8, 3);
+
+        beginTest ("Smoothing");
+
+        IIRFilterCascade cascade (1, 1);
+        cascade.setSmoothingLength (100);
+
+        IIRFilter filter;
+        filter.makeLowPass (44100.0, 1000.0);
+        cascade.setStage (0, filter);
+
+        // with a constant input, the output should move smoothly to the new filter's response
+        AudioSampleBuffer buffer (1, 300);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.getSampleData (0)[i] = 1.0f;
+
+        cascade.processSamples (buffer, 0, buffer.getNumSamples());
+        float maxStep = 0;
+
+        for (int i = 1; i < buffer.getNumSamples(); ++i)
+            maxStep = jmax (maxStep, std::abs (buffer.getSampleData (0)[i] - buffer.getSampleData (0)[i - 1]));
+
+        expect (maxStep < 0.05f, "step: " + String (maxStep));
+        expect (std::abs (buffer.getSampleData (0)[buffer.getNumSamples() - 1] - 1.0f) < 0.01f);
+    }
+};
+
+static IIRFilterCascadeTests iirFilterCascadeTests;
+
+#endif
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_IIRFILTERCASCADE_JUCEHEADER__
+#define __JUCE_IIRFILTERCASCADE_JUCEHEADER__
+
+#include "juce_IIRFilter.h"
+#include "juce_AudioSampleBuffer.h"
+#include "../../memory/juce_HeapBlock.h"
+
+
+//==============================================================================
+/**
+    A chain of biquad filters that's applied to a set of channels.
+
+    Each stage of the cascade is set up with an IIRFilter, and all the channels are
+    put through the same stages. The filters run in transposed direct form II, and
+    their state is kept as a structure-of-arrays so that several of them can be
+    processed at once in the lanes of a SIMD register: if there are at least as
+    many channels as lanes, each lane handles a different channel; otherwise the
+    stages themselves are pipelined across the lanes, so that a long chain of EQ
+    bands on a mono or stereo signal is still vectorised.
+
+    When a stage's settings are changed, its coefficients are ramped from their old
+    values to the new ones over a number of samples (see setSmoothingLength()), so
+    the parameters can be moved while audio is playing without clicking.
+
+    @see IIRFilter, IIRFilterAudioSource
+*/
+class JUCE_API  IIRFilterCascade
+{
+public:
+    //==============================================================================
+    /** Creates a cascade with the given number of channels and stages.
+        The stages are initially inactive, i.e. they leave the signal unchanged.
+    */
+    IIRFilterCascade (int numChannels = 2, int numStages = 1);
+
+    /** Destructor. */
+    ~IIRFilterCascade();
+
+    //==============================================================================
+    /** Changes the number of channels and stages.
+
+        Any stages that already exist keep their settings, but the processing
+        state is reset. This allocates memory, so avoid calling it on the audio
+        thread if the size is actually changing.
+    */
+    void setSize (int numChannels, int numStages);
+
+    /** Returns the number of channels that the cascade processes. */
+    int getNumChannels() const noexcept                 { return numChannels; }
+
+    /** Returns the number of stages in the cascade. */
+    int getNumStages() const noexcept                   { return numStages; }
+
+    //==============================================================================
+    /** Makes one of the stages use the same coefficients as the given filter.
+
+        If the filter is inactive, the stage will pass the signal through unchanged.
+        The change is smoothed over the number of samples set by setSmoothingLength().
+    */
+    void setStage (int stageIndex, const IIRFilter& newSettings) noexcept;
+
+    /** Sets the number of samples over which changes to the stages are ramped.
+        A length of 0 makes changes take effect immediately. The default is 128.
+    */
+    void setSmoothingLength (int numSamples) noexcept;
+
+    /** Resets the filters' processing state, ready to start a new stream of data.
+        This doesn't change the settings of the stages, and any coefficient ramps
+        that are in progress are completed immediately.
+    */
+    void reset() noexcept;
+
+    //==============================================================================
+    /** Filters a section of an AudioSampleBuffer.
+
+        Only the first getNumChannels() channels of the buffer are processed.
+    */
+    void processSamples (AudioSampleBuffer& buffer, int startSample, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    CriticalSection processLock;
+    int numChannels, numStages;
+    bool channelsInLanes;
+
+    // For each coefficient (b0, b1, b2, a1, a2) these hold the current values for each
+    // stage, the values being ramped towards, and the per-sample ramp increments.
+    enum { numCoefficients = 5 };
+    HeapBlock<float> coefficients, targets, deltas;
+    int numStagesAllocated, numRampSamplesLeft, smoothingLength;
+
+    // The two state variables for each filter, laid out so that the lanes that are
+    // processed together are next to each other.
+    HeapBlock<float> state1, state2, silence;
+
+    template <class Ops> void processChannelsInLanes (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+    template <class Ops> void processStagesInLanes (AudioSampleBuffer&, int startSample, int numSamples) noexcept;
+    void updateRamp (int numSteps) noexcept;
+    void flushDenormals() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IIRFilterCascade);
+};
+
+
+#endif   // __JUCE_IIRFILTERCASCADE_JUCEHEADER__
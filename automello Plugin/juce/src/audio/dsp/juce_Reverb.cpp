@@ -0,0 +1,488 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_Reverb.h"
+#include "juce_FloatVectorOperations.h"
+
+
+//==============================================================================
+namespace ReverbHelpers
+{
+    // These wrap up the vector operations that the comb filters need, so that the same
+    // code can be compiled for whichever instruction set is available. Each lane holds a
+    // different comb, and as each comb has its own delay line, the delayed samples are
+    // read as a square block of numLanes samples from numLanes lines, which is transposed
+    // so that each vector holds one sample from each comb.
+    struct ScalarOps
+    {
+        typedef float Type;
+        enum { numLanes = 1 };
+
+        static inline Type load (const float* src) noexcept                         { return *src; }
+        static inline void store (float* dest, Type v) noexcept                     { *dest = v; }
+        static inline Type expand (float v) noexcept                                { return v; }
+        static inline Type add (Type a, Type b) noexcept                            { return a + b; }
+        static inline Type mul (Type a, Type b) noexcept                            { return a * b; }
+        static inline Type gather (float* const* src, int i) noexcept               { return src[0][i]; }
+        static inline void scatter (float* const* dest, int i, Type v) noexcept     { dest[0][i] = v; }
+        static inline void transpose (Type*) noexcept                               {}
+        static inline Type undenormalise (Type v) noexcept                          { JUCE_UNDENORMALISE (v); return v; }
+    };
+
+   #if JUCE_USE_SSE_INTRINSICS
+    struct SSEOps
+    {
+        typedef __m128 Type;
+        enum { numLanes = 4 };
+
+        static inline Type load (const float* src) noexcept             { return _mm_loadu_ps (src); }
+        static inline void store (float* dest, Type v) noexcept         { _mm_storeu_ps (dest, v); }
+        static inline Type expand (float v) noexcept                    { return _mm_set1_ps (v); }
+        static inline Type add (Type a, Type b) noexcept                { return _mm_add_ps (a, b); }
+        static inline Type mul (Type a, Type b) noexcept                { return _mm_mul_ps (a, b); }
+
+        // (denormals are dealt with by the ScopedNoDenormals that the reverb uses)
+        static inline Type undenormalise (Type v) noexcept              { return v; }
+
+        static inline Type gather (float* const* src, int i) noexcept
+        {
+            return _mm_setr_ps (src[0][i], src[1][i], src[2][i], src[3][i]);
+        }
+
+        static inline void scatter (float* const* dest, int i, Type v) noexcept
+        {
+            float values [numLanes];
+            _mm_storeu_ps (values, v);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                dest[lane][i] = values[lane];
+        }
+
+        static inline void transpose (Type* rows) noexcept
+        {
+            _MM_TRANSPOSE4_PS (rows[0], rows[1], rows[2], rows[3]);
+        }
+    };
+
+    typedef SSEOps VectorOps;
+
+   #elif JUCE_USE_ARM_NEON
+    struct NeonOps
+    {
+        typedef float32x4_t Type;
+        enum { numLanes = 4 };
+
+        static inline Type load (const float* src) noexcept             { return vld1q_f32 (src); }
+        static inline void store (float* dest, Type v) noexcept         { vst1q_f32 (dest, v); }
+        static inline Type expand (float v) noexcept                    { return vdupq_n_f32 (v); }
+        static inline Type add (Type a, Type b) noexcept                { return vaddq_f32 (a, b); }
+        static inline Type mul (Type a, Type b) noexcept                { return vmulq_f32 (a, b); }
+        static inline Type undenormalise (Type v) noexcept              { return v; }
+
+        static inline Type gather (float* const* src, int i) noexcept
+        {
+            const float values[] = { src[0][i], src[1][i], src[2][i], src[3][i] };
+            return vld1q_f32 (values);
+        }
+
+        static inline void scatter (float* const* dest, int i, Type v) noexcept
+        {
+            float values [numLanes];
+            vst1q_f32 (values, v);
+
+            for (int lane = 0; lane < numLanes; ++lane)
+                dest[lane][i] = values[lane];
+        }
+
+        static inline void transpose (Type* rows) noexcept
+        {
+            const float32x4x2_t t01 (vtrnq_f32 (rows[0], rows[1]));
+            const float32x4x2_t t23 (vtrnq_f32 (rows[2], rows[3]));
+
+            rows[0] = vcombine_f32 (vget_low_f32 (t01.val[0]),  vget_low_f32 (t23.val[0]));
+            rows[1] = vcombine_f32 (vget_low_f32 (t01.val[1]),  vget_low_f32 (t23.val[1]));
+            rows[2] = vcombine_f32 (vget_high_f32 (t01.val[0]), vget_high_f32 (t23.val[0]));
+            rows[3] = vcombine_f32 (vget_high_f32 (t01.val[1]), vget_high_f32 (t23.val[1]));
+        }
+    };
+
+    typedef NeonOps VectorOps;
+
+   #else
+    typedef ScalarOps VectorOps;
+   #endif
+}
+
+//==============================================================================
+void Reverb::SmoothedValue::setTarget (const float newTarget, const int numSamplesToTake) noexcept
+{
+    target = newTarget;
+
+    if (numSamplesToTake > 0)
+    {
+        numSamplesLeft = numSamplesToTake;
+    }
+    else
+    {
+        current = newTarget;
+        numSamplesLeft = 0;
+    }
+}
+
+void Reverb::SmoothedValue::skip (const int numSamples) noexcept
+{
+    if (numSamplesLeft > 0)
+    {
+        if (numSamples >= numSamplesLeft)
+        {
+            current = target;
+            numSamplesLeft = 0;
+        }
+        else
+        {
+            current += (target - current) * numSamples / (float) numSamplesLeft;
+            numSamplesLeft -= numSamples;
+        }
+    }
+}
+
+//==============================================================================
+void Reverb::DelayLine::setSize (const int newSize)
+{
+    if (newSize != size)
+    {
+        position = 0;
+        buffer.malloc ((size_t) newSize);
+        size = newSize;
+    }
+
+    clear();
+}
+
+void Reverb::DelayLine::clear() noexcept
+{
+    buffer.clear ((size_t) size);
+}
+
+void Reverb::DelayLine::advance (const int numSamples) noexcept
+{
+    position += numSamples;
+    jassert (position <= size);
+
+    if (position >= size)
+        position = 0;
+}
+
+//==============================================================================
+Reverb::Reverb()
+    : sampleRate (44100.0),
+      smoothingTime (0)
+{
+    zeromem (combFilterStates, sizeof (combFilterStates));
+
+    setParameters (Parameters());
+    setSampleRate (44100.0);
+}
+
+Reverb::~Reverb()
+{
+}
+
+//==============================================================================
+void Reverb::setParameters (const Parameters& newParams) noexcept
+{
+    const float wetScaleFactor = 3.0f;
+    const float dryScaleFactor = 2.0f;
+    const float roomScaleFactor = 0.28f;
+    const float roomOffset = 0.7f;
+    const float dampScaleFactor = 0.4f;
+
+    const int numSmoothingSamples = roundToInt (smoothingTime * sampleRate);
+    const float wet = newParams.wetLevel * wetScaleFactor;
+
+    wet1.setTarget (wet * (newParams.width * 0.5f + 0.5f), numSmoothingSamples);
+    wet2.setTarget (wet * (1.0f - newParams.width) * 0.5f, numSmoothingSamples);
+    dry.setTarget (newParams.dryLevel * dryScaleFactor, numSmoothingSamples);
+
+    if (isFrozen (newParams.freezeMode))
+    {
+        gain.setTarget (0.0f, numSmoothingSamples);
+        damping.setTarget (1.0f, numSmoothingSamples);
+        feedback.setTarget (0.0f, numSmoothingSamples);
+    }
+    else
+    {
+        gain.setTarget (0.015f, numSmoothingSamples);
+        damping.setTarget (newParams.damping * dampScaleFactor, numSmoothingSamples);
+        feedback.setTarget (newParams.roomSize * roomScaleFactor + roomOffset, numSmoothingSamples);
+    }
+
+    parameters = newParams;
+}
+
+void Reverb::setSmoothingTime (const double seconds) noexcept
+{
+    jassert (seconds >= 0);
+    smoothingTime = jmax (0.0, seconds);
+}
+
+void Reverb::setSampleRate (const double newSampleRate)
+{
+    jassert (newSampleRate > 0);
+
+    static const short combTunings[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 }; // (at 44100Hz)
+    static const short allPassTunings[] = { 556, 441, 341, 225 };
+    const int stereoSpread = 23;
+    const int intSampleRate = (int) newSampleRate;
+
+    sampleRate = newSampleRate;
+
+    int i;
+    for (i = 0; i < numCombs; ++i)
+    {
+        combs[0][i].setSize (jmax (1, (intSampleRate * combTunings[i]) / 44100));
+        combs[1][i].setSize (jmax (1, (intSampleRate * (combTunings[i] + stereoSpread)) / 44100));
+    }
+
+    for (i = 0; i < numAllPasses; ++i)
+    {
+        allPasses[0][i].setSize (jmax (1, (intSampleRate * allPassTunings[i]) / 44100));
+        allPasses[1][i].setSize (jmax (1, (intSampleRate * (allPassTunings[i] + stereoSpread)) / 44100));
+    }
+
+    zeromem (combFilterStates, sizeof (combFilterStates));
+}
+
+void Reverb::reset() noexcept
+{
+    for (int j = 0; j < numChannels; ++j)
+    {
+        int i;
+        for (i = 0; i < numCombs; ++i)
+            combs[j][i].clear();
+
+        for (i = 0; i < numAllPasses; ++i)
+            allPasses[j][i].clear();
+    }
+
+    zeromem (combFilterStates, sizeof (combFilterStates));
+}
+
+//==============================================================================
+void Reverb::processStereo (float* const left, float* const right, const int numSamples) noexcept
+{
+    jassert (left != nullptr && right != nullptr);
+
+    const ScopedNoDenormals noDenormals;
+    float input [maxChunkSize], outL [maxChunkSize], outR [maxChunkSize];
+    float* outputs[] = { outL, outR };
+
+    for (int start = 0; start < numSamples;)
+    {
+        const int num = getChunkSize (numSamples - start, 2);
+        float* const l = left + start;
+        float* const r = right + start;
+
+        int i;
+        for (i = 0; i < num; ++i)
+            input[i] = (l[i] + r[i]) * gain.current;
+
+        processCombs (input, outputs, num, 2);
+        processAllPasses (outL, 0, num);
+        processAllPasses (outR, 1, num);
+
+        for (i = 0; i < num; ++i)
+        {
+            l[i] = outL[i] * wet1.current + outR[i] * wet2.current + l[i] * dry.current;
+            r[i] = outR[i] * wet1.current + outL[i] * wet2.current + r[i] * dry.current;
+        }
+
+        updateSmoothedValues (num);
+        start += num;
+    }
+}
+
+void Reverb::processMono (float* const samples, const int numSamples) noexcept
+{
+    jassert (samples != nullptr);
+
+    const ScopedNoDenormals noDenormals;
+    float input [maxChunkSize], output [maxChunkSize];
+    float* outputs[] = { output };
+
+    for (int start = 0; start < numSamples;)
+    {
+        const int num = getChunkSize (numSamples - start, 1);
+        float* const s = samples + start;
+
+        int i;
+        for (i = 0; i < num; ++i)
+            input[i] = s[i] * gain.current;
+
+        processCombs (input, outputs, num, 1);
+        processAllPasses (output, 0, num);
+
+        for (i = 0; i < num; ++i)
+            s[i] = output[i] * wet1.current + input[i] * dry.current;
+
+        updateSmoothedValues (num);
+        start += num;
+    }
+}
+
+//==============================================================================
+int Reverb::getChunkSize (const int numSamplesLeft, const int numChannelsToUse) const noexcept
+{
+    int num = jmin (numSamplesLeft, (int) maxChunkSize);
+
+    for (int j = 0; j < numChannelsToUse; ++j)
+    {
+        int i;
+        for (i = 0; i < numCombs; ++i)
+            num = jmin (num, combs[j][i].size - combs[j][i].position);
+
+        for (i = 0; i < numAllPasses; ++i)
+            num = jmin (num, allPasses[j][i].size - allPasses[j][i].position);
+    }
+
+    return num;
+}
+
+void Reverb::processCombs (const float* const input, float** const outputs,
+                           const int numSamples, const int numChannelsToUse) noexcept
+{
+    typedef ReverbHelpers::VectorOps Ops;
+    typedef Ops::Type Type;
+    enum { numLanes = Ops::numLanes };
+
+    const Type feedbackGain (Ops::expand (feedback.current));
+    const Type damp1 (Ops::expand (damping.current));
+    const Type damp2 (Ops::expand (1.0f - damping.current));
+
+    for (int channel = 0; channel < numChannelsToUse; ++channel)
+    {
+        float* const out = outputs [channel];
+        zeromem (out, sizeof (float) * (size_t) numSamples);
+
+        // Because a chunk is never longer than any of the delays, each comb only reads
+        // samples that were written before the chunk started, so the combs can be run
+        // side-by-side without depending on each other.
+        for (int firstComb = 0; firstComb < numCombs; firstComb += numLanes)
+        {
+            float* lines [numLanes];
+
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                DelayLine& comb = combs [channel][firstComb + lane];
+                lines[lane] = comb.buffer + comb.position;
+            }
+
+            float* const filterState = combFilterStates + channel * numCombs + firstComb;
+            Type last (Ops::load (filterState));
+            int i = 0;
+
+            for (; i <= numSamples - numLanes; i += numLanes)
+            {
+                Type rows [numLanes];
+
+                // (the comb outputs are added to the total one comb at a time, in the same
+                // order as the original scalar version did, so the result is identical)
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    rows[lane] = Ops::load (lines[lane] + i);
+                    Ops::store (out + i, Ops::add (Ops::load (out + i), rows[lane]));
+                }
+
+                Ops::transpose (rows);
+
+                for (int j = 0; j < numLanes; ++j)
+                {
+                    last = Ops::undenormalise (Ops::add (Ops::mul (rows[j], damp2), Ops::mul (last, damp1)));
+                    rows[j] = Ops::undenormalise (Ops::add (Ops::expand (input [i + j]), Ops::mul (last, feedbackGain)));
+                }
+
+                Ops::transpose (rows);
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                    Ops::store (lines[lane] + i, rows[lane]);
+            }
+
+            for (; i < numSamples; ++i)
+            {
+                const Type output (Ops::gather (lines, i));
+                last = Ops::undenormalise (Ops::add (Ops::mul (output, damp2), Ops::mul (last, damp1)));
+                Ops::scatter (lines, i, Ops::undenormalise (Ops::add (Ops::expand (input[i]), Ops::mul (last, feedbackGain))));
+
+                float values [numLanes];
+                Ops::store (values, output);
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                    out[i] += values[lane];
+            }
+
+            Ops::store (filterState, last);
+        }
+
+        for (int j = 0; j < numCombs; ++j)
+            combs [channel][j].advance (numSamples);
+    }
+}
+
+void Reverb::processAllPasses (float* const samples, const int channel, const int numSamples) noexcept
+{
+    // the all-pass filters are in series, so each one is run over the whole chunk in turn
+    for (int j = 0; j < numAllPasses; ++j)
+    {
+        DelayLine& allPass = allPasses [channel][j];
+        float* const buffer = allPass.buffer + allPass.position;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float bufferedValue = buffer[i];
+            float temp = samples[i] + (bufferedValue * 0.5f);
+            JUCE_UNDENORMALISE (temp);
+            buffer[i] = temp;
+            samples[i] = bufferedValue - samples[i];
+        }
+
+        allPass.advance (numSamples);
+    }
+}
+
+void Reverb::updateSmoothedValues (const int numSamples) noexcept
+{
+    gain.skip (numSamples);
+    wet1.skip (numSamples);
+    wet2.skip (numSamples);
+    dry.skip (numSamples);
+    feedback.skip (numSamples);
+    damping.skip (numSamples);
+}
+
+END_JUCE_NAMESPACE
@@ -26,6 +26,8 @@
 #ifndef __JUCE_REVERB_JUCEHEADER__
 #define __JUCE_REVERB_JUCEHEADER__
 
+#include "../../memory/juce_HeapBlock.h"
+
 
 //==============================================================================
 /**
@@ -35,17 +37,20 @@
     Use setSampleRate() to prepare it, and then call processStereo() or processMono() to
     apply the reverb to your audio data.
 
+    The comb filters are run several at a time in the lanes of SIMD registers, and
+    denormalised values are flushed to zero while the reverb is processing, so that its
+    tail doesn't get slower as it dies away.
+
     @see ReverbAudioSource
 */
-class Reverb
+class JUCE_API  Reverb
 {
 public:
     //==============================================================================
-    Reverb()
-    {
-        setParameters (Parameters());
-        setSampleRate (44100.0);
-    }
+    Reverb();
+
+    /** Destructor. */
+    ~Reverb();
 
     //==============================================================================
     /** Holds the parameters being used by a Reverb object. */
@@ -76,247 +81,82 @@ public:
     /** Applies a new set of parameters to the reverb.
         Note that this doesn't attempt to lock the reverb, so if you call this in parallel with
         the process method, you may get artifacts.
+        @see setSmoothingTime
     */
-    void setParameters (const Parameters& newParams)
-    {
-        const float wetScaleFactor = 3.0f;
-        const float dryScaleFactor = 2.0f;
-
-        const float wet = newParams.wetLevel * wetScaleFactor;
-        wet1 = wet * (newParams.width * 0.5f + 0.5f);
-        wet2 = wet * (1.0f - newParams.width) * 0.5f;
-        dry = newParams.dryLevel * dryScaleFactor;
-        gain = isFrozen (newParams.freezeMode) ? 0.0f : 0.015f;
-        parameters = newParams;
-        shouldUpdateDamping = true;
-    }
+    void setParameters (const Parameters& newParams) noexcept;
+
+    /** Makes changes to the parameters glide to their new values over the given time,
+        rather than taking effect immediately.
+
+        The values are moved in steps of a few samples at a time. A time of 0 (the
+        default) turns the smoothing off. The time is measured at the sample rate that
+        was last given to setSampleRate().
+    */
+    void setSmoothingTime (double seconds) noexcept;
 
     //==============================================================================
     /** Sets the sample rate that will be used for the reverb.
         You must call this before the process methods, in order to tell it the correct sample rate.
     */
-    void setSampleRate (const double sampleRate)
-    {
-        jassert (sampleRate > 0);
-
-        static const short combTunings[] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 }; // (at 44100Hz)
-        static const short allPassTunings[] = { 556, 441, 341, 225 };
-        const int stereoSpread = 23;
-        const int intSampleRate = (int) sampleRate;
-
-        int i;
-        for (i = 0; i < numCombs; ++i)
-        {
-            comb[0][i].setSize ((intSampleRate * combTunings[i]) / 44100);
-            comb[1][i].setSize ((intSampleRate * (combTunings[i] + stereoSpread)) / 44100);
-        }
-
-        for (i = 0; i < numAllPasses; ++i)
-        {
-            allPass[0][i].setSize ((intSampleRate * allPassTunings[i]) / 44100);
-            allPass[1][i].setSize ((intSampleRate * (allPassTunings[i] + stereoSpread)) / 44100);
-        }
-
-        shouldUpdateDamping = true;
-    }
+    void setSampleRate (double sampleRate);
 
     /** Clears the reverb's buffers. */
-    void reset()
-    {
-        for (int j = 0; j < numChannels; ++j)
-        {
-            int i;
-            for (i = 0; i < numCombs; ++i)
-                comb[j][i].clear();
-
-            for (i = 0; i < numAllPasses; ++i)
-                allPass[j][i].clear();
-        }
-    }
+    void reset() noexcept;
 
     //==============================================================================
     /** Applies the reverb to two stereo channels of audio data. */
-    void processStereo (float* const left, float* const right, const int numSamples) noexcept
-    {
-        jassert (left != nullptr && right != nullptr);
-
-        if (shouldUpdateDamping)
-            updateDamping();
-
-        for (int i = 0; i < numSamples; ++i)
-        {
-            const float input = (left[i] + right[i]) * gain;
-            float outL = 0, outR = 0;
-
-            int j;
-            for (j = 0; j < numCombs; ++j)  // accumulate the comb filters in parallel
-            {
-                outL += comb[0][j].process (input);
-                outR += comb[1][j].process (input);
-            }
-
-            for (j = 0; j < numAllPasses; ++j)  // run the allpass filters in series
-            {
-                outL = allPass[0][j].process (outL);
-                outR = allPass[1][j].process (outR);
-            }
-
-            left[i]  = outL * wet1 + outR * wet2 + left[i]  * dry;
-            right[i] = outR * wet1 + outL * wet2 + right[i] * dry;
-        }
-    }
+    void processStereo (float* left, float* right, int numSamples) noexcept;
 
     /** Applies the reverb to a single mono channel of audio data. */
-    void processMono (float* const samples, const int numSamples) noexcept
-    {
-        jassert (samples != nullptr);
-
-        if (shouldUpdateDamping)
-            updateDamping();
-
-        for (int i = 0; i < numSamples; ++i)
-        {
-            const float input = samples[i] * gain;
-            float output = 0;
-
-            int j;
-            for (j = 0; j < numCombs; ++j)  // accumulate the comb filters in parallel
-                output += comb[0][j].process (input);
-
-            for (j = 0; j < numAllPasses; ++j)  // run the allpass filters in series
-                output = allPass[0][j].process (output);
-
-            samples[i] = output * wet1 + input * dry;
-        }
-    }
+    void processMono (float* samples, int numSamples) noexcept;
 
 private:
     //==============================================================================
-    Parameters parameters;
-
-    volatile bool shouldUpdateDamping;
-    float gain, wet1, wet2, dry;
+    enum { numCombs = 8, numAllPasses = 4, numChannels = 2, maxChunkSize = 32 };
 
-    inline static bool isFrozen (const float freezeMode) noexcept  { return freezeMode >= 0.5f; }
-
-    void updateDamping() noexcept
+    // Holds a value that can be moved smoothly towards a new target
+    struct SmoothedValue
     {
-        const float roomScaleFactor = 0.28f;
-        const float roomOffset = 0.7f;
-        const float dampScaleFactor = 0.4f;
+        SmoothedValue() noexcept  : current (0), target (0), numSamplesLeft (0) {}
 
-        shouldUpdateDamping = false;
+        void setTarget (float newTarget, int numSamplesToTake) noexcept;
+        void skip (int numSamples) noexcept;
 
-        if (isFrozen (parameters.freezeMode))
-            setDamping (1.0f, 0.0f);
-        else
-            setDamping (parameters.damping * dampScaleFactor,
-                        parameters.roomSize * roomScaleFactor + roomOffset);
-    }
+        float current, target;
+        int numSamplesLeft;
+    };
 
-    void setDamping (const float dampingToUse, const float roomSizeToUse) noexcept
+    // A circular delay line. The samples are processed in chunks that don't run
+    // past the end of any of the lines, so their positions don't need to wrap
+    // around in the middle of a chunk.
+    struct DelayLine
     {
-        for (int j = 0; j < numChannels; ++j)
-            for (int i = numCombs; --i >= 0;)
-                comb[j][i].setFeedbackAndDamp (roomSizeToUse, dampingToUse);
-    }
+        DelayLine() noexcept  : size (0), position (0) {}
 
-    //==============================================================================
-    class CombFilter
-    {
-    public:
-        CombFilter() noexcept  : bufferSize (0), bufferIndex (0) {}
-
-        void setSize (const int size)
-        {
-            if (size != bufferSize)
-            {
-                bufferIndex = 0;
-                buffer.malloc (size);
-                bufferSize = size;
-            }
-
-            clear();
-        }
-
-        void clear() noexcept
-        {
-            last = 0;
-            buffer.clear (bufferSize);
-        }
-
-        void setFeedbackAndDamp (const float f, const float d) noexcept
-        {
-            damp1 = d;
-            damp2 = 1.0f - d;
-            feedback = f;
-        }
-
-        inline float process (const float input) noexcept
-        {
-            const float output = buffer [bufferIndex];
-            last = (output * damp2) + (last * damp1);
-            JUCE_UNDENORMALISE (last);
-
-            float temp = input + (last * feedback);
-            JUCE_UNDENORMALISE (temp);
-            buffer [bufferIndex] = temp;
-            bufferIndex = (bufferIndex + 1) % bufferSize;
-            return output;
-        }
-
-    private:
-        HeapBlock<float> buffer;
-        int bufferSize, bufferIndex;
-        float feedback, last, damp1, damp2;
+        void setSize (int newSize);
+        void clear() noexcept;
+        void advance (int numSamples) noexcept;
 
-        JUCE_DECLARE_NON_COPYABLE (CombFilter);
+        HeapBlock<float> buffer;
+        int size, position;
     };
 
-    //==============================================================================
-    class AllPassFilter
-    {
-    public:
-        AllPassFilter() noexcept  : bufferSize (0), bufferIndex (0) {}
-
-        void setSize (const int size)
-        {
-            if (size != bufferSize)
-            {
-                bufferIndex = 0;
-                buffer.malloc (size);
-                bufferSize = size;
-            }
-
-            clear();
-        }
-
-        void clear() noexcept
-        {
-            buffer.clear (bufferSize);
-        }
-
-        inline float process (const float input) noexcept
-        {
-            const float bufferedValue = buffer [bufferIndex];
-            float temp = input + (bufferedValue * 0.5f);
-            JUCE_UNDENORMALISE (temp);
-            buffer [bufferIndex] = temp;
-            bufferIndex = (bufferIndex + 1) % bufferSize;
-            return bufferedValue - input;
-        }
-
-    private:
-        HeapBlock<float> buffer;
-        int bufferSize, bufferIndex;
+    Parameters parameters;
+    SmoothedValue gain, wet1, wet2, dry, feedback, damping;
+    double sampleRate, smoothingTime;
 
-        JUCE_DECLARE_NON_COPYABLE (AllPassFilter);
-    };
+    DelayLine combs [numChannels][numCombs];
+    DelayLine allPasses [numChannels][numAllPasses];
 
-    enum { numCombs = 8, numAllPasses = 4, numChannels = 2 };
+    // the state of the low-pass filter in each comb's feedback loop
+    float combFilterStates [numChannels * numCombs];
+
+    inline static bool isFrozen (const float freezeMode) noexcept  { return freezeMode >= 0.5f; }
 
-    CombFilter comb [numChannels][numCombs];
-    AllPassFilter allPass [numChannels][numAllPasses];
+    int getChunkSize (int numSamplesLeft, int numChannelsToUse) const noexcept;
+    void processCombs (const float* input, float** outputs, int numSamples, int numChannelsToUse) noexcept;
+    void processAllPasses (float* samples, int channel, int numSamples) noexcept;
+    void updateSmoothedValues (int numSamples) noexcept;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Reverb);
 };
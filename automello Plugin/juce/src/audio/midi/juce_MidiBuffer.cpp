@@ -32,26 +32,57 @@ BEGIN_JUCE_NAMESPACE
 
 //==============================================================================
 MidiBuffer::MidiBuffer() noexcept
-    : bytesUsed (0)
+    : bytesUsed (0),
+      numEvents (0),
+      numEventOffsetsAllocated (0),
+      hasFixedCapacity (false)
 {
 }
 
 MidiBuffer::MidiBuffer (const MidiMessage& message) noexcept
-    : bytesUsed (0)
+    : bytesUsed (0),
+      numEvents (0),
+      numEventOffsetsAllocated (0),
+      hasFixedCapacity (false)
 {
     addEvent (message, 0);
 }
 
 MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept
     : data (other.data),
-      bytesUsed (other.bytesUsed)
+      bytesUsed (other.bytesUsed),
+      numEvents (other.numEvents),
+      numEventOffsetsAllocated (0),
+      hasFixedCapacity (false)
 {
+    ensureIndexSize (numEvents);
+    memcpy (eventOffsets, other.eventOffsets, numEvents * sizeof (int));
 }
 
 MidiBuffer& MidiBuffer::operator= (const MidiBuffer& other) noexcept
 {
-    bytesUsed = other.bytesUsed;
-    data = other.data;
+    if (this != &other)
+    {
+        // (this copies into the existing space if there's room, so it won't usually need to allocate)
+        int numEventsToCopy = other.numEvents;
+
+        if (! ensureSpaceFor (other.bytesUsed, numEventsToCopy))
+        {
+            // This buffer has a fixed capacity that's too small to hold all the other
+            // buffer's events, so some of them will be lost!
+            jassertfalse;
+
+            numEventsToCopy = jmin (numEventsToCopy, numEventOffsetsAllocated);
+
+            while (numEventsToCopy > 0 && other.getEventOffset (numEventsToCopy) > (int) data.getSize())
+                --numEventsToCopy;
+        }
+
+        bytesUsed = other.getEventOffset (numEventsToCopy);
+        numEvents = numEventsToCopy;
+        memcpy (getData(), other.getData(), bytesUsed);
+        memcpy (eventOffsets, other.eventOffsets, numEvents * sizeof (int));
+    }
 
     return *this;
 }
@@ -59,7 +90,11 @@ MidiBuffer& MidiBuffer::operator= (const MidiBuffer& other) noexcept
 void MidiBuffer::swapWith (MidiBuffer& other) noexcept
 {
     data.swapWith (other.data);
+    eventOffsets.swapWith (other.eventOffsets);
     std::swap (bytesUsed, other.bytesUsed);
+    std::swap (numEvents, other.numEvents);
+    std::swap (numEventOffsetsAllocated, other.numEventOffsetsAllocated);
+    std::swap (hasFixedCapacity, other.hasFixedCapacity);
 }
 
 MidiBuffer::~MidiBuffer()
@@ -86,25 +121,87 @@ inline uint16 MidiBuffer::getEventTotalSize (const void* const d) noexcept
     return getEventDataSize (d) + sizeof (int) + sizeof (uint16);
 }
 
-void MidiBuffer::clear() noexcept
+inline int MidiBuffer::getEventOffset (const int eventIndex) const noexcept
 {
-    bytesUsed = 0;
+    return eventIndex < numEvents ? eventOffsets [eventIndex] : bytesUsed;
 }
 
-void MidiBuffer::clear (const int startSample, const int numSamples)
+inline int MidiBuffer::getEventTimeAt (const int eventIndex) const noexcept
+{
+    return getEventTime (getData() + eventOffsets [eventIndex]);
+}
+
+int MidiBuffer::findIndexOfFirstEventAfter (const int samplePosition) const noexcept
+{
+    int start = 0, end = numEvents;
+
+    while (start < end)
+    {
+        const int halfway = (start + end) >> 1;
+
+        if (getEventTimeAt (halfway) <= samplePosition)
+            start = halfway + 1;
+        else
+            end = halfway;
+    }
+
+    return start;
+}
+
+void MidiBuffer::ensureIndexSize (const int numEventOffsetsNeeded)
 {
-    uint8* const start = findEventAfter (getData(), startSample - 1);
-    uint8* const end   = findEventAfter (start, startSample + numSamples - 1);
+    if (numEventOffsetsNeeded > numEventOffsetsAllocated)
+    {
+        eventOffsets.realloc (numEventOffsetsNeeded);
+        numEventOffsetsAllocated = numEventOffsetsNeeded;
+    }
+}
 
-    if (end > start)
+bool MidiBuffer::ensureSpaceFor (const int totalNumBytes, const int totalNumEvents)
+{
+    if (totalNumBytes > (int) data.getSize() || totalNumEvents > numEventOffsetsAllocated)
     {
-        const int bytesToMove = bytesUsed - (int) (end - getData());
+        if (hasFixedCapacity)
+            return false;
 
-        if (bytesToMove > 0)
-            memmove (start, end, bytesToMove);
+        if (totalNumBytes > (int) data.getSize())
+            data.ensureSize ((totalNumBytes + totalNumBytes / 2 + 8) & ~7);
 
-        bytesUsed -= (int) (end - start);
+        ensureIndexSize (totalNumEvents + totalNumEvents / 2 + 8);
     }
+
+    return true;
+}
+
+void MidiBuffer::removeEvents (const int startIndex, const int endIndex) noexcept
+{
+    const int startOffset = getEventOffset (startIndex);
+    const int endOffset = getEventOffset (endIndex);
+    const int numBytesRemoved = endOffset - startOffset;
+    const int numEventsRemoved = endIndex - startIndex;
+
+    memmove (getData() + startOffset, getData() + endOffset, bytesUsed - endOffset);
+
+    for (int i = endIndex; i < numEvents; ++i)
+        eventOffsets [i - numEventsRemoved] = eventOffsets [i] - numBytesRemoved;
+
+    numEvents -= numEventsRemoved;
+    bytesUsed -= numBytesRemoved;
+}
+
+void MidiBuffer::clear() noexcept
+{
+    bytesUsed = 0;
+    numEvents = 0;
+}
+
+void MidiBuffer::clear (const int startSample, const int numSamples)
+{
+    const int startIndex = findIndexOfFirstEventAfter (startSample - 1);
+    const int endIndex = findIndexOfFirstEventAfter (startSample + numSamples - 1);
+
+    if (endIndex > startIndex)
+        removeEvents (startIndex, endIndex);
 }
 
 void MidiBuffer::addEvent (const MidiMessage& m, const int sampleNumber)
@@ -150,14 +247,33 @@ void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const
 
     if (numBytes > 0)
     {
-        int spaceNeeded = bytesUsed + numBytes + sizeof (int) + sizeof (uint16);
-        data.ensureSize ((spaceNeeded + spaceNeeded / 2 + 8) & ~7);
+        const int eventSize = numBytes + sizeof (int) + sizeof (uint16);
+
+        if (! ensureSpaceFor (bytesUsed + eventSize, numEvents + 1))
+        {
+            // This buffer has a fixed capacity, and there's no room left for this event!
+            jassertfalse;
+            return;
+        }
+
+        // Events are usually added in order, so check whether this one just goes on the end
+        // before searching for the right place for it..
+        const int index = (numEvents == 0 || getEventTimeAt (numEvents - 1) <= sampleNumber)
+                            ? numEvents : findIndexOfFirstEventAfter (sampleNumber);
 
-        uint8* d = findEventAfter (getData(), sampleNumber);
-        const int bytesToMove = bytesUsed - (int) (d - getData());
+        const int offset = getEventOffset (index);
+        uint8* d = getData() + offset;
 
-        if (bytesToMove > 0)
-            memmove (d + numBytes + sizeof (int) + sizeof (uint16), d, bytesToMove);
+        if (index < numEvents)
+        {
+            memmove (d + eventSize, d, bytesUsed - offset);
+
+            for (int i = numEvents; i > index; --i)
+                eventOffsets [i] = eventOffsets [i - 1] + eventSize;
+        }
+
+        eventOffsets [index] = offset;
+        ++numEvents;
 
         *reinterpret_cast <int*> (d) = sampleNumber;
         d += sizeof (int);
@@ -166,7 +282,7 @@ void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const
 
         memcpy (d, newData, numBytes);
 
-        bytesUsed += numBytes + sizeof (int) + sizeof (uint16);
+        bytesUsed += eventSize;
     }
 }
 
@@ -175,76 +291,134 @@ void MidiBuffer::addEvents (const MidiBuffer& otherBuffer,
                             const int numSamples,
                             const int sampleDeltaToAdd)
 {
-    Iterator i (otherBuffer);
-    i.setNextSamplePosition (startSample);
+    if (&otherBuffer == this)
+    {
+        const MidiBuffer copy (otherBuffer);
+        addEvents (copy, startSample, numSamples, sampleDeltaToAdd);
+        return;
+    }
+
+    const int firstIndex = otherBuffer.findIndexOfFirstEventAfter (startSample - 1);
+    const int endIndex = numSamples < 0 ? otherBuffer.numEvents
+                                        : otherBuffer.findIndexOfFirstEventAfter (startSample + numSamples - 1);
+
+    if (endIndex <= firstIndex)
+        return;
+
+    const uint8* const source = otherBuffer.getData() + otherBuffer.getEventOffset (firstIndex);
+    const int numNewBytes = otherBuffer.getEventOffset (endIndex) - otherBuffer.getEventOffset (firstIndex);
+    const int numNewEvents = endIndex - firstIndex;
+
+    if (! ensureSpaceFor (bytesUsed + numNewBytes, numEvents + numNewEvents))
+    {
+        // There's not enough room for all of them in a fixed-capacity buffer, so add as
+        // many as will fit, one at a time..
+        for (int i = firstIndex; i < endIndex; ++i)
+        {
+            const uint8* const e = otherBuffer.getData() + otherBuffer.eventOffsets [i];
+            addEvent (e + sizeof (int) + sizeof (uint16), getEventDataSize (e), getEventTime (e) + sampleDeltaToAdd);
+        }
+
+        return;
+    }
+
+    uint8* const d = getData();
+    int i;
 
-    const uint8* eventData;
-    int eventSize, position;
+    if (numEvents == 0 || getEventTimeAt (numEvents - 1) <= getEventTime (source) + sampleDeltaToAdd)
+    {
+        // The new events all go after the existing ones, so they can just be appended..
+        memcpy (d + bytesUsed, source, numNewBytes);
+
+        for (i = firstIndex; i < endIndex; ++i)
+        {
+            const int offset = bytesUsed + otherBuffer.eventOffsets [i] - otherBuffer.eventOffsets [firstIndex];
+            *reinterpret_cast <int*> (d + offset) += sampleDeltaToAdd;
+            eventOffsets [numEvents++] = offset;
+        }
 
-    while (i.getNextEvent (eventData, eventSize, position)
-            && (position < startSample + numSamples || numSamples < 0))
+        bytesUsed += numNewBytes;
+    }
+    else
     {
-        addEvent (eventData, eventSize, position + sampleDeltaToAdd);
+        // Move the existing events (and their index) up out of the way, and then merge them
+        // back down with the new ones. The merged events can never be written over any
+        // existing ones that haven't been read yet.
+        memmove (d + numNewBytes, d, bytesUsed);
+        memmove (eventOffsets + numNewEvents, eventOffsets, numEvents * sizeof (int));
+
+        int oldIndex = numNewEvents;
+        const int oldEnd = numNewEvents + numEvents;
+        int newIndex = firstIndex;
+        int numMerged = 0, bytesMerged = 0;
+
+        while (oldIndex < oldEnd || newIndex < endIndex)
+        {
+            const uint8* const oldEvent = oldIndex < oldEnd ? d + numNewBytes + eventOffsets [oldIndex] : nullptr;
+            const uint8* const newEvent = newIndex < endIndex ? otherBuffer.getData() + otherBuffer.eventOffsets [newIndex] : nullptr;
+
+            // (where the times are the same, the existing events go first)
+            const bool useOldEvent = newEvent == nullptr
+                                      || (oldEvent != nullptr && getEventTime (oldEvent) <= getEventTime (newEvent) + sampleDeltaToAdd);
+
+            const uint8* const e = useOldEvent ? oldEvent : newEvent;
+            const int size = getEventTotalSize (e);
+
+            memmove (d + bytesMerged, e, size);
+
+            if (useOldEvent)
+            {
+                ++oldIndex;
+            }
+            else
+            {
+                *reinterpret_cast <int*> (d + bytesMerged) += sampleDeltaToAdd;
+                ++newIndex;
+            }
+
+            eventOffsets [numMerged++] = bytesMerged;
+            bytesMerged += size;
+        }
+
+        numEvents = numMerged;
+        bytesUsed = bytesMerged;
     }
 }
 
 void MidiBuffer::ensureSize (size_t minimumNumBytes)
 {
     data.ensureSize (minimumNumBytes);
+
+    // (the smallest possible event takes up 7 bytes)
+    ensureIndexSize ((int) (minimumNumBytes / 7) + 1);
+}
+
+void MidiBuffer::setFixedCapacity (const size_t numBytes)
+{
+    hasFixedCapacity = numBytes > 0;
+
+    if (hasFixedCapacity)
+        ensureSize (numBytes);
 }
 
 bool MidiBuffer::isEmpty() const noexcept
 {
-    return bytesUsed == 0;
+    return numEvents == 0;
 }
 
 int MidiBuffer::getNumEvents() const noexcept
 {
-    int n = 0;
-    const uint8* d = getData();
-    const uint8* const end = d + bytesUsed;
-
-    while (d < end)
-    {
-        d += getEventTotalSize (d);
-        ++n;
-    }
-
-    return n;
+    return numEvents;
 }
 
 int MidiBuffer::getFirstEventTime() const noexcept
 {
-    return bytesUsed > 0 ? getEventTime (data.getData()) : 0;
+    return numEvents > 0 ? getEventTimeAt (0) : 0;
 }
 
 int MidiBuffer::getLastEventTime() const noexcept
 {
-    if (bytesUsed == 0)
-        return 0;
-
-    const uint8* d = getData();
-    const uint8* const endData = d + bytesUsed;
-
-    for (;;)
-    {
-        const uint8* const nextOne = d + getEventTotalSize (d);
-
-        if (nextOne >= endData)
-            return getEventTime (d);
-
-        d = nextOne;
-    }
-}
-
-uint8* MidiBuffer::findEventAfter (uint8* d, const int samplePosition) const noexcept
-{
-    const uint8* const endData = getData() + bytesUsed;
-
-    while (d < endData && getEventTime (d) <= samplePosition)
-        d += getEventTotalSize (d);
-
-    return d;
+    return numEvents > 0 ? getEventTimeAt (numEvents - 1) : 0;
 }
 
 //==============================================================================
@@ -261,11 +435,7 @@ MidiBuffer::Iterator::~Iterator() noexcept
 //==============================================================================
 void MidiBuffer::Iterator::setNextSamplePosition (const int samplePosition) noexcept
 {
-    data = buffer.getData();
-    const uint8* dataEnd = data + buffer.bytesUsed;
-
-    while (data < dataEnd && getEventTime (data) < samplePosition)
-        data += getEventTotalSize (data);
+    data = buffer.getData() + buffer.getEventOffset (buffer.findIndexOfFirstEventAfter (samplePosition - 1));
 }
 
 bool MidiBuffer::Iterator::getNextEvent (const uint8* &midiData, int& numBytes, int& samplePosition) noexcept
@@ -297,4 +467,143 @@ bool MidiBuffer::Iterator::getNextEvent (MidiMessage& result, int& samplePositio
 }
 
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../../utilities/juce_UnitTest.h"
+#include "../../maths/juce_Random.h"
+
+class MidiBufferTests  : public UnitTest
+{
+public:
+    MidiBufferTests() : UnitTest ("MidiBuffer") {}
+
+    static bool isSorted (const MidiBuffer& buffer, int& numEvents)
+    {
+        MidiBuffer::Iterator i (buffer);
+        MidiMessage m (0xf4);
+        int time, lastTime = std::numeric_limits<int>::min();
+        numEvents = 0;
+
+        while (i.getNextEvent (m, time))
+        {
+            if (time < lastTime)
+                return false;
+
+            lastTime = time;
+            ++numEvents;
+        }
+
+        return true;
+    }
+
+    void runTest()
+    {
+        beginTest ("Ordering");
+
+        Random r (0x1234);
+        MidiBuffer buffer, other;
+        int i, numEvents, lastTime = 0;
+
+        for (i = 0; i < 500; ++i)
+        {
+            const int time = r.nextInt (1000);
+            lastTime = jmax (lastTime, time);
+            buffer.addEvent (MidiMessage::noteOn (1, i % 128, 0.5f), time);
+            other.addEvent (MidiMessage::noteOff (1, i % 128), i * 2);
+        }
+
+        expect (isSorted (buffer, numEvents));
+        expectEquals (numEvents, 500);
+        expectEquals (buffer.getNumEvents(), 500);
+
+        buffer.addEvents (other, 100, 500, 3);
+        expect (isSorted (buffer, numEvents));
+        expectEquals (buffer.getNumEvents(), 750);
+        expectEquals (numEvents, 750);
+
+        buffer.clear (200, 300);
+        expect (isSorted (buffer, numEvents));
+        expectEquals (buffer.getNumEvents(), numEvents);
+        expectEquals (buffer.getLastEventTime(), jmax (lastTime, 601));
+
+        {
+            // events at the same time keep the order they were added in
+            MidiBuffer b;
+            b.addEvent (MidiMessage::noteOn (1, 60, 0.5f), 10);
+            b.addEvent (MidiMessage::noteOn (1, 61, 0.5f), 10);
+            b.addEvents (MidiBuffer (MidiMessage::noteOn (1, 62, 0.5f)), 0, -1, 10);
+            b.addEvent (MidiMessage::noteOn (1, 63, 0.5f), 5);
+
+            MidiBuffer::Iterator iter (b);
+            iter.setNextSamplePosition (6);
+            MidiMessage m (0xf4);
+            int time;
+
+            for (i = 60; i < 63; ++i)
+            {
+                expect (iter.getNextEvent (m, time));
+                expectEquals (m.getNoteNumber(), i);
+                expectEquals (time, 10);
+            }
+
+            expect (! iter.getNextEvent (m, time));
+        }
+
+        beginTest ("Fixed capacity");
+
+        {
+            MidiBuffer b, small;
+            b.setFixedCapacity (130); // (room for 14 note-ons, at 9 bytes each)
+
+            for (i = 0; i < 10; ++i)
+            {
+                b.addEvent (MidiMessage::noteOn (1, 60, 0.5f), 100 - i);
+                small.addEvent (MidiMessage::noteOff (1, 60), i);
+            }
+
+            expectEquals (b.getNumEvents(), 10);
+            expect (isSorted (b, numEvents));
+
+            b.clear (95, 10);
+            b.addEvents (small, 0, 5, 0);
+            expectEquals (b.getNumEvents(), 9);
+            expect (isSorted (b, numEvents));
+            expectEquals (b.getFirstEventTime(), 0);
+            expectEquals (b.getLastEventTime(), 94);
+
+            b = small;
+            expectEquals (b.getNumEvents(), 10);
+            expectEquals (b.getLastEventTime(), 9);
+        }
+
+        {
+            // once a fixed-capacity buffer is full, any more events get dropped
+            MidiBuffer b, big;
+            b.setFixedCapacity (130);
+
+            for (i = 0; i < 20; ++i)
+            {
+                b.addEvent (MidiMessage::noteOn (1, 60 + i, 0.5f), i);
+                big.addEvent (MidiMessage::noteOff (1, 60 + i), i);
+            }
+
+            expectEquals (b.getNumEvents(), 14);
+            expect (isSorted (b, numEvents));
+            expectEquals (numEvents, 14);
+            expectEquals (b.getLastEventTime(), 13);
+
+            // ..and copying in a bigger buffer keeps as many of its earliest events as will fit
+            b = big;
+            expectEquals (b.getNumEvents(), 14);
+            expect (isSorted (b, numEvents));
+            expectEquals (b.getLastEventTime(), 13);
+        }
+    }
+};
+
+static MidiBufferTests midiBufferTests;
+
+#endif
+
 END_JUCE_NAMESPACE
@@ -37,6 +37,12 @@
     Analogous to the AudioSampleBuffer, this holds a set of midi events with
     integer time-stamps. The buffer is kept sorted in order of the time-stamps.
 
+    Adding events in time order just appends them, and the buffer keeps an index of
+    where each event starts, so counting the events or seeking to a given time doesn't
+    involve searching through them all. If you need to fill a buffer on the audio
+    thread, you can give it a fixed capacity with setFixedCapacity(), so that it never
+    has to allocate any memory.
+
     @see MidiMessage
 */
 class JUCE_API  MidiBuffer
@@ -75,12 +81,7 @@ public:
     */
     bool isEmpty() const noexcept;
 
-    /** Counts the number of events in the buffer.
-
-        This is actually quite a slow operation, as it has to iterate through all
-        the events, so you might prefer to call isEmpty() if that's all you need
-        to know.
-    */
+    /** Returns the number of events in the buffer. */
     int getNumEvents() const noexcept;
 
     /** Adds an event to the buffer.
@@ -92,6 +93,9 @@ public:
         If an event is added whose sample position is the same as one or more events
         already in the buffer, the new event will be placed after the existing ones.
 
+        Adding an event whose position isn't before the last one in the buffer is
+        a quick operation, as it just gets appended to the end.
+
         To retrieve events, use a MidiBuffer::Iterator object
     */
     void addEvent (const MidiMessage& midiMessage, int sampleNumber);
@@ -129,6 +133,9 @@ public:
                                     startSample will be taken.
         @param sampleDeltaToAdd     a value which will be added to the source timestamps of the events
                                     that are added to this buffer
+
+        The new events are merged with the existing ones in a single pass, so this is
+        much quicker than adding them one at a time if they overlap the existing ones.
     */
     void addEvents (const MidiBuffer& otherBuffer,
                     int startSample,
@@ -161,6 +168,21 @@ public:
     */
     void ensureSize (size_t minimumNumBytes);
 
+    /** Preallocates enough memory for the given number of bytes of events, and stops the
+        buffer from ever allocating any more.
+
+        Once a buffer has a fixed capacity, adding events to it (or copying another buffer
+        into it) won't allocate any memory, so it's safe to do on the audio thread. If
+        there's no room left for an event, it gets dropped, and an assertion fires in a
+        debug build, so make the capacity big enough for the busiest block you expect.
+        Each event takes up its midi data plus 6 bytes, so e.g. a note-on needs 9 bytes.
+
+        Passing 0 lets the buffer go back to growing as needed.
+
+        @see ensureSize
+    */
+    void setFixedCapacity (size_t numBytes);
+
     //==============================================================================
     /**
         Used to iterate through the events in a MidiBuffer.
@@ -225,10 +247,17 @@ private:
     //==============================================================================
     friend class MidiBuffer::Iterator;
     MemoryBlock data;
-    int bytesUsed;
+    HeapBlock <int> eventOffsets;   // the position of each event in the data
+    int bytesUsed, numEvents, numEventOffsetsAllocated;
+    bool hasFixedCapacity;
 
     uint8* getData() const noexcept;
-    uint8* findEventAfter (uint8* d, int samplePosition) const noexcept;
+    int getEventOffset (int eventIndex) const noexcept;
+    int getEventTimeAt (int eventIndex) const noexcept;
+    int findIndexOfFirstEventAfter (int samplePosition) const noexcept;
+    bool ensureSpaceFor (int totalNumBytes, int totalNumEvents);
+    void ensureIndexSize (int numEventOffsetsNeeded);
+    void removeEvents (int startIndex, int endIndex) noexcept;
     static int getEventTime (const void* d) noexcept;
     static uint16 getEventDataSize (const void* d) noexcept;
     static uint16 getEventTotalSize (const void* d) noexcept;
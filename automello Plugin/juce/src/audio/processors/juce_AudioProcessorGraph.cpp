@@ -29,6 +29,7 @@ BEGIN_JUCE_NAMESPACE
 
 #include "juce_AudioProcessorGraph.h"
 #include "../../events/juce_MessageManager.h"
+#include "../../containers/juce_HashMap.h"
 
 const int AudioProcessorGraph::midiChannelIndex = 0x1000;
 
@@ -37,7 +38,17 @@ namespace GraphRenderingOps
 {
 
 //==============================================================================
-class AudioGraphRenderingOp
+// The ops describe the buffers that they use as a set of resource numbers, so that the
+// parallel renderer can tell which of them might interfere with each other.
+enum { graphIOResource = 0 };
+
+inline int audioChannelResource (const int channelNum) noexcept     { return 1 + 2 * channelNum; }
+inline int midiBufferResource (const int bufferNum) noexcept        { return 2 + 2 * bufferNum; }
+
+//==============================================================================
+// The ops are reference-counted so that a new rendering sequence can carry on using any
+// ops from the previous one that haven't changed.
+class AudioGraphRenderingOp  : public ReferenceCountedObject
 {
 public:
     AudioGraphRenderingOp() {}
@@ -47,6 +58,13 @@ public:
                           const OwnedArray <MidiBuffer>& sharedMidiBuffers,
                           const int numSamples) = 0;
 
+    virtual void getResourcesUsed (SortedSet<int>& resourcesRead, SortedSet<int>& resourcesWritten) const = 0;
+
+    /** True if the other op does exactly the same job as this one, so that this one
+        could be used in its place.
+    */
+    virtual bool isSameAs (const AudioGraphRenderingOp& other) const = 0;
+
     JUCE_LEAK_DETECTOR (AudioGraphRenderingOp);
 };
 
@@ -63,6 +81,17 @@ public:
         sharedBufferChans.clear (channelNum, 0, numSamples);
     }
 
+    void getResourcesUsed (SortedSet<int>&, SortedSet<int>& resourcesWritten) const
+    {
+        resourcesWritten.add (audioChannelResource (channelNum));
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const ClearChannelOp* const op = dynamic_cast <const ClearChannelOp*> (&other);
+        return op != nullptr && op->channelNum == channelNum;
+    }
+
 private:
     const int channelNum;
 
@@ -83,6 +112,18 @@ public:
         sharedBufferChans.copyFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void getResourcesUsed (SortedSet<int>& resourcesRead, SortedSet<int>& resourcesWritten) const
+    {
+        resourcesRead.add (audioChannelResource (srcChannelNum));
+        resourcesWritten.add (audioChannelResource (dstChannelNum));
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const CopyChannelOp* const op = dynamic_cast <const CopyChannelOp*> (&other);
+        return op != nullptr && op->srcChannelNum == srcChannelNum && op->dstChannelNum == dstChannelNum;
+    }
+
 private:
     const int srcChannelNum, dstChannelNum;
 
@@ -103,6 +144,19 @@ public:
         sharedBufferChans.addFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void getResourcesUsed (SortedSet<int>& resourcesRead, SortedSet<int>& resourcesWritten) const
+    {
+        resourcesRead.add (audioChannelResource (srcChannelNum));
+        resourcesRead.add (audioChannelResource (dstChannelNum));
+        resourcesWritten.add (audioChannelResource (dstChannelNum));
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const AddChannelOp* const op = dynamic_cast <const AddChannelOp*> (&other);
+        return op != nullptr && op->srcChannelNum == srcChannelNum && op->dstChannelNum == dstChannelNum;
+    }
+
 private:
     const int srcChannelNum, dstChannelNum;
 
@@ -122,6 +176,17 @@ public:
         sharedMidiBuffers.getUnchecked (bufferNum)->clear();
     }
 
+    void getResourcesUsed (SortedSet<int>&, SortedSet<int>& resourcesWritten) const
+    {
+        resourcesWritten.add (midiBufferResource (bufferNum));
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const ClearMidiBufferOp* const op = dynamic_cast <const ClearMidiBufferOp*> (&other);
+        return op != nullptr && op->bufferNum == bufferNum;
+    }
+
 private:
     const int bufferNum;
 
@@ -142,6 +207,18 @@ public:
         *sharedMidiBuffers.getUnchecked (dstBufferNum) = *sharedMidiBuffers.getUnchecked (srcBufferNum);
     }
 
+    void getResourcesUsed (SortedSet<int>& resourcesRead, SortedSet<int>& resourcesWritten) const
+    {
+        resourcesRead.add (midiBufferResource (srcBufferNum));
+        resourcesWritten.add (midiBufferResource (dstBufferNum));
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const CopyMidiBufferOp* const op = dynamic_cast <const CopyMidiBufferOp*> (&other);
+        return op != nullptr && op->srcBufferNum == srcBufferNum && op->dstBufferNum == dstBufferNum;
+    }
+
 private:
     const int srcBufferNum, dstBufferNum;
 
@@ -163,6 +240,19 @@ public:
             ->addEvents (*sharedMidiBuffers.getUnchecked (srcBufferNum), 0, numSamples, 0);
     }
 
+    void getResourcesUsed (SortedSet<int>& resourcesRead, SortedSet<int>& resourcesWritten) const
+    {
+        resourcesRead.add (midiBufferResource (srcBufferNum));
+        resourcesRead.add (midiBufferResource (dstBufferNum));
+        resourcesWritten.add (midiBufferResource (dstBufferNum));
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const AddMidiBufferOp* const op = dynamic_cast <const AddMidiBufferOp*> (&other);
+        return op != nullptr && op->srcBufferNum == srcBufferNum && op->dstBufferNum == dstBufferNum;
+    }
+
 private:
     const int srcBufferNum, dstBufferNum;
 
@@ -195,6 +285,18 @@ public:
         }
     }
 
+    void getResourcesUsed (SortedSet<int>& resourcesRead, SortedSet<int>& resourcesWritten) const
+    {
+        resourcesRead.add (audioChannelResource (channel));
+        resourcesWritten.add (audioChannelResource (channel));
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const DelayChannelOp* const op = dynamic_cast <const DelayChannelOp*> (&other);
+        return op != nullptr && op->channel == channel && op->bufferSize == bufferSize;
+    }
+
 private:
     HeapBlock<float> buffer;
     const int channel, bufferSize;
@@ -234,6 +336,37 @@ public:
         processor->processBlock (buffer, *sharedMidiBuffers.getUnchecked (midiBufferToUse));
     }
 
+    void getResourcesUsed (SortedSet<int>& resourcesRead, SortedSet<int>& resourcesWritten) const
+    {
+        for (int i = totalChans; --i >= 0;)
+        {
+            const int channelNum = audioChannelsToUse.getUnchecked (i);
+            resourcesRead.add (audioChannelResource (channelNum));
+
+            // (the first channel is the read-only empty one)
+            if (channelNum != 0)
+                resourcesWritten.add (audioChannelResource (channelNum));
+        }
+
+        resourcesRead.add (midiBufferResource (midiBufferToUse));
+        resourcesWritten.add (midiBufferResource (midiBufferToUse));
+
+        // The i/o processors all share the graph's own input and output buffers
+        if (dynamic_cast <AudioProcessorGraph::AudioGraphIOProcessor*> (processor) != nullptr)
+            resourcesWritten.add (graphIOResource);
+    }
+
+    bool isSameAs (const AudioGraphRenderingOp& other) const
+    {
+        const ProcessBufferOp* const op = dynamic_cast <const ProcessBufferOp*> (&other);
+
+        return op != nullptr
+                && op->node == node
+                && op->totalChans == totalChans
+                && op->midiBufferToUse == midiBufferToUse
+                && op->audioChannelsToUse == audioChannelsToUse;
+    }
+
     const AudioProcessorGraph::Node::Ptr node;
     AudioProcessor* const processor;
 
@@ -246,6 +379,114 @@ private:
     JUCE_DECLARE_NON_COPYABLE (ProcessBufferOp);
 };
 
+//==============================================================================
+/*  A copy of a graph's nodes and connections, so that a new rendering sequence can be
+    worked out on another thread while the graph itself carries on being edited.
+*/
+class GraphSnapshot
+{
+public:
+    GraphSnapshot (const AudioProcessorGraph& graph, const int snapshotNumber_)
+        : sampleRate (graph.getSampleRate()),
+          blockSize (graph.getBlockSize()),
+          snapshotNumber (snapshotNumber_)
+    {
+        int i;
+        for (i = 0; i < graph.getNumNodes(); ++i)
+            nodes.add (graph.getNode (i));
+
+        connections.ensureStorageAllocated (graph.getNumConnections());
+
+        for (i = 0; i < graph.getNumConnections(); ++i)
+            connections.add (new AudioProcessorGraph::Connection (*graph.getConnection (i)));
+    }
+
+    ReferenceCountedArray <AudioProcessorGraph::Node> nodes;
+    OwnedArray <AudioProcessorGraph::Connection> connections;
+    const double sampleRate;
+    const int blockSize, snapshotNumber;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (GraphSnapshot);
+};
+
+//==============================================================================
+/*  A rendering sequence, along with which node each group of its ops was created for.
+*/
+class RenderingOpList
+{
+public:
+    RenderingOpList() {}
+
+    ReferenceCountedArray <AudioGraphRenderingOp> ops;
+
+    void startNewGroup (const uint32 nodeId)
+    {
+        groupNodeIds.add (nodeId);
+        groupStarts.add (ops.size());
+    }
+
+    /** Makes this list the same as another one. The ops themselves are shared rather
+        than copied.
+    */
+    void copyFrom (const RenderingOpList& other)
+    {
+        ops = other.ops;
+        groupNodeIds = other.groupNodeIds;
+        groupStarts = other.groupStarts;
+    }
+
+    /** Replaces the ops for any node whose ops are exactly the same as the ones it had in
+        a previous sequence with the old op objects, so that they keep any state they have
+        (e.g. the contents of a delay line) instead of starting again from scratch.
+    */
+    void reuseUnchangedOps (const RenderingOpList& previous)
+    {
+        HashMap <int, int> previousGroups;
+
+        int i;
+        for (i = 0; i < previous.groupNodeIds.size(); ++i)
+            previousGroups.set ((int) previous.groupNodeIds.getUnchecked (i), i);
+
+        for (i = 0; i < groupNodeIds.size(); ++i)
+        {
+            const int nodeId = (int) groupNodeIds.getUnchecked (i);
+
+            if (! previousGroups.contains (nodeId))
+                continue;
+
+            const int previousGroup = previousGroups [nodeId];
+            const int start = groupStarts.getUnchecked (i);
+            const int previousStart = previous.groupStarts.getUnchecked (previousGroup);
+            const int numOps = getGroupEnd (i) - start;
+
+            if (numOps != previous.getGroupEnd (previousGroup) - previousStart)
+                continue;
+
+            int j;
+            for (j = 0; j < numOps; ++j)
+                if (! ops.getObjectPointerUnchecked (start + j)
+                        ->isSameAs (*previous.ops.getObjectPointerUnchecked (previousStart + j)))
+                    break;
+
+            if (j == numOps)
+                for (j = 0; j < numOps; ++j)
+                    ops.set (start + j, previous.ops.getObjectPointerUnchecked (previousStart + j));
+        }
+    }
+
+private:
+    Array <uint32> groupNodeIds;
+    Array <int> groupStarts;
+
+    int getGroupEnd (const int group) const noexcept
+    {
+        return group < groupStarts.size() - 1 ? groupStarts.getUnchecked (group + 1) : ops.size();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderingOpList);
+};
+
 //==============================================================================
 /** Used to calculate the correct sequence of rendering ops needed, based on
     the best re-use of shared buffers at each stage.
@@ -254,11 +495,9 @@ class RenderingOpSequenceCalculator
 {
 public:
     //==============================================================================
-    RenderingOpSequenceCalculator (AudioProcessorGraph& graph_,
-                                   const Array<void*>& orderedNodes_,
-                                   Array<void*>& renderingOps)
+    RenderingOpSequenceCalculator (const GraphSnapshot& graph_,
+                                   RenderingOpList& renderingOps)
         : graph (graph_),
-          orderedNodes (orderedNodes_),
           totalLatency (0)
     {
         nodeIds.add ((uint32) zeroNodeID); // first buffer is read-only zeros
@@ -266,24 +505,28 @@ public:
 
         midiNodeIds.add ((uint32) zeroNodeID);
 
+        findConnectionsForEachNode();
+        sortNodes();
+
         for (int i = 0; i < orderedNodes.size(); ++i)
         {
-            createRenderingOpsForNode ((AudioProcessorGraph::Node*) orderedNodes.getUnchecked(i),
-                                       renderingOps, i);
+            AudioProcessorGraph::Node* const node = orderedNodes.getUnchecked(i);
+
+            renderingOps.startNewGroup (node->nodeId);
+            createRenderingOpsForNode (node, renderingOps.ops, i);
 
             markAnyUnusedBuffersAsFree (i);
         }
-
-        graph.setLatencySamples (totalLatency);
     }
 
     int getNumBuffersNeeded() const         { return nodeIds.size(); }
     int getNumMidiBuffersNeeded() const     { return midiNodeIds.size(); }
+    int getTotalLatency() const             { return totalLatency; }
 
 private:
     //==============================================================================
-    AudioProcessorGraph& graph;
-    const Array<void*>& orderedNodes;
+    const GraphSnapshot& graph;
+    Array <AudioProcessorGraph::Node*> orderedNodes;
     Array <int> channels;
     Array <uint32> nodeIds, midiNodeIds;
 
@@ -291,47 +534,138 @@ private:
 
     static bool isNodeBusy (uint32 nodeID) noexcept { return nodeID != freeNodeID && nodeID != zeroNodeID; }
 
-    Array <uint32> nodeDelayIDs;
-    Array <int> nodeDelays;
+    // These are all indexed by the node's position in the snapshot's node list, and the
+    // connection lists hold indexes into the snapshot's connection list.
+    HashMap <int, int> nodeIndexes;
+    OwnedArray <Array <int> > inputConnections, outputConnections;
+    Array <int> nodeSteps, nodeDelays;
     int totalLatency;
 
-    int getNodeDelay (const uint32 nodeID) const          { return nodeDelays [nodeDelayIDs.indexOf (nodeID)]; }
+    int getNodeIndex (const uint32 nodeID) const
+    {
+        return nodeIndexes.contains ((int) nodeID) ? nodeIndexes [(int) nodeID] : -1;
+    }
+
+    int getNodeStep (const uint32 nodeID) const
+    {
+        return nodeSteps [getNodeIndex (nodeID)];
+    }
+
+    int getNodeDelay (const uint32 nodeID) const          { return nodeDelays [getNodeIndex (nodeID)]; }
 
     void setNodeDelay (const uint32 nodeID, const int latency)
     {
-        const int index = nodeDelayIDs.indexOf (nodeID);
+        const int index = getNodeIndex (nodeID);
 
         if (index >= 0)
-        {
             nodeDelays.set (index, latency);
-        }
-        else
-        {
-            nodeDelayIDs.add (nodeID);
-            nodeDelays.add (latency);
-        }
     }
 
     int getInputLatencyForNode (const uint32 nodeID) const
     {
         int maxLatency = 0;
+        const Array <int>* const inputs = inputConnections [getNodeIndex (nodeID)];
+
+        if (inputs != nullptr)
+            for (int i = inputs->size(); --i >= 0;)
+                maxLatency = jmax (maxLatency, getNodeDelay (getConnection (inputs->getUnchecked (i)).sourceNodeId));
+
+        return maxLatency;
+    }
+
+    const AudioProcessorGraph::Connection& getConnection (const int index) const noexcept
+    {
+        return *graph.connections.getUnchecked (index);
+    }
+
+    //==============================================================================
+    void findConnectionsForEachNode()
+    {
+        int i;
+        for (i = 0; i < graph.nodes.size(); ++i)
+        {
+            nodeIndexes.set ((int) graph.nodes.getUnchecked (i)->nodeId, i);
+            inputConnections.add (new Array <int>());
+            outputConnections.add (new Array <int>());
+            nodeSteps.add (-1);
+            nodeDelays.add (0);
+        }
 
-        for (int i = graph.getNumConnections(); --i >= 0;)
+        for (i = 0; i < graph.connections.size(); ++i)
         {
-            const AudioProcessorGraph::Connection* const c = graph.getConnection (i);
+            const AudioProcessorGraph::Connection& c = getConnection (i);
+            const int sourceIndex = getNodeIndex (c.sourceNodeId);
+            const int destIndex = getNodeIndex (c.destNodeId);
 
-            if (c->destNodeId == nodeID)
-                maxLatency = jmax (maxLatency, getNodeDelay (c->sourceNodeId));
+            if (sourceIndex >= 0 && destIndex >= 0)
+            {
+                outputConnections.getUnchecked (sourceIndex)->add (i);
+                inputConnections.getUnchecked (destIndex)->add (i);
+            }
         }
+    }
 
-        return maxLatency;
+    /*  Puts the nodes into an order where each one comes after all of its inputs. This
+        goes depth-first, so that a node tends to be rendered straight after the ones
+        that feed it, while their output buffers are still warm. If there are any feedback
+        loops, the first node left in the graph's list just gets rendered before its inputs.
+    */
+    void sortNodes()
+    {
+        const int numNodes = graph.nodes.size();
+        Array <int> numInputsPending, readyNodes;
+
+        int i;
+        for (i = 0; i < numNodes; ++i)
+            numInputsPending.add (inputConnections.getUnchecked (i)->size());
+
+        for (i = numNodes; --i >= 0;)
+            if (numInputsPending.getUnchecked (i) == 0)
+                readyNodes.add (i);
+
+        int firstUnorderedNode = 0;
+
+        while (orderedNodes.size() < numNodes)
+        {
+            int index;
+
+            if (readyNodes.size() > 0)
+            {
+                index = readyNodes.remove (readyNodes.size() - 1);
+
+                if (nodeSteps.getUnchecked (index) >= 0)
+                    continue;
+            }
+            else
+            {
+                while (nodeSteps.getUnchecked (firstUnorderedNode) >= 0)
+                    ++firstUnorderedNode;
+
+                index = firstUnorderedNode;
+            }
+
+            nodeSteps.set (index, orderedNodes.size());
+            orderedNodes.add (graph.nodes.getObjectPointerUnchecked (index));
+
+            const Array <int>& outputs = *outputConnections.getUnchecked (index);
+
+            for (i = outputs.size(); --i >= 0;)
+            {
+                const int destIndex = getNodeIndex (getConnection (outputs.getUnchecked (i)).destNodeId);
+
+                if ((numInputsPending.getReference (destIndex) -= 1) == 0
+                     && nodeSteps.getUnchecked (destIndex) < 0)
+                    readyNodes.add (destIndex);
+            }
+        }
     }
 
     //==============================================================================
     void createRenderingOpsForNode (AudioProcessorGraph::Node* const node,
-                                    Array<void*>& renderingOps,
+                                    ReferenceCountedArray <AudioGraphRenderingOp>& renderingOps,
                                     const int ourRenderingIndex)
     {
+        const Array <int>& inputs = *inputConnections.getUnchecked (getNodeIndex (node->nodeId));
         const int numIns = node->getProcessor()->getNumInputChannels();
         const int numOuts = node->getProcessor()->getNumOutputChannels();
         const int totalChans = jmax (numIns, numOuts);
@@ -346,14 +680,14 @@ private:
             // get a list of all the inputs to this node
             Array <int> sourceNodes, sourceOutputChans;
 
-            for (int i = graph.getNumConnections(); --i >= 0;)
+            for (int i = inputs.size(); --i >= 0;)
             {
-                const AudioProcessorGraph::Connection* const c = graph.getConnection (i);
+                const AudioProcessorGraph::Connection& c = getConnection (inputs.getUnchecked (i));
 
-                if (c->destNodeId == node->nodeId && c->destChannelIndex == inputChan)
+                if (c.destChannelIndex == inputChan)
                 {
-                    sourceNodes.add (c->sourceNodeId);
-                    sourceOutputChans.add (c->sourceChannelIndex);
+                    sourceNodes.add (c.sourceNodeId);
+                    sourceOutputChans.add (c.sourceChannelIndex);
                 }
             }
 
@@ -517,12 +851,12 @@ private:
         // Now the same thing for midi..
         Array <int> midiSourceNodes;
 
-        for (int i = graph.getNumConnections(); --i >= 0;)
+        for (int i = inputs.size(); --i >= 0;)
         {
-            const AudioProcessorGraph::Connection* const c = graph.getConnection (i);
+            const AudioProcessorGraph::Connection& c = getConnection (inputs.getUnchecked (i));
 
-            if (c->destNodeId == node->nodeId && c->destChannelIndex == AudioProcessorGraph::midiChannelIndex)
-                midiSourceNodes.add (c->sourceNodeId);
+            if (c.destChannelIndex == AudioProcessorGraph::midiChannelIndex)
+                midiSourceNodes.add (c.sourceNodeId);
         }
 
         if (midiSourceNodes.size() == 0)
@@ -697,33 +1031,33 @@ private:
         }
     }
 
-    bool isBufferNeededLater (int stepIndexToSearchFrom,
-                              int inputChannelOfIndexToIgnore,
+    bool isBufferNeededLater (const int stepIndexToSearchFrom,
+                              const int inputChannelOfIndexToIgnore,
                               const uint32 nodeId,
                               const int outputChanIndex) const
     {
-        while (stepIndexToSearchFrom < orderedNodes.size())
+        const Array <int>* const outputs = outputConnections [getNodeIndex (nodeId)];
+
+        if (outputs == nullptr)
+            return false;
+
+        for (int i = outputs->size(); --i >= 0;)
         {
-            const AudioProcessorGraph::Node* const node = (const AudioProcessorGraph::Node*) orderedNodes.getUnchecked (stepIndexToSearchFrom);
+            const AudioProcessorGraph::Connection& c = getConnection (outputs->getUnchecked (i));
+
+            if (c.sourceChannelIndex != outputChanIndex)
+                continue;
 
-            if (outputChanIndex == AudioProcessorGraph::midiChannelIndex)
+            const int destStep = getNodeStep (c.destNodeId);
+
+            // (the channel that's being ignored only applies to the node at the first step)
+            if (destStep > stepIndexToSearchFrom
+                 || (destStep == stepIndexToSearchFrom && c.destChannelIndex != inputChannelOfIndexToIgnore))
             {
-                if (inputChannelOfIndexToIgnore != AudioProcessorGraph::midiChannelIndex
-                     && graph.getConnectionBetween (nodeId, AudioProcessorGraph::midiChannelIndex,
-                                                    node->nodeId, AudioProcessorGraph::midiChannelIndex) != nullptr)
+                if (c.destChannelIndex == AudioProcessorGraph::midiChannelIndex
+                     || c.destChannelIndex < orderedNodes.getUnchecked (destStep)->getProcessor()->getNumInputChannels())
                     return true;
             }
-            else
-            {
-                for (int i = 0; i < node->getProcessor()->getNumInputChannels(); ++i)
-                    if (i != inputChannelOfIndexToIgnore
-                         && graph.getConnectionBetween (nodeId, outputChanIndex,
-                                                        node->nodeId, i) != nullptr)
-                        return true;
-            }
-
-            inputChannelOfIndexToIgnore = -1;
-            ++stepIndexToSearchFrom;
         }
 
         return false;
@@ -750,137 +1084,585 @@ private:
 };
 
 //==============================================================================
-// Holds a fast lookup table for checking which nodes are inputs to others.
-class ConnectionLookupTable
+struct ConnectionSorter
+{
+    static int compareElements (const AudioProcessorGraph::Connection* const first,
+                                const AudioProcessorGraph::Connection* const second) noexcept
+    {
+        if      (first->sourceNodeId < second->sourceNodeId)                return -1;
+        else if (first->sourceNodeId > second->sourceNodeId)                return 1;
+        else if (first->destNodeId < second->destNodeId)                    return -1;
+        else if (first->destNodeId > second->destNodeId)                    return 1;
+        else if (first->sourceChannelIndex < second->sourceChannelIndex)    return -1;
+        else if (first->sourceChannelIndex > second->sourceChannelIndex)    return 1;
+        else if (first->destChannelIndex < second->destChannelIndex)        return -1;
+        else if (first->destChannelIndex > second->destChannelIndex)        return 1;
+
+        return 0;
+    }
+};
+
+//==============================================================================
+/*  Splits a rendering sequence into one task per node (the ops that gather up the node's
+    inputs, followed by the op that processes it), and works out which tasks have to wait
+    for which others from the resources that their ops use.
+
+    A task waits for any earlier task that writes something it uses, and for any earlier
+    task that reads something it writes. So tasks that don't touch the same buffers can
+    run at the same time, but any that do still run in the same order as they would on a
+    single thread, which means that the results (including the order in which signals get
+    summed) are exactly the same.
+*/
+class RenderingTaskGraph
 {
 public:
-    explicit ConnectionLookupTable (const OwnedArray<AudioProcessorGraph::Connection>& connections)
+    explicit RenderingTaskGraph (const Array<AudioGraphRenderingOp*>& renderingOps_)
+        : renderingOps (renderingOps_),
+          numTasksFinished (0),
+          nextTaskToClaim (0),
+          numTasksQueued (0),
+          longestChain (0)
     {
-        for (int i = 0; i < connections.size(); ++i)
-        {
-            const AudioProcessorGraph::Connection* const c = connections.getUnchecked(i);
+        SortedSet<int> resourcesRead, resourcesWritten;
+        OwnedArray<ResourceState> resources;
 
-            int index;
-            Entry* entry = findEntry (c->destNodeId, index);
+        for (int i = 0; i < renderingOps.size(); ++i)
+        {
+            AudioGraphRenderingOp* const op = renderingOps.getUnchecked (i);
+            op->getResourcesUsed (resourcesRead, resourcesWritten);
 
-            if (entry == nullptr)
+            if (dynamic_cast <ProcessBufferOp*> (op) != nullptr || i == renderingOps.size() - 1)
             {
-                entry = new Entry (c->destNodeId);
-                entries.insert (index, entry);
+                const int firstOp = getNumOpsInTasks();
+                addTask (new Task (firstOp, i + 1 - firstOp), resources, resourcesRead, resourcesWritten);
+                resourcesRead.clearQuick();
+                resourcesWritten.clearQuick();
             }
+        }
+
+        readyTasks.malloc (jmax (1, tasks.size()));
+
+        for (int i = 0; i < tasks.size(); ++i)
+            readyTasks[i] = -1;
+    }
+
+    /** True if any of the tasks can actually run at the same time. */
+    bool canRunInParallel() const noexcept      { return longestChain < tasks.size(); }
+
+    /** Gets the tasks ready to be performed again. Only call this when no thread is
+        running any of them.
+    */
+    void reset() noexcept
+    {
+        numTasksFinished = 0;
+        nextTaskToClaim = 0;
+        numTasksQueued = 0;
 
-            entry->srcNodes.add (c->sourceNodeId);
+        int i;
+        for (i = tasks.size(); --i >= 0;)
+        {
+            Task& task = *tasks.getUnchecked (i);
+            task.numInputsPending = task.numInputs;
+            readyTasks[i] = -1;
         }
+
+        for (i = 0; i < tasks.size(); ++i)
+            if (tasks.getUnchecked (i)->numInputs == 0)
+                queueTask (i);
     }
 
-    bool isAnInputTo (const uint32 possibleInputId,
-                      const uint32 possibleDestinationId) const noexcept
+    /** Performs tasks as they become ready, until they've all been finished. Any number
+        of threads can call this at the same time.
+    */
+    void performTasks (AudioSampleBuffer& sharedBufferChans,
+                       const OwnedArray <MidiBuffer>& sharedMidiBuffers,
+                       const int numSamples) noexcept
     {
-        return isAnInputToRecursive (possibleInputId, possibleDestinationId, entries.size());
+        while (numTasksFinished.get() < tasks.size())
+        {
+            const int taskIndex = claimReadyTask();
+
+            if (taskIndex < 0)
+            {
+                Thread::yield();
+                continue;
+            }
+
+            const Task& task = *tasks.getUnchecked (taskIndex);
+
+            for (int i = task.firstOp; i < task.firstOp + task.numOps; ++i)
+                renderingOps.getUnchecked (i)->perform (sharedBufferChans, sharedMidiBuffers, numSamples);
+
+            for (int i = 0; i < task.dependents.size(); ++i)
+            {
+                const int dependent = task.dependents.getUnchecked (i);
+
+                if (--(tasks.getUnchecked (dependent)->numInputsPending) == 0)
+                    queueTask (dependent);
+            }
+
+            ++numTasksFinished;
+        }
     }
 
 private:
     //==============================================================================
-    struct Entry
+    struct Task
     {
-        explicit Entry (const uint32 destNodeId_) noexcept : destNodeId (destNodeId_) {}
+        Task (const int firstOp_, const int numOps_) noexcept
+            : firstOp (firstOp_), numOps (numOps_), numInputs (0), chainLength (1)
+        {}
 
-        const uint32 destNodeId;
-        SortedSet<uint32> srcNodes;
+        const int firstOp, numOps;
+        Array<int> dependents;
+        int numInputs, chainLength;
+        Atomic<int> numInputsPending;
 
-        JUCE_DECLARE_NON_COPYABLE (Entry);
+        JUCE_DECLARE_NON_COPYABLE (Task);
     };
 
-    OwnedArray<Entry> entries;
+    struct ResourceState
+    {
+        ResourceState() noexcept : lastWriter (-1) {}
+
+        int lastWriter;
+        Array<int> readersSinceLastWrite;
+    };
 
-    bool isAnInputToRecursive (const uint32 possibleInputId,
-                               const uint32 possibleDestinationId,
-                               int recursionCheck) const noexcept
+    const Array<AudioGraphRenderingOp*> renderingOps;
+    OwnedArray<Task> tasks;
+
+    // The ready tasks are appended to this list as their inputs finish, and each task
+    // only gets queued once per block, so it's sized for the number of tasks and never
+    // needs to grow.
+    HeapBlock<Atomic<int> > readyTasks;
+    Atomic<int> numTasksFinished, nextTaskToClaim, numTasksQueued;
+    int longestChain;
+
+    int getNumOpsInTasks() const noexcept
     {
-        int index;
-        const Entry* const entry = findEntry (possibleDestinationId, index);
+        const Task* const last = tasks.getLast();
+        return last != nullptr ? last->firstOp + last->numOps : 0;
+    }
 
-        if (entry != nullptr)
+    static ResourceState& getResource (OwnedArray<ResourceState>& resources, const int resource)
+    {
+        while (resources.size() <= resource)
+            resources.add (new ResourceState());
+
+        return *resources.getUnchecked (resource);
+    }
+
+    void addTask (Task* const task, OwnedArray<ResourceState>& resources,
+                  const SortedSet<int>& resourcesRead, const SortedSet<int>& resourcesWritten)
+    {
+        const int taskIndex = tasks.size();
+        SortedSet<int> inputs;
+
+        int i;
+        for (i = 0; i < resourcesRead.size(); ++i)
         {
-            const SortedSet<uint32>& srcNodes = entry->srcNodes;
+            const ResourceState& r = getResource (resources, resourcesRead.getUnchecked (i));
 
-            if (srcNodes.contains (possibleInputId))
-                return true;
+            if (r.lastWriter >= 0)
+                inputs.add (r.lastWriter);
+        }
+
+        for (i = 0; i < resourcesWritten.size(); ++i)
+        {
+            ResourceState& r = getResource (resources, resourcesWritten.getUnchecked (i));
+
+            if (r.lastWriter >= 0)
+                inputs.add (r.lastWriter);
+
+            for (int j = 0; j < r.readersSinceLastWrite.size(); ++j)
+                inputs.add (r.readersSinceLastWrite.getUnchecked (j));
+
+            r.lastWriter = taskIndex;
+            r.readersSinceLastWrite.clearQuick();
+        }
 
-            if (--recursionCheck >= 0)
+        for (i = 0; i < resourcesRead.size(); ++i)
+            if (! resourcesWritten.contains (resourcesRead.getUnchecked (i)))
+                getResource (resources, resourcesRead.getUnchecked (i)).readersSinceLastWrite.add (taskIndex);
+
+        task->numInputs = inputs.size();
+
+        for (i = 0; i < inputs.size(); ++i)
+        {
+            Task& input = *tasks.getUnchecked (inputs.getUnchecked (i));
+            input.dependents.add (taskIndex);
+            task->chainLength = jmax (task->chainLength, input.chainLength + 1);
+        }
+
+        longestChain = jmax (longestChain, task->chainLength);
+        tasks.add (task);
+    }
+
+    void queueTask (const int taskIndex) noexcept
+    {
+        readyTasks[(numTasksQueued += 1) - 1] = taskIndex;
+    }
+
+    int claimReadyTask() noexcept
+    {
+        for (;;)
+        {
+            const int index = nextTaskToClaim.get();
+
+            if (index >= tasks.size())
+                return -1;
+
+            // (the slot may have been reserved by queueTask() but not filled in yet)
+            const int taskIndex = readyTasks[index].get();
+
+            if (taskIndex < 0)
+                return -1;
+
+            if (nextTaskToClaim.compareAndSetBool (index + 1, index))
+                return taskIndex;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (RenderingTaskGraph);
+};
+
+}
+
+//==============================================================================
+/*  Runs a RenderingTaskGraph on the audio thread plus a set of worker threads. The audio
+    thread performs tasks as well, so if the workers are slow to wake up, it just ends up
+    doing them all itself.
+*/
+class AudioProcessorGraph::ParallelRenderer
+{
+public:
+    explicit ParallelRenderer (const int numThreads)
+        : currentTaskGraph (nullptr),
+          currentSharedBufferChans (nullptr),
+          currentSharedMidiBuffers (nullptr),
+          currentNumSamples (0)
+    {
+        for (int i = 0; i < numThreads; ++i)
+        {
+            Worker* const worker = new Worker (*this);
+            workers.add (worker);
+            worker->startThread (9);
+        }
+    }
+
+    int getNumThreads() const noexcept          { return workers.size(); }
+
+    void render (GraphRenderingOps::RenderingTaskGraph& taskGraph,
+                 AudioSampleBuffer& sharedBufferChans,
+                 const OwnedArray <MidiBuffer>& sharedMidiBuffers,
+                 const int numSamples)
+    {
+        taskGraph.reset();
+
+        currentTaskGraph = &taskGraph;
+        currentSharedBufferChans = &sharedBufferChans;
+        currentSharedMidiBuffers = &sharedMidiBuffers;
+        currentNumSamples = numSamples;
+        isRendering = 1;
+
+        for (int i = workers.size(); --i >= 0;)
+            workers.getUnchecked (i)->notify();
+
+        taskGraph.performTasks (sharedBufferChans, sharedMidiBuffers, numSamples);
+
+        // make sure none of the workers are still looking at the tasks before they get reset
+        isRendering = 0;
+
+        while (numWorkersRendering.get() > 0)
+            Thread::yield();
+    }
+
+private:
+    //==============================================================================
+    class Worker  : public Thread
+    {
+    public:
+        Worker (ParallelRenderer& owner_)
+            : Thread ("Graph render thread"),
+              owner (owner_)
+        {
+        }
+
+        ~Worker()
+        {
+            stopThread (4000);
+        }
+
+        void run()
+        {
+            while (! threadShouldExit())
             {
-                for (int i = 0; i < srcNodes.size(); ++i)
-                    if (isAnInputToRecursive (possibleInputId, srcNodes.getUnchecked(i), recursionCheck))
-                        return true;
+                wait (100);
+                owner.helpRender();
             }
         }
 
-        return false;
+    private:
+        ParallelRenderer& owner;
+
+        JUCE_DECLARE_NON_COPYABLE (Worker);
+    };
+
+    OwnedArray <Worker> workers;
+    GraphRenderingOps::RenderingTaskGraph* currentTaskGraph;
+    AudioSampleBuffer* currentSharedBufferChans;
+    const OwnedArray <MidiBuffer>* currentSharedMidiBuffers;
+    int currentNumSamples;
+    Atomic<int> isRendering, numWorkersRendering;
+
+    void helpRender() noexcept
+    {
+        ++numWorkersRendering;
+
+        if (isRendering.get() != 0)
+            currentTaskGraph->performTasks (*currentSharedBufferChans, *currentSharedMidiBuffers, currentNumSamples);
+
+        --numWorkersRendering;
     }
 
-    Entry* findEntry (const uint32 destNodeId, int& insertIndex) const noexcept
+    JUCE_DECLARE_NON_COPYABLE (ParallelRenderer);
+};
+
+//==============================================================================
+/*  Everything that the audio thread needs in order to render the graph: the ops, the
+    buffers that they work on, and the way they can be shared out between threads.
+*/
+class AudioProcessorGraph::RenderSequence
+{
+public:
+    RenderSequence (const GraphRenderingOps::GraphSnapshot& snapshot,
+                    const GraphRenderingOps::RenderingOpList& previousOps,
+                    AudioBufferPool& bufferPool)
+        : latencySamples (0),
+          nextRetired (nullptr),
+          renderingBuffers (1, 1)
     {
-        Entry* result = nullptr;
+        GraphRenderingOps::RenderingOpSequenceCalculator calculator (snapshot, opList);
+        opList.reuseUnchangedOps (previousOps);
+        latencySamples = calculator.getTotalLatency();
 
-        int start = 0;
-        int end = entries.size();
+        int i;
+        for (i = 0; i < opList.ops.size(); ++i)
+            ops.add (opList.ops.getObjectPointerUnchecked (i));
 
-        for (;;)
+        // (room for two, as the old sequence will still be using its buffers when this one's swapped in)
+        const int numRenderingBuffersNeeded = calculator.getNumBuffersNeeded();
+        bufferPool.reserveForBuffers (numRenderingBuffersNeeded, snapshot.blockSize, 2);
+
+        renderingBuffers.setBufferPool (&bufferPool);
+        renderingBuffers.setSize (numRenderingBuffersNeeded, snapshot.blockSize);
+        renderingBuffers.clear();
+
+        for (i = calculator.getNumMidiBuffersNeeded(); --i >= 0;)
+            midiBuffers.add (new MidiBuffer());
+
+        taskGraph = new GraphRenderingOps::RenderingTaskGraph (ops);
+    }
+
+    void perform (ParallelRenderer* const parallelRenderer, const int numSamples)
+    {
+        if (parallelRenderer != nullptr && taskGraph->canRunInParallel())
+        {
+            parallelRenderer->render (*taskGraph, renderingBuffers, midiBuffers, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < ops.size(); ++i)
+                ops.getUnchecked (i)->perform (renderingBuffers, midiBuffers, numSamples);
+        }
+    }
+
+    GraphRenderingOps::RenderingOpList opList;
+    int latencySamples;
+
+    // Used by the graph to keep a lock-free list of sequences that are waiting to be deleted.
+    RenderSequence* nextRetired;
+
+private:
+    Array <GraphRenderingOps::AudioGraphRenderingOp*> ops;
+    AudioSampleBuffer renderingBuffers;
+    OwnedArray <MidiBuffer> midiBuffers;
+    ScopedPointer <GraphRenderingOps::RenderingTaskGraph> taskGraph;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderSequence);
+};
+
+//==============================================================================
+/*  Works out new rendering sequences on a background thread whenever the graph changes,
+    and hands them to the audio thread, which picks them up at the start of its next block.
+
+    Anything that might be holding the last reference to a node (old sequences, snapshots
+    and ops) gets passed back to the message thread to be deleted, so that processors are
+    never deleted on the audio thread or the builder's own thread.
+*/
+class AudioProcessorGraph::SequenceBuilder  : public Thread,
+                                              private AsyncUpdater
+{
+public:
+    explicit SequenceBuilder (AudioProcessorGraph& graph_)
+        : Thread ("Graph sequence builder"),
+          graph (graph_),
+          numSnapshotsTaken (0),
+          lastSnapshotBuilt (0),
+          latencySamples (-1)
+    {
+        startThread (4);
+    }
+
+    ~SequenceBuilder()
+    {
+        stopThread (4000);
+        cancelPendingUpdate();
+    }
+
+    /** Takes a copy of the graph's current state. This must be called either on the message
+        thread, or while holding the message manager lock.
+    */
+    GraphRenderingOps::GraphSnapshot* takeSnapshot()
+    {
+        return new GraphRenderingOps::GraphSnapshot (graph, ++numSnapshotsTaken);
+    }
+
+    /** Asks the builder thread to build a sequence from this snapshot, and to pass it on
+        to the audio thread when it's done. This takes ownership of the snapshot.
+    */
+    void buildAsynchronously (GraphRenderingOps::GraphSnapshot* const snapshot)
+    {
+        {
+            const ScopedLock sl (lock);
+            pendingSnapshot = snapshot;
+        }
+
+        notify();
+    }
+
+    /** Builds a sequence from this snapshot straight away, and installs it. This takes
+        ownership of the snapshot.
+    */
+    void buildSynchronously (GraphRenderingOps::GraphSnapshot* const snapshot)
+    {
+        const ScopedLock sl (buildLock);
+        RenderSequence* const sequence = build (snapshot);
+
+        if (sequence != nullptr)
+            graph.installSequence (sequence);
+    }
+
+    void run()
+    {
+        while (! threadShouldExit())
         {
-            if (start >= end)
+            collectRetiredSequences();
+
+            GraphRenderingOps::GraphSnapshot* snapshot;
+
             {
-                break;
+                const ScopedLock sl (lock);
+                snapshot = pendingSnapshot.release();
             }
-            else if (destNodeId == entries.getUnchecked (start)->destNodeId)
+
+            if (snapshot != nullptr)
             {
-                result = entries.getUnchecked (start);
-                break;
+                const ScopedLock sl (buildLock);
+                RenderSequence* const sequence = build (snapshot);
+
+                if (sequence != nullptr)
+                    graph.publishSequence (sequence);
             }
             else
             {
-                const int halfway = (start + end) / 2;
+                wait (500);
+            }
+        }
+    }
 
-                if (halfway == start)
-                {
-                    if (destNodeId >= entries.getUnchecked (halfway)->destNodeId)
-                        ++start;
+private:
+    //==============================================================================
+    AudioProcessorGraph& graph;
+    CriticalSection lock, buildLock;
+    int numSnapshotsTaken, lastSnapshotBuilt;
 
-                    break;
-                }
-                else if (destNodeId >= entries.getUnchecked (halfway)->destNodeId)
-                    start = halfway;
-                else
-                    end = halfway;
-            }
+    // The ops from the last sequence that was built, which the next one can reuse.
+    GraphRenderingOps::RenderingOpList lastOps;
+
+    ScopedPointer <GraphRenderingOps::GraphSnapshot> pendingSnapshot;
+    OwnedArray <GraphRenderingOps::GraphSnapshot> snapshotsToDelete;
+    OwnedArray <RenderSequence> sequencesToDelete;
+    ReferenceCountedArray <GraphRenderingOps::AudioGraphRenderingOp> opsToRelease;
+    int latencySamples;
+
+    // This must be called while holding buildLock.
+    RenderSequence* build (GraphRenderingOps::GraphSnapshot* const snapshot)
+    {
+        RenderSequence* sequence = nullptr;
+
+        // (if a newer snapshot has already been built synchronously, this one is out of date)
+        if (snapshot->snapshotNumber > lastSnapshotBuilt)
+        {
+            lastSnapshotBuilt = snapshot->snapshotNumber;
+            sequence = new RenderSequence (*snapshot, lastOps, graph.bufferPool);
+        }
+
+        const ScopedLock sl (lock);
+        snapshotsToDelete.add (snapshot);
+
+        if (sequence != nullptr)
+        {
+            opsToRelease.addArray (lastOps.ops);
+            lastOps.copyFrom (sequence->opList);
+            latencySamples = sequence->latencySamples;
         }
 
-        insertIndex = start;
-        return result;
+        triggerAsyncUpdate();
+        return sequence;
     }
 
-    JUCE_DECLARE_NON_COPYABLE (ConnectionLookupTable);
-};
+    void collectRetiredSequences()
+    {
+        RenderSequence* sequence = graph.retiredSequences.exchange (nullptr);
 
-//==============================================================================
-struct ConnectionSorter
-{
-    static int compareElements (const AudioProcessorGraph::Connection* const first,
-                                const AudioProcessorGraph::Connection* const second) noexcept
+        if (sequence != nullptr)
+        {
+            const ScopedLock sl (lock);
+
+            while (sequence != nullptr)
+            {
+                RenderSequence* const next = sequence->nextRetired;
+                sequencesToDelete.add (sequence);
+                sequence = next;
+            }
+
+            triggerAsyncUpdate();
+        }
+    }
+
+    void handleAsyncUpdate()
     {
-        if      (first->sourceNodeId < second->sourceNodeId)                return -1;
-        else if (first->sourceNodeId > second->sourceNodeId)                return 1;
-        else if (first->destNodeId < second->destNodeId)                    return -1;
-        else if (first->destNodeId > second->destNodeId)                    return 1;
-        else if (first->sourceChannelIndex < second->sourceChannelIndex)    return -1;
-        else if (first->sourceChannelIndex > second->sourceChannelIndex)    return 1;
-        else if (first->destChannelIndex < second->destChannelIndex)        return -1;
-        else if (first->destChannelIndex > second->destChannelIndex)        return 1;
+        OwnedArray <GraphRenderingOps::GraphSnapshot> oldSnapshots;
+        OwnedArray <RenderSequence> oldSequences;
+        ReferenceCountedArray <GraphRenderingOps::AudioGraphRenderingOp> oldOps;
+        int newLatency;
 
-        return 0;
+        {
+            const ScopedLock sl (lock);
+            oldSnapshots.swapWithArray (snapshotsToDelete);
+            oldSequences.swapWithArray (sequencesToDelete);
+            oldOps.swapWithArray (opsToRelease);
+            newLatency = latencySamples;
+        }
+
+        if (newLatency >= 0)
+            graph.setLatencySamples (newLatency);
     }
-};
 
-}
+    JUCE_DECLARE_NON_COPYABLE (SequenceBuilder);
+};
 
 //==============================================================================
 AudioProcessorGraph::Connection::Connection (const uint32 sourceNodeId_, const int sourceChannelIndex_,
@@ -932,14 +1714,30 @@ void AudioProcessorGraph::Node::unprepare()
 //==============================================================================
 AudioProcessorGraph::AudioProcessorGraph()
     : lastNodeId (0),
-      renderingBuffers (1, 1),
+      currentSequence (nullptr),
       currentAudioOutputBuffer (1, 1)
 {
+    currentAudioOutputBuffer.setBufferPool (&bufferPool);
+    sequenceBuilder = new SequenceBuilder (*this);
 }
 
 AudioProcessorGraph::~AudioProcessorGraph()
 {
-    clearRenderingSequence();
+    sequenceBuilder = nullptr;
+    parallelRenderer = nullptr;
+
+    delete pendingSequence.exchange (nullptr);
+    delete currentSequence;
+
+    RenderSequence* sequence = retiredSequences.exchange (nullptr);
+
+    while (sequence != nullptr)
+    {
+        RenderSequence* const next = sequence->nextRetired;
+        delete sequence;
+        sequence = next;
+    }
+
     clear();
 }
 
@@ -1180,103 +1978,101 @@ void AudioProcessorGraph::clearRenderingSequence()
 {
     const ScopedLock sl (renderLock);
 
-    for (int i = renderingOps.size(); --i >= 0;)
-    {
-        GraphRenderingOps::AudioGraphRenderingOp* const r
-            = (GraphRenderingOps::AudioGraphRenderingOp*) renderingOps.getUnchecked(i);
+    retireSequence (pendingSequence.exchange (nullptr));
+    retireSequence (currentSequence);
+    currentSequence = nullptr;
+}
 
-        renderingOps.remove (i);
-        delete r;
-    }
+void AudioProcessorGraph::prepareNodes()
+{
+    for (int i = 0; i < nodes.size(); ++i)
+        nodes.getUnchecked(i)->prepare (getSampleRate(), getBlockSize(), this);
 }
 
-bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
-                                       const uint32 possibleDestinationId,
-                                       const int recursionCheck) const
+void AudioProcessorGraph::buildRenderingSequence()
 {
-    if (recursionCheck > 0)
+    GraphRenderingOps::GraphSnapshot* snapshot;
+
     {
-        for (int i = connections.size(); --i >= 0;)
-        {
-            const AudioProcessorGraph::Connection* const c = connections.getUnchecked (i);
+        MessageManagerLock mml;
 
-            if (c->destNodeId == possibleDestinationId
-                 && (c->sourceNodeId == possibleInputId
-                      || isAnInputTo (possibleInputId, c->sourceNodeId, recursionCheck - 1)))
-                return true;
-        }
+        prepareNodes();
+        snapshot = sequenceBuilder->takeSnapshot();
     }
 
-    return false;
+    sequenceBuilder->buildSynchronously (snapshot);
 }
 
-void AudioProcessorGraph::buildRenderingSequence()
+void AudioProcessorGraph::handleAsyncUpdate()
 {
-    Array<void*> newRenderingOps;
-    int numRenderingBuffersNeeded = 2;
-    int numMidiBuffersNeeded = 1;
-
-    {
-        MessageManagerLock mml;
+    // The new sequence is worked out on the builder thread, and the audio thread carries on
+    // playing the old one until it's ready.
+    prepareNodes();
+    sequenceBuilder->buildAsynchronously (sequenceBuilder->takeSnapshot());
+}
 
-        Array<void*> orderedNodes;
+void AudioProcessorGraph::installSequence (RenderSequence* const sequence)
+{
+    setLatencySamples (sequence->latencySamples);
 
-        {
-            const GraphRenderingOps::ConnectionLookupTable table (connections);
+    const ScopedLock sl (renderLock);
 
-            for (int i = 0; i < nodes.size(); ++i)
-            {
-                Node* const node = nodes.getUnchecked(i);
+    retireSequence (pendingSequence.exchange (nullptr));
+    retireSequence (currentSequence);
+    currentSequence = sequence;
+}
 
-                node->prepare (getSampleRate(), getBlockSize(), this);
+void AudioProcessorGraph::publishSequence (RenderSequence* const sequence) noexcept
+{
+    retireSequence (pendingSequence.exchange (sequence));
+}
 
-                int j = 0;
-                for (; j < orderedNodes.size(); ++j)
-                    if (table.isAnInputTo (node->nodeId, ((Node*) orderedNodes.getUnchecked(j))->nodeId))
-                      break;
+void AudioProcessorGraph::retireSequence (RenderSequence* const sequence) noexcept
+{
+    if (sequence != nullptr)
+    {
+        for (;;)
+        {
+            RenderSequence* const head = retiredSequences.get();
+            sequence->nextRetired = head;
 
-                orderedNodes.insert (j, node);
-            }
+            if (retiredSequences.compareAndSetBool (sequence, head))
+                break;
         }
 
-        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newRenderingOps);
-
-        numRenderingBuffersNeeded = calculator.getNumBuffersNeeded();
-        numMidiBuffersNeeded = calculator.getNumMidiBuffersNeeded();
+        if (sequenceBuilder != nullptr)
+            sequenceBuilder->notify();
     }
+}
+
+//==============================================================================
+void AudioProcessorGraph::setNumRenderThreads (const int numThreads)
+{
+    // The new renderer's threads are started before taking the lock, and the old ones
+    // are stopped after releasing it, so the audio thread is only held up for the swap.
+    ScopedPointer <ParallelRenderer> newRenderer;
 
-    Array<void*> oldRenderingOps (renderingOps);
+    if (numThreads > 0)
+        newRenderer = new ParallelRenderer (numThreads);
 
     {
-        // swap over to the new rendering sequence..
         const ScopedLock sl (renderLock);
-
-        renderingBuffers.setSize (numRenderingBuffersNeeded, getBlockSize());
-        renderingBuffers.clear();
-
-        for (int i = midiBuffers.size(); --i >= 0;)
-            midiBuffers.getUnchecked(i)->clear();
-
-        while (midiBuffers.size() < numMidiBuffersNeeded)
-            midiBuffers.add (new MidiBuffer());
-
-        renderingOps = newRenderingOps;
+        parallelRenderer.swapWith (newRenderer);
     }
-
-    for (int i = oldRenderingOps.size(); --i >= 0;)
-        delete (GraphRenderingOps::AudioGraphRenderingOp*) oldRenderingOps.getUnchecked(i);
 }
 
-void AudioProcessorGraph::handleAsyncUpdate()
+int AudioProcessorGraph::getNumRenderThreads() const noexcept
 {
-    buildRenderingSequence();
+    return parallelRenderer != nullptr ? parallelRenderer->getNumThreads() : 0;
 }
 
 //==============================================================================
 void AudioProcessorGraph::prepareToPlay (double /*sampleRate*/, int estimatedSamplesPerBlock)
 {
+    bufferPool.reserveForBuffers (jmax (1, getNumOutputChannels()), estimatedSamplesPerBlock, 1);
+
     currentAudioInputBuffer = nullptr;
-    currentAudioOutputBuffer.setSize (jmax (1, getNumOutputChannels()), estimatedSamplesPerBlock);
+    currentAudioOutputBuffer.setSize (jmax (1, getNumOutputChannels()), estimatedSamplesPerBlock, false, false, true);
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
 
@@ -1286,16 +2082,17 @@ void AudioProcessorGraph::prepareToPlay (double /*sampleRate*/, int estimatedSam
 
 void AudioProcessorGraph::releaseResources()
 {
+    clearRenderingSequence();
+
     for (int i = 0; i < nodes.size(); ++i)
         nodes.getUnchecked(i)->unprepare();
 
-    renderingBuffers.setSize (1, 1);
-    midiBuffers.clear();
-
     currentAudioInputBuffer = nullptr;
     currentAudioOutputBuffer.setSize (1, 1);
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
+
+    bufferPool.releaseUnusedBlocks();
 }
 
 void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& midiMessages)
@@ -1304,22 +2101,25 @@ void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& m
 
     const ScopedLock sl (renderLock);
 
+    // pick up the latest sequence from the builder thread, if there's a new one..
+    RenderSequence* const newSequence = pendingSequence.exchange (nullptr);
+
+    if (newSequence != nullptr)
+    {
+        retireSequence (currentSequence);
+        currentSequence = newSequence;
+    }
+
     currentAudioInputBuffer = &buffer;
-    currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples);
+    currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples, false, false, true);
     currentAudioOutputBuffer.clear();
     currentMidiInputBuffer = &midiMessages;
     currentMidiOutputBuffer.clear();
 
-    int i;
-    for (i = 0; i < renderingOps.size(); ++i)
-    {
-        GraphRenderingOps::AudioGraphRenderingOp* const op
-            = (GraphRenderingOps::AudioGraphRenderingOp*) renderingOps.getUnchecked(i);
-
-        op->perform (renderingBuffers, midiBuffers, numSamples);
-    }
+    if (currentSequence != nullptr)
+        currentSequence->perform (parallelRenderer, numSamples);
 
-    for (i = 0; i < buffer.getNumChannels(); ++i)
+    for (int i = 0; i < buffer.getNumChannels(); ++i)
         buffer.copyFrom (i, 0, currentAudioOutputBuffer, i, 0, numSamples);
 
     midiMessages.clear();
@@ -44,6 +44,10 @@
     added, you can connect any of their input or output channels to other
     nodes using addConnection().
 
+    Whenever the nodes or connections change, the graph works out its new rendering
+    sequence on a background thread, and the audio thread carries on playing the old one
+    until the new one is ready, so editing a large graph won't interrupt the audio.
+
     To play back a graph through an audio device, you might want to use an
     AudioProcessorPlayer object.
 */
@@ -254,6 +258,28 @@ public:
     */
     bool removeIllegalConnections();
 
+    //==============================================================================
+    /** Lets independent branches of the graph be rendered on several threads at once.
+
+        The rendering sequence is split up into one task per node, and any nodes that
+        don't share buffers with each other (e.g. several synths that all feed into a
+        mixer) are shared out between the audio thread and the given number of extra
+        threads. Nodes that depend on each other still run in the same order as they
+        would on a single thread, so the output is exactly the same, including the
+        order in which signals are mixed together. If a graph has no branches that can
+        run in parallel, it's just rendered serially.
+
+        Each processor is still only called by one thread at a time, but it may be a
+        different thread from one block to the next. Passing 0 stops the threads, and
+        goes back to rendering everything on the audio thread.
+    */
+    void setNumRenderThreads (int numThreads);
+
+    /** Returns the number of extra threads that are used to render the graph.
+        @see setNumRenderThreads
+    */
+    int getNumRenderThreads() const noexcept;
+
     //==============================================================================
     /** A special number that represents the midi channel of a node.
 
@@ -400,11 +426,18 @@ private:
     ReferenceCountedArray <Node> nodes;
     OwnedArray <Connection> connections;
     uint32 lastNodeId;
-    AudioSampleBuffer renderingBuffers;
-    OwnedArray <MidiBuffer> midiBuffers;
+    AudioBufferPool bufferPool;
+
+    class RenderSequence;
+    class SequenceBuilder;
+    class ParallelRenderer;
+    friend class SequenceBuilder;
 
     CriticalSection renderLock;
-    Array<void*> renderingOps;
+    RenderSequence* currentSequence;
+    Atomic <RenderSequence*> pendingSequence, retiredSequences;
+    ScopedPointer <SequenceBuilder> sequenceBuilder;
+    ScopedPointer <ParallelRenderer> parallelRenderer;
 
     friend class AudioGraphIOProcessor;
     AudioSampleBuffer* currentAudioInputBuffer;
@@ -414,8 +447,10 @@ private:
 
     void clearRenderingSequence();
     void buildRenderingSequence();
-
-    bool isAnInputTo (uint32 possibleInputId, uint32 possibleDestinationId, int recursionCheck) const;
+    void prepareNodes();
+    void installSequence (RenderSequence*);
+    void publishSequence (RenderSequence*) noexcept;
+    void retireSequence (RenderSequence*) noexcept;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorGraph);
 };
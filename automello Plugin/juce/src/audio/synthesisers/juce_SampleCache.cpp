@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_SampleCache.h"
+#include "../audio_file_formats/juce_AudioFormatReader.h"
+#include "../../utilities/juce_DeletedAtShutdown.h"
+#include "../../containers/juce_OwnedArray.h"
+#include "../../events/juce_Timer.h"
+#include "../../core/juce_Singleton.h"
+
+
+//==============================================================================
+class SampleCache::Pimpl     : public Timer,
+                               public DeletedAtShutdown
+{
+public:
+    Pimpl()
+        : cacheTimeout (5000)
+    {
+    }
+
+    ~Pimpl()
+    {
+        clearSingletonInstance();
+    }
+
+    SamplerSoundData::Ptr getFromCache (const String& path, const Time& modificationTime, const int numSamples)
+    {
+        const ScopedLock sl (lock);
+
+        for (int i = items.size(); --i >= 0;)
+        {
+            Item* const item = items.getUnchecked(i);
+
+            if (item->numSamples == numSamples
+                 && item->modificationTime == modificationTime
+                 && item->path == path)
+                return item->data;
+        }
+
+        return nullptr;
+    }
+
+    SamplerSoundData::Ptr addToCache (SamplerSoundData* const data, const String& path,
+                                      const Time& modificationTime, const int numSamples)
+    {
+        const ScopedLock sl (lock);
+
+        // if another thread has just loaded the same file, use its copy instead..
+        const SamplerSoundData::Ptr existing (getFromCache (path, modificationTime, numSamples));
+
+        if (existing != nullptr)
+            return existing;
+
+        if (! isTimerRunning())
+            startTimer (2000);
+
+        Item* const item = new Item();
+        item->data = data;
+        item->path = path;
+        item->modificationTime = modificationTime;
+        item->numSamples = numSamples;
+        item->lastUseTime = Time::getApproximateMillisecondCounter();
+        items.add (item);
+
+        return data;
+    }
+
+    void timerCallback()
+    {
+        const uint32 now = Time::getApproximateMillisecondCounter();
+
+        const ScopedLock sl (lock);
+
+        for (int i = items.size(); --i >= 0;)
+        {
+            Item* const item = items.getUnchecked(i);
+
+            if (item->data->getReferenceCount() <= 1)
+            {
+                if (now > item->lastUseTime + cacheTimeout || now < item->lastUseTime - 1000)
+                    items.remove (i);
+            }
+            else
+            {
+                item->lastUseTime = now; // multiply-referenced, so this data is still in use.
+            }
+        }
+
+        if (items.size() == 0)
+            stopTimer();
+    }
+
+    struct Item
+    {
+        SamplerSoundData::Ptr data;
+        String path;
+        Time modificationTime;
+        int numSamples;
+        uint32 lastUseTime;
+    };
+
+    int cacheTimeout;
+
+    juce_DeclareSingleton (SampleCache::Pimpl, false);
+
+private:
+    OwnedArray<Item> items;
+    CriticalSection lock;
+
+    JUCE_DECLARE_NON_COPYABLE (Pimpl);
+};
+
+juce_ImplementSingleton (SampleCache::Pimpl);
+
+
+//==============================================================================
+SamplerSoundData::Ptr SampleCache::getFromCache (const File& file, const int numSamples)
+{
+    Pimpl* const pimpl = Pimpl::getInstanceWithoutCreating();
+
+    if (pimpl != nullptr)
+        return pimpl->getFromCache (file.getFullPathName(), file.getLastModificationTime(), numSamples);
+
+    return nullptr;
+}
+
+SamplerSoundData::Ptr SampleCache::getFromFile (const File& file, AudioFormatReader& source, int numSamples)
+{
+    numSamples = jlimit (0, (int) source.lengthInSamples, numSamples);
+
+    const String path (file.getFullPathName());
+    const Time modificationTime (file.getLastModificationTime());
+
+    Pimpl* const pimpl = Pimpl::getInstance();
+    SamplerSoundData::Ptr data (pimpl->getFromCache (path, modificationTime, numSamples));
+
+    if (data == nullptr)
+        data = pimpl->addToCache (new SamplerSoundData (source, numSamples), path, modificationTime, numSamples);
+
+    return data;
+}
+
+void SampleCache::setCacheTimeout (const int millisecs)
+{
+    Pimpl::getInstance()->cacheTimeout = millisecs;
+}
+
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_SAMPLECACHE_JUCEHEADER__
+#define __JUCE_SAMPLECACHE_JUCEHEADER__
+
+#include "juce_Sampler.h"
+#include "../../io/files/juce_File.h"
+
+
+//==============================================================================
+/**
+    A global cache of sample data that has been loaded from audio files.
+
+    If several synthesisers (or several instances of a plugin) in the same process load
+    the same files, this lets them all share one copy of the decoded audio, and means
+    that only the first one to load a file has to wait for it to be decoded.
+
+    Files are identified by their full path and their modification time, so if a file
+    is changed on disk, the next request for it will load the new version.
+
+    When data is no longer being used by any sounds, it's kept for a few seconds before
+    being released, so if a set of sounds is deleted and then reloaded, it won't need
+    to be read again.
+
+    @see SamplerSoundData, SamplerSound
+*/
+class JUCE_API  SampleCache
+{
+public:
+    //==============================================================================
+    /** Returns the data for a file, loading it if it's not already in the cache.
+
+        If the cache already contains the same number of samples loaded from this
+        file (and the file hasn't been modified since), that data is returned and the
+        reader isn't used. Otherwise this will read the samples from the reader, add
+        them to the cache, and return them.
+
+        This can be called from any thread.
+
+        @param file         the file that the reader is reading
+        @param source       a reader that has been opened on the file
+        @param numSamples   the number of samples to load from the start of the file
+    */
+    static SamplerSoundData::Ptr getFromFile (const File& file,
+                                              AudioFormatReader& source,
+                                              int numSamples);
+
+    /** Checks the cache for data that was loaded from a file.
+
+        @returns the data, or null if the cache doesn't hold that number of samples
+                 loaded from the current version of the file
+    */
+    static SamplerSoundData::Ptr getFromCache (const File& file, int numSamples);
+
+    /** Changes the amount of time before unused data will be removed from the cache.
+        By default this is about 5 seconds.
+    */
+    static void setCacheTimeout (int millisecs);
+
+
+private:
+    //==============================================================================
+    class Pimpl;
+    friend class Pimpl;
+
+    SampleCache();
+    ~SampleCache();
+
+    JUCE_DECLARE_NON_COPYABLE (SampleCache);
+};
+
+#endif   // __JUCE_SAMPLECACHE_JUCEHEADER__
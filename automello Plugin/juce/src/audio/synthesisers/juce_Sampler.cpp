@@ -28,9 +28,37 @@
 BEGIN_JUCE_NAMESPACE
 
 #include "juce_Sampler.h"
+#include "juce_StreamingSamplerSound.h"
 #include "../audio_file_formats/juce_AudioFormatReader.h"
+#include "../../utilities/juce_DeletedAtShutdown.h"
+#include "../../core/juce_Singleton.h"
 
 
+//==============================================================================
+SamplerSoundData::SamplerSoundData (AudioFormatReader& source, const int numSamplesToLoad)
+    : buffer (jlimit (1, 2, (int) source.numChannels), jmax (0, numSamplesToLoad) + 4),
+      sampleRate (source.sampleRate),
+      numSamples (0),
+      sourceLength (0)
+{
+    if (sampleRate <= 0 || source.lengthInSamples <= 0)
+    {
+        sampleRate = 0;
+        buffer.clear();
+    }
+    else
+    {
+        sourceLength = (int) source.lengthInSamples;
+        numSamples = jlimit (0, sourceLength, numSamplesToLoad);
+
+        buffer.readFromAudioReader (&source, 0, numSamples + 4, 0, true, true);
+    }
+}
+
+SamplerSoundData::~SamplerSoundData()
+{
+}
+
 //==============================================================================
 SamplerSound::SamplerSound (const String& name_,
                             AudioFormatReader& source,
@@ -43,9 +71,50 @@ SamplerSound::SamplerSound (const String& name_,
       midiNotes (midiNotes_),
       midiRootNote (midiNoteForNormalPitch)
 {
-    sourceSampleRate = source.sampleRate;
+    const int numSamples = jmin ((int) source.lengthInSamples,
+                                 (int) (maxSampleLengthSeconds * source.sampleRate));
+
+    setSoundData (new SamplerSoundData (source, numSamples), numSamples, attackTimeSecs, releaseTimeSecs);
+}
+
+SamplerSound::SamplerSound (const String& name_,
+                            SamplerSoundData* const data_,
+                            const BigInteger& midiNotes_,
+                            const int midiNoteForNormalPitch,
+                            const double attackTimeSecs,
+                            const double releaseTimeSecs)
+    : name (name_),
+      midiNotes (midiNotes_),
+      midiRootNote (midiNoteForNormalPitch)
+{
+    jassert (data_ != nullptr);
+
+    setSoundData (data_, data_->getNumSamples(), attackTimeSecs, releaseTimeSecs);
+}
+
+SamplerSound::SamplerSound (const String& name_,
+                            const BigInteger& midiNotes_,
+                            const int midiNoteForNormalPitch)
+    : name (name_),
+      sourceSampleRate (0),
+      midiNotes (midiNotes_),
+      length (0),
+      attackSamples (0),
+      releaseSamples (0),
+      midiRootNote (midiNoteForNormalPitch)
+{
+}
+
+void SamplerSound::setSoundData (SamplerSoundData* const newData,
+                                 const int totalLength,
+                                 const double attackTimeSecs,
+                                 const double releaseTimeSecs)
+{
+    data = newData;
+    playbackData = newData;
+    sourceSampleRate = newData != nullptr ? newData->getSampleRate() : 0.0;
 
-    if (sourceSampleRate <= 0 || source.lengthInSamples <= 0)
+    if (sourceSampleRate <= 0)
     {
         length = 0;
         attackSamples = 0;
@@ -53,13 +122,7 @@ SamplerSound::SamplerSound (const String& name_,
     }
     else
     {
-        length = jmin ((int) source.lengthInSamples,
-                       (int) (maxSampleLengthSeconds * sourceSampleRate));
-
-        data = new AudioSampleBuffer (jmin (2, (int) source.numChannels), length + 4);
-
-        data->readFromAudioReader (&source, 0, length + 4, 0, true, true);
-
+        length = totalLength;
         attackSamples = roundToInt (attackTimeSecs * sourceSampleRate);
         releaseSamples = roundToInt (releaseTimeSecs * sourceSampleRate);
     }
@@ -69,6 +132,16 @@ SamplerSound::~SamplerSound()
 {
 }
 
+bool SamplerSound::resampleTo (const double newSampleRate)
+{
+    // if only part of the sound is in memory, the rest of it will still arrive at the original rate
+    if (data == nullptr || newSampleRate <= 0 || data->getNumSamples() < length)
+        return false;
+
+    playbackData = data->getResampledVersion (newSampleRate);
+    return true;
+}
+
 //==============================================================================
 bool SamplerSound::appliesToNote (const int midiNoteNumber)
 {
@@ -81,6 +154,752 @@ bool SamplerSound::appliesToChannel (const int /*midiChannel*/)
 }
 
 
+//==============================================================================
+namespace SamplerRenderHelpers
+{
+    // These wrap up the vector operations that the renderer needs, so that the same
+    // code can be compiled for whichever instruction set is available.
+    //
+    // Each one has a Cursor, which steps through the source positions of a whole vector of
+    // output frames at a time, and produces their sample indexes and interpolation fractions.
+    struct ScalarOps
+    {
+        typedef float Type;
+        enum { numLanes = 1 };
+
+        static inline Type load (const float* src) noexcept                     { return *src; }
+        static inline void store (float* dest, Type v) noexcept                 { *dest = v; }
+        static inline Type expand (float v) noexcept                            { return v; }
+        static inline Type ramp (float start, float) noexcept                   { return start; }
+        static inline Type gather (const float* src, const int* i) noexcept     { return src [i[0]]; }
+        static inline Type add (Type a, Type b) noexcept                        { return a + b; }
+        static inline Type sub (Type a, Type b) noexcept                        { return a - b; }
+        static inline Type mul (Type a, Type b) noexcept                        { return a * b; }
+        static inline float sum (Type a) noexcept                               { return a; }
+
+        struct Cursor
+        {
+            Cursor (double start, double ratio_) noexcept  : position (start), ratio (ratio_) {}
+
+            inline void next (int* indexes, Type& alpha) noexcept
+            {
+                indexes[0] = (int) position;
+                alpha = (float) (position - indexes[0]);
+                position += ratio;
+            }
+
+            double getPosition() const noexcept     { return position; }
+
+        private:
+            double position;
+            const double ratio;
+        };
+    };
+
+   #if JUCE_USE_AVX_INTRINSICS
+    struct AVXOps
+    {
+        typedef __m256 Type;
+        enum { numLanes = 8 };
+
+        static inline Type load (const float* src) noexcept             { return _mm256_loadu_ps (src); }
+        static inline void store (float* dest, Type v) noexcept         { _mm256_storeu_ps (dest, v); }
+        static inline Type expand (float v) noexcept                    { return _mm256_set1_ps (v); }
+        static inline Type add (Type a, Type b) noexcept                { return _mm256_add_ps (a, b); }
+        static inline Type sub (Type a, Type b) noexcept                { return _mm256_sub_ps (a, b); }
+        static inline Type mul (Type a, Type b) noexcept                { return _mm256_mul_ps (a, b); }
+
+        static inline Type ramp (float start, float delta) noexcept
+        {
+            return add (expand (start), mul (expand (delta), _mm256_setr_ps (0, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)));
+        }
+
+        static inline Type gather (const float* src, const int* i) noexcept
+        {
+            return _mm256_setr_ps (src [i[0]], src [i[1]], src [i[2]], src [i[3]],
+                                   src [i[4]], src [i[5]], src [i[6]], src [i[7]]);
+        }
+
+        static inline float sum (Type a) noexcept
+        {
+            __m128 s = _mm_add_ps (_mm256_castps256_ps128 (a), _mm256_extractf128_ps (a, 1));
+            s = _mm_add_ps (s, _mm_movehl_ps (s, s));
+            return _mm_cvtss_f32 (_mm_add_ss (s, _mm_shuffle_ps (s, s, 1)));
+        }
+
+        struct Cursor
+        {
+            Cursor (double start, double ratio) noexcept
+                : lo (_mm256_add_pd (_mm256_set1_pd (start), _mm256_mul_pd (_mm256_set1_pd (ratio), _mm256_setr_pd (0, 1.0, 2.0, 3.0)))),
+                  hi (_mm256_add_pd (lo, _mm256_set1_pd (ratio * 4.0))),
+                  step (_mm256_set1_pd (ratio * 8.0))
+            {}
+
+            inline void next (int* indexes, Type& alpha) noexcept
+            {
+                const __m128i loIndexes (_mm256_cvttpd_epi32 (lo));
+                const __m128i hiIndexes (_mm256_cvttpd_epi32 (hi));
+                _mm_storeu_si128 ((__m128i*) indexes, loIndexes);
+                _mm_storeu_si128 ((__m128i*) (indexes + 4), hiIndexes);
+
+                alpha = _mm256_insertf128_ps (_mm256_castps128_ps256 (_mm256_cvtpd_ps (_mm256_sub_pd (lo, _mm256_cvtepi32_pd (loIndexes)))),
+                                              _mm256_cvtpd_ps (_mm256_sub_pd (hi, _mm256_cvtepi32_pd (hiIndexes))), 1);
+
+                lo = _mm256_add_pd (lo, step);
+                hi = _mm256_add_pd (hi, step);
+            }
+
+            double getPosition() const noexcept     { return _mm_cvtsd_f64 (_mm256_castpd256_pd128 (lo)); }
+
+        private:
+            __m256d lo, hi;
+            const __m256d step;
+        };
+    };
+
+    typedef AVXOps VectorOps;
+
+   #elif JUCE_USE_SSE_INTRINSICS
+    struct SSEOps
+    {
+        typedef __m128 Type;
+        enum { numLanes = 4 };
+
+        static inline Type load (const float* src) noexcept             { return _mm_loadu_ps (src); }
+        static inline void store (float* dest, Type v) noexcept         { _mm_storeu_ps (dest, v); }
+        static inline Type expand (float v) noexcept                    { return _mm_set1_ps (v); }
+        static inline Type add (Type a, Type b) noexcept                { return _mm_add_ps (a, b); }
+        static inline Type sub (Type a, Type b) noexcept                { return _mm_sub_ps (a, b); }
+        static inline Type mul (Type a, Type b) noexcept                { return _mm_mul_ps (a, b); }
+
+        static inline Type ramp (float start, float delta) noexcept
+        {
+            return add (expand (start), mul (expand (delta), _mm_setr_ps (0, 1.0f, 2.0f, 3.0f)));
+        }
+
+        static inline Type gather (const float* src, const int* i) noexcept
+        {
+            return _mm_setr_ps (src [i[0]], src [i[1]], src [i[2]], src [i[3]]);
+        }
+
+        static inline float sum (Type a) noexcept
+        {
+            a = _mm_add_ps (a, _mm_movehl_ps (a, a));
+            return _mm_cvtss_f32 (_mm_add_ss (a, _mm_shuffle_ps (a, a, 1)));
+        }
+
+        struct Cursor
+        {
+            Cursor (double start, double ratio) noexcept
+                : lo (_mm_setr_pd (start, start + ratio)),
+                  hi (_mm_setr_pd (start + ratio * 2.0, start + ratio * 3.0)),
+                  step (_mm_set1_pd (ratio * 4.0))
+            {}
+
+            inline void next (int* indexes, Type& alpha) noexcept
+            {
+                const __m128i loIndexes (_mm_cvttpd_epi32 (lo));
+                const __m128i hiIndexes (_mm_cvttpd_epi32 (hi));
+                _mm_storeu_si128 ((__m128i*) indexes, _mm_unpacklo_epi64 (loIndexes, hiIndexes));
+
+                alpha = _mm_movelh_ps (_mm_cvtpd_ps (_mm_sub_pd (lo, _mm_cvtepi32_pd (loIndexes))),
+                                       _mm_cvtpd_ps (_mm_sub_pd (hi, _mm_cvtepi32_pd (hiIndexes))));
+
+                lo = _mm_add_pd (lo, step);
+                hi = _mm_add_pd (hi, step);
+            }
+
+            double getPosition() const noexcept     { return _mm_cvtsd_f64 (lo); }
+
+        private:
+            __m128d lo, hi;
+            const __m128d step;
+        };
+    };
+
+    typedef SSEOps VectorOps;
+
+   #elif JUCE_USE_ARM_NEON
+    struct NeonOps
+    {
+        typedef float32x4_t Type;
+        enum { numLanes = 4 };
+
+        static inline Type load (const float* src) noexcept             { return vld1q_f32 (src); }
+        static inline void store (float* dest, Type v) noexcept         { vst1q_f32 (dest, v); }
+        static inline Type expand (float v) noexcept                    { return vdupq_n_f32 (v); }
+        static inline Type add (Type a, Type b) noexcept                { return vaddq_f32 (a, b); }
+        static inline Type sub (Type a, Type b) noexcept                { return vsubq_f32 (a, b); }
+        static inline Type mul (Type a, Type b) noexcept                { return vmulq_f32 (a, b); }
+
+        static inline Type ramp (float start, float delta) noexcept
+        {
+            const float steps[] = { 0, 1.0f, 2.0f, 3.0f };
+            return add (expand (start), mul (expand (delta), vld1q_f32 (steps)));
+        }
+
+        static inline Type gather (const float* src, const int* i) noexcept
+        {
+            Type v (vdupq_n_f32 (src [i[0]]));
+            v = vsetq_lane_f32 (src [i[1]], v, 1);
+            v = vsetq_lane_f32 (src [i[2]], v, 2);
+            return vsetq_lane_f32 (src [i[3]], v, 3);
+        }
+
+        static inline float sum (Type a) noexcept
+        {
+            const float32x2_t s (vadd_f32 (vget_low_f32 (a), vget_high_f32 (a)));
+            return vget_lane_f32 (vpadd_f32 (s, s), 0);
+        }
+
+        // (32-bit ARM has no double-precision vectors, so the positions are stepped one at a time)
+        struct Cursor
+        {
+            Cursor (double start, double ratio_) noexcept  : position (start), ratio (ratio_) {}
+
+            inline void next (int* indexes, Type& alpha) noexcept
+            {
+                float fractions [numLanes];
+
+                for (int i = 0; i < numLanes; ++i)
+                {
+                    indexes[i] = (int) position;
+                    fractions[i] = (float) (position - indexes[i]);
+                    position += ratio;
+                }
+
+                alpha = vld1q_f32 (fractions);
+            }
+
+            double getPosition() const noexcept     { return position; }
+
+        private:
+            double position;
+            const double ratio;
+        };
+    };
+
+    typedef NeonOps VectorOps;
+
+   #else
+    typedef ScalarOps VectorOps;
+   #endif
+
+    //==============================================================================
+    // The interpolators. Each one reads numTaps source samples around a position, starting
+    // numTapsBefore samples before it, and can either interpolate a vector of frames that
+    // are at arbitrary positions, or provide a set of FIR coefficients for a single fraction.
+    struct LinearInterpolator
+    {
+        enum { numTapsBefore = 0, numTapsAfter = 1, numTaps = 2 };
+
+        template <class Ops, bool stereo>
+        inline void interpolate (const float* const inL, const float* const inR, const int* const indexes,
+                                 const typename Ops::Type alpha, typename Ops::Type& l, typename Ops::Type& r) const noexcept
+        {
+            const typename Ops::Type invAlpha (Ops::sub (Ops::expand (1.0f), alpha));
+
+            l = Ops::add (Ops::mul (Ops::gather (inL, indexes), invAlpha), Ops::mul (Ops::gather (inL + 1, indexes), alpha));
+
+            if (stereo)
+                r = Ops::add (Ops::mul (Ops::gather (inR, indexes), invAlpha), Ops::mul (Ops::gather (inR + 1, indexes), alpha));
+        }
+
+        void getCoefficients (const float alpha, float* const coefficients) const noexcept
+        {
+            coefficients[0] = 1.0f - alpha;
+            coefficients[1] = alpha;
+        }
+    };
+
+    // A 4-point, 3rd-order (Catmull-Rom) Hermite interpolator
+    struct CubicInterpolator
+    {
+        enum { numTapsBefore = 1, numTapsAfter = 2, numTaps = 4 };
+
+        template <class Ops, bool stereo>
+        inline void interpolate (const float* const inL, const float* const inR, const int* const indexes,
+                                 const typename Ops::Type alpha, typename Ops::Type& l, typename Ops::Type& r) const noexcept
+        {
+            l = interpolateChannel <Ops> (inL, indexes, alpha);
+
+            if (stereo)
+                r = interpolateChannel <Ops> (inR, indexes, alpha);
+        }
+
+        template <class Ops>
+        static inline typename Ops::Type interpolateChannel (const float* const in, const int* const indexes,
+                                                             const typename Ops::Type alpha) noexcept
+        {
+            typedef typename Ops::Type Type;
+
+            const Type xm1 (Ops::gather (in - 1, indexes));
+            const Type x0  (Ops::gather (in, indexes));
+            const Type x1  (Ops::gather (in + 1, indexes));
+            const Type x2  (Ops::gather (in + 2, indexes));
+            const Type half (Ops::expand (0.5f));
+
+            const Type c1 (Ops::mul (half, Ops::sub (x1, xm1)));
+            const Type c2 (Ops::sub (Ops::add (Ops::sub (xm1, Ops::mul (Ops::expand (2.5f), x0)), Ops::add (x1, x1)), Ops::mul (half, x2)));
+            const Type c3 (Ops::add (Ops::mul (half, Ops::sub (x2, xm1)), Ops::mul (Ops::expand (1.5f), Ops::sub (x0, x1))));
+
+            return Ops::add (Ops::mul (Ops::add (Ops::mul (Ops::add (Ops::mul (c3, alpha), c2), alpha), c1), alpha), x0);
+        }
+
+        void getCoefficients (const float a, float* const coefficients) const noexcept
+        {
+            coefficients[0] = ((-0.5f * a + 1.0f) * a - 0.5f) * a;
+            coefficients[1] = (1.5f * a - 2.5f) * a * a + 1.0f;
+            coefficients[2] = ((-1.5f * a + 2.0f) * a + 0.5f) * a;
+            coefficients[3] = (0.5f * a - 0.5f) * a * a;
+        }
+    };
+
+    //==============================================================================
+    // A table of Kaiser-windowed sinc coefficients for a set of fractional positions between
+    // samples (with the differences between neighbouring phases, so that they can be interpolated).
+    template <int numTapsToUse, int numPhasesToUse>
+    class WindowedSincTable
+    {
+    public:
+        enum { numTaps = numTapsToUse, numTapsBefore = numTaps / 2 - 1, numTapsAfter = numTaps / 2, numPhases = numPhasesToUse };
+
+        WindowedSincTable (const double cutoff, const double kaiserBeta)
+            : coefficients ((size_t) ((numPhases + 1) * numTaps)),
+              deltas ((size_t) ((numPhases + 1) * numTaps))
+        {
+            for (int phase = 0; phase <= numPhases; ++phase)
+            {
+                float* const c = coefficients + phase * numTaps;
+                double total = 0;
+
+                for (int i = 0; i < numTaps; ++i)
+                {
+                    const double x = (i - numTapsBefore) - phase / (double) numPhases;
+                    const double w = x / (numTaps / 2);
+                    const double window = w * w < 1.0 ? besselI0 (kaiserBeta * std::sqrt (1.0 - w * w)) / besselI0 (kaiserBeta) : 0.0;
+                    const double sinc = x == 0 ? 1.0 : std::sin (double_Pi * cutoff * x) / (double_Pi * cutoff * x);
+
+                    c[i] = (float) (cutoff * sinc * window);
+                    total += c[i];
+                }
+
+                // normalise each phase so that it has unity gain at DC
+                for (int i = 0; i < numTaps; ++i)
+                    c[i] = (float) (c[i] / total);
+            }
+
+            for (int i = 0; i < numPhases * numTaps; ++i)
+                deltas[i] = coefficients [i + numTaps] - coefficients[i];
+
+            for (int i = 0; i < numTaps; ++i)
+                deltas [numPhases * numTaps + i] = 0;
+        }
+
+        void getCoefficients (const float alpha, float* const dest) const noexcept
+        {
+            typedef VectorOps Ops;
+
+            const float phasePosition = alpha * numPhases;
+            const int phase = jlimit (0, (int) numPhases, (int) phasePosition);
+            const Ops::Type phaseFraction (Ops::expand (phasePosition - phase));
+            const float* const c = coefficients + phase * numTaps;
+            const float* const d = deltas + phase * numTaps;
+
+            for (int i = 0; i < numTaps; i += Ops::numLanes)
+                Ops::store (dest + i, Ops::add (Ops::load (c + i), Ops::mul (Ops::load (d + i), phaseFraction)));
+        }
+
+        static inline float applyCoefficients (const float* const in, const float* const c) noexcept
+        {
+            typedef VectorOps Ops;
+            Ops::Type total (Ops::mul (Ops::load (in), Ops::load (c)));
+
+            for (int i = Ops::numLanes; i < numTaps; i += Ops::numLanes)
+                total = Ops::add (total, Ops::mul (Ops::load (in + i), Ops::load (c + i)));
+
+            return Ops::sum (total);
+        }
+
+    private:
+        HeapBlock <float> coefficients, deltas;
+
+        static double besselI0 (const double x) noexcept
+        {
+            double total = 1.0, term = 1.0;
+
+            for (int i = 1; i < 50 && term > total * 1.0e-12; ++i)
+            {
+                const double t = x / (2.0 * i);
+                term *= t * t;
+                total += term;
+            }
+
+            return total;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (WindowedSincTable);
+    };
+
+    //==============================================================================
+    // A 32-point windowed-sinc interpolator for the voices to use.
+    //
+    // So that pitching a sample up doesn't alias, there's a table for each of a range of
+    // cutoff frequencies, and a voice picks the one that's below the new Nyquist frequency.
+    class SincInterpolator  : public WindowedSincTable <32, 128>
+    {
+    public:
+        // (a beta of 7 gives about 70dB of stop-band rejection)
+        SincInterpolator (const double cutoff)
+            : WindowedSincTable <32, 128> (cutoff, 7.0)
+        {
+        }
+
+        template <class Ops, bool stereo>
+        inline void interpolate (const float* const inL, const float* const inR, const int* const indexes,
+                                 const typename Ops::Type alpha, typename Ops::Type& l, typename Ops::Type& r) const noexcept
+        {
+            // each frame needs its own set of coefficients, so the taps are vectorised
+            // instead of the frames..
+            float fractions [Ops::numLanes], resultsL [Ops::numLanes], resultsR [Ops::numLanes];
+            float c [numTaps];
+            Ops::store (fractions, alpha);
+
+            for (int i = 0; i < Ops::numLanes; ++i)
+            {
+                getCoefficients (fractions[i], c);
+                resultsL[i] = applyCoefficients (inL + indexes[i] - numTapsBefore, c);
+
+                if (stereo)
+                    resultsR[i] = applyCoefficients (inR + indexes[i] - numTapsBefore, c);
+            }
+
+            l = Ops::load (resultsL);
+
+            if (stereo)
+                r = Ops::load (resultsR);
+        }
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE (SincInterpolator);
+    };
+
+    // Holds the sinc tables for pitch ratios of up to three octaves, in steps of a quarter of
+    // an octave. These are created by SamplerVoice::createInterpolationTables(), or else the
+    // first time a voice is switched to sinc interpolation.
+    class SincInterpolatorSet  : public DeletedAtShutdown
+    {
+    public:
+        enum { numStepsPerOctave = 4, numTables = 3 * numStepsPerOctave + 1 };
+
+        SincInterpolatorSet()
+        {
+            // the cutoff is set a little below the Nyquist frequency, so that the transition
+            // band doesn't fold back into the audible range..
+            for (int i = 0; i < numTables; ++i)
+                tables.add (new SincInterpolator (0.86 * std::pow (2.0, -i / (double) numStepsPerOctave)));
+        }
+
+        ~SincInterpolatorSet()
+        {
+            clearSingletonInstance();
+        }
+
+        const SincInterpolator& getForPitchRatio (const double pitchRatio) const noexcept
+        {
+            const int index = pitchRatio <= 1.0 ? 0 : (int) std::ceil (numStepsPerOctave * std::log (pitchRatio) / std::log (2.0) - 0.001);
+            return *tables.getUnchecked (jmin (index, (int) numTables - 1));
+        }
+
+        juce_DeclareSingleton (SincInterpolatorSet, false);
+
+    private:
+        OwnedArray <SincInterpolator> tables;
+
+        JUCE_DECLARE_NON_COPYABLE (SincInterpolatorSet);
+    };
+
+    juce_ImplementSingleton (SincInterpolatorSet);
+
+    //==============================================================================
+    // The parts of a voice's state that change as it renders
+    struct RenderState
+    {
+        double position, pitchRatio;
+        float gainL, gainR, level, levelDelta;
+    };
+
+    template <class Ops, bool stereoOut>
+    inline void mixFrames (const typename Ops::Type l, const typename Ops::Type r, const typename Ops::Type level,
+                           const typename Ops::Type gainL, const typename Ops::Type gainR,
+                           float* const outL, float* const outR) noexcept
+    {
+        const typename Ops::Type outputL (Ops::mul (l, Ops::mul (gainL, level)));
+        const typename Ops::Type outputR (Ops::mul (r, Ops::mul (gainR, level)));
+
+        if (stereoOut)
+        {
+            Ops::store (outL, Ops::add (Ops::load (outL), outputL));
+            Ops::store (outR, Ops::add (Ops::load (outR), outputR));
+        }
+        else
+        {
+            Ops::store (outL, Ops::add (Ops::load (outL), Ops::mul (Ops::add (outputL, outputR), Ops::expand (0.5f))));
+        }
+    }
+
+    // Renders a run of frames in which the envelope is a straight line, and for which all
+    // the interpolator's taps lie inside the source data.
+    template <class Ops, class Interpolator, bool stereoIn, bool stereoOut>
+    void renderFrames (const Interpolator& interpolator, const float* const inL, const float* const inR,
+                       float* outL, float* outR, const int numFrames, RenderState& state) noexcept
+    {
+        typedef typename Ops::Type Type;
+        const int numLanes = Ops::numLanes;
+        const int numVectors = numFrames / numLanes;
+
+        const Type gainL (Ops::expand (state.gainL));
+        const Type gainR (Ops::expand (state.gainR));
+        const Type levelStep (Ops::expand (state.levelDelta * numLanes));
+        Type level (Ops::ramp (state.level, state.levelDelta));
+
+        if (state.pitchRatio == 1.0 && state.position == (double) (int) state.position)
+        {
+            // when playing at the natural pitch from a whole-numbered position, the source
+            // frames can be copied straight across..
+            const float* l = inL + (int) state.position;
+            const float* r = stereoIn ? inR + (int) state.position : nullptr;
+
+            for (int i = numVectors; --i >= 0;)
+            {
+                const Type sourceL (Ops::load (l));
+                mixFrames <Ops, stereoOut> (sourceL, stereoIn ? Ops::load (r) : sourceL, level, gainL, gainR, outL, outR);
+
+                l += numLanes;
+                r = stereoIn ? r + numLanes : nullptr;
+                outL += numLanes;
+                outR = stereoOut ? outR + numLanes : nullptr;
+                level = Ops::add (level, levelStep);
+            }
+
+            state.position += numVectors * numLanes;
+        }
+        else if (state.pitchRatio == 1.0)
+        {
+            // ..or if they're between samples, they're still contiguous and all have the same
+            // fraction, so they can be run through a fixed FIR filter..
+            const int start = (int) state.position;
+            float coefficients [Interpolator::numTaps];
+            interpolator.getCoefficients ((float) (state.position - start), coefficients);
+
+            const float* l = inL + start - Interpolator::numTapsBefore;
+            const float* r = stereoIn ? inR + start - Interpolator::numTapsBefore : nullptr;
+
+            for (int i = numVectors; --i >= 0;)
+            {
+                Type sumL (Ops::mul (Ops::load (l), Ops::expand (coefficients[0])));
+                Type sumR (stereoIn ? Ops::mul (Ops::load (r), Ops::expand (coefficients[0])) : sumL);
+
+                for (int j = 1; j < Interpolator::numTaps; ++j)
+                {
+                    sumL = Ops::add (sumL, Ops::mul (Ops::load (l + j), Ops::expand (coefficients[j])));
+
+                    if (stereoIn)
+                        sumR = Ops::add (sumR, Ops::mul (Ops::load (r + j), Ops::expand (coefficients[j])));
+                }
+
+                mixFrames <Ops, stereoOut> (sumL, stereoIn ? sumR : sumL, level, gainL, gainR, outL, outR);
+
+                l += numLanes;
+                r = stereoIn ? r + numLanes : nullptr;
+                outL += numLanes;
+                outR = stereoOut ? outR + numLanes : nullptr;
+                level = Ops::add (level, levelStep);
+            }
+
+            state.position += numVectors * numLanes;
+        }
+        else
+        {
+            // ..but otherwise they have to be gathered, before being interpolated and
+            // mixed a whole vector at a time
+            typename Ops::Cursor cursor (state.position, state.pitchRatio);
+            int indexes [numLanes];
+            Type alpha, l, r;
+
+            for (int i = numVectors; --i >= 0;)
+            {
+                cursor.next (indexes, alpha);
+                interpolator.template interpolate <Ops, stereoIn> (inL, inR, indexes, alpha, l, r);
+
+                mixFrames <Ops, stereoOut> (l, stereoIn ? r : l, level, gainL, gainR, outL, outR);
+
+                outL += numLanes;
+                outR = stereoOut ? outR + numLanes : nullptr;
+                level = Ops::add (level, levelStep);
+            }
+
+            state.position = cursor.getPosition();
+        }
+
+        state.level += state.levelDelta * (float) (numVectors * numLanes);
+
+        // any frames left over are done one at a time
+        if (numLanes > 1 && numFrames > numVectors * numLanes)
+            renderFrames <ScalarOps, Interpolator, stereoIn, stereoOut> (interpolator, inL, inR, outL, outR,
+                                                                         numFrames - numVectors * numLanes, state);
+    }
+
+    // Renders a single frame whose taps would reach past the start or end of the source
+    // data, treating anything outside it as silence.
+    template <class Interpolator, bool stereoIn, bool stereoOut>
+    void renderFrameAtEdge (const Interpolator& interpolator, const float* const inL, const float* const inR,
+                            const int numAvailable, float* const outL, float* const outR, RenderState& state) noexcept
+    {
+        float tapsL [Interpolator::numTaps], tapsR [Interpolator::numTaps];
+        const int pos = (int) state.position;
+
+        for (int i = 0; i < Interpolator::numTaps; ++i)
+        {
+            const int index = pos - Interpolator::numTapsBefore + i;
+            const bool isInside = isPositiveAndBelow (index, numAvailable);
+
+            tapsL[i] = isInside ? inL [index] : 0.0f;
+
+            if (stereoIn)
+                tapsR[i] = isInside ? inR [index] : 0.0f;
+        }
+
+        RenderState frameState (state);
+        frameState.position = Interpolator::numTapsBefore + (state.position - pos);
+
+        renderFrames <ScalarOps, Interpolator, stereoIn, stereoOut> (interpolator, tapsL, tapsR, outL, outR, 1, frameState);
+
+        state.position += state.pitchRatio;
+        state.level = frameState.level;
+    }
+
+    template <class Interpolator, bool stereoIn, bool stereoOut>
+    void renderSegmentFrames (const Interpolator& interpolator, const float* const inL, const float* const inR, const int numAvailable,
+                        float* outL, float* outR, int numFrames, RenderState& state) noexcept
+    {
+        while (numFrames > 0)
+        {
+            // find how many frames can be done before the taps would go past the end of the data..
+            int numInside = 0;
+
+            if (state.position >= Interpolator::numTapsBefore)
+                numInside = (int) jlimit (0.0, (double) numFrames,
+                                          std::ceil ((numAvailable - Interpolator::numTapsAfter - state.position) / state.pitchRatio));
+
+            if (numInside > 0)
+            {
+                renderFrames <VectorOps, Interpolator, stereoIn, stereoOut> (interpolator, inL, inR, outL, outR, numInside, state);
+            }
+            else
+            {
+                // (this only happens for the first and last few frames of the data)
+                renderFrameAtEdge <Interpolator, stereoIn, stereoOut> (interpolator, inL, inR, numAvailable, outL, outR, state);
+                numInside = 1;
+            }
+
+            numFrames -= numInside;
+            outL += numInside;
+
+            if (stereoOut)
+                outR += numInside;
+        }
+    }
+
+    // Renders a run of frames in which the envelope is a straight line
+    template <class Interpolator>
+    void renderSegment (const Interpolator& interpolator, const float* const inL, const float* const inR, const int numAvailable,
+                        float* const outL, float* const outR, const int numFrames, RenderState& state) noexcept
+    {
+        if (outR != nullptr)
+        {
+            if (inR != nullptr)     renderSegmentFrames <Interpolator, true, true>   (interpolator, inL, inR, numAvailable, outL, outR, numFrames, state);
+            else                    renderSegmentFrames <Interpolator, false, true>  (interpolator, inL, inR, numAvailable, outL, outR, numFrames, state);
+        }
+        else
+        {
+            if (inR != nullptr)     renderSegmentFrames <Interpolator, true, false>  (interpolator, inL, inR, numAvailable, outL, outR, numFrames, state);
+            else                    renderSegmentFrames <Interpolator, false, false> (interpolator, inL, inR, numAvailable, outL, outR, numFrames, state);
+        }
+    }
+
+    //==============================================================================
+    // This is only used to convert sounds to a new sample rate when they're loaded, so it can
+    // afford a much longer filter than the voices use. A beta of 9 gives about 90dB of
+    // stop-band rejection.
+    typedef WindowedSincTable <128, 256> ResamplingFilter;
+
+    void resample (const ResamplingFilter& filter, const float* const source, const int numSourceSamples,
+                   float* const dest, const int numDestSamples, const double ratio)
+    {
+        // the source is copied into a block of silence, so that the filter can run off either end of it..
+        HeapBlock <float> padded;
+        padded.calloc ((size_t) (numSourceSamples + 2 * ResamplingFilter::numTaps));
+        memcpy (padded + ResamplingFilter::numTaps, source, sizeof (float) * (size_t) numSourceSamples);
+
+        const float* const start = padded + (ResamplingFilter::numTaps - ResamplingFilter::numTapsBefore);
+        float coefficients [ResamplingFilter::numTaps];
+
+        for (int i = 0; i < numDestSamples; ++i)
+        {
+            const double position = i * ratio;
+            const int index = (int) position;
+
+            filter.getCoefficients ((float) (position - index), coefficients);
+            dest[i] = ResamplingFilter::applyCoefficients (start + index, coefficients);
+        }
+    }
+}
+
+//==============================================================================
+SamplerSoundData::SamplerSoundData (const SamplerSoundData& source, const double newSampleRate)
+    : buffer (source.buffer.getNumChannels(), roundToInt (source.numSamples * newSampleRate / source.sampleRate) + 4),
+      sampleRate (newSampleRate),
+      numSamples (roundToInt (source.numSamples * newSampleRate / source.sampleRate)),
+      sourceLength (roundToInt (source.sourceLength * newSampleRate / source.sampleRate))
+{
+    using namespace SamplerRenderHelpers;
+
+    jassert (source.sampleRate > 0 && newSampleRate > 0);
+
+    // the cutoff sits just below whichever of the two Nyquist frequencies is lower
+    const double ratio = source.sampleRate / newSampleRate;
+    const ResamplingFilter filter (0.955 * jmin (1.0, 1.0 / ratio), 9.0);
+
+    buffer.clear();
+
+    for (int i = buffer.getNumChannels(); --i >= 0;)
+        resample (filter, source.buffer.getSampleData (i), source.numSamples,
+                  buffer.getSampleData (i), numSamples, ratio);
+}
+
+SamplerSoundData* SamplerSoundData::getResampledVersion (const double newSampleRate)
+{
+    jassert (newSampleRate > 0);
+
+    if (newSampleRate == sampleRate || sampleRate <= 0)
+        return this;
+
+    const ScopedLock sl (resampleLock);
+
+    for (int i = resampledVersions.size(); --i >= 0;)
+    {
+        SamplerSoundData* const version = resampledVersions.getUnchecked (i);
+
+        if (version->sampleRate == newSampleRate)
+            return version;
+    }
+
+    SamplerSoundData* const newVersion = new SamplerSoundData (*this, newSampleRate);
+    resampledVersions.add (newVersion);
+    return newVersion;
+}
+
 //==============================================================================
 SamplerVoice::SamplerVoice()
     : pitchRatio (0.0),
@@ -88,12 +907,49 @@ SamplerVoice::SamplerVoice()
       lgain (0.0f),
       rgain (0.0f),
       isInAttack (false),
-      isInRelease (false)
+      isInRelease (false),
+      interpolationMode ((int) linearInterpolation),
+      noteInterpolationMode (linearInterpolation),
+      playbackLength (0),
+      noteData (nullptr),
+      streamer (nullptr),
+      streamIndex (-1),
+      streamWindow (2, 4096),
+      streamWindowStart (0),
+      streamWindowSize (0)
 {
 }
 
 SamplerVoice::~SamplerVoice()
 {
+    // a voice mustn't be deleted while it's still playing from a stream
+    jassert (streamIndex < 0);
+}
+
+void SamplerVoice::setInterpolationMode (const InterpolationMode newMode)
+{
+    // make sure the tables exist before the audio thread needs them..
+    if (newMode == sincInterpolation)
+        createInterpolationTables();
+
+    interpolationMode = (int) newMode;
+}
+
+void SamplerVoice::createInterpolationTables()
+{
+    SamplerRenderHelpers::SincInterpolatorSet::getInstance();
+}
+
+int SamplerVoice::getNumInterpolationTaps (const InterpolationMode mode, const bool before) noexcept
+{
+    using namespace SamplerRenderHelpers;
+
+    switch (mode)
+    {
+        case cubicInterpolation:    return before ? (int) CubicInterpolator::numTapsBefore : (int) CubicInterpolator::numTapsAfter;
+        case sincInterpolation:     return before ? (int) SincInterpolator::numTapsBefore : (int) SincInterpolator::numTapsAfter;
+        default:                    return before ? (int) LinearInterpolator::numTapsBefore : (int) LinearInterpolator::numTapsAfter;
+    }
 }
 
 bool SamplerVoice::canPlaySound (SynthesiserSound* sound)
@@ -111,12 +967,20 @@ void SamplerVoice::startNote (const int midiNoteNumber,
 
     if (sound != nullptr)
     {
+        // the note carries on using whichever version of the data it started with, even if
+        // the sound gets resampled while it's playing..
+        noteData = sound->playbackData.get();
+
         const double targetFreq = MidiMessage::getMidiNoteInHertz (midiNoteNumber);
         const double naturalFreq = MidiMessage::getMidiNoteInHertz (sound->midiRootNote);
 
-        pitchRatio = (targetFreq * sound->sourceSampleRate) / (naturalFreq * getSampleRate());
+        pitchRatio = (targetFreq * noteData->getSampleRate()) / (naturalFreq * getSampleRate());
+
+        // (the envelope lengths are measured at the sound's original rate)
+        const double envelopeScale = noteData->getSampleRate() / sound->sourceSampleRate;
 
         sourceSamplePosition = 0.0;
+        noteInterpolationMode = (InterpolationMode) interpolationMode.get();
         lgain = velocity;
         rgain = velocity;
 
@@ -126,7 +990,7 @@ void SamplerVoice::startNote (const int midiNoteNumber,
         if (isInAttack)
         {
             attackReleaseLevel = 0.0f;
-            attackDelta = (float) (pitchRatio / sound->attackSamples);
+            attackDelta = (float) (pitchRatio / (sound->attackSamples * envelopeScale));
         }
         else
         {
@@ -136,12 +1000,28 @@ void SamplerVoice::startNote (const int midiNoteNumber,
 
         if (sound->releaseSamples > 0)
         {
-            releaseDelta = (float) (-pitchRatio / sound->releaseSamples);
+            releaseDelta = (float) (-pitchRatio / (sound->releaseSamples * envelopeScale));
         }
         else
         {
             releaseDelta = 0.0f;
         }
+
+        playbackLength = noteData == sound->data ? sound->length : noteData->getNumSamples();
+
+        const StreamingSamplerSound* const streamingSound = dynamic_cast <const StreamingSamplerSound*> (sound);
+
+        if (streamingSound != nullptr && streamingSound->preloadLength < sound->length)
+        {
+            streamer = &(streamingSound->streamer);
+            streamIndex = streamer->openStream (*streamingSound);
+            streamWindowStart = 0;
+            streamWindowSize = 0;
+
+            // if there are no streams free, we can still play the part that's in memory
+            if (streamIndex < 0)
+                playbackLength = streamingSound->preloadLength;
+        }
     }
 }
 
@@ -154,10 +1034,20 @@ void SamplerVoice::stopNote (const bool allowTailOff)
     }
     else
     {
+        closeStream();
         clearCurrentNote();
     }
 }
 
+void SamplerVoice::closeStream()
+{
+    if (streamIndex >= 0)
+    {
+        streamer->closeStream (streamIndex);
+        streamIndex = -1;
+    }
+}
+
 void SamplerVoice::pitchWheelMoved (const int /*newValue*/)
 {
 }
@@ -174,73 +1064,417 @@ void SamplerVoice::renderNextBlock (AudioSampleBuffer& outputBuffer, int startSa
 
     if (playingSound != nullptr)
     {
-        const float* const inL = playingSound->data->getSampleData (0, 0);
-        const float* const inR = playingSound->data->getNumChannels() > 1
-                                    ? playingSound->data->getSampleData (1, 0) : nullptr;
-
         float* outL = outputBuffer.getSampleData (0, startSample);
         float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getSampleData (1, startSample) : nullptr;
 
-        while (--numSamples >= 0)
+        const AudioSampleBuffer& source = noteData->getAudioData();
+
+        if (streamIndex < 0)
+        {
+            const float* const inL = source.getSampleData (0, 0);
+            const float* const inR = source.getNumChannels() > 1 ? source.getSampleData (1, 0) : nullptr;
+
+            renderSamples (inL, inR, 0, source.getNumSamples(), outL, outR, numSamples);
+        }
+        else
+        {
+            // When streaming, the source samples are gathered into a small window, which is
+            // rendered from in chunks that are short enough for the window to cover..
+            const bool isStereo = source.getNumChannels() > 1;
+
+            while (numSamples > 0)
+            {
+                const int numThisTime = fillStreamWindow (*playingSound, numSamples);
+
+                if (! renderSamples (streamWindow.getSampleData (0, 0),
+                                     isStereo ? streamWindow.getSampleData (1, 0) : nullptr,
+                                     streamWindowStart, streamWindowSize, outL, outR, numThisTime))
+                    break;
+
+                outL += numThisTime;
+
+                if (outR != nullptr)
+                    outR += numThisTime;
+
+                numSamples -= numThisTime;
+            }
+        }
+    }
+}
+
+bool SamplerVoice::renderSamples (const float* const inL, const float* const inR,
+                                  const int firstSampleInSource, const int numAvailable,
+                                  float* outL, float* outR, int numSamples)
+{
+    using namespace SamplerRenderHelpers;
+
+    RenderState state;
+    state.position = sourceSamplePosition - firstSampleInSource;
+    state.pitchRatio = pitchRatio;
+    state.gainL = lgain;
+    state.gainR = rgain;
+
+    const double endPosition = (double) (playbackLength - firstSampleInSource);
+
+    while (numSamples > 0)
+    {
+        // The block is split into segments in which the envelope is either flat or a
+        // straight ramp, so that the inner loops don't need to check it for every sample..
+        int numThisTime = numSamples;
+        bool envelopeSegmentEnds = false;
+        bool soundEnds = false;
+
+        if (isInAttack)
+        {
+            state.level = attackReleaseLevel;
+            state.levelDelta = attackDelta;
+
+            const double numToEnd = std::ceil ((1.0 - attackReleaseLevel) / attackDelta);
+
+            if (numToEnd <= numThisTime)
+            {
+                numThisTime = jmax (1, (int) numToEnd);
+                envelopeSegmentEnds = true;
+            }
+        }
+        else if (isInRelease)
+        {
+            state.level = attackReleaseLevel;
+            state.levelDelta = releaseDelta;
+
+            if (releaseDelta < 0)
+            {
+                // (the note stops without playing the sample after which the level would
+                // reach zero, as the original per-sample loop did)
+                const double numToEnd = std::ceil (attackReleaseLevel / -releaseDelta) - 1.0;
+
+                if (numToEnd < 1.0)
+                {
+                    stopNote (false);
+                    return false;
+                }
+
+                if (numToEnd <= numThisTime)
+                {
+                    numThisTime = (int) numToEnd;
+                    envelopeSegmentEnds = true;
+                }
+            }
+        }
+        else
+        {
+            state.level = 1.0f;
+            state.levelDelta = 0.0f;
+        }
+
+        // ..and also stops at the end of the sample.
+        const double numBeforeEnd = (endPosition - state.position) / pitchRatio;
+
+        if (numBeforeEnd < numThisTime)
+        {
+            numThisTime = jmax (1, (int) numBeforeEnd + 1);
+            soundEnds = true;
+        }
+
+        switch (noteInterpolationMode)
+        {
+            case cubicInterpolation:
+                renderSegment (CubicInterpolator(), inL, inR, numAvailable, outL, outR, numThisTime, state);
+                break;
+
+            case sincInterpolation:
+                renderSegment (SincInterpolatorSet::getInstanceWithoutCreating()->getForPitchRatio (pitchRatio),
+                               inL, inR, numAvailable, outL, outR, numThisTime, state);
+                break;
+
+            default:
+                renderSegment (LinearInterpolator(), inL, inR, numAvailable, outL, outR, numThisTime, state);
+                break;
+        }
+
+        numSamples -= numThisTime;
+        outL += numThisTime;
+
+        if (outR != nullptr)
+            outR += numThisTime;
+
+        if (isInAttack)
+        {
+            attackReleaseLevel = state.level;
+
+            if (envelopeSegmentEnds)
+            {
+                attackReleaseLevel = 1.0f;
+                isInAttack = false;
+            }
+        }
+        else if (isInRelease)
+        {
+            attackReleaseLevel = state.level;
+
+            if (envelopeSegmentEnds)
+                soundEnds = true;
+        }
+
+        if (soundEnds)
+        {
+            stopNote (false);
+            return false;
+        }
+    }
+
+    sourceSamplePosition = state.position + firstSampleInSource;
+    return true;
+}
+
+int SamplerVoice::fillStreamWindow (const SamplerSound& sound, const int numSamples)
+{
+    const int numChannels = sound.data->getAudioData().getNumChannels();
+    const int windowCapacity = streamWindow.getNumSamples();
+
+    const int numTapsBefore = getNumInterpolationTaps (noteInterpolationMode, true);
+    const int numTapsAfter = getNumInterpolationTaps (noteInterpolationMode, false);
+
+    // drop any samples that the playback position (and the interpolator) have already moved past..
+    const int numToDrop = jlimit (0, streamWindowSize, (int) sourceSamplePosition - numTapsBefore - streamWindowStart);
+
+    if (numToDrop > 0)
+    {
+        streamWindowSize -= numToDrop;
+        streamWindowStart += numToDrop;
+
+        for (int i = numChannels; --i >= 0;)
         {
+            float* const d = streamWindow.getSampleData (i, 0);
+            memmove (d, d + numToDrop, sizeof (float) * (size_t) streamWindowSize);
+        }
+    }
+
+    // work out how many output samples the window can hold the source for (allowing
+    // extra samples for the interpolator)..
+    const double offsetInWindow = sourceSamplePosition - streamWindowStart;
+    const int numOut = jlimit (1, numSamples, (int) ((windowCapacity - numTapsAfter - 2 - offsetInWindow) / pitchRatio));
+    const int endOfWindow = jmin (streamWindowStart + windowCapacity,
+                                  (int) (sourceSamplePosition + numOut * pitchRatio) + numTapsAfter + 2);
+
+    int next = streamWindowStart + streamWindowSize;
+
+    const StreamingSamplerSound& streamingSound = static_cast <const StreamingSamplerSound&> (sound);
+
+    // ..first from the part of the sound that's in memory..
+    const int numFromMemory = jmin (endOfWindow, streamingSound.preloadLength) - next;
+
+    if (numFromMemory > 0)
+    {
+        for (int i = numChannels; --i >= 0;)
+            streamWindow.copyFrom (i, streamWindowSize, sound.data->getAudioData(), i, next, numFromMemory);
+
+        next += numFromMemory;
+    }
+
+    // ..then from the stream..
+    const int numFromStream = jmin (endOfWindow, sound.length) - next;
+
+    if (numFromStream > 0)
+    {
+        const int numRead = streamer->readFromStream (streamIndex, streamWindow, next - streamWindowStart, numFromStream);
+
+        if (numRead < numFromStream)
+            streamWindow.clear (next - streamWindowStart + numRead, numFromStream - numRead);
+
+        next += numFromStream;
+    }
+
+    // ..and anything past the end of the sound is silent.
+    if (next < endOfWindow)
+        streamWindow.clear (next - streamWindowStart, endOfWindow - next);
+
+    streamWindowSize = jmax (streamWindowSize, endOfWindow - streamWindowStart);
+    return numOut;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../../utilities/juce_UnitTest.h"
+
+class SamplerVoiceTests  : public UnitTest
+{
+public:
+    SamplerVoiceTests() : UnitTest ("SamplerVoice") {}
+
+    // produces a few seconds of sine waves, with a different frequency in each channel
+    class SineReader  : public AudioFormatReader
+    {
+    public:
+        SineReader (const int numChannels_)
+            : AudioFormatReader (nullptr, "test")
+        {
+            sampleRate = 44100.0;
+            bitsPerSample = 32;
+            lengthInSamples = 3 * 44100;
+            numChannels = (unsigned int) numChannels_;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples)
+        {
+            for (int chan = 0; chan < numDestChannels; ++chan)
+            {
+                if (destSamples [chan] != nullptr)
+                {
+                    float* const dest = reinterpret_cast <float*> (destSamples [chan] + startOffsetInDestBuffer);
+
+                    for (int i = 0; i < numSamples; ++i)
+                        dest[i] = 0.8f * (float) std::sin ((startSampleInFile + i) * 0.01 * (chan + 1));
+                }
+            }
+
+            return true;
+        }
+    };
+
+    // this is the per-sample loop that SamplerVoice used before it was vectorised
+    static void renderReference (const AudioSampleBuffer& source, AudioSampleBuffer& output,
+                                 const double pitchRatio, const float gain,
+                                 const int attackSamples, const int releaseSamples, const int noteOffTime)
+    {
+        const float* const inL = source.getSampleData (0);
+        const float* const inR = source.getNumChannels() > 1 ? source.getSampleData (1) : nullptr;
+        float* const outL = output.getSampleData (0);
+        float* const outR = output.getNumChannels() > 1 ? output.getSampleData (1) : nullptr;
+
+        double sourceSamplePosition = 0;
+        bool isInAttack = attackSamples > 0, isInRelease = false;
+        float level = isInAttack ? 0.0f : 1.0f;
+        const float attackDelta = isInAttack ? (float) (pitchRatio / attackSamples) : 0.0f;
+        const float releaseDelta = releaseSamples > 0 ? (float) (-pitchRatio / releaseSamples) : 0.0f;
+
+        for (int i = 0; i < output.getNumSamples(); ++i)
+        {
+            if (i == noteOffTime)
+            {
+                isInAttack = false;
+                isInRelease = true;
+            }
+
             const int pos = (int) sourceSamplePosition;
             const float alpha = (float) (sourceSamplePosition - pos);
             const float invAlpha = 1.0f - alpha;
 
-            // just using a very simple linear interpolation here..
             float l = (inL [pos] * invAlpha + inL [pos + 1] * alpha);
-            float r = (inR != nullptr) ? (inR [pos] * invAlpha + inR [pos + 1] * alpha)
-                                       : l;
+            float r = (inR != nullptr) ? (inR [pos] * invAlpha + inR [pos + 1] * alpha) : l;
 
-            l *= lgain;
-            r *= rgain;
+            l *= gain;
+            r *= gain;
 
             if (isInAttack)
             {
-                l *= attackReleaseLevel;
-                r *= attackReleaseLevel;
-
-                attackReleaseLevel += attackDelta;
+                l *= level;
+                r *= level;
+                level += attackDelta;
 
-                if (attackReleaseLevel >= 1.0f)
+                if (level >= 1.0f)
                 {
-                    attackReleaseLevel = 1.0f;
+                    level = 1.0f;
                     isInAttack = false;
                 }
             }
             else if (isInRelease)
             {
-                l *= attackReleaseLevel;
-                r *= attackReleaseLevel;
+                l *= level;
+                r *= level;
+                level += releaseDelta;
 
-                attackReleaseLevel += releaseDelta;
-
-                if (attackReleaseLevel <= 0.0f)
-                {
-                    stopNote (false);
+                if (level <= 0.0f)
                     break;
-                }
             }
 
             if (outR != nullptr)
             {
-                *outL++ += l;
-                *outR++ += r;
+                outL[i] += l;
+                outR[i] += r;
             }
             else
             {
-                *outL++ += (l + r) * 0.5f;
+                outL[i] += (l + r) * 0.5f;
             }
 
             sourceSamplePosition += pitchRatio;
+        }
+    }
+
+    void compareWithReference (const int numInputChannels, const int numOutputChannels, const int note,
+                               const double attackSecs, const int noteOffTime)
+    {
+        beginTest ("Inputs: " + String (numInputChannels) + ", outputs: " + String (numOutputChannels)
+                     + ", note: " + String (note) + ", attack: " + String (attackSecs) + ", note-off: " + String (noteOffTime));
+
+        const double releaseSecs = 0.02;
+        const int rootNote = 60;
+        const float velocity = 0.8f;
+
+        SineReader reader (numInputChannels);
+        BigInteger allNotes;
+        allNotes.setRange (0, 128, true);
+
+        SamplerSound* const sound = new SamplerSound ("test", reader, allNotes, rootNote, attackSecs, releaseSecs, 10.0);
+
+        Synthesiser synth;
+        synth.addVoice (new SamplerVoice());
+        synth.addSound (sound);
+        synth.setCurrentPlaybackSampleRate (reader.sampleRate);
+
+        MidiBuffer midi;
+        midi.addEvent (MidiMessage::noteOn (1, note, velocity), 0);
+        midi.addEvent (MidiMessage::noteOff (1, note), noteOffTime);
+
+        AudioSampleBuffer output (numOutputChannels, 6000), expected (numOutputChannels, 6000);
+        output.clear();
+        expected.clear();
+
+        // (awkward block sizes, so that the segments don't line up with the blocks)
+        for (int start = 0, blockSize = 1; start < output.getNumSamples(); start += blockSize, blockSize = blockSize * 2 + 3)
+            synth.renderNextBlock (output, midi, start, jmin (blockSize, output.getNumSamples() - start));
+
+        const double pitchRatio = MidiMessage::getMidiNoteInHertz (note) / MidiMessage::getMidiNoteInHertz (rootNote);
 
-            if (sourceSamplePosition > playingSound->length)
+        // (the velocity gets rounded to 7 bits on its way through the midi message)
+        renderReference (*sound->getAudioData(), expected, pitchRatio, MidiMessage::noteOn (1, note, velocity).getFloatVelocity(),
+                         roundToInt (attackSecs * reader.sampleRate), roundToInt (releaseSecs * reader.sampleRate), noteOffTime);
+
+        float maxError = 0;
+
+        for (int chan = 0; chan < numOutputChannels; ++chan)
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                maxError = jmax (maxError, std::abs (output.getSampleData (chan)[i] - expected.getSampleData (chan)[i]));
+
+        expect (maxError < 5.0e-5f, "error: " + String (maxError));
+    }
+
+    void runTest()
+    {
+        const int notes[] = { 60, 67, 53, 72, 41 };
+
+        for (int numInputs = 1; numInputs <= 2; ++numInputs)
+        {
+            for (int numOutputs = 1; numOutputs <= 2; ++numOutputs)
             {
-                stopNote (false);
-                break;
+                for (int i = 0; i < numElementsInArray (notes); ++i)
+                {
+                    compareWithReference (numInputs, numOutputs, notes[i], 0.01, 3000);
+
+                    // (a note-off that arrives before the attack has finished)
+                    compareWithReference (numInputs, numOutputs, notes[i], 0.1, 1000);
+                }
             }
         }
     }
-}
+};
+
+static SamplerVoiceTests samplerVoiceTests;
+
+#endif
 
 END_JUCE_NAMESPACE
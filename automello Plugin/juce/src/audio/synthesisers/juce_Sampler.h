@@ -28,7 +28,85 @@
 
 #include "../../maths/juce_BigInteger.h"
 #include "../../memory/juce_ScopedPointer.h"
+#include "../../memory/juce_ReferenceCountedObject.h"
+#include "../../memory/juce_Atomic.h"
+#include "../../containers/juce_ReferenceCountedArray.h"
+#include "../../threads/juce_CriticalSection.h"
 #include "juce_Synthesiser.h"
+class SamplerStreamer;
+
+
+//==============================================================================
+/**
+    The decoded audio that a SamplerSound plays.
+
+    Once it has been created this data never changes, so a single copy of it can be
+    shared by any number of sounds - the SampleCache uses this to avoid loading the
+    same file more than once.
+
+    @see SamplerSound, SampleCache
+*/
+class JUCE_API  SamplerSoundData  : public ReferenceCountedObject
+{
+public:
+    //==============================================================================
+    /** Reads audio from a source into memory.
+
+        @param source           the audio to load. This object can be safely deleted by the
+                                caller after this constructor returns
+        @param numSamplesToLoad the number of samples to read from the start of the source.
+                                This is clipped to the source's length
+    */
+    SamplerSoundData (AudioFormatReader& source, int numSamplesToLoad);
+
+    /** Destructor. */
+    ~SamplerSoundData();
+
+    //==============================================================================
+    /** Returns the audio, which will have either one or two channels.
+        The buffer has a few extra samples of padding after getNumSamples(), so don't use its
+        size to find out how much audio there is.
+    */
+    const AudioSampleBuffer& getAudioData() const noexcept      { return buffer; }
+
+    /** Returns the number of samples that were loaded. */
+    int getNumSamples() const noexcept                          { return numSamples; }
+
+    /** Returns the length of the source that the data was loaded from.
+        This can be longer than getNumSamples() if only the start of it was loaded.
+    */
+    int getSourceLength() const noexcept                        { return sourceLength; }
+
+    /** Returns the source's sample rate, or 0 if it couldn't be read. */
+    double getSampleRate() const noexcept                       { return sampleRate; }
+
+    //==============================================================================
+    /** Returns a copy of this data that has been converted to a different sample rate.
+
+        The first time a particular rate is asked for, this uses a high-quality filter to
+        convert the audio, which can take a while - so it's best called on a background thread.
+        After that, the same copy is returned, and it stays alive for as long as this
+        object does, so it's shared by all the sounds that use this data.
+
+        If the new rate is the same as this data's rate, this just returns the object itself.
+    */
+    SamplerSoundData* getResampledVersion (double newSampleRate);
+
+    /** A pointer type that can be used to share the data. */
+    typedef ReferenceCountedObjectPtr <SamplerSoundData> Ptr;
+
+private:
+    //==============================================================================
+    AudioSampleBuffer buffer;
+    double sampleRate;
+    int numSamples, sourceLength;
+    ReferenceCountedArray <SamplerSoundData> resampledVersions;
+    CriticalSection resampleLock;
+
+    SamplerSoundData (const SamplerSoundData& source, double newSampleRate);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerSoundData);
+};
 
 
 //==============================================================================
@@ -36,7 +114,8 @@
     A subclass of SynthesiserSound that represents a sampled audio clip.
 
     This is a pretty basic sampler, and just attempts to load the whole audio stream
-    into memory.
+    into memory. For long samples, a StreamingSamplerSound will only keep the start
+    of the sample in memory, and play the rest of it from disk.
 
     To use it, create a Synthesiser, add some SamplerVoice objects to it, then
     give it some SampledSound objects to play.
@@ -73,6 +152,26 @@ public:
                   double releaseTimeSecs,
                   double maxSampleLengthSeconds);
 
+    /** Creates a sound that plays some audio that has already been loaded.
+
+        This lets several sounds share the same data, e.g. one that was returned by the
+        SampleCache.
+
+        @param name         a name for the sample
+        @param data         the audio to play - this must not be null
+        @param midiNotes    the set of midi keys that this sound should be played on
+        @param midiNoteForNormalPitch   the midi note at which the sample should be played
+                                        with its natural rate
+        @param attackTimeSecs   the attack (fade-in) time, in seconds
+        @param releaseTimeSecs  the decay (fade-out) time, in seconds
+    */
+    SamplerSound (const String& name,
+                  SamplerSoundData* data,
+                  const BigInteger& midiNotes,
+                  int midiNoteForNormalPitch,
+                  double attackTimeSecs,
+                  double releaseTimeSecs);
+
     /** Destructor. */
     ~SamplerSound();
 
@@ -83,7 +182,31 @@ public:
     /** Returns the audio sample data.
         This could be 0 if there was a problem loading it.
     */
-    AudioSampleBuffer* getAudioData() const                 { return data; }
+    const AudioSampleBuffer* getAudioData() const           { return data != nullptr ? &(data->getAudioData()) : nullptr; }
+
+    /** Returns the shared object that holds the sound's audio. */
+    SamplerSoundData* getSoundData() const noexcept         { return data; }
+
+    //==============================================================================
+    /** Converts the sound's audio to the sample rate that it'll be played at.
+
+        A voice has to interpolate every sample of a sound whose rate doesn't match its
+        own, even at the sound's root note. After this has been called with the voices'
+        sample rate, notes at the root pitch are a straight copy of the data, and other
+        notes only need to be interpolated for the change in pitch.
+
+        The conversion can take a while, so this should be called on a background thread.
+        Voices carry on playing the original data until it has finished, and any notes that
+        are already playing when it finishes will stay with the data they started with.
+        The original data is kept, so it's cheap to switch back to it (or to any rate that
+        has already been used).
+
+        Sounds that only keep part of their audio in memory (i.e. a StreamingSamplerSound
+        that's longer than its preload time) can't be resampled, and will return false.
+
+        @see SamplerSoundData::getResampledVersion
+    */
+    bool resampleTo (double newSampleRate);
 
 
     //==============================================================================
@@ -91,12 +214,36 @@ public:
     bool appliesToChannel (const int midiChannel);
 
 
+protected:
+    //==============================================================================
+    /** Creates a sound without loading any audio.
+        Subclasses that use this must call setSoundData() from their own constructor.
+    */
+    SamplerSound (const String& name,
+                  const BigInteger& midiNotes,
+                  int midiNoteForNormalPitch);
+
+    /** Sets the audio that the sound plays.
+
+        @param data             the audio data, which may only hold the start of the sound
+        @param totalLength      the length that the sound should be played for - this can be
+                                longer than the data if a subclass provides the rest
+        @param attackTimeSecs   the attack (fade-in) time, in seconds
+        @param releaseTimeSecs  the decay (fade-out) time, in seconds
+    */
+    void setSoundData (SamplerSoundData* data,
+                       int totalLength,
+                       double attackTimeSecs,
+                       double releaseTimeSecs);
+
 private:
     //==============================================================================
     friend class SamplerVoice;
+    friend class SamplerStreamer;
 
     String name;
-    ScopedPointer <AudioSampleBuffer> data;
+    SamplerSoundData::Ptr data;
+    Atomic <SamplerSoundData*> playbackData;
     double sourceSampleRate;
     BigInteger midiNotes;
     int length, attackSamples, releaseSamples;
@@ -143,6 +290,42 @@ public:
 
     void renderNextBlock (AudioSampleBuffer& outputBuffer, int startSample, int numSamples);
 
+    //==============================================================================
+    /** The methods that a SamplerVoice can use to interpolate between source samples. */
+    enum InterpolationMode
+    {
+        linearInterpolation = 0,    /**< The cheapest method, but it'll alias badly if a sample
+                                         is pitched a long way from its root note. */
+        cubicInterpolation,         /**< A 4-point cubic Hermite interpolator, which is smoother
+                                         than linear but still not band-limited. */
+        sincInterpolation           /**< A 32-point windowed-sinc interpolator, whose cutoff follows
+                                         the pitch so that samples can be pitched up without aliasing.
+                                         This is the best quality, but uses by far the most CPU. */
+    };
+
+    /** Changes the interpolation method that the voice uses.
+
+        This takes effect from the next note that the voice starts, and it's safe to call while
+        the voice is rendering on another thread. By default, a voice uses linearInterpolation.
+
+        The first switch to sincInterpolation creates the tables that it needs, unless
+        createInterpolationTables() has already done so, so if this might be called from the
+        audio thread (e.g. from a plugin parameter change), call createInterpolationTables()
+        beforehand.
+    */
+    void setInterpolationMode (InterpolationMode newMode);
+
+    /** Creates the tables that sincInterpolation uses, if they don't already exist.
+
+        These are shared by all voices, and take a while to build, so this lets you get it out
+        of the way before playback starts.
+        @see setInterpolationMode
+    */
+    static void createInterpolationTables();
+
+    /** Returns the interpolation method that was set with setInterpolationMode(). */
+    InterpolationMode getInterpolationMode() const noexcept         { return (InterpolationMode) interpolationMode.get(); }
+
 
 private:
     //==============================================================================
@@ -150,6 +333,22 @@ private:
     double sourceSamplePosition;
     float lgain, rgain, attackReleaseLevel, attackDelta, releaseDelta;
     bool isInAttack, isInRelease;
+    Atomic<int> interpolationMode;  // (set from other threads, and read when a note starts)
+    InterpolationMode noteInterpolationMode;
+    int playbackLength;
+    const SamplerSoundData* noteData;
+
+    // state used while playing a StreamingSamplerSound
+    SamplerStreamer* streamer;
+    int streamIndex;
+    AudioSampleBuffer streamWindow;
+    int streamWindowStart, streamWindowSize;
+
+    bool renderSamples (const float* inL, const float* inR, int firstSampleInSource, int numAvailable,
+                        float* outL, float* outR, int numSamples);
+    static int getNumInterpolationTaps (InterpolationMode mode, bool before) noexcept;
+    int fillStreamWindow (const SamplerSound& sound, int numSamples);
+    void closeStream();
 
     JUCE_LEAK_DETECTOR (SamplerVoice);
 };
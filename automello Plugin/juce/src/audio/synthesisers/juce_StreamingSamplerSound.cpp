@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_StreamingSamplerSound.h"
+
+
+//==============================================================================
+class SamplerStreamer::Stream
+{
+public:
+    Stream (const int samplesPerStream)
+        : state (streamFree),
+          sound (nullptr),
+          nextSampleToRead (0),
+          fifo (samplesPerStream),
+          buffer (2, samplesPerStream)
+    {
+    }
+
+    /* A stream is claimed and released by the audio thread, but only ever goes back
+       to being free on the reader thread, so the reader never has one reset under its feet.
+    */
+    enum State
+    {
+        streamFree,
+        streamOpening,
+        streamActive,
+        streamClosing
+    };
+
+    Atomic <int> state;
+    const StreamingSamplerSound* sound;
+    int nextSampleToRead;
+    AbstractFifo fifo;
+    AudioSampleBuffer buffer;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE (Stream);
+};
+
+//==============================================================================
+SamplerStreamer::SamplerStreamer (TimeSliceThread& thread_,
+                                  const int numStreams,
+                                  const int samplesPerStream)
+    : thread (thread_),
+      readBuffer (2, jmin (8192, samplesPerStream))
+{
+    jassert (numStreams > 0 && samplesPerStream > 1024);
+
+    for (int i = 0; i < numStreams; ++i)
+        streams.add (new Stream (samplesPerStream));
+
+    thread.addTimeSliceClient (this);
+}
+
+SamplerStreamer::~SamplerStreamer()
+{
+    thread.removeTimeSliceClient (this);
+}
+
+//==============================================================================
+int SamplerStreamer::openStream (const StreamingSamplerSound& sound)
+{
+    for (int i = 0; i < streams.size(); ++i)
+    {
+        Stream& s = *streams.getUnchecked (i);
+
+        if (s.state.compareAndSetBool (Stream::streamOpening, Stream::streamFree))
+        {
+            s.sound = &sound;
+            s.nextSampleToRead = sound.preloadLength;
+            s.fifo.reset();
+            s.state = Stream::streamActive;
+
+            thread.notify();
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+int SamplerStreamer::readFromStream (const int streamIndex, AudioSampleBuffer& dest,
+                                     const int destStartSample, const int numSamples)
+{
+    Stream& s = *streams.getUnchecked (streamIndex);
+    jassert (s.state.get() == Stream::streamActive);
+
+    int start1, size1, start2, size2;
+    s.fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    for (int i = jmin (dest.getNumChannels(), s.sound->data->getAudioData().getNumChannels()); --i >= 0;)
+    {
+        dest.copyFrom (i, destStartSample, s.buffer, i, start1, size1);
+        dest.copyFrom (i, destStartSample + size1, s.buffer, i, start2, size2);
+    }
+
+    const int numRead = size1 + size2;
+    s.fifo.finishedRead (numRead);
+
+    if (numRead < numSamples)
+        ++numUnderruns;
+
+    if (s.fifo.getFreeSpace() >= readBuffer.getNumSamples())
+        thread.notify();
+
+    return numRead;
+}
+
+void SamplerStreamer::closeStream (const int streamIndex)
+{
+    streams.getUnchecked (streamIndex)->state = Stream::streamClosing;
+}
+
+void SamplerStreamer::soundDeleted (const StreamingSamplerSound& sound)
+{
+    const ScopedLock sl (readLock);
+
+    for (int i = streams.size(); --i >= 0;)
+    {
+        Stream& s = *streams.getUnchecked (i);
+
+        if (s.sound == &sound)
+        {
+            // a sound can't be deleted while a voice is still playing it!
+            jassert (s.state.get() != Stream::streamActive);
+
+            s.sound = nullptr;
+            s.state = Stream::streamFree;
+        }
+    }
+}
+
+//==============================================================================
+int SamplerStreamer::useTimeSlice()
+{
+    const ScopedLock sl (readLock);
+    bool isBusy = false;
+
+    for (int i = 0; i < streams.size(); ++i)
+    {
+        Stream& s = *streams.getUnchecked (i);
+        const int state = s.state.get();
+
+        if (state == Stream::streamClosing)
+        {
+            s.sound = nullptr;
+            s.state = Stream::streamFree;
+        }
+        else if (state == Stream::streamActive)
+        {
+            if (fillStream (s))
+                isBusy = true;
+        }
+    }
+
+    return isBusy ? 1 : 20;
+}
+
+bool SamplerStreamer::fillStream (Stream& s)
+{
+    const int numLeft = s.sound->length - s.nextSampleToRead;
+
+    // (the fifo's getFreeSpace() can over-report by one, so the size of the read has
+    // to come from the space that prepareToWrite() actually hands out)
+    int start1, size1, start2, size2;
+    s.fifo.prepareToWrite (jmin (numLeft, readBuffer.getNumSamples()), start1, size1, start2, size2);
+    const int numToRead = size1 + size2;
+
+    // avoid lots of tiny reads, unless it's the last bit of the sound
+    if (numToRead <= 0 || (numToRead < numLeft && numToRead < readBuffer.getNumSamples() / 2))
+        return false;
+
+    readBuffer.readFromAudioReader (s.sound->reader, 0, numToRead, s.nextSampleToRead, true, true);
+    s.nextSampleToRead += numToRead;
+
+    for (int i = s.sound->data->getAudioData().getNumChannels(); --i >= 0;)
+    {
+        s.buffer.copyFrom (i, start1, readBuffer, i, 0, size1);
+        s.buffer.copyFrom (i, start2, readBuffer, i, size1, size2);
+    }
+
+    s.fifo.finishedWrite (size1 + size2);
+    return true;
+}
+
+//==============================================================================
+StreamingSamplerSound::StreamingSamplerSound (const String& name_,
+                                              AudioFormatReader* const source,
+                                              const BigInteger& midiNotes_,
+                                              const int midiNoteForNormalPitch,
+                                              const double attackTimeSecs,
+                                              const double releaseTimeSecs,
+                                              const double preloadTimeSecs,
+                                              SamplerStreamer& streamer_)
+    : SamplerSound (name_, midiNotes_, midiNoteForNormalPitch),
+      reader (source),
+      streamer (streamer_),
+      preloadLength (0)
+{
+    jassert (source != nullptr);
+
+    if (source != nullptr)
+    {
+        SamplerSoundData* const preloadedData
+            = new SamplerSoundData (*source, roundToInt (preloadTimeSecs * source->sampleRate));
+
+        preloadLength = preloadedData->getNumSamples();
+        setSoundData (preloadedData, (int) source->lengthInSamples, attackTimeSecs, releaseTimeSecs);
+    }
+}
+
+StreamingSamplerSound::StreamingSamplerSound (const String& name_,
+                                              AudioFormatReader* const source,
+                                              SamplerSoundData* const preloadedData,
+                                              const BigInteger& midiNotes_,
+                                              const int midiNoteForNormalPitch,
+                                              const double attackTimeSecs,
+                                              const double releaseTimeSecs,
+                                              SamplerStreamer& streamer_)
+    : SamplerSound (name_, midiNotes_, midiNoteForNormalPitch),
+      reader (source),
+      streamer (streamer_),
+      preloadLength (0)
+{
+    jassert (source != nullptr && preloadedData != nullptr);
+
+    if (source != nullptr && preloadedData != nullptr)
+    {
+        // the data must have come from the same audio as the reader..
+        jassert (preloadedData->getSourceLength() == (int) source->lengthInSamples);
+
+        preloadLength = preloadedData->getNumSamples();
+        setSoundData (preloadedData, (int) source->lengthInSamples, attackTimeSecs, releaseTimeSecs);
+    }
+}
+
+StreamingSamplerSound::~StreamingSamplerSound()
+{
+    streamer.soundDeleted (*this);
+}
+
+END_JUCE_NAMESPACE
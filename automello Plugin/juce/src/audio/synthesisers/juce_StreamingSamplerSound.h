@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
+#define __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
+
+#include "juce_Sampler.h"
+#include "../audio_file_formats/juce_AudioFormatReader.h"
+#include "../../threads/juce_TimeSliceThread.h"
+#include "../../containers/juce_AbstractFifo.h"
+#include "../../containers/juce_OwnedArray.h"
+class StreamingSamplerSound;
+
+
+//==============================================================================
+/**
+    Feeds StreamingSamplerSounds to the SamplerVoices that are playing them.
+
+    A SamplerStreamer owns a fixed number of lock-free ring buffers ("streams"). When a
+    SamplerVoice starts playing a StreamingSamplerSound it claims one of these, and the
+    streamer then uses a TimeSliceThread to keep it topped-up from the sound's
+    AudioFormatReader, starting at the point where the sound's preloaded data ends.
+
+    All the buffers are allocated when the streamer is created, so the audio thread never
+    has to allocate or wait for the disk. You should create enough streams for the number
+    of voices that might be playing streamed sounds at once - if a voice can't get one,
+    it'll just play the part of the sound that's held in memory.
+
+    @see StreamingSamplerSound, SamplerVoice
+*/
+class JUCE_API  SamplerStreamer  : private TimeSliceClient
+{
+public:
+    //==============================================================================
+    /** Creates a streamer.
+
+        @param thread               the thread that should do the reading. The streamer adds
+                                    itself to this thread, but it's up to the caller to start it
+        @param numStreams           the maximum number of voices that can stream at once
+        @param samplesPerStream     the size of each voice's ring buffer. This needs to hold
+                                    enough audio to ride out any delays in reading the disk
+    */
+    SamplerStreamer (TimeSliceThread& thread,
+                     int numStreams,
+                     int samplesPerStream = 32768);
+
+    /** Destructor.
+        Any StreamingSamplerSounds that use this streamer must be deleted before it is.
+    */
+    ~SamplerStreamer();
+
+    //==============================================================================
+    /** Returns the number of times that a voice has run out of streamed data because
+        the disk couldn't keep up.
+    */
+    int getNumUnderruns() const noexcept            { return numUnderruns.get(); }
+
+
+private:
+    //==============================================================================
+    friend class SamplerVoice;
+    friend class StreamingSamplerSound;
+    class Stream;
+
+    TimeSliceThread& thread;
+    OwnedArray <Stream> streams;
+    AudioSampleBuffer readBuffer;
+    CriticalSection readLock;
+    Atomic <int> numUnderruns;
+
+    int openStream (const StreamingSamplerSound& sound);
+    int readFromStream (int streamIndex, AudioSampleBuffer& dest, int destStartSample, int numSamples);
+    void closeStream (int streamIndex);
+    void soundDeleted (const StreamingSamplerSound& sound);
+    bool fillStream (Stream& stream);
+    int useTimeSlice();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerStreamer);
+};
+
+
+//==============================================================================
+/**
+    A SamplerSound that only keeps the start of its sample in memory, and streams the
+    rest from disk as it plays.
+
+    This lets you use samples of any length without them all having to fit into memory.
+    The preloaded section is played while the SamplerStreamer fetches the rest, so it
+    needs to be long enough to cover the time it takes to read the first block from disk.
+
+    To play these, just give your Synthesiser some normal SamplerVoice objects.
+
+    @see SamplerStreamer, SamplerSound, SamplerVoice
+*/
+class JUCE_API  StreamingSamplerSound    : public SamplerSound
+{
+public:
+    //==============================================================================
+    /** Creates a streaming sound.
+
+        @param name             a name for the sample
+        @param source           the audio to play. This object will be deleted by the sound
+                                when no longer needed, and mustn't be used by the caller after
+                                being passed in
+        @param midiNotes        the set of midi keys that this sound should be played on
+        @param midiNoteForNormalPitch   the midi note at which the sample should be played
+                                        with its natural rate
+        @param attackTimeSecs   the attack (fade-in) time, in seconds
+        @param releaseTimeSecs  the decay (fade-out) time, in seconds
+        @param preloadTimeSecs  the length of audio to keep in memory, in seconds
+        @param streamer         the streamer that will supply the rest of the audio. This
+                                must not be deleted before the sound is
+    */
+    StreamingSamplerSound (const String& name,
+                           AudioFormatReader* source,
+                           const BigInteger& midiNotes,
+                           int midiNoteForNormalPitch,
+                           double attackTimeSecs,
+                           double releaseTimeSecs,
+                           double preloadTimeSecs,
+                           SamplerStreamer& streamer);
+
+    /** Creates a streaming sound whose start has already been loaded.
+
+        This lets the preloaded part of the sound be shared, e.g. by getting it from
+        the SampleCache.
+
+        @param name             a name for the sample
+        @param source           the audio to play. This object will be deleted by the sound
+                                when no longer needed, and mustn't be used by the caller after
+                                being passed in
+        @param preloadedData    the start of the source's audio, which must have been read
+                                from the same source
+        @param midiNotes        the set of midi keys that this sound should be played on
+        @param midiNoteForNormalPitch   the midi note at which the sample should be played
+                                        with its natural rate
+        @param attackTimeSecs   the attack (fade-in) time, in seconds
+        @param releaseTimeSecs  the decay (fade-out) time, in seconds
+        @param streamer         the streamer that will supply the rest of the audio. This
+                                must not be deleted before the sound is
+    */
+    StreamingSamplerSound (const String& name,
+                           AudioFormatReader* source,
+                           SamplerSoundData* preloadedData,
+                           const BigInteger& midiNotes,
+                           int midiNoteForNormalPitch,
+                           double attackTimeSecs,
+                           double releaseTimeSecs,
+                           SamplerStreamer& streamer);
+
+    /** Destructor. */
+    ~StreamingSamplerSound();
+
+
+private:
+    //==============================================================================
+    friend class SamplerVoice;
+    friend class SamplerStreamer;
+
+    ScopedPointer <AudioFormatReader> reader;
+    SamplerStreamer& streamer;
+    int preloadLength;
+
+    JUCE_LEAK_DETECTOR (StreamingSamplerSound);
+};
+
+
+#endif   // __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
@@ -28,6 +28,10 @@
 BEGIN_JUCE_NAMESPACE
 
 #include "juce_Synthesiser.h"
+#include "../../containers/juce_AbstractFifo.h"
+#include "../../containers/juce_Array.h"
+#include "../../events/juce_Timer.h"
+#include "../../threads/juce_ParallelTaskRunner.h"
 
 
 //==============================================================================
@@ -45,8 +49,17 @@ SynthesiserVoice::SynthesiserVoice()
       currentlyPlayingNote (-1),
       noteOnTime (0),
       keyIsDown (false),
-      sostenutoPedalDown (false)
+      sostenutoPedalDown (false),
+      owner (nullptr),
+      listIndex (-1),
+      listNote (-1),
+      channelMask (0),
+      isActive (false),
+      previousWithNote (nullptr),
+      nextWithNote (nullptr)
 {
+    zerostruct (previousOnChannel);
+    zerostruct (nextOnChannel);
 }
 
 SynthesiserVoice::~SynthesiserVoice()
@@ -66,65 +79,653 @@ void SynthesiserVoice::setCurrentPlaybackSampleRate (const double newRate)
 
 void SynthesiserVoice::clearCurrentNote()
 {
+    // (if the voices are being rendered on several threads, the synth catches up with
+    // the ones that have finished once they're all done)
+    if (isActive && ! owner->isRenderingInParallel)
+        owner->voiceFinished (this);
+
     currentlyPlayingNote = -1;
     currentlyPlayingSound = nullptr;
 }
 
+//==============================================================================
+namespace SynthesiserHelpers
+{
+    /*  Fills in a table of the sounds that apply to each note, only reallocating it if it
+        needs to get bigger. Returns the number of sounds that were used to build it.
+
+        The table starts out with room for one sound per note (see initialSoundLookupSize),
+        so in the usual case of a key-mapped set of sounds it's never reallocated after it's
+        first been created.
+
+        (The sounds for each note are listed in the same order that the old linear search
+        used to find them)
+    */
+    enum { initialSoundLookupSize = 128 };
+
+    int buildSoundLookup (const ReferenceCountedArray <SynthesiserSound>& sounds,
+                          HeapBlock <SynthesiserSound*>& noteSounds,
+                          int& numNoteSoundsAllocated,
+                          int* const noteSoundsStart)
+    {
+        int numNeeded = 0;
+
+        for (int note = 0; note < 128; ++note)
+            for (int i = sounds.size(); --i >= 0;)
+                if (sounds.getUnchecked (i)->appliesToNote (note))
+                    ++numNeeded;
+
+        if (numNeeded > numNoteSoundsAllocated)
+        {
+            numNoteSoundsAllocated = numNeeded;
+            noteSounds.malloc ((size_t) numNeeded);
+        }
+
+        int numDone = 0;
+
+        for (int note = 0; note < 128; ++note)
+        {
+            noteSoundsStart [note] = numDone;
+
+            for (int i = sounds.size(); --i >= 0;)
+            {
+                SynthesiserSound* const sound = sounds.getUnchecked (i);
+
+                if (sound->appliesToNote (note))
+                    noteSounds [numDone++] = sound;
+            }
+        }
+
+        noteSoundsStart [128] = numDone;
+        return sounds.size();
+    }
+
+    /*  Locks the synth, unless it's in real-time-safe mode, where the render and note
+        methods are only ever called by the audio thread.
+    */
+    class ScopedRenderLock
+    {
+    public:
+        ScopedRenderLock (const CriticalSection& lock_, const bool isRealtimeSafe) noexcept
+            : lock (isRealtimeSafe ? nullptr : &lock_)
+        {
+            if (lock != nullptr)
+                lock->enter();
+        }
+
+        ~ScopedRenderLock() noexcept
+        {
+            if (lock != nullptr)
+                lock->exit();
+        }
+
+    private:
+        const CriticalSection* const lock;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRenderLock);
+    };
+}
+
+//==============================================================================
+/*  Renders a set of voices on several threads at once. Each voice renders into a buffer of
+    its own, and these are added to the output in voice order, so the result is the same
+    whichever thread happened to render each voice.
+*/
+class Synthesiser::ParallelRenderer  : private ParallelTaskRunner::TaskList
+{
+public:
+    ParallelRenderer (const int numThreads, const int numChannels_, const int maximumBlockSize_,
+                      const int maximumNumVoices)
+        : numChannels (numChannels_),
+          maximumBlockSize (maximumBlockSize_),
+          voicesToRender (nullptr),
+          numSamplesToRender (0),
+          runner ("Synthesiser render thread", numThreads)
+    {
+        for (int i = 0; i < maximumNumVoices; ++i)
+            voiceBuffers.add (new AudioSampleBuffer (numChannels, maximumBlockSize));
+    }
+
+    int getNumThreads() const noexcept          { return runner.getNumThreads(); }
+
+    bool canRender (const AudioSampleBuffer& outputBuffer, const int numSamples, const int numVoices) const noexcept
+    {
+        return numVoices >= minimumVoicesToShare
+                && numVoices <= voiceBuffers.size()
+                && numSamples >= minimumSamplesToShare
+                && numSamples <= maximumBlockSize
+                && outputBuffer.getNumChannels() == numChannels;
+    }
+
+    void render (SynthesiserVoice* const* const voices, const int numVoices,
+                 AudioSampleBuffer& outputBuffer, const int startSample, const int numSamples,
+                 const double sampleRate)
+    {
+        voicesToRender = voices;
+        numSamplesToRender = numSamples;
+
+        // (a worker that takes longer than the block lasts is going to make the audio late
+        // anyway, so that's as long as it's worth waiting for one)
+        runner.runTasks (*this, numVoices, sampleRate > 0 ? roundToInt (numSamples * 1000.0 / sampleRate) : 1);
+
+        for (int i = 0; i < numVoices; ++i)
+        {
+            const AudioSampleBuffer& voiceBuffer = *voiceBuffers.getUnchecked (i);
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                outputBuffer.addFrom (chan, startSample, voiceBuffer, chan, 0, numSamples);
+        }
+    }
+
+private:
+    //==============================================================================
+    enum { minimumVoicesToShare = 4, minimumSamplesToShare = 32 };
+
+    const int numChannels, maximumBlockSize;
+    OwnedArray <AudioSampleBuffer> voiceBuffers;
+    SynthesiserVoice* const* voicesToRender;
+    int numSamplesToRender;
+    ParallelTaskRunner runner; // (declared last, so that the threads are stopped first)
+
+    void runTask (const int index)
+    {
+        AudioSampleBuffer& voiceBuffer = *voiceBuffers.getUnchecked (index);
+        voiceBuffer.clear (0, numSamplesToRender);
+        voicesToRender [index]->renderNextBlock (voiceBuffer, 0, numSamplesToRender);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelRenderer);
+};
+
+//==============================================================================
+/*  In real-time-safe mode, the voices and sounds are changed in a copy of them which
+    belongs to the other threads. Each change publishes a complete new configuration,
+    with all its memory already allocated, which the audio thread swaps into the synth at
+    the start of its next block. The audio thread hands the old configuration back through
+    a fifo so that it can be deleted here, and anything that was removed is kept alive
+    until the audio thread can't be using it any more.
+
+    The sample rate and the render threads get handed over in the same way, so an old
+    renderer is only deleted once it's come back in a retired configuration.
+*/
+class Synthesiser::RealtimeUpdater  : private Timer
+{
+public:
+    //==============================================================================
+    struct Configuration
+    {
+        Configuration()
+            : noteSounds ((size_t) SynthesiserHelpers::initialSoundLookupSize),
+              numNoteSoundsAllocated (SynthesiserHelpers::initialSoundLookupSize),
+              sampleRate (0),
+              changesRenderer (false),
+              generation (0)
+        {
+            zerostruct (noteSoundsStart);
+        }
+
+        ~Configuration()
+        {
+            voices.clear (false); // (the voices are deleted by the updater once they're finished with)
+        }
+
+        OwnedArray <SynthesiserVoice> voices;
+        ReferenceCountedArray <SynthesiserSound> sounds;
+        HeapBlock <SynthesiserVoice*> freeVoices, activeVoices;
+        HeapBlock <SynthesiserSound*> noteSounds;
+        int noteSoundsStart [129];
+        int numNoteSoundsAllocated;
+        Array <SynthesiserVoice*> removedVoices;
+        double sampleRate;
+
+        // If changesRenderer is set, the synth swaps its renderer for this one (which may
+        // be null), and the old one then gets deleted along with this configuration
+        ScopedPointer <ParallelRenderer> renderer;
+        bool changesRenderer;
+
+        int generation;
+
+        JUCE_DECLARE_NON_COPYABLE (Configuration);
+    };
+
+    //==============================================================================
+    RealtimeUpdater (Synthesiser& owner)
+        : shadowSampleRate (owner.sampleRate),
+          rendererChanged (false),
+          retiredFifo (numElementsInArray (retired)),
+          publishedGeneration (0)
+    {
+        for (int i = 0; i < owner.voices.size(); ++i)
+            shadowVoices.add (owner.voices.getUnchecked (i));
+
+        shadowSounds = owner.sounds;
+        startTimer (500);
+    }
+
+    ~RealtimeUpdater()
+    {
+        stopTimer();
+
+        // (the synth should have taken the last configuration before deleting this)
+        jassert (pending.get() == nullptr);
+        delete pending.exchange (nullptr);
+
+        releaseRetiredObjects();
+        jassert (removedVoices.size() == 0);
+    }
+
+    //==============================================================================
+    int getNumVoices() const                            { const ScopedLock sl (configLock); return shadowVoices.size(); }
+    SynthesiserVoice* getVoice (int index) const        { const ScopedLock sl (configLock); return shadowVoices [index]; }
+    int getNumSounds() const                            { const ScopedLock sl (configLock); return shadowSounds.size(); }
+    SynthesiserSound* getSound (int index) const        { const ScopedLock sl (configLock); return shadowSounds [index]; }
+    const ReferenceCountedArray <SynthesiserSound> getSounds() const    { const ScopedLock sl (configLock); return shadowSounds; }
+
+    void addVoice (SynthesiserVoice* const newVoice)
+    {
+        const ScopedLock sl (configLock);
+        shadowVoices.add (newVoice);
+        publish();
+    }
+
+    void removeVoice (const int index)
+    {
+        const ScopedLock sl (configLock);
+        SynthesiserVoice* const voice = shadowVoices [index];
+
+        if (voice != nullptr)
+        {
+            shadowVoices.remove (index);
+            removedVoices.add (voice);
+            publish();
+        }
+    }
+
+    void clearVoices()
+    {
+        const ScopedLock sl (configLock);
+        removedVoices.addArray (shadowVoices);
+        shadowVoices.clear();
+        publish();
+    }
+
+    void addSound (const SynthesiserSound::Ptr& newSound)
+    {
+        const ScopedLock sl (configLock);
+        shadowSounds.add (newSound);
+        publish();
+    }
+
+    void removeSound (const int index)
+    {
+        const ScopedLock sl (configLock);
+        SynthesiserSound* const sound = shadowSounds [index];
+
+        if (sound != nullptr)
+        {
+            removedSounds.addIfNotAlreadyThere (sound);
+            shadowSounds.remove (index);
+            publish();
+        }
+    }
+
+    void clearSounds()
+    {
+        const ScopedLock sl (configLock);
+
+        for (int i = shadowSounds.size(); --i >= 0;)
+            removedSounds.addIfNotAlreadyThere (shadowSounds.getUnchecked (i));
+
+        shadowSounds.clear();
+        publish();
+    }
+
+    void swapSounds (ReferenceCountedArray <SynthesiserSound>& newSounds)
+    {
+        const ScopedLock sl (configLock);
+        shadowSounds.swapWithArray (newSounds);
+
+        // (the audio thread may still be using the old sounds, so they're held on to here
+        // rather than being left in the caller's array)
+        for (int i = newSounds.size(); --i >= 0;)
+        {
+            SynthesiserSound* const sound = newSounds.getUnchecked (i);
+
+            if (! shadowSounds.contains (sound))
+                removedSounds.addIfNotAlreadyThere (sound);
+        }
+
+        publish();
+    }
+
+    void setSampleRate (const double newRate)
+    {
+        const ScopedLock sl (configLock);
+
+        if (shadowSampleRate != newRate)
+        {
+            shadowSampleRate = newRate;
+            publish();
+        }
+    }
+
+    void setRenderer (ParallelRenderer* const newRenderer)
+    {
+        const ScopedLock sl (configLock);
+        nextRenderer = newRenderer;
+        rendererChanged = true;
+        publish();
+    }
+
+    void publish()
+    {
+        const ScopedLock sl (configLock);
+
+        // If the audio thread hasn't picked up the previous configuration yet, it never will,
+        // but a renderer that it was carrying still needs to be passed on to the next one
+        {
+            ScopedPointer <Configuration> previous (pending.exchange (nullptr));
+
+            if (previous != nullptr && previous->changesRenderer && ! rendererChanged)
+            {
+                nextRenderer = previous->renderer.release();
+                rendererChanged = true;
+            }
+        }
+
+        ScopedPointer <Configuration> config (new Configuration());
+
+        config->voices.ensureStorageAllocated (shadowVoices.size());
+
+        for (int i = 0; i < shadowVoices.size(); ++i)
+            config->voices.add (shadowVoices.getUnchecked (i));
+
+        config->sounds = shadowSounds;
+
+        const int numVoiceSlots = jmax (1, shadowVoices.size());
+        config->freeVoices.malloc ((size_t) numVoiceSlots);
+        config->activeVoices.malloc ((size_t) numVoiceSlots);
+
+        SynthesiserHelpers::buildSoundLookup (config->sounds, config->noteSounds,
+                                              config->numNoteSoundsAllocated, config->noteSoundsStart);
+
+        config->removedVoices = removedVoices;
+        config->sampleRate = shadowSampleRate;
+        config->renderer = nextRenderer.release();
+        config->changesRenderer = rendererChanged;
+        rendererChanged = false;
+        config->generation = ++publishedGeneration;
+
+        pending = config.release();
+
+        releaseRetiredObjects();
+    }
+
+    //==============================================================================
+    // Called by the audio thread. A new configuration is only taken if there's room in
+    // the fifo to hand back the old one.
+    Configuration* takePendingConfiguration() noexcept
+    {
+        if (pending.get() == nullptr)
+            return nullptr;
+
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 + size2 == 0)
+            return nullptr;
+
+        return pending.exchange (nullptr);
+    }
+
+    // Called by the audio thread once it's finished swapping in a configuration, which
+    // now holds the synth's old voices and sounds.
+    void retire (Configuration* const oldConfig, const int generationNowInUse) noexcept
+    {
+        confirmedGeneration = generationNowInUse;
+
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToWrite (1, start1, size1, start2, size2);
+        jassert (size1 + size2 == 1);
+
+        retired [size1 > 0 ? start1 : start2] = oldConfig;
+        retiredFifo.finishedWrite (size1 + size2);
+    }
+
+    //==============================================================================
+    void releaseRetiredObjects()
+    {
+        const ScopedLock sl (configLock);
+
+        int start1, size1, start2, size2;
+        retiredFifo.prepareToRead (retiredFifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            delete retired [start1 + i];
+
+        for (int i = 0; i < size2; ++i)
+            delete retired [start2 + i];
+
+        retiredFifo.finishedRead (size1 + size2);
+
+        // once the audio thread is using the latest configuration, it has stopped all the
+        // voices that were removed..
+        if (confirmedGeneration.get() == publishedGeneration)
+        {
+            for (int i = removedVoices.size(); --i >= 0;)
+                delete removedVoices.getUnchecked (i);
+
+            removedVoices.clear();
+        }
+
+        // ..but a sound can only go once nothing else is holding on to it
+        for (int i = removedSounds.size(); --i >= 0;)
+        {
+            const SynthesiserSound* const sound = removedSounds.getUnchecked (i);
+
+            if (sound->getReferenceCount() == 1)
+                removedSounds.remove (i);
+        }
+    }
+
+private:
+    //==============================================================================
+    CriticalSection configLock;
+    Array <SynthesiserVoice*> shadowVoices, removedVoices;
+    ReferenceCountedArray <SynthesiserSound> shadowSounds, removedSounds;
+    double shadowSampleRate;
+    ScopedPointer <ParallelRenderer> nextRenderer;
+    bool rendererChanged;
+
+    Atomic <Configuration*> pending;
+    AbstractFifo retiredFifo;
+    Configuration* retired [16];
+    int publishedGeneration;
+    Atomic <int> confirmedGeneration;
+
+    void timerCallback()
+    {
+        releaseRetiredObjects();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (RealtimeUpdater);
+};
+
 //==============================================================================
 Synthesiser::Synthesiser()
     : sampleRate (0),
       lastNoteOnCounter (0),
-      shouldStealNotes (true)
+      shouldStealNotes (true),
+      numFreeVoices (0),
+      numActiveVoices (0),
+      noteSounds ((size_t) SynthesiserHelpers::initialSoundLookupSize),
+      numNoteSoundsAllocated (SynthesiserHelpers::initialSoundLookupSize),
+      numSoundsInLookup (0),
+      numRenderThreads (0),
+      renderThreadChannels (0),
+      renderThreadBlockSize (0),
+      renderThreadVoices (0),
+      isRenderingInParallel (false)
 {
     for (int i = 0; i < numElementsInArray (lastPitchWheelValues); ++i)
         lastPitchWheelValues[i] = 0x2000;
+
+    zerostruct (firstVoiceWithNote);
+    zerostruct (firstVoiceOnChannel);
+    zerostruct (noteSoundsStart);
 }
 
 Synthesiser::~Synthesiser()
 {
+    setRealtimeSafeMode (false);
+    parallelRenderer = nullptr;
 }
 
 //==============================================================================
+int Synthesiser::getNumVoices() const
+{
+    if (realtimeUpdater != nullptr)
+        return realtimeUpdater->getNumVoices();
+
+    return voices.size();
+}
+
 SynthesiserVoice* Synthesiser::getVoice (const int index) const
 {
+    if (realtimeUpdater != nullptr)
+        return realtimeUpdater->getVoice (index);
+
     const ScopedLock sl (lock);
     return voices [index];
 }
 
 void Synthesiser::clearVoices()
 {
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->clearVoices();
+        return;
+    }
+
     const ScopedLock sl (lock);
     voices.clear();
+    updateVoiceLists();
 }
 
 void Synthesiser::addVoice (SynthesiserVoice* const newVoice)
 {
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->addVoice (newVoice);
+        return;
+    }
+
     const ScopedLock sl (lock);
     voices.add (newVoice);
+    updateVoiceLists();
 }
 
 void Synthesiser::removeVoice (const int index)
 {
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->removeVoice (index);
+        return;
+    }
+
     const ScopedLock sl (lock);
     voices.remove (index);
+    updateVoiceLists();
+}
+
+int Synthesiser::getNumSounds() const
+{
+    if (realtimeUpdater != nullptr)
+        return realtimeUpdater->getNumSounds();
+
+    return sounds.size();
+}
+
+SynthesiserSound* Synthesiser::getSound (const int index) const
+{
+    if (realtimeUpdater != nullptr)
+        return realtimeUpdater->getSound (index);
+
+    return sounds [index];
+}
+
+const ReferenceCountedArray <SynthesiserSound> Synthesiser::getSounds() const
+{
+    if (realtimeUpdater != nullptr)
+        return realtimeUpdater->getSounds();
+
+    const ScopedLock sl (lock);
+    return sounds;
 }
 
 void Synthesiser::clearSounds()
 {
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->clearSounds();
+        return;
+    }
+
     const ScopedLock sl (lock);
     sounds.clear();
+    updateSoundLookup();
 }
 
 void Synthesiser::addSound (const SynthesiserSound::Ptr& newSound)
 {
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->addSound (newSound);
+        return;
+    }
+
     const ScopedLock sl (lock);
     sounds.add (newSound);
+    updateSoundLookup();
 }
 
 void Synthesiser::removeSound (const int index)
 {
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->removeSound (index);
+        return;
+    }
+
     const ScopedLock sl (lock);
     sounds.remove (index);
+    updateSoundLookup();
+}
+
+void Synthesiser::swapSounds (ReferenceCountedArray <SynthesiserSound>& newSounds)
+{
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->swapSounds (newSounds);
+        return;
+    }
+
+    const ScopedLock sl (lock);
+    sounds.swapWithArray (newSounds);
+    updateSoundLookup();
+}
+
+void Synthesiser::updateSoundLookup()
+{
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->publish();
+        return;
+    }
+
+    const ScopedLock sl (lock);
+    numSoundsInLookup = SynthesiserHelpers::buildSoundLookup (sounds, noteSounds,
+                                                              numNoteSoundsAllocated, noteSoundsStart);
 }
 
 void Synthesiser::setNoteStealingEnabled (const bool shouldStealNotes_)
@@ -132,9 +733,79 @@ void Synthesiser::setNoteStealingEnabled (const bool shouldStealNotes_)
     shouldStealNotes = shouldStealNotes_;
 }
 
+void Synthesiser::setNumRenderThreads (int numThreads, const int numChannels, const int maximumBlockSize)
+{
+    if (numChannels <= 0 || maximumBlockSize <= 0)
+        numThreads = 0;
+
+    numThreads = jmax (0, numThreads);
+
+    // (starting the threads is slow, so if nothing's changed, the old ones are kept)
+    const int numVoices = getNumVoices();
+
+    if (numThreads == numRenderThreads
+         && (numThreads == 0 || (numChannels == renderThreadChannels
+                                  && maximumBlockSize == renderThreadBlockSize
+                                  && numVoices == renderThreadVoices)))
+        return;
+
+    numRenderThreads = numThreads;
+    renderThreadChannels = numChannels;
+    renderThreadBlockSize = maximumBlockSize;
+    renderThreadVoices = numVoices;
+
+    // The new renderer's threads and buffers are created before anything gets locked, and
+    // the old one is deleted afterwards, so the audio thread is only held up for the swap
+    ScopedPointer <ParallelRenderer> newRenderer;
+
+    if (numThreads > 0)
+        newRenderer = new ParallelRenderer (numThreads, numChannels, maximumBlockSize, numVoices);
+
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->setRenderer (newRenderer.release());
+    }
+    else
+    {
+        const ScopedLock sl (lock);
+        parallelRenderer.swapWith (newRenderer);
+    }
+}
+
+int Synthesiser::getNumRenderThreads() const noexcept
+{
+    return numRenderThreads;
+}
+
+void Synthesiser::setRealtimeSafeMode (const bool shouldBeRealtimeSafe)
+{
+    if (shouldBeRealtimeSafe == (realtimeUpdater != nullptr))
+        return;
+
+    const ScopedLock sl (lock);
+
+    if (shouldBeRealtimeSafe)
+    {
+        realtimeUpdater = new RealtimeUpdater (*this);
+    }
+    else
+    {
+        // bring the synth's own arrays up to date before letting go of the old ones..
+        realtimeUpdater->releaseRetiredObjects();
+        applyPendingConfiguration();
+        realtimeUpdater = nullptr;
+    }
+}
+
 //==============================================================================
 void Synthesiser::setCurrentPlaybackSampleRate (const double newRate)
 {
+    if (realtimeUpdater != nullptr)
+    {
+        realtimeUpdater->setSampleRate (newRate);
+        return;
+    }
+
     if (sampleRate != newRate)
     {
         const ScopedLock sl (lock);
@@ -153,38 +824,77 @@ void Synthesiser::renderNextBlock (AudioSampleBuffer& outputBuffer,
                                    int startSample,
                                    int numSamples)
 {
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
+
+    if (realtimeUpdater != nullptr)
+        applyPendingConfiguration();
+
     // must set the sample rate before using this!
     jassert (sampleRate != 0);
 
-    const ScopedLock sl (lock);
-
     MidiBuffer::Iterator midiIterator (midiData);
     midiIterator.setNextSamplePosition (startSample);
-    MidiMessage m (0xf4, 0.0);
 
     while (numSamples > 0)
     {
-        int midiEventPos;
-        const bool useEvent = midiIterator.getNextEvent (m, midiEventPos)
+        const uint8* midiEventData;
+        int midiEventSize, midiEventPos;
+        const bool useEvent = midiIterator.getNextEvent (midiEventData, midiEventSize, midiEventPos)
                                 && midiEventPos < startSample + numSamples;
 
         const int numThisTime = useEvent ? midiEventPos - startSample
                                          : numSamples;
 
         if (numThisTime > 0)
-        {
-            for (int i = voices.size(); --i >= 0;)
-                voices.getUnchecked (i)->renderNextBlock (outputBuffer, startSample, numThisTime);
-        }
+            renderVoices (outputBuffer, startSample, numThisTime);
 
-        if (useEvent)
-            handleMidiEvent (m);
+        // (sysex messages are skipped rather than copied, because they'd need allocating
+        // and none of them are used by the synth)
+        if (useEvent && midiEventSize <= 4)
+            handleMidiEvent (MidiMessage (midiEventData, midiEventSize, 0.0));
 
         startSample += numThisTime;
         numSamples -= numThisTime;
     }
 }
 
+void Synthesiser::renderVoices (AudioSampleBuffer& outputBuffer, int startSample, int numSamples)
+{
+    if (parallelRenderer != nullptr)
+    {
+        checkVoiceLists();
+
+        if (parallelRenderer->canRender (outputBuffer, numSamples, numActiveVoices))
+        {
+            // (the free voices aren't playing anything, so there's no point sharing them out)
+            for (int i = numFreeVoices; --i >= 0;)
+                freeVoices[i]->renderNextBlock (outputBuffer, startSample, numSamples);
+
+            isRenderingInParallel = true;
+            parallelRenderer->render (activeVoices, numActiveVoices, outputBuffer, startSample, numSamples, sampleRate);
+            isRenderingInParallel = false;
+
+            // now catch up with any voices that finished while they were being rendered
+            // (which reshuffles the heap, so the search starts again after each one)
+            for (int i = numActiveVoices; --i >= 0;)
+            {
+                SynthesiserVoice* const voice = activeVoices[i];
+
+                if (voice->currentlyPlayingSound == nullptr)
+                {
+                    voiceFinished (voice);
+                    i = numActiveVoices;
+                }
+            }
+
+            return;
+        }
+    }
+
+    for (int i = voices.size(); --i >= 0;)
+        voices.getUnchecked (i)->renderNextBlock (outputBuffer, startSample, numSamples);
+}
+
 void Synthesiser::handleMidiEvent (const MidiMessage& m)
 {
     if (m.isNoteOn())
@@ -224,24 +934,38 @@ void Synthesiser::noteOn (const int midiChannel,
                           const int midiNoteNumber,
                           const float velocity)
 {
-    const ScopedLock sl (lock);
+    jassert (isPositiveAndBelow (midiNoteNumber, 128));
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
+
+    if (! isPositiveAndBelow (midiNoteNumber, 128))
+        return;
 
-    for (int i = sounds.size(); --i >= 0;)
+    checkVoiceLists();
+
+    // If a subclass has changed the sounds array without calling updateSoundLookup(), the
+    // sounds get searched instead, rather than rebuilding the table on the audio thread.
+    const bool lookupIsValid = (numSoundsInLookup == sounds.size());
+    const int start = lookupIsValid ? noteSoundsStart [midiNoteNumber] : 0;
+    const int end = lookupIsValid ? noteSoundsStart [midiNoteNumber + 1] : sounds.size();
+
+    for (int i = start; i < end; ++i)
     {
-        SynthesiserSound* const sound = sounds.getUnchecked(i);
+        SynthesiserSound* const sound = lookupIsValid ? noteSounds[i]
+                                                      : sounds.getObjectPointerUnchecked (end - 1 - i);
 
-        if (sound->appliesToNote (midiNoteNumber)
-             && sound->appliesToChannel (midiChannel))
+        if (sound->appliesToChannel (midiChannel)
+             && (lookupIsValid || sound->appliesToNote (midiNoteNumber)))
         {
             // If hitting a note that's still ringing, stop it first (it could be
             // still playing because of the sustain or sostenuto pedal).
-            for (int j = voices.size(); --j >= 0;)
+            for (SynthesiserVoice* voice = firstVoiceWithNote [midiNoteNumber]; voice != nullptr;)
             {
-                SynthesiserVoice* const voice = voices.getUnchecked (j);
+                SynthesiserVoice* const next = voice->nextWithNote;
 
-                if (voice->getCurrentlyPlayingNote() == midiNoteNumber
-                     && voice->isPlayingChannel (midiChannel))
+                if (voice->isPlayingChannel (midiChannel))
                     stopVoice (voice, true);
+
+                voice = next;
             }
 
             startVoice (findFreeVoice (sound, shouldStealNotes),
@@ -258,9 +982,16 @@ void Synthesiser::startVoice (SynthesiserVoice* const voice,
 {
     if (voice != nullptr && sound != nullptr)
     {
+        // the voice must belong to this synth!
+        jassert (voice->owner == this);
+
         if (voice->currentlyPlayingSound != nullptr)
             voice->stopNote (false);
 
+        // (in case the voice didn't call clearCurrentNote() when it was stopped)
+        if (voice->isActive)
+            voiceFinished (voice);
+
         voice->startNote (midiNoteNumber, velocity, sound,
                           lastPitchWheelValues [midiChannel - 1]);
 
@@ -269,6 +1000,8 @@ void Synthesiser::startVoice (SynthesiserVoice* const voice,
         voice->currentlyPlayingSound = sound;
         voice->keyIsDown = true;
         voice->sostenutoPedalDown = false;
+
+        voiceStarted (voice);
     }
 }
 
@@ -286,39 +1019,55 @@ void Synthesiser::noteOff (const int midiChannel,
                            const int midiNoteNumber,
                            const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
 
-    for (int i = voices.size(); --i >= 0;)
+    if (! isPositiveAndBelow (midiNoteNumber, 128))
+        return;
+
+    checkVoiceLists();
+
+    for (SynthesiserVoice* voice = firstVoiceWithNote [midiNoteNumber]; voice != nullptr;)
     {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
+        SynthesiserVoice* const next = voice->nextWithNote;
+        SynthesiserSound* const sound = voice->currentlyPlayingSound;
 
-        if (voice->getCurrentlyPlayingNote() == midiNoteNumber)
+        if (sound != nullptr
+             && sound->appliesToNote (midiNoteNumber)
+             && sound->appliesToChannel (midiChannel))
         {
-            SynthesiserSound* const sound = voice->getCurrentlyPlayingSound();
+            voice->keyIsDown = false;
 
-            if (sound != nullptr
-                 && sound->appliesToNote (midiNoteNumber)
-                 && sound->appliesToChannel (midiChannel))
-            {
-                voice->keyIsDown = false;
-
-                if (! (sustainPedalsDown [midiChannel] || voice->sostenutoPedalDown))
-                    stopVoice (voice, allowTailOff);
-            }
+            if (! (sustainPedalsDown [midiChannel] || voice->sostenutoPedalDown))
+                stopVoice (voice, allowTailOff);
         }
+
+        voice = next;
     }
 }
 
 void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
+    checkVoiceLists();
 
-    for (int i = voices.size(); --i >= 0;)
+    if (isPositiveAndBelow (midiChannel - 1, 16))
     {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
-
-        if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+        for (SynthesiserVoice* voice = firstVoiceOnChannel [midiChannel - 1]; voice != nullptr;)
+        {
+            SynthesiserVoice* const next = voice->nextOnChannel [midiChannel - 1];
             voice->stopNote (allowTailOff);
+            voice = next;
+        }
+    }
+    else
+    {
+        for (int i = voices.size(); --i >= 0;)
+        {
+            SynthesiserVoice* const voice = voices.getUnchecked (i);
+
+            if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+                voice->stopNote (allowTailOff);
+        }
     }
 
     sustainPedalsDown.clear();
@@ -326,14 +1075,27 @@ void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 
 void Synthesiser::handlePitchWheel (const int midiChannel, const int wheelValue)
 {
-    const ScopedLock sl (lock);
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
+    checkVoiceLists();
 
-    for (int i = voices.size(); --i >= 0;)
+    if (isPositiveAndBelow (midiChannel - 1, 16))
     {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
-
-        if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+        for (SynthesiserVoice* voice = firstVoiceOnChannel [midiChannel - 1]; voice != nullptr;)
+        {
+            SynthesiserVoice* const next = voice->nextOnChannel [midiChannel - 1];
             voice->pitchWheelMoved (wheelValue);
+            voice = next;
+        }
+    }
+    else
+    {
+        for (int i = voices.size(); --i >= 0;)
+        {
+            SynthesiserVoice* const voice = voices.getUnchecked (i);
+
+            if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+                voice->pitchWheelMoved (wheelValue);
+        }
     }
 }
 
@@ -349,21 +1111,34 @@ void Synthesiser::handleController (const int midiChannel,
         default:    break;
     }
 
-    const ScopedLock sl (lock);
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
+    checkVoiceLists();
 
-    for (int i = voices.size(); --i >= 0;)
+    if (isPositiveAndBelow (midiChannel - 1, 16))
     {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
-
-        if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+        for (SynthesiserVoice* voice = firstVoiceOnChannel [midiChannel - 1]; voice != nullptr;)
+        {
+            SynthesiserVoice* const next = voice->nextOnChannel [midiChannel - 1];
             voice->controllerMoved (controllerNumber, controllerValue);
+            voice = next;
+        }
+    }
+    else
+    {
+        for (int i = voices.size(); --i >= 0;)
+        {
+            SynthesiserVoice* const voice = voices.getUnchecked (i);
+
+            if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
+                voice->controllerMoved (controllerNumber, controllerValue);
+        }
     }
 }
 
 void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
 
     if (isDown)
     {
@@ -371,12 +1146,19 @@ void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
     }
     else
     {
-        for (int i = voices.size(); --i >= 0;)
+        if (isPositiveAndBelow (midiChannel - 1, 16))
         {
-            SynthesiserVoice* const voice = voices.getUnchecked (i);
+            checkVoiceLists();
+
+            for (SynthesiserVoice* voice = firstVoiceOnChannel [midiChannel - 1]; voice != nullptr;)
+            {
+                SynthesiserVoice* const next = voice->nextOnChannel [midiChannel - 1];
+
+                if (! voice->keyIsDown)
+                    stopVoice (voice, true);
 
-            if (voice->isPlayingChannel (midiChannel) && ! voice->keyIsDown)
-                stopVoice (voice, true);
+                voice = next;
+            }
         }
 
         sustainPedalsDown.clearBit (midiChannel);
@@ -386,19 +1168,23 @@ void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 void Synthesiser::handleSostenutoPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
 
-    for (int i = voices.size(); --i >= 0;)
+    if (! isPositiveAndBelow (midiChannel - 1, 16))
+        return;
+
+    checkVoiceLists();
+
+    for (SynthesiserVoice* voice = firstVoiceOnChannel [midiChannel - 1]; voice != nullptr;)
     {
-        SynthesiserVoice* const voice = voices.getUnchecked (i);
+        SynthesiserVoice* const next = voice->nextOnChannel [midiChannel - 1];
 
-        if (voice->isPlayingChannel (midiChannel))
-        {
-            if (isDown)
-                voice->sostenutoPedalDown = true;
-            else if (voice->sostenutoPedalDown)
-                stopVoice (voice, true);
-        }
+        if (isDown)
+            voice->sostenutoPedalDown = true;
+        else if (voice->sostenutoPedalDown)
+            stopVoice (voice, true);
+
+        voice = next;
     }
 }
 
@@ -412,21 +1198,26 @@ void Synthesiser::handleSoftPedal (int midiChannel, bool /*isDown*/)
 SynthesiserVoice* Synthesiser::findFreeVoice (SynthesiserSound* soundToPlay,
                                               const bool stealIfNoneAvailable) const
 {
-    const ScopedLock sl (lock);
+    const SynthesiserHelpers::ScopedRenderLock sl (lock, realtimeUpdater != nullptr);
 
-    for (int i = voices.size(); --i >= 0;)
-        if (voices.getUnchecked (i)->getCurrentlyPlayingNote() < 0
-             && voices.getUnchecked (i)->canPlaySound (soundToPlay))
-            return voices.getUnchecked (i);
+    // if all the voices can play the sound (which they usually can), this only has to
+    // look at the last free one..
+    for (int i = numFreeVoices; --i >= 0;)
+        if (freeVoices[i]->canPlaySound (soundToPlay))
+            return freeVoices[i];
 
     if (stealIfNoneAvailable)
     {
-        // currently this just steals the one that's been playing the longest, but could be made a bit smarter..
+        // the voice at the top of the heap is the one that's been playing the longest..
+        if (numActiveVoices > 0 && activeVoices[0]->canPlaySound (soundToPlay))
+            return activeVoices[0];
+
+        // ..but if it can't play this sound, the others have to be searched
         SynthesiserVoice* oldest = nullptr;
 
-        for (int i = voices.size(); --i >= 0;)
+        for (int i = numActiveVoices; --i > 0;)
         {
-            SynthesiserVoice* const voice = voices.getUnchecked (i);
+            SynthesiserVoice* const voice = activeVoices[i];
 
             if (voice->canPlaySound (soundToPlay)
                  && (oldest == nullptr || oldest->noteOnTime > voice->noteOnTime))
@@ -440,5 +1231,251 @@ SynthesiserVoice* Synthesiser::findFreeVoice (SynthesiserSound* soundToPlay,
     return nullptr;
 }
 
+//==============================================================================
+void Synthesiser::updateVoiceLists()
+{
+    const int numVoices = voices.size();
+
+    freeVoices.malloc ((size_t) jmax (1, numVoices));
+    activeVoices.malloc ((size_t) jmax (1, numVoices));
+    relinkVoices();
+}
+
+void Synthesiser::relinkVoices()
+{
+    numFreeVoices = 0;
+    numActiveVoices = 0;
+
+    zerostruct (firstVoiceWithNote);
+    zerostruct (firstVoiceOnChannel);
+
+    for (int i = 0; i < voices.size(); ++i)
+    {
+        SynthesiserVoice* const voice = voices.getUnchecked (i);
+
+        voice->owner = this;
+        voice->isActive = false;
+        voice->listIndex = numFreeVoices;
+        freeVoices [numFreeVoices++] = voice;
+
+        if (voice->currentlyPlayingSound != nullptr)
+            voiceStarted (voice);
+    }
+}
+
+void Synthesiser::checkVoiceLists()
+{
+    // (this only happens if a subclass has changed the voices array directly)
+    if (numFreeVoices + numActiveVoices != voices.size())
+    {
+        // in real-time-safe mode, the voices must only be changed with addVoice(), etc.
+        jassert (realtimeUpdater == nullptr);
+
+        if (realtimeUpdater == nullptr)
+            updateVoiceLists();
+    }
+}
+
+void Synthesiser::applyPendingConfiguration()
+{
+    RealtimeUpdater::Configuration* const config = realtimeUpdater->takePendingConfiguration();
+
+    if (config == nullptr)
+        return;
+
+    // stop any voices that are being removed, so that nothing's still using them when they
+    // get deleted..
+    for (int i = config->removedVoices.size(); --i >= 0;)
+    {
+        SynthesiserVoice* const voice = config->removedVoices.getUnchecked (i);
+
+        if (voice->owner == this)
+        {
+            if (voice->currentlyPlayingSound != nullptr)
+                voice->stopNote (false);
+
+            if (voice->isActive)
+                voiceFinished (voice);
+
+            voice->owner = nullptr;
+        }
+    }
+
+    // a change of sample rate stops everything that's playing, as it does in the normal mode
+    if (config->sampleRate != sampleRate)
+    {
+        allNotesOff (0, false);
+        sampleRate = config->sampleRate;
+    }
+
+    if (config->changesRenderer)
+        parallelRenderer.swapWith (config->renderer);
+
+    // ..then swap in the new voices and sounds, whose memory has all been allocated already
+    const int generation = config->generation;
+
+    voices.swapWithArray (config->voices);
+    sounds.swapWithArray (config->sounds);
+    freeVoices.swapWith (config->freeVoices);
+    activeVoices.swapWith (config->activeVoices);
+    noteSounds.swapWith (config->noteSounds);
+    std::swap (numNoteSoundsAllocated, config->numNoteSoundsAllocated);
+    memcpy (noteSoundsStart, config->noteSoundsStart, sizeof (noteSoundsStart));
+    numSoundsInLookup = sounds.size();
+
+    if (sampleRate > 0)
+        for (int i = voices.size(); --i >= 0;)
+            voices.getUnchecked (i)->setCurrentPlaybackSampleRate (sampleRate);
+
+    relinkVoices();
+
+    realtimeUpdater->retire (config, generation);
+}
+
+void Synthesiser::voiceStarted (SynthesiserVoice* const voice)
+{
+    jassert (! voice->isActive);
+
+    // take it off the free list..
+    SynthesiserVoice* const lastFree = freeVoices [--numFreeVoices];
+    freeVoices [voice->listIndex] = lastFree;
+    lastFree->listIndex = voice->listIndex;
+
+    // ..and put it into the heap..
+    voice->isActive = true;
+    voice->listIndex = numActiveVoices;
+    activeVoices [numActiveVoices++] = voice;
+    moveUpHeap (voice->listIndex);
+
+    // ..and the lists for its note and channels
+    const int note = voice->currentlyPlayingNote;
+    voice->listNote = note;
+    voice->previousWithNote = nullptr;
+    voice->nextWithNote = nullptr;
+
+    if (isPositiveAndBelow (note, 128))
+    {
+        voice->nextWithNote = firstVoiceWithNote [note];
+
+        if (voice->nextWithNote != nullptr)
+            voice->nextWithNote->previousWithNote = voice;
+
+        firstVoiceWithNote [note] = voice;
+    }
+
+    voice->channelMask = 0;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        voice->previousOnChannel[i] = nullptr;
+        voice->nextOnChannel[i] = nullptr;
+
+        if (voice->currentlyPlayingSound->appliesToChannel (i + 1))
+        {
+            voice->channelMask |= (1 << i);
+            voice->nextOnChannel[i] = firstVoiceOnChannel[i];
+
+            if (voice->nextOnChannel[i] != nullptr)
+                voice->nextOnChannel[i]->previousOnChannel[i] = voice;
+
+            firstVoiceOnChannel[i] = voice;
+        }
+    }
+}
+
+void Synthesiser::voiceFinished (SynthesiserVoice* const voice)
+{
+    jassert (voice->isActive && voice->owner == this);
+
+    if (voice->previousWithNote != nullptr)
+        voice->previousWithNote->nextWithNote = voice->nextWithNote;
+    else if (isPositiveAndBelow (voice->listNote, 128))
+        firstVoiceWithNote [voice->listNote] = voice->nextWithNote;
+
+    if (voice->nextWithNote != nullptr)
+        voice->nextWithNote->previousWithNote = voice->previousWithNote;
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if ((voice->channelMask & (1 << i)) != 0)
+        {
+            if (voice->previousOnChannel[i] != nullptr)
+                voice->previousOnChannel[i]->nextOnChannel[i] = voice->nextOnChannel[i];
+            else
+                firstVoiceOnChannel[i] = voice->nextOnChannel[i];
+
+            if (voice->nextOnChannel[i] != nullptr)
+                voice->nextOnChannel[i]->previousOnChannel[i] = voice->previousOnChannel[i];
+        }
+    }
+
+    // take it out of the heap, and fill the gap with the last voice in there..
+    const int index = voice->listIndex;
+    SynthesiserVoice* const lastActive = activeVoices [--numActiveVoices];
+
+    if (lastActive != voice)
+    {
+        activeVoices [index] = lastActive;
+        lastActive->listIndex = index;
+        moveUpHeap (index);
+        moveDownHeap (lastActive->listIndex);
+    }
+
+    // ..and put it back on the free list
+    voice->isActive = false;
+    voice->listIndex = numFreeVoices;
+    freeVoices [numFreeVoices++] = voice;
+}
+
+void Synthesiser::moveUpHeap (int index) noexcept
+{
+    SynthesiserVoice* const voice = activeVoices [index];
+
+    while (index > 0)
+    {
+        const int parentIndex = (index - 1) / 2;
+        SynthesiserVoice* const parent = activeVoices [parentIndex];
+
+        if (parent->noteOnTime <= voice->noteOnTime)
+            break;
+
+        activeVoices [index] = parent;
+        parent->listIndex = index;
+        index = parentIndex;
+    }
+
+    activeVoices [index] = voice;
+    voice->listIndex = index;
+}
+
+void Synthesiser::moveDownHeap (int index) noexcept
+{
+    SynthesiserVoice* const voice = activeVoices [index];
+
+    for (;;)
+    {
+        int childIndex = index * 2 + 1;
+
+        if (childIndex >= numActiveVoices)
+            break;
+
+        if (childIndex + 1 < numActiveVoices
+             && activeVoices [childIndex + 1]->noteOnTime < activeVoices [childIndex]->noteOnTime)
+            ++childIndex;
+
+        SynthesiserVoice* const child = activeVoices [childIndex];
+
+        if (voice->noteOnTime <= child->noteOnTime)
+            break;
+
+        activeVoices [index] = child;
+        child->listIndex = index;
+        index = childIndex;
+    }
+
+    activeVoices [index] = voice;
+    voice->listIndex = index;
+}
+
 
 END_JUCE_NAMESPACE
@@ -33,6 +33,9 @@
 #include "../../containers/juce_ReferenceCountedArray.h"
 #include "../../threads/juce_CriticalSection.h"
 #include "../../maths/juce_BigInteger.h"
+#include "../../memory/juce_HeapBlock.h"
+#include "../../memory/juce_ScopedPointer.h"
+class Synthesiser;
 
 
 //==============================================================================
@@ -62,14 +65,17 @@ public:
     /** Returns true if this sound should be played when a given midi note is pressed.
 
         The Synthesiser will use this information when deciding which sounds to trigger
-        for a given note.
+        for a given note. It asks once for every note when the sound is added, and keeps
+        the answers in a lookup table, so the result mustn't change while the sound is
+        in use (if it does, call Synthesiser::updateSoundLookup()).
     */
     virtual bool appliesToNote (const int midiNoteNumber) = 0;
 
     /** Returns true if the sound should be triggered by midi events on a given channel.
 
         The Synthesiser will use this information when deciding which sounds to trigger
-        for a given note.
+        for a given note. While a voice is playing the sound, the synth remembers which
+        channels it applies to, so the result mustn't change while the sound is in use.
     */
     virtual bool appliesToChannel (const int midiChannel) = 0;
 
@@ -236,6 +242,15 @@ private:
     bool keyIsDown; // the voice may still be playing when the key is not down (i.e. sustain pedal)
     bool sostenutoPedalDown;
 
+    // these are used by the synth that owns the voice to keep track of what it's doing
+    Synthesiser* owner;
+    int listIndex, listNote, channelMask;
+    bool isActive;
+    SynthesiserVoice* previousWithNote;
+    SynthesiserVoice* nextWithNote;
+    SynthesiserVoice* previousOnChannel [16];
+    SynthesiserVoice* nextOnChannel [16];
+
     JUCE_LEAK_DETECTOR (SynthesiserVoice);
 };
 
@@ -263,6 +278,10 @@ private:
     Before rendering, be sure to call the setCurrentPlaybackSampleRate() to tell it
     what the target playback rate is. This value is passed on to the voices so that
     they can pitch their output correctly.
+
+    Normally the voices and sounds are protected by a lock which the audio thread has to
+    take while rendering, so changing them from another thread can hold up the audio. If
+    that's a problem, see setRealtimeSafeMode().
 */
 class JUCE_API  Synthesiser
 {
@@ -282,7 +301,7 @@ public:
     void clearVoices();
 
     /** Returns the number of voices that have been added. */
-    int getNumVoices() const                                        { return voices.size(); }
+    int getNumVoices() const;
 
     /** Returns one of the voices that have been added. */
     SynthesiserVoice* getVoice (int index) const;
@@ -305,10 +324,18 @@ public:
     void clearSounds();
 
     /** Returns the number of sounds that have been added to the synth. */
-    int getNumSounds() const                                        { return sounds.size(); }
+    int getNumSounds() const;
 
     /** Returns one of the sounds. */
-    SynthesiserSound* getSound (int index) const                    { return sounds [index]; }
+    SynthesiserSound* getSound (int index) const;
+
+    /** Returns a copy of the synth's current set of sounds.
+
+        The copy holds a reference to each sound, so unlike the pointer that getSound()
+        returns, these can be used safely while another thread is changing the synth's
+        sounds.
+    */
+    const ReferenceCountedArray <SynthesiserSound> getSounds() const;
 
     /** Adds a new sound to the synthesiser.
 
@@ -320,6 +347,28 @@ public:
     /** Removes and deletes one of the sounds. */
     void removeSound (int index);
 
+    /** Replaces the synth's complete set of sounds with the contents of another array.
+
+        The two arrays just exchange their contents, so nothing gets deleted while the lock
+        is held. When this returns, the array that was passed in holds the sounds that the
+        synth was previously using, so the caller can choose which thread they finally get
+        released on (voices that are still playing them will keep them alive until their
+        notes finish).
+
+        The synth's note lookup table is rebuilt for the new sounds. It's created with room
+        for one sound per note, and only needs to allocate memory if the new sounds cover
+        more notes between them than that, or than any previous set did.
+    */
+    void swapSounds (ReferenceCountedArray <SynthesiserSound>& newSounds);
+
+    /** Rebuilds the table that the synth uses to find the sounds for a note.
+
+        The table is built from SynthesiserSound::appliesToNote() whenever the set of sounds
+        changes, so this only needs to be called if one of the sounds changes its mind about
+        which notes it applies to.
+    */
+    void updateSoundLookup();
+
     //==============================================================================
     /** If set to true, then the synth will try to take over an existing voice if
         it runs out and needs to play another note.
@@ -334,6 +383,68 @@ public:
     */
     bool isNoteStealingEnabled() const                              { return shouldStealNotes; }
 
+    //==============================================================================
+    /** Makes the audio thread independent of any other threads that change the voices
+        or sounds.
+
+        In real-time-safe mode, the renderNextBlock() method (and the note and controller
+        methods it calls) never take the synth's lock or allocate memory. Instead, each call
+        to addVoice(), removeVoice(), addSound(), swapSounds(), etc. builds a complete new
+        set of voices and sounds, which the audio thread picks up at the start of its next
+        block. Voices and sounds that get removed are deleted later on the message thread,
+        once the audio thread has stopped using them.
+
+        The catch is that the render and note methods must then all be called from the
+        same thread (normally the audio thread), and that changes to the voices and sounds
+        only take effect when the next block gets rendered, so e.g. getNumVoices() returns
+        the number of voices that the synth will have, not the number it's currently
+        playing with. The same goes for setCurrentPlaybackSampleRate() and
+        setNumRenderThreads(), which are also passed to the audio thread this way.
+
+        This mustn't be called while a block is being rendered. A Timer is used to clean
+        up the old voices and sounds, so a message thread must be running.
+    */
+    void setRealtimeSafeMode (bool shouldBeRealtimeSafe);
+
+    /** Returns true if real-time-safe mode is turned on.
+        @see setRealtimeSafeMode
+    */
+    bool isRealtimeSafeMode() const noexcept                        { return realtimeUpdater != nullptr; }
+
+    //==============================================================================
+    /** Shares out the work of rendering the voices between some extra threads.
+
+        When enough voices are playing, renderNextBlock() hands them out to a set of worker
+        threads (see ParallelTaskRunner). Each voice renders into a buffer of its own, and
+        these buffers are then added to the output in voice order, so the result doesn't
+        depend on which thread rendered which voice. The calling thread renders voices as
+        well, and picks up any voices that the workers haven't got round to, so it never
+        waits for a worker to start; and if a worker that's already started a voice is held
+        up for longer than the block lasts, the next few blocks are rendered without the
+        workers. The block is still divided up at each midi event in the same way, so the
+        timing of the events isn't affected.
+
+        The numChannels and maximumBlockSize values, and the number of voices that the synth
+        has when this is called, are used to allocate the voices' buffers, so any block
+        that's longer than this, has a different number of channels, or has more voices
+        playing gets rendered in the normal way. Passing 0 for numThreads stops the threads,
+        and goes back to rendering everything on the calling thread.
+
+        While a voice is being rendered on one of these threads, it mustn't use anything
+        other than its own state and the sound it's playing.
+
+        Starting the threads is slow, so if the settings are the same as last time, this
+        does nothing. In real-time-safe mode, the new threads are handed to the audio
+        thread at the start of its next block, and the old ones are stopped later on the
+        message thread; otherwise, this takes the synth's lock while it swaps them over.
+    */
+    void setNumRenderThreads (int numThreads, int numChannels, int maximumBlockSize);
+
+    /** Returns the number of extra threads that are used to render the voices.
+        @see setNumRenderThreads
+    */
+    int getNumRenderThreads() const noexcept;
+
     //==============================================================================
     /** Triggers a note-on event.
 
@@ -459,7 +570,11 @@ protected:
     /** Searches through the voices to find one that's not currently playing, and which
         can play the given sound.
 
-        Returns 0 if all voices are busy and stealing isn't enabled.
+        Returns 0 if all voices are busy and stealing isn't enabled. If stealing is enabled,
+        this returns the voice that's been playing for the longest.
+
+        The synth keeps a list of its free voices and a heap of the busy ones ordered by
+        age, so as long as all the voices can play the sound, this doesn't need to search.
 
         This can be overridden to implement custom voice-stealing algorithms.
     */
@@ -479,14 +594,53 @@ protected:
 
 private:
     //==============================================================================
+    friend class SynthesiserVoice;
+    class RealtimeUpdater;
+    friend class RealtimeUpdater;
+    class ParallelRenderer;
+
     double sampleRate;
     uint32 lastNoteOnCounter;
     bool shouldStealNotes;
     BigInteger sustainPedalsDown;
 
+    // The voices that aren't playing are kept in a list, and the ones that are playing are
+    // kept in a heap with the oldest note at the top. Both of these are allocated when voices
+    // are added, so nothing needs to be allocated while notes are starting and stopping.
+    HeapBlock <SynthesiserVoice*> freeVoices, activeVoices;
+    int numFreeVoices, numActiveVoices;
+
+    // The playing voices are also linked into a list for each note and each midi channel
+    SynthesiserVoice* firstVoiceWithNote [128];
+    SynthesiserVoice* firstVoiceOnChannel [16];
+
+    // The sounds that apply to note n are noteSounds [noteSoundsStart [n]] up to
+    // noteSounds [noteSoundsStart [n + 1] - 1]
+    HeapBlock <SynthesiserSound*> noteSounds;
+    int noteSoundsStart [129];
+    int numNoteSoundsAllocated, numSoundsInLookup;
+
+    // (only used in real-time-safe mode)
+    ScopedPointer <RealtimeUpdater> realtimeUpdater;
+
+    // (only used if there are some render threads)
+    ScopedPointer <ParallelRenderer> parallelRenderer;
+    int numRenderThreads, renderThreadChannels, renderThreadBlockSize, renderThreadVoices;
+    bool isRenderingInParallel;
+
     void handleMidiEvent (const MidiMessage& m);
+    void renderVoices (AudioSampleBuffer& outputBuffer, int startSample, int numSamples);
     void stopVoice (SynthesiserVoice* voice, bool allowTailOff);
 
+    void updateVoiceLists();
+    void relinkVoices();
+    void checkVoiceLists();
+    void applyPendingConfiguration();
+    void voiceStarted (SynthesiserVoice* voice);
+    void voiceFinished (SynthesiserVoice* voice);
+    void moveUpHeap (int index) noexcept;
+    void moveDownHeap (int index) noexcept;
+
    #if JUCE_CATCH_DEPRECATED_CODE_MISUSE
     // Note the new parameters for this method.
     virtual int findFreeVoice (const bool) const { return 0; }
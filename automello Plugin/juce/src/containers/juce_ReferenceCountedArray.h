@@ -147,6 +147,20 @@ public:
         return data.elements [index];
     }
 
+    /** Returns a raw pointer to the object at this index in the array, without checking
+        whether the index is in-range.
+
+        This is like getUnchecked(), but avoids the cost of creating a temporary
+        ReferenceCountedObjectPtr, so it's handy in time-critical loops. The pointer that's
+        returned is only valid for as long as the array keeps hold of the object.
+    */
+    inline ObjectClass* getObjectPointerUnchecked (const int index) const noexcept
+    {
+        const ScopedLockType lock (getLock());
+        jassert (isPositiveAndBelow (index, numUsed));
+        return data.elements [index];
+    }
+
     /** Returns a pointer to the first object in the array.
 
         This will return a null pointer if the array's empty.
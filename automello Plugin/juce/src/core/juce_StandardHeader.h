@@ -136,6 +136,37 @@
   #include <byteswap.h>
 #endif
 
+// Work out which SIMD instruction sets the compiler is allowed to use..
+#ifndef JUCE_USE_SSE_INTRINSICS
+  #if JUCE_INTEL && (defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define JUCE_USE_SSE_INTRINSICS 1
+  #endif
+#endif
+
+#ifndef JUCE_USE_AVX_INTRINSICS
+  #if JUCE_USE_SSE_INTRINSICS && defined (__AVX__)
+    #define JUCE_USE_AVX_INTRINSICS 1
+  #endif
+#endif
+
+#ifndef JUCE_USE_ARM_NEON
+  #if defined (__ARM_NEON__) || defined (__ARM_NEON)
+    #define JUCE_USE_ARM_NEON 1
+  #endif
+#endif
+
+#if JUCE_USE_SSE_INTRINSICS
+  #include <emmintrin.h>
+#endif
+
+#if JUCE_USE_AVX_INTRINSICS
+  #include <immintrin.h>
+#endif
+
+#if JUCE_USE_ARM_NEON
+  #include <arm_neon.h>
+#endif
+
 //==============================================================================
 // DLL building settings on Win32
 #if JUCE_MSVC
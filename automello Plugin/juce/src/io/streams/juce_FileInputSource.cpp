@@ -53,7 +53,7 @@ InputStream* FileInputSource::createInputStreamFor (const String& relatedItemPat
 
 int64 FileInputSource::hashCode() const
 {
-    int64 h = file.hashCode();
+    int64 h = file.hashCode64();
 
     if (useFileTimeInHashGeneration)
         h ^= file.getLastModificationTime().toMilliseconds();
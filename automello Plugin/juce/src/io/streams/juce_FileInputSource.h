@@ -40,7 +40,13 @@ class JUCE_API  FileInputSource     : public InputSource
 {
 public:
     //==============================================================================
-    FileInputSource (const File& file, bool useFileTimeInHashGeneration = false);
+    /** Creates a source for a file.
+
+        If useFileTimeInHashGeneration is true, the file's modification time is mixed into
+        its hashCode(), so anything that's cached using the hash (e.g. an AudioThumbnail)
+        won't be reused once the file has been changed.
+    */
+    FileInputSource (const File& file, bool useFileTimeInHashGeneration = true);
     ~FileInputSource();
 
     InputStream* createInputStream();
@@ -77,6 +77,9 @@
 #ifndef __JUCE_FLACAUDIOFORMAT_JUCEHEADER__
  #include "audio/audio_file_formats/juce_FlacAudioFormat.h"
 #endif
+#ifndef __JUCE_MEMORYMAPPEDAUDIOFORMATREADER_JUCEHEADER__
+ #include "audio/audio_file_formats/juce_MemoryMappedAudioFormatReader.h"
+#endif
 #ifndef __JUCE_OGGVORBISAUDIOFORMAT_JUCEHEADER__
  #include "audio/audio_file_formats/juce_OggVorbisAudioFormat.h"
 #endif
@@ -131,6 +134,9 @@
 #ifndef __JUCE_AUDIOIODEVICETYPE_JUCEHEADER__
  #include "audio/devices/juce_AudioIODeviceType.h"
 #endif
+#ifndef __JUCE_AUDIOBUFFERPOOL_JUCEHEADER__
+ #include "audio/dsp/juce_AudioBufferPool.h"
+#endif
 #ifndef __JUCE_AUDIODATACONVERTERS_JUCEHEADER__
  #include "audio/dsp/juce_AudioDataConverters.h"
 #endif
@@ -140,9 +146,15 @@
 #ifndef __JUCE_DECIBELS_JUCEHEADER__
  #include "audio/dsp/juce_Decibels.h"
 #endif
+#ifndef __JUCE_FLOATVECTOROPERATIONS_JUCEHEADER__
+ #include "audio/dsp/juce_FloatVectorOperations.h"
+#endif
 #ifndef __JUCE_IIRFILTER_JUCEHEADER__
  #include "audio/dsp/juce_IIRFilter.h"
 #endif
+#ifndef __JUCE_IIRFILTERCASCADE_JUCEHEADER__
+ #include "audio/dsp/juce_IIRFilterCascade.h"
+#endif
 #ifndef __JUCE_REVERB_JUCEHEADER__
  #include "audio/dsp/juce_Reverb.h"
 #endif
@@ -227,9 +239,15 @@
 #ifndef __JUCE_GENERICAUDIOPROCESSOREDITOR_JUCEHEADER__
  #include "audio/processors/juce_GenericAudioProcessorEditor.h"
 #endif
+#ifndef __JUCE_SAMPLECACHE_JUCEHEADER__
+ #include "audio/synthesisers/juce_SampleCache.h"
+#endif
 #ifndef __JUCE_SAMPLER_JUCEHEADER__
  #include "audio/synthesisers/juce_Sampler.h"
 #endif
+#ifndef __JUCE_STREAMINGSAMPLERSOUND_JUCEHEADER__
+ #include "audio/synthesisers/juce_StreamingSamplerSound.h"
+#endif
 #ifndef __JUCE_SYNTHESISER_JUCEHEADER__
  #include "audio/synthesisers/juce_Synthesiser.h"
 #endif
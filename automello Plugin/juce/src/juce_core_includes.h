@@ -293,6 +293,9 @@
 #ifndef __JUCE_INTERPROCESSLOCK_JUCEHEADER__
  #include "threads/juce_InterProcessLock.h"
 #endif
+#ifndef __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
+ #include "threads/juce_ParallelTaskRunner.h"
+#endif
 #ifndef __JUCE_PROCESS_JUCEHEADER__
  #include "threads/juce_Process.h"
 #endif
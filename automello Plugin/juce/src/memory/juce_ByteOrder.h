@@ -70,6 +70,9 @@ public:
     /** Turns 2 bytes into a little-endian integer. */
     static uint16 littleEndianShort (const void* bytes);
 
+    /** Turns 8 bytes into a little-endian integer. */
+    static uint64 littleEndianInt64 (const void* bytes);
+
     /** Turns 4 bytes into a big-endian integer. */
     static uint32 bigEndianInt (const void* bytes);
 
@@ -157,6 +160,7 @@ inline uint64 ByteOrder::swap (uint64 value)
  inline uint64 ByteOrder::swapIfLittleEndian (const uint64 v)                               { return swap (v); }
  inline uint32 ByteOrder::littleEndianInt (const void* const bytes)                         { return *static_cast <const uint32*> (bytes); }
  inline uint16 ByteOrder::littleEndianShort (const void* const bytes)                       { return *static_cast <const uint16*> (bytes); }
+ inline uint64 ByteOrder::littleEndianInt64 (const void* const bytes)                       { return *static_cast <const uint64*> (bytes); }
  inline uint32 ByteOrder::bigEndianInt (const void* const bytes)                            { return swap (*static_cast <const uint32*> (bytes)); }
  inline uint16 ByteOrder::bigEndianShort (const void* const bytes)                          { return swap (*static_cast <const uint16*> (bytes)); }
  inline bool ByteOrder::isBigEndian()                                                       { return false; }
@@ -169,6 +173,7 @@ inline uint64 ByteOrder::swap (uint64 value)
  inline uint64 ByteOrder::swapIfLittleEndian (const uint64 v)                               { return v; }
  inline uint32 ByteOrder::littleEndianInt (const void* const bytes)                         { return swap (*static_cast <const uint32*> (bytes)); }
  inline uint16 ByteOrder::littleEndianShort (const void* const bytes)                       { return swap (*static_cast <const uint16*> (bytes)); }
+ inline uint64 ByteOrder::littleEndianInt64 (const void* const bytes)                       { return swap (*static_cast <const uint64*> (bytes)); }
  inline uint32 ByteOrder::bigEndianInt (const void* const bytes)                            { return *static_cast <const uint32*> (bytes); }
  inline uint16 ByteOrder::bigEndianShort (const void* const bytes)                          { return *static_cast <const uint16*> (bytes); }
  inline bool ByteOrder::isBigEndian()                                                       { return true; }
@@ -118,13 +118,16 @@ namespace
 class ALSADevice
 {
 public:
-    ALSADevice (const String& deviceID, bool forInput)
+    ALSADevice (const String& deviceID, bool forInput, bool shouldUseMmap, Atomic<int>& xRunCounter)
         : handle (0),
           bitDepth (16),
           numChannelsRunning (0),
           latency (0),
+          isMmap (false),
           isInput (forInput),
-          isInterleaved (true)
+          isInterleaved (true),
+          useMmap (shouldUseMmap),
+          numXRuns (xRunCounter)
     {
         failed (snd_pcm_open (&handle, deviceID.toUTF8(),
                               forInput ? SND_PCM_STREAM_CAPTURE : SND_PCM_STREAM_PLAYBACK,
@@ -148,7 +151,19 @@ public:
         if (failed (snd_pcm_hw_params_any (handle, hwParams)))
             return false;
 
-        if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_NONINTERLEAVED) >= 0)
+        isMmap = false;
+
+        if (useMmap && snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_MMAP_NONINTERLEAVED) >= 0)
+        {
+            isMmap = true;
+            isInterleaved = false;
+        }
+        else if (useMmap && snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) >= 0)
+        {
+            isMmap = true;
+            isInterleaved = true;
+        }
+        else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_NONINTERLEAVED) >= 0)
             isInterleaved = false;
         else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) >= 0)
             isInterleaved = true;
@@ -177,7 +192,7 @@ public:
                 bitDepth = formatsToTry [i + 1] & 255;
                 const bool isFloat = (formatsToTry [i + 1] & isFloatBit) != 0;
                 const bool isLittleEndian = (formatsToTry [i + 1] & isLittleEndianBit) != 0;
-                converter = createConverter (isInput, bitDepth, isFloat, isLittleEndian, numChannels);
+                converter = createConverter (isInput, bitDepth, isFloat, isLittleEndian, isInterleaved ? numChannels : 1);
                 break;
             }
         }
@@ -202,7 +217,7 @@ public:
             return false;
         }
 
-        snd_pcm_uframes_t frames = 0;
+        snd_pcm_uframes_t frames = 0, bufferFrames = 0;
 
         if (failed (snd_pcm_hw_params_get_period_size (hwParams, &frames, &dir))
              || failed (snd_pcm_hw_params_get_periods (hwParams, &periods, &dir)))
@@ -210,16 +225,26 @@ public:
         else
             latency = frames * (periods - 1); // (this is the method JACK uses to guess the latency..)
 
+        if (failed (snd_pcm_hw_params_get_buffer_size (hwParams, &bufferFrames)))
+            return false;
+
         snd_pcm_sw_params_t* swParams;
         snd_pcm_sw_params_alloca (&swParams);
         snd_pcm_uframes_t boundary;
 
         if (failed (snd_pcm_sw_params_current (handle, swParams))
-            || failed (snd_pcm_sw_params_get_boundary (swParams, &boundary))
-            || failed (snd_pcm_sw_params_set_silence_threshold (handle, swParams, 0))
+            || failed (snd_pcm_sw_params_get_boundary (swParams, &boundary)))
+            return false;
+
+        // In mmap mode the stream stops when it runs out of data, like JACK's does, so that
+        // xruns get reported and the stream is restarted cleanly. Otherwise it's left to run on
+        // through them, playing silence.
+        const snd_pcm_uframes_t stopThreshold = isMmap ? bufferFrames : boundary;
+
+        if (failed (snd_pcm_sw_params_set_silence_threshold (handle, swParams, 0))
             || failed (snd_pcm_sw_params_set_silence_size (handle, swParams, boundary))
             || failed (snd_pcm_sw_params_set_start_threshold (handle, swParams, samplesPerPeriod))
-            || failed (snd_pcm_sw_params_set_stop_threshold (handle, swParams, boundary))
+            || failed (snd_pcm_sw_params_set_stop_threshold (handle, swParams, stopThreshold))
             || failed (snd_pcm_sw_params (handle, swParams)))
         {
             return false;
@@ -242,6 +267,9 @@ public:
     bool writeToOutputDevice (AudioSampleBuffer& outputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= outputChannelBuffer.getNumChannels());
+        if (isMmap)
+            return transferMmap (outputChannelBuffer, numSamples);
+
         float** const data = outputChannelBuffer.getArrayOfChannels();
         snd_pcm_sframes_t numDone = 0;
 
@@ -266,6 +294,8 @@ public:
         {
             if (numDone == -EPIPE)
             {
+                ++numXRuns;
+
                 if (failed (snd_pcm_prepare (handle)))
                     return false;
             }
@@ -279,6 +309,10 @@ public:
     bool readFromInputDevice (AudioSampleBuffer& inputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= inputChannelBuffer.getNumChannels());
+
+        if (isMmap)
+            return transferMmap (inputChannelBuffer, numSamples);
+
         float** const data = inputChannelBuffer.getArrayOfChannels();
 
         if (isInterleaved)
@@ -292,6 +326,8 @@ public:
             {
                 if (num == -EPIPE)
                 {
+                    ++numXRuns;
+
                     if (failed (snd_pcm_prepare (handle)))
                         return false;
                 }
@@ -306,6 +342,9 @@ public:
         {
             snd_pcm_sframes_t num = snd_pcm_readn (handle, (void**) data, numSamples);
 
+            if (num == -EPIPE)
+                ++numXRuns;
+
             if (failed (num) && num != -EPIPE && num != -ESTRPIPE)
                 return false;
 
@@ -320,14 +359,113 @@ public:
     snd_pcm_t* handle;
     String error;
     int bitDepth, numChannelsRunning, latency;
+    bool isMmap;
 
     //==============================================================================
 private:
     const bool isInput;
     bool isInterleaved;
+    const bool useMmap;
+    Atomic<int>& numXRuns; // (owned by the ALSAThread, so it can be read while the devices are being deleted)
     MemoryBlock scratch;
     ScopedPointer<AudioData::Converter> converter;
 
+    //==============================================================================
+    /*  Converts the samples straight into or out of the device's own ring buffer, rather
+        than going through the scratch buffer and a read or write call. The device can hand
+        back less than a whole block at a time (e.g. where its buffer wraps round), so this
+        keeps going until the block's done, waiting whenever there's no room or data.
+    */
+    bool transferMmap (AudioSampleBuffer& buffer, const int numSamples)
+    {
+        jassert (numChannelsRunning <= buffer.getNumChannels());
+        float** const data = buffer.getArrayOfChannels();
+        int numDone = 0;
+
+        while (numDone < numSamples)
+        {
+            const snd_pcm_sframes_t numAvailable = snd_pcm_avail_update (handle);
+
+            if (numAvailable < 0)
+            {
+                if (! recover ((int) numAvailable))
+                    return false;
+
+                continue;
+            }
+
+            if (numAvailable == 0)
+            {
+                // (unlike snd_pcm_readi, capturing through mmap doesn't start the stream by itself)
+                if (isInput && snd_pcm_state (handle) == SND_PCM_STATE_PREPARED
+                      && failed (snd_pcm_start (handle)))
+                    return false;
+
+                const int result = snd_pcm_wait (handle, 1000);
+
+                if (result == 0)
+                {
+                    error = "device timed out";
+                    return false;
+                }
+
+                if (result < 0 && ! recover (result))
+                    return false;
+
+                continue;
+            }
+
+            const snd_pcm_channel_area_t* areas = nullptr;
+            snd_pcm_uframes_t offset = 0;
+            snd_pcm_uframes_t numFrames = (snd_pcm_uframes_t) (numSamples - numDone);
+
+            const int result = snd_pcm_mmap_begin (handle, &areas, &offset, &numFrames);
+
+            if (result < 0)
+            {
+                if (! recover (result))
+                    return false;
+
+                continue;
+            }
+
+            for (int i = 0; i < numChannelsRunning; ++i)
+            {
+                const snd_pcm_channel_area_t& area = areas[i];
+                jassert (area.step == (unsigned int) (bitDepth * (isInterleaved ? numChannelsRunning : 1)));
+
+                char* const deviceData = static_cast <char*> (area.addr) + (area.first + area.step * offset) / 8;
+
+                if (isInput)
+                    converter->convertSamples (data[i] + numDone, 0, deviceData, 0, (int) numFrames);
+                else
+                    converter->convertSamples (deviceData, 0, data[i] + numDone, 0, (int) numFrames);
+            }
+
+            const snd_pcm_sframes_t numCommitted = snd_pcm_mmap_commit (handle, offset, numFrames);
+
+            if (numCommitted < 0 || (snd_pcm_uframes_t) numCommitted != numFrames)
+            {
+                if (! recover (numCommitted < 0 ? (int) numCommitted : -EPIPE))
+                    return false;
+
+                continue;
+            }
+
+            numDone += (int) numFrames;
+        }
+
+        return true;
+    }
+
+    bool recover (const int errorNum)
+    {
+        if (errorNum == -EPIPE)
+            ++numXRuns;
+
+        return ! failed (snd_pcm_recover (handle, errorNum, 1));
+    }
+
     //==============================================================================
     template <class SampleType>
     struct ConverterHelper
@@ -388,16 +526,19 @@ class ALSAThread  : public Thread
 {
 public:
     ALSAThread (const String& inputId_,
-                const String& outputId_)
+                const String& outputId_,
+                const bool lowLatencyMode_)
         : Thread ("Juce ALSA"),
           sampleRate (0),
           bufferSize (0),
           outputLatency (0),
           inputLatency (0),
-          callback (0),
           inputId (inputId_),
           outputId (outputId_),
+          lowLatencyMode (lowLatencyMode_),
+          isMemoryLocked (false),
           numCallbacks (0),
+          ticksPerBlock (0),
           inputChannelBuffer (1, 1),
           outputChannelBuffer (1, 1)
     {
@@ -417,6 +558,7 @@ public:
         close();
 
         error = String::empty;
+        numXRuns = 0;
         sampleRate = sampleRate_;
         bufferSize = bufferSize_;
 
@@ -456,7 +598,7 @@ public:
 
         if (outputChannelDataForCallback.size() > 0 && outputId.isNotEmpty())
         {
-            outputDevice = new ALSADevice (outputId, false);
+            outputDevice = new ALSADevice (outputId, false, lowLatencyMode, numXRuns);
 
             if (outputDevice->error.isNotEmpty())
             {
@@ -481,7 +623,7 @@ public:
 
         if (inputChannelDataForCallback.size() > 0 && inputId.isNotEmpty())
         {
-            inputDevice = new ALSADevice (inputId, true);
+            inputDevice = new ALSADevice (inputId, true, lowLatencyMode, numXRuns);
 
             if (inputDevice->error.isNotEmpty())
             {
@@ -521,6 +663,22 @@ public:
         if (outputDevice != nullptr && failed (snd_pcm_prepare (outputDevice->handle)))
             return;
 
+        numTimedCallbacks = 0;
+        numLateCallbacks = 0;
+        totalCallbackTicks = 0;
+        maxCallbackTicks = 0;
+        ticksPerBlock = sampleRate > 0 ? (int64) (Time::getHighResolutionTicksPerSecond() * bufferSize / sampleRate) : 0;
+
+        // (only the pages that are mapped at this point get locked, because with MCL_FUTURE,
+        // any later allocation that went over the process's RLIMIT_MEMLOCK would fail)
+        if (lowLatencyMode)
+        {
+            isMemoryLocked = (mlockall (MCL_CURRENT) == 0);
+
+            if (! isMemoryLocked)
+                DBG ("ALSA: couldn't lock the process's memory");
+        }
+
         startThread (9);
 
         int count = 1000;
@@ -544,20 +702,60 @@ public:
         inputDevice = nullptr;
         outputDevice = nullptr;
 
+        if (isMemoryLocked)
+        {
+            munlockall();
+            isMemoryLocked = false;
+        }
+
         inputChannelBuffer.setSize (1, 1);
         outputChannelBuffer.setSize (1, 1);
 
         numCallbacks = 0;
     }
 
+    AudioIODeviceCallback* getCallback() const noexcept
+    {
+        return callback.get();
+    }
+
     void setCallback (AudioIODeviceCallback* const newCallback) noexcept
     {
-        const ScopedLock sl (callbackLock);
         callback = newCallback;
+
+        // The audio thread doesn't take a lock to call the callback, so before the caller can
+        // tell the old callback that it's stopped, this has to wait for any call that might
+        // still be using it to finish. The counter is odd while the thread's in a callback.
+        if (Thread::getCurrentThreadId() != getThreadId())
+        {
+            const int count = callbackCounter.get();
+
+            if ((count & 1) != 0)
+                while (callbackCounter.get() == count && isThreadRunning())
+                    Thread::sleep (1);
+        }
+    }
+
+    int getXRunCount() const noexcept
+    {
+        return numXRuns.get();
+    }
+
+    void getCallbackStatistics (AudioIODevice::CallbackStatistics& result) const
+    {
+        const double msPerTick = 1000.0 / Time::getHighResolutionTicksPerSecond();
+
+        result.numCallbacks = numTimedCallbacks.get();
+        result.numLateCallbacks = numLateCallbacks.get();
+        result.averageMilliseconds = result.numCallbacks > 0 ? totalCallbackTicks.get() * msPerTick / result.numCallbacks : 0.0;
+        result.maximumMilliseconds = maxCallbackTicks.get() * msPerTick;
     }
 
     void run()
     {
+        if (lowLatencyMode)
+            setRealtimePriority();
+
         while (! threadShouldExit())
         {
             if (inputDevice != nullptr)
@@ -573,32 +771,44 @@ public:
                 break;
 
             {
-                const ScopedLock sl (callbackLock);
+                ++callbackCounter;
                 ++numCallbacks;
 
-                if (callback != nullptr)
+                AudioIODeviceCallback* const currentCallback = callback.get();
+
+                if (currentCallback != nullptr)
                 {
-                    callback->audioDeviceIOCallback ((const float**) inputChannelDataForCallback.getRawDataPointer(),
-                                                     inputChannelDataForCallback.size(),
-                                                     outputChannelDataForCallback.getRawDataPointer(),
-                                                     outputChannelDataForCallback.size(),
-                                                     bufferSize);
+                    const int64 startTicks = Time::getHighResolutionTicks();
+
+                    currentCallback->audioDeviceIOCallback ((const float**) inputChannelDataForCallback.getRawDataPointer(),
+                                                            inputChannelDataForCallback.size(),
+                                                            outputChannelDataForCallback.getRawDataPointer(),
+                                                            outputChannelDataForCallback.size(),
+                                                            bufferSize);
+
+                    addCallbackTime (Time::getHighResolutionTicks() - startTicks);
                 }
                 else
                 {
                     for (int i = 0; i < outputChannelDataForCallback.size(); ++i)
                         zeromem (outputChannelDataForCallback[i], sizeof (float) * bufferSize);
                 }
+
+                ++callbackCounter;
             }
 
             if (outputDevice != nullptr)
             {
-                failed (snd_pcm_wait (outputDevice->handle, 2000));
+                // (in mmap mode, the transfer waits for space in the device's buffer itself)
+                if (! outputDevice->isMmap)
+                {
+                    failed (snd_pcm_wait (outputDevice->handle, 2000));
 
-                if (threadShouldExit())
-                    break;
+                    if (threadShouldExit())
+                        break;
 
-                failed (snd_pcm_avail_update (outputDevice->handle));
+                    failed (snd_pcm_avail_update (outputDevice->handle));
+                }
 
                 if (! outputDevice->writeToOutputDevice (outputChannelBuffer, bufferSize))
                 {
@@ -628,15 +838,19 @@ public:
 
     Array <int> sampleRates;
     StringArray channelNamesOut, channelNamesIn;
-    AudioIODeviceCallback* callback;
 
 private:
     //==============================================================================
     const String inputId, outputId;
+    const bool lowLatencyMode;
+    bool isMemoryLocked;
     ScopedPointer<ALSADevice> outputDevice, inputDevice;
     int numCallbacks;
 
-    CriticalSection callbackLock;
+    Atomic<AudioIODeviceCallback*> callback;
+    Atomic<int> callbackCounter, numTimedCallbacks, numLateCallbacks, numXRuns;
+    Atomic<int64> totalCallbackTicks, maxCallbackTicks;
+    int64 ticksPerBlock;
 
     AudioSampleBuffer inputChannelBuffer, outputChannelBuffer;
     Array<float*> inputChannelDataForCallback, outputChannelDataForCallback;
@@ -654,6 +868,33 @@ private:
         return true;
     }
 
+    void addCallbackTime (const int64 ticks) noexcept
+    {
+        ++numTimedCallbacks;
+        totalCallbackTicks += ticks;
+
+        if (ticks > maxCallbackTicks.get())
+            maxCallbackTicks = ticks;
+
+        if (ticksPerBlock > 0 && ticks > ticksPerBlock)
+            ++numLateCallbacks;
+    }
+
+    // Switches the calling thread to SCHED_FIFO. If the process isn't allowed to do that
+    // (it needs an rtprio limit or CAP_SYS_NICE), the thread carries on with the priority
+    // it was started with.
+    static void setRealtimePriority()
+    {
+        const int minPriority = sched_get_priority_min (SCHED_FIFO);
+        const int maxPriority = sched_get_priority_max (SCHED_FIFO);
+
+        struct sched_param param;
+        param.sched_priority = ((maxPriority - minPriority) * 9) / 10 + minPriority;
+
+        if (pthread_setschedparam (pthread_self(), SCHED_FIFO, &param) != 0)
+            DBG ("ALSA: couldn't give the audio thread SCHED_FIFO priority");
+    }
+
     void initialiseRatesAndChannels()
     {
         sampleRates.clear();
@@ -685,14 +926,16 @@ class ALSAAudioIODevice   : public AudioIODevice
 {
 public:
     ALSAAudioIODevice (const String& deviceName,
+                       const String& typeName_,
                        const String& inputId_,
-                       const String& outputId_)
-        : AudioIODevice (deviceName, "ALSA"),
+                       const String& outputId_,
+                       const bool lowLatencyMode)
+        : AudioIODevice (deviceName, typeName_),
           inputId (inputId_),
           outputId (outputId_),
           isOpen_ (false),
           isStarted (false),
-          internal (inputId_, outputId_)
+          internal (inputId_, outputId_, lowLatencyMode)
     {
     }
 
@@ -772,6 +1015,14 @@ public:
     int getOutputLatencyInSamples()         { return internal.outputLatency; }
     int getInputLatencyInSamples()          { return internal.inputLatency; }
 
+    int getXRunCount() const noexcept       { return internal.getXRunCount(); }
+
+    bool getCallbackStatistics (CallbackStatistics& result) const
+    {
+        internal.getCallbackStatistics (result);
+        return true;
+    }
+
     void start (AudioIODeviceCallback* callback)
     {
         if (! isOpen_)
@@ -787,7 +1038,7 @@ public:
 
     void stop()
     {
-        AudioIODeviceCallback* const oldCallback = internal.callback;
+        AudioIODeviceCallback* const oldCallback = internal.getCallback();
 
         start (0);
 
@@ -808,9 +1059,10 @@ class ALSAAudioIODeviceType  : public AudioIODeviceType
 {
 public:
     //==============================================================================
-    ALSAAudioIODeviceType()
-        : AudioIODeviceType ("ALSA"),
-          hasScanned (false)
+    ALSAAudioIODeviceType (const bool lowLatencyMode_)
+        : AudioIODeviceType (lowLatencyMode_ ? "ALSA (low latency)" : "ALSA"),
+          hasScanned (false),
+          lowLatencyMode (lowLatencyMode_)
     {
     }
 
@@ -969,9 +1221,10 @@ public:
                                             : inputDeviceName);
 
         if (inputIndex >= 0 || outputIndex >= 0)
-            return new ALSAAudioIODevice (deviceName,
+            return new ALSAAudioIODevice (deviceName, getTypeName(),
                                           inputIds [inputIndex],
-                                          outputIds [outputIndex]);
+                                          outputIds [outputIndex],
+                                          lowLatencyMode);
 
         return nullptr;
     }
@@ -980,6 +1233,7 @@ public:
 private:
     StringArray inputNames, outputNames, inputIds, outputIds;
     bool hasScanned;
+    const bool lowLatencyMode;
 
     static bool testDevice (const String& id, bool& isInput, bool& isOutput)
     {
@@ -1014,7 +1268,12 @@ private:
 //==============================================================================
 AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSA()
 {
-    return new ALSAAudioIODeviceType();
+    return new ALSAAudioIODeviceType (false);
+}
+
+AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSALowLatency()
+{
+    return new ALSAAudioIODeviceType (true);
 }
 
 #endif
@@ -0,0 +1,257 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#include "../core/juce_StandardHeader.h"
+
+BEGIN_JUCE_NAMESPACE
+
+#include "juce_ParallelTaskRunner.h"
+
+
+//==============================================================================
+class ParallelTaskRunner::Worker  : public Thread
+{
+public:
+    Worker (ParallelTaskRunner& owner_, const String& threadName)
+        : Thread (threadName),
+          owner (owner_)
+    {
+    }
+
+    ~Worker()
+    {
+        stopThread (4000);
+    }
+
+    void run()
+    {
+        while (! threadShouldExit())
+        {
+            wait (100);
+            owner.runClaimedTasks (true);
+        }
+    }
+
+private:
+    ParallelTaskRunner& owner;
+
+    JUCE_DECLARE_NON_COPYABLE (Worker);
+};
+
+//==============================================================================
+namespace ParallelTaskRunnerHelpers
+{
+    // after a worker has held things up, this many batches are run without the workers
+    enum { numBatchesToRunSeriallyAfterDelay = 64 };
+}
+
+ParallelTaskRunner::ParallelTaskRunner (const String& threadName, const int numThreads, const int threadPriority)
+    : currentTasks (nullptr),
+      numBatchesToRunSerially (0)
+{
+    for (int i = 0; i < numThreads; ++i)
+    {
+        Worker* const worker = new Worker (*this, threadName);
+        workers.add (worker);
+        worker->startThread (threadPriority);
+    }
+}
+
+ParallelTaskRunner::~ParallelTaskRunner()
+{
+    workers.clear();
+}
+
+//==============================================================================
+void ParallelTaskRunner::runTasks (TaskList& tasks, const int numTasks, const int maxMillisecondsToWait)
+{
+    jassert (numTasks <= (int) maximumNumTasks);
+
+    if (numTasks <= 0)
+        return;
+
+    if (workers.size() == 0 || numBatchesToRunSerially > 0)
+    {
+        if (numBatchesToRunSerially > 0)
+            --numBatchesToRunSerially;
+
+        for (int i = 0; i < numTasks; ++i)
+            tasks.runTask (i);
+
+        return;
+    }
+
+    workersFinished.reset();
+    currentTasks = &tasks;
+    numTasksFinished = 0;
+    claimState = (numTasks << 16);
+
+    for (int i = workers.size(); --i >= 0;)
+        workers.getUnchecked (i)->notify();
+
+    // Anything that the workers haven't got round to gets run here..
+    runClaimedTasks (false);
+
+    // ..so all that can be left is the tasks that the workers have already started, and
+    // those can't be taken back, so they have to be waited for. (The event may also have
+    // been left signalled by a worker that finished the last batch, hence the loop)
+    bool workersAreLate = false;
+
+    while (numTasksFinished.get() < numTasks)
+    {
+        if (! workersFinished.wait (workersAreLate ? 100 : jmax (1, maxMillisecondsToWait)))
+        {
+            workersAreLate = true;
+            numBatchesToRunSerially = ParallelTaskRunnerHelpers::numBatchesToRunSeriallyAfterDelay;
+        }
+    }
+
+    currentTasks = nullptr;
+}
+
+void ParallelTaskRunner::runClaimedTasks (const bool isWorker)
+{
+    for (;;)
+    {
+        const int state = claimState.get();
+        const int numTasks = state >> 16;
+
+        if ((state & 0xffff) >= numTasks)
+            return;
+
+        if (claimState.compareAndSetBool (state + 1, state))
+        {
+            currentTasks->runTask (state & 0xffff);
+
+            // (the calling thread checks the count itself, so only the workers need to tell it)
+            if (++numTasksFinished == numTasks && isWorker)
+                workersFinished.signal();
+        }
+    }
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../utilities/juce_UnitTest.h"
+
+class ParallelTaskRunnerTests  : public UnitTest
+{
+public:
+    ParallelTaskRunnerTests() : UnitTest ("ParallelTaskRunner") {}
+
+    // counts how many times each task gets run, and notes which thread ran it
+    class CountingTasks  : public ParallelTaskRunner::TaskList
+    {
+    public:
+        CountingTasks (const int workerDelayMilliseconds_)
+            : callingThread (Thread::getCurrentThreadId()),
+              workerDelayMilliseconds (workerDelayMilliseconds_)
+        {
+        }
+
+        void runTask (const int index)
+        {
+            // (this pretends that the workers have been held up by the system)
+            if (workerDelayMilliseconds > 0 && Thread::getCurrentThreadId() != callingThread)
+                Thread::sleep (workerDelayMilliseconds);
+
+            ++counts [index];
+            threads [index] = Thread::getCurrentThreadId();
+        }
+
+        bool anyRunElsewhere (const int numTasks) const
+        {
+            for (int i = 0; i < numTasks; ++i)
+                if (threads [i] != callingThread)
+                    return true;
+
+            return false;
+        }
+
+        enum { maxTasks = 64 };
+        Atomic<int> counts [maxTasks];
+        Thread::ThreadID threads [maxTasks];
+        const Thread::ThreadID callingThread;
+        const int workerDelayMilliseconds;
+    };
+
+    void runTest()
+    {
+        beginTest ("Running tasks");
+
+        {
+            ParallelTaskRunner runner ("test", 3);
+            expectEquals (runner.getNumThreads(), 3);
+
+            CountingTasks tasks (0);
+
+            for (int i = 0; i < 1000; ++i)
+                runner.runTasks (tasks, 1 + i % CountingTasks::maxTasks, 1000);
+
+            bool allCorrect = true;
+
+            for (int i = 0; i < CountingTasks::maxTasks; ++i)
+            {
+                int expected = 0;
+
+                for (int j = 0; j < 1000; ++j)
+                    if (i < 1 + j % CountingTasks::maxTasks)
+                        ++expected;
+
+                allCorrect = allCorrect && tasks.counts[i].get() == expected;
+            }
+
+            expect (allCorrect);
+        }
+
+        beginTest ("Delayed workers");
+
+        {
+            ParallelTaskRunner runner ("test", 3);
+
+            // if a worker got hold of one of these tasks, it held the caller up for longer
+            // than it allowed, so the next batches shouldn't use the workers at all
+            CountingTasks slowTasks (50);
+            runner.runTasks (slowTasks, 8, 1);
+
+            if (slowTasks.anyRunElsewhere (8))
+            {
+                CountingTasks tasks (0);
+                runner.runTasks (tasks, 8, 1000);
+                expect (! tasks.anyRunElsewhere (8));
+            }
+
+            for (int i = 0; i < 8; ++i)
+                expectEquals (slowTasks.counts[i].get(), 1);
+        }
+    }
+};
+
+static ParallelTaskRunnerTests parallelTaskRunnerTests;
+
+#endif
+
+END_JUCE_NAMESPACE
@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library - "Jules' Utility Class Extensions"
+   Copyright 2004-11 by Raw Material Software Ltd.
+
+  ------------------------------------------------------------------------------
+
+   JUCE can be redistributed and/or modified under the terms of the GNU General
+   Public License (Version 2), as published by the Free Software Foundation.
+   A copy of the license is included in the JUCE distribution, or can be found
+   online at www.gnu.org/licenses.
+
+   JUCE is distributed in the hope that it will be useful, but WITHOUT ANY
+   WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+   A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+
+  ------------------------------------------------------------------------------
+
+   To release a closed-source product which uses JUCE, commercial licenses are
+   available: visit www.rawmaterialsoftware.com/juce for more information.
+
+  ==============================================================================
+*/
+
+#ifndef __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
+#define __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
+
+#include "juce_Thread.h"
+#include "juce_WaitableEvent.h"
+#include "../containers/juce_OwnedArray.h"
+#include "../memory/juce_Atomic.h"
+
+
+//==============================================================================
+/**
+    A set of worker threads that helps a time-critical thread (normally the audio thread)
+    get through a batch of independent tasks.
+
+    Each call to runTasks() shares the tasks out between the workers and the thread that
+    called it. The tasks are claimed one at a time by whichever thread gets to them first,
+    and the calling thread claims them too, so it never waits for a worker to wake up:
+    anything that the workers haven't started by the time it runs out of work of its own
+    just gets run by the calling thread.
+
+    The only waiting it ever does is for tasks that a worker has already started, and if
+    that takes longer than the caller says it can afford, the next few batches are run
+    entirely on the calling thread, so that a worker that's been held up by the system
+    can't keep on delaying it.
+
+    Because any task can end up on any thread, the results of the tasks should be kept
+    apart (e.g. in a buffer for each task) and combined in task order afterwards, which
+    makes them independent of the way the tasks happened to get shared out.
+
+    @see Thread
+*/
+class JUCE_API  ParallelTaskRunner
+{
+public:
+    //==============================================================================
+    /** A batch of tasks that can be run by a ParallelTaskRunner. */
+    class JUCE_API  TaskList
+    {
+    public:
+        /** Destructor. */
+        virtual ~TaskList()  {}
+
+        /** Runs one of the tasks.
+
+            This may be called on any of the runner's threads, and at the same time as other
+            tasks from the list, but each task is only run once by each call to runTasks().
+        */
+        virtual void runTask (int taskIndex) = 0;
+    };
+
+    //==============================================================================
+    /** Creates a runner, and starts its worker threads.
+
+        If numThreads is 0, all the tasks get run on the thread that calls runTasks().
+    */
+    ParallelTaskRunner (const String& threadName, int numThreads, int threadPriority = 9);
+
+    /** Destructor.
+
+        This stops the worker threads, so it mustn't be called while runTasks() is running.
+    */
+    ~ParallelTaskRunner();
+
+    //==============================================================================
+    /** Returns the number of worker threads (not counting the thread that calls runTasks()). */
+    int getNumThreads() const noexcept                  { return workers.size(); }
+
+    /** The largest number of tasks that can be run by a call to runTasks(). */
+    enum { maximumNumTasks = 0xffff };
+
+    /** Runs tasks 0 to (numTasks - 1) from the list, and returns once they've all finished.
+
+        This never allocates memory or takes a lock while the workers are keeping up. If a
+        worker has started a task but not finished it within maxMillisecondsToWait of the
+        calling thread running out of work, the calling thread still has to let it finish,
+        but it runs the next few batches by itself.
+
+        Only one thread at a time can call this.
+    */
+    void runTasks (TaskList& tasks, int numTasks, int maxMillisecondsToWait);
+
+private:
+    //==============================================================================
+    class Worker;
+    friend class Worker;
+
+    OwnedArray <Worker> workers;
+
+    // (the top 16 bits of the claim state hold the number of tasks, and the bottom 16 bits
+    // hold the index of the next one to be claimed)
+    Atomic <int> claimState, numTasksFinished;
+    TaskList* currentTasks;
+    WaitableEvent workersFinished;
+    int numBatchesToRunSerially;
+
+    void runClaimedTasks (bool isWorker);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelTaskRunner);
+};
+
+
+#endif   // __JUCE_PARALLELTASKRUNNER_JUCEHEADER__
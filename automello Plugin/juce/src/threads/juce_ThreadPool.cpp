@@ -28,6 +28,7 @@
 BEGIN_JUCE_NAMESPACE
 
 #include "juce_ThreadPool.h"
+#include "juce_SpinLock.h"
 #include "../core/juce_Time.h"
 
 
@@ -35,9 +36,12 @@ BEGIN_JUCE_NAMESPACE
 ThreadPoolJob::ThreadPoolJob (const String& name)
     : jobName (name),
       pool (nullptr),
+      poolState (notInPool),
       shouldStop (false),
       isActive (false),
-      shouldBeDeleted (false)
+      shouldBeDeleted (false),
+      nextQueuedJob (nullptr),
+      outerRunningJob (nullptr)
 {
 }
 
@@ -45,7 +49,7 @@ ThreadPoolJob::~ThreadPoolJob()
 {
     // you mustn't delete a job while it's still in a pool! Use ThreadPool::removeJob()
     // to remove it first!
-    jassert (pool == nullptr || ! pool->contains (this));
+    jassert (poolState.get() == notInPool);
 }
 
 String ThreadPoolJob::getJobName() const
@@ -68,10 +72,12 @@ void ThreadPoolJob::signalJobShouldExit()
 class ThreadPool::ThreadPoolThread  : public Thread
 {
 public:
-    ThreadPoolThread (ThreadPool& pool_)
+    ThreadPoolThread (ThreadPool& pool_, const int index_)
         : Thread ("Pool"),
-          pool (pool_),
-          busy (false)
+          index (index_),
+          firstQueuedJob (0),
+          isStarted (false),
+          pool (pool_)
     {
     }
 
@@ -79,18 +85,133 @@ public:
     {
         while (! threadShouldExit())
         {
-            if (! pool.runNextJob())
-                wait (500);
+            if (pool.runNextJob (*this))
+                continue;
+
+            // Once this thread is marked as idle, anything that queues a job will wake it,
+            // so the check for work has to come after that to avoid missing a job that
+            // arrives in between.
+            isIdle = 1;
+            ++pool.numIdleThreads;
+
+            const bool wasWoken = pool.isWorkAvailable() || wait (500);
+
+            if (isIdle.compareAndSetBool (0, 1))
+                --pool.numIdleThreads;
+
+            if (! wasWoken && pool.stopIdleThread (*this))
+                return;
+        }
+    }
+
+    bool hasQueuedJobs() const noexcept
+    {
+        return firstQueuedJob < queue.size();
+    }
+
+    /** The owning thread takes jobs from the end of its queue. */
+    ThreadPoolJob* takeLastQueuedJob() noexcept
+    {
+        ThreadPoolJob* const job = queue.remove (queue.size() - 1);
+        removeEmptySpace();
+        return job;
+    }
+
+    /** Other threads steal from the start, which leaves the owner's end untouched. */
+    ThreadPoolJob* takeFirstQueuedJob() noexcept
+    {
+        ThreadPoolJob* const job = queue.getUnchecked (firstQueuedJob++);
+        removeEmptySpace();
+        return job;
+    }
+
+    void removeEmptySpace() noexcept
+    {
+        if (firstQueuedJob >= queue.size())
+        {
+            queue.clearQuick();
+            firstQueuedJob = 0;
         }
     }
 
+    /** Marks a job as being run by this thread. This has to happen while the job is still
+        locked in the queue it came from, so that the pool can always find it somewhere.
+    */
+    void startJob (ThreadPoolJob* const job) noexcept
+    {
+        job->isActive = true;
+        job->outerRunningJob = currentJob.get();
+        currentJob = job;
+    }
+
+    /** Takes a job off this thread once it's been run. If it's leaving the pool, it gets
+        marked as gone at the same moment, after which anything that was waiting for it
+        may delete it, so the job mustn't be touched again.
+    */
+    void endJob (ThreadPoolJob* const job, const bool jobIsLeavingPool) noexcept
+    {
+        const SpinLock::ScopedLockType sl (queueLock);
+
+        currentJob = job->outerRunningJob;
+        job->outerRunningJob = nullptr;
+
+        if (jobIsLeavingPool)
+            job->poolState = ThreadPoolJob::notInPool;
+    }
+
+    const int index;
+    SpinLock queueLock;
+    Array <ThreadPoolJob*> queue;
+    int firstQueuedJob;
+
+    /** The job this thread is running. If that job is waiting for another one and this
+        thread has picked up something else in the meantime, the jobs are chained together
+        through their outerRunningJob pointers.
+    */
+    Atomic <ThreadPoolJob*> currentJob;
+    Atomic <int> isIdle;
+    bool isStarted;
+
 private:
     ThreadPool& pool;
-    bool volatile busy;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolThread);
 };
 
+//==============================================================================
+namespace ThreadPoolHelpers
+{
+    void removeMatchingJobs (Array <ThreadPoolJob*>& jobs, const int startIndex,
+                             ThreadPool::JobSelector* const selector,
+                             Array <ThreadPoolJob*>& removedJobs)
+    {
+        int numKept = startIndex;
+
+        for (int i = startIndex; i < jobs.size(); ++i)
+        {
+            ThreadPoolJob* const job = jobs.getUnchecked (i);
+
+            if (selector == nullptr || selector->isJobSuitable (job))
+                removedJobs.add (job);
+            else
+                jobs.set (numKept++, job);
+        }
+
+        jobs.removeRange (numKept, jobs.size() - numKept);
+    }
+
+    class SingleJobSelector  : public ThreadPool::JobSelector
+    {
+    public:
+        SingleJobSelector (ThreadPoolJob* const job_) noexcept  : job (job_) {}
+
+        bool isJobSuitable (ThreadPoolJob* const other)     { return other == job; }
+
+    private:
+        ThreadPoolJob* const job;
+    };
+}
+
 //==============================================================================
 ThreadPool::ThreadPool (const int numThreads,
                         const bool startThreadsOnlyWhenNeeded,
@@ -100,12 +221,18 @@ ThreadPool::ThreadPool (const int numThreads,
 {
     jassert (numThreads > 0); // not much point having one of these with no threads in it.
 
-    for (int i = jmax (1, numThreads); --i >= 0;)
-        threads.add (new ThreadPoolThread (*this));
+    for (int i = 0; i < jmax (1, numThreads); ++i)
+        threads.add (new ThreadPoolThread (*this, i));
 
     if (! startThreadsOnlyWhenNeeded)
+    {
         for (int i = threads.size(); --i >= 0;)
+        {
+            threads.getUnchecked(i)->isStarted = true;
+            ++numThreadsRunning;
             threads.getUnchecked(i)->startThread (priority);
+        }
+    }
 }
 
 ThreadPool::~ThreadPool()
@@ -123,73 +250,94 @@ ThreadPool::~ThreadPool()
 void ThreadPool::addJob (ThreadPoolJob* const job)
 {
     jassert (job != nullptr);
-    jassert (job->pool == nullptr);
+    jassert (job->poolState.get() == ThreadPoolJob::notInPool);
 
-    if (job->pool == nullptr)
+    if (job->poolState.get() == ThreadPoolJob::notInPool)
     {
         job->pool = this;
         job->shouldStop = false;
         job->isActive = false;
+        job->poolState = ThreadPoolJob::inPool;
 
-        {
-            const ScopedLock sl (lock);
-            jobs.add (job);
+        ++numJobs;
+        queueJob (job);
+    }
+}
+
+void ThreadPool::addJobAfter (ThreadPoolJob* const job, const Array <ThreadPoolJob*>& prerequisites)
+{
+    jassert (job != nullptr);
+    jassert (job->poolState.get() == ThreadPoolJob::notInPool);
 
-            int numRunning = 0;
+    if (job->poolState.get() == ThreadPoolJob::notInPool)
+    {
+        job->pool = this;
+        job->shouldStop = false;
+        job->isActive = false;
 
-            for (int i = threads.size(); --i >= 0;)
-                if (threads.getUnchecked(i)->isThreadRunning() && ! threads.getUnchecked(i)->threadShouldExit())
-                    ++numRunning;
+        const ScopedLock sl (lock);
+        job->poolState = ThreadPoolJob::inPool;
+        ++numJobs;
 
-            if (numRunning < threads.size())
+        for (int i = 0; i < prerequisites.size(); ++i)
+        {
+            ThreadPoolJob* const prerequisite = prerequisites.getUnchecked (i);
+
+            // A prerequisite only gets a dependent while it's still properly in the pool -
+            // once it's started leaving, it'll never look at its dependents again. Only the
+            // lock holder ever moves a job out of the inPoolWithDependents state.
+            if (prerequisite != nullptr && prerequisite != job && prerequisite->pool == this
+                 && ! job->unfinishedPrerequisites.contains (prerequisite)
+                 && (prerequisite->poolState.compareAndSetBool (ThreadPoolJob::inPoolWithDependents, ThreadPoolJob::inPool)
+                      || prerequisite->poolState.get() == ThreadPoolJob::inPoolWithDependents))
             {
-                bool startedOne = false;
-                int n = 1000;
-
-                while (--n >= 0 && ! startedOne)
-                {
-                    for (int i = threads.size(); --i >= 0;)
-                    {
-                        if (! threads.getUnchecked(i)->isThreadRunning())
-                        {
-                            threads.getUnchecked(i)->startThread (priority);
-                            startedOne = true;
-                            break;
-                        }
-                    }
-
-                    if (! startedOne)
-                        Thread::sleep (2);
-                }
+                job->unfinishedPrerequisites.add (prerequisite);
+                prerequisite->dependentJobs.add (job);
             }
         }
 
-        for (int i = threads.size(); --i >= 0;)
-            threads.getUnchecked(i)->notify();
+        if (job->unfinishedPrerequisites.size() > 0)
+            waitingJobs.add (job);
+        else
+            queueJob (job);
     }
 }
 
 int ThreadPool::getNumJobs() const
 {
-    return jobs.size();
+    return numJobs.get();
 }
 
 ThreadPoolJob* ThreadPool::getJob (const int index) const
 {
-    const ScopedLock sl (lock);
-    return jobs [index];
+    Array <ThreadPoolJob*> allJobs;
+    getAllJobs (allJobs, false);
+    return allJobs [index];
 }
 
 bool ThreadPool::contains (const ThreadPoolJob* const job) const
 {
-    const ScopedLock sl (lock);
-    return jobs.contains (const_cast <ThreadPoolJob*> (job));
+    return job != nullptr
+            && job->poolState.get() != ThreadPoolJob::notInPool
+            && job->pool == this;
 }
 
 bool ThreadPool::isJobRunning (const ThreadPoolJob* const job) const
 {
-    const ScopedLock sl (lock);
-    return jobs.contains (const_cast <ThreadPoolJob*> (job)) && job->isActive;
+    // This doesn't look at the job itself, because a running job that's being waited
+    // for may delete itself when it finishes. A thread's chain of running jobs only
+    // changes while its queue is locked, so nothing in it can be deleted during the search.
+    for (int i = threads.size(); --i >= 0;)
+    {
+        const ThreadPoolThread& thread = *threads.getUnchecked(i);
+        const SpinLock::ScopedLockType sl (thread.queueLock);
+
+        for (const ThreadPoolJob* j = thread.currentJob.get(); j != nullptr; j = j->outerRunningJob)
+            if (j == job)
+                return true;
+    }
+
+    return false;
 }
 
 bool ThreadPool::waitForJobToFinish (const ThreadPoolJob* const job,
@@ -198,13 +346,23 @@ bool ThreadPool::waitForJobToFinish (const ThreadPoolJob* const job,
     if (job != nullptr)
     {
         const uint32 start = Time::getMillisecondCounter();
+        ThreadPoolThread* const currentThread = getCurrentPoolThread();
 
         while (contains (job))
         {
-            if (timeOutMs >= 0 && Time::getMillisecondCounter() >= start + timeOutMs)
+            const int timeLeft = timeOutMs >= 0 ? (int) (start + timeOutMs - Time::getMillisecondCounter()) : 100;
+
+            if (timeLeft <= 0)
                 return false;
 
-            jobFinishedSignal.wait (2);
+            // When one of our own jobs is waiting, its thread runs other jobs rather than
+            // sitting idle - quite possibly the very one that's being waited for.
+            if (currentThread != nullptr && const_cast <ThreadPool*> (this)->runNextJob (*currentThread))
+                continue;
+
+            // Other threads may be waiting on the same signal and get woken instead of this
+            // one, so the wait is capped rather than relying on being signalled.
+            jobFinishedSignal.wait (jmin (timeLeft, 100));
         }
     }
 
@@ -221,20 +379,23 @@ bool ThreadPool::removeJob (ThreadPoolJob* const job,
     {
         const ScopedLock sl (lock);
 
-        if (jobs.contains (job))
+        if (contains (job))
         {
-            if (job->isActive)
+            if (! job->isActive)
+            {
+                ThreadPoolHelpers::SingleJobSelector selector (job);
+                Array <ThreadPoolJob*> removedJobs;
+                removeQueuedJobs (&selector, removedJobs);
+            }
+
+            // if it's still in the pool, a thread must have started running it
+            if (contains (job))
             {
                 if (interruptIfRunning)
                     job->signalJobShouldExit();
 
                 dontWait = false;
             }
-            else
-            {
-                jobs.removeValue (job);
-                job->pool = nullptr;
-            }
         }
     }
 
@@ -251,28 +412,26 @@ bool ThreadPool::removeAllJobs (const bool interruptRunningJobs,
     {
         const ScopedLock sl (lock);
 
-        for (int i = jobs.size(); --i >= 0;)
+        Array <ThreadPoolJob*> removedJobs;
+        removeQueuedJobs (selectedJobsToRemove, removedJobs);
+
+        if (deleteInactiveJobs)
+            for (int i = removedJobs.size(); --i >= 0;)
+                delete removedJobs.getUnchecked (i);
+
+        Array <ThreadPoolJob*> runningJobs;
+        getAllJobs (runningJobs, true);
+
+        for (int i = 0; i < runningJobs.size(); ++i)
         {
-            ThreadPoolJob* const job = jobs.getUnchecked(i);
+            ThreadPoolJob* const job = runningJobs.getUnchecked (i);
 
             if (selectedJobsToRemove == nullptr || selectedJobsToRemove->isJobSuitable (job))
             {
-                if (job->isActive)
-                {
-                    jobsToWaitFor.add (job);
-
-                    if (interruptRunningJobs)
-                        job->signalJobShouldExit();
-                }
-                else
-                {
-                    jobs.remove (i);
-
-                    if (deleteInactiveJobs)
-                        delete job;
-                    else
-                        job->pool = nullptr;
-                }
+                jobsToWaitFor.add (job);
+
+                if (interruptRunningJobs)
+                    job->signalJobShouldExit();
             }
         }
     }
@@ -299,15 +458,13 @@ bool ThreadPool::removeAllJobs (const bool interruptRunningJobs,
 
 StringArray ThreadPool::getNamesOfAllJobs (const bool onlyReturnActiveJobs) const
 {
+    Array <ThreadPoolJob*> allJobs;
+    getAllJobs (allJobs, onlyReturnActiveJobs);
+
     StringArray s;
-    const ScopedLock sl (lock);
 
-    for (int i = 0; i < jobs.size(); ++i)
-    {
-        const ThreadPoolJob* const job = jobs.getUnchecked(i);
-        if (job->isActive || ! onlyReturnActiveJobs)
-            s.add (job->getJobName());
-    }
+    for (int i = 0; i < allJobs.size(); ++i)
+        s.add (allJobs.getUnchecked(i)->getJobName());
 
     return s;
 }
@@ -328,86 +485,529 @@ bool ThreadPool::setThreadPriorities (const int newPriority)
     return ok;
 }
 
-bool ThreadPool::runNextJob()
+//==============================================================================
+bool ThreadPool::runNextJob (ThreadPoolThread& thread)
+{
+    ThreadPoolJob* const job = takeNextJob (thread);
+
+    if (job == nullptr)
+        return false;
+
+    ThreadPoolJob::JobStatus result = ThreadPoolJob::jobHasFinished;
+
+    JUCE_TRY
+    {
+        // a job that was told to stop before it got started is dropped without being run
+        if (! job->shouldStop)
+            result = job->runJob();
+    }
+#if JUCE_CATCH_UNHANDLED_EXCEPTIONS
+    catch (...)
+    {
+        result = ThreadPoolJob::jobHasFinished;
+    }
+#endif
+
+    lastJobEndTime = Time::getApproximateMillisecondCounter();
+
+    finishJob (thread, job, result);
+    return true;
+}
+
+ThreadPoolJob* ThreadPool::takeNextJob (ThreadPoolThread& thread)
 {
     ThreadPoolJob* job = nullptr;
+    bool moreJobsQueued = false;
+
+    {
+        const SpinLock::ScopedLockType sl (thread.queueLock);
+
+        if (! thread.hasQueuedJobs())
+        {
+            // The incoming jobs are a newest-first stack, so adding them in that order
+            // leaves the oldest one at the end of the queue, where it'll be taken first.
+            for (ThreadPoolJob* j = incomingJobs.exchange (nullptr); j != nullptr; j = j->nextQueuedJob)
+                thread.queue.add (j);
+        }
+
+        if (thread.hasQueuedJobs())
+        {
+            job = thread.takeLastQueuedJob();
+            thread.startJob (job);
+            moreJobsQueued = thread.hasQueuedJobs();
+        }
+    }
+
+    for (int i = 1; job == nullptr && i < threads.size(); ++i)
+    {
+        ThreadPoolThread& other = *threads.getUnchecked ((thread.index + i) % threads.size());
+
+        const SpinLock::ScopedLockType sl (other.queueLock);
+
+        if (other.hasQueuedJobs())
+        {
+            job = other.takeFirstQueuedJob();
+            thread.startJob (job);
+            moreJobsQueued = other.hasQueuedJobs();
+        }
+    }
+
+    // if there's still work left, get another thread to come and take some of it
+    if (moreJobsQueued)
+        wakeIdleThread();
+
+    return job;
+}
+
+void ThreadPool::finishJob (ThreadPoolThread& thread, ThreadPoolJob* const job,
+                            const ThreadPoolJob::JobStatus result)
+{
+    job->isActive = false;
 
+    if (result == ThreadPoolJob::jobNeedsRunningAgain && ! job->shouldStop)
     {
+        // Send the job to the back of the queue if it wants another go. This is done with
+        // the lock held so that removeAllJobs() can't miss it while it's between the two.
         const ScopedLock sl (lock);
+        thread.endJob (job, false);
+        pushIncomingJob (job);
+        wakeIdleThread();
+        return;
+    }
 
-        for (int i = 0; i < jobs.size(); ++i)
+    job->shouldStop = true;
+    const bool shouldBeDeleted = (result == ThreadPoolJob::jobHasFinishedAndShouldBeDeleted);
+
+    // Only a job that other jobs are waiting for needs the lock, to release them.
+    if (! job->poolState.compareAndSetBool (ThreadPoolJob::leavingPool, ThreadPoolJob::inPool))
+    {
+        const ScopedLock sl (lock);
+        releaseDependentJobs (job);
+        job->poolState = ThreadPoolJob::leavingPool;
+    }
+
+    thread.endJob (job, true);
+
+    --numJobs;
+    jobFinishedSignal.signal();
+
+    if (shouldBeDeleted)
+        delete job;
+}
+
+void ThreadPool::releaseDependentJobs (ThreadPoolJob* const job)
+{
+    for (int i = 0; i < job->dependentJobs.size(); ++i)
+    {
+        ThreadPoolJob* const dependentJob = job->dependentJobs.getUnchecked (i);
+        dependentJob->unfinishedPrerequisites.removeValue (job);
+
+        if (dependentJob->unfinishedPrerequisites.size() == 0)
         {
-            job = jobs[i];
+            waitingJobs.removeValue (dependentJob);
+            queueJob (dependentJob);
+        }
+    }
 
-            if (job != nullptr && ! (job->isActive || job->shouldStop))
-                break;
+    job->dependentJobs.clear();
+}
+
+void ThreadPool::jobHasLeftPool (ThreadPoolJob* const job)
+{
+    releaseDependentJobs (job);
+
+    // A thread that's waiting for the job may delete it as soon as it sees that it's
+    // gone, so the job mustn't be touched after this.
+    job->poolState = ThreadPoolJob::notInPool;
+
+    --numJobs;
+    jobFinishedSignal.signal();
+}
+
+void ThreadPool::removeQueuedJobs (JobSelector* const selector, Array <ThreadPoolJob*>& removedJobs)
+{
+    for (int i = 0; i < waitingJobs.size();)
+    {
+        ThreadPoolJob* const job = waitingJobs.getUnchecked (i);
+
+        if (selector == nullptr || selector->isJobSuitable (job))
+        {
+            waitingJobs.remove (i);
+
+            for (int j = job->unfinishedPrerequisites.size(); --j >= 0;)
+                job->unfinishedPrerequisites.getUnchecked (j)->dependentJobs.removeValue (job);
+
+            job->unfinishedPrerequisites.clear();
+            removedJobs.add (job);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    // The incoming jobs are taken first, so any that get moved into a thread's queue
+    // while this is going on will be found when that queue is searched. A job that
+    // gets started after its queue has been searched was left there because it didn't
+    // match, so nothing can slip through.
+    Array <ThreadPoolJob*> incoming;
+    takeAllIncomingJobs (incoming);
+    ThreadPoolHelpers::removeMatchingJobs (incoming, 0, selector, removedJobs);
+
+    for (int i = threads.size(); --i >= 0;)
+    {
+        ThreadPoolThread& thread = *threads.getUnchecked(i);
+
+        const SpinLock::ScopedLockType sl (thread.queueLock);
+        ThreadPoolHelpers::removeMatchingJobs (thread.queue, thread.firstQueuedJob, selector, removedJobs);
+        thread.removeEmptySpace();
+    }
+
+    restoreIncomingJobs (incoming);
+
+    // Only now that all the removed jobs are out of the way can any jobs that were
+    // waiting for them be released.
+    for (int i = 0; i < removedJobs.size(); ++i)
+        jobHasLeftPool (removedJobs.getUnchecked (i));
+}
+
+void ThreadPool::queueJob (ThreadPoolJob* const job)
+{
+    ThreadPoolThread* const currentThread = getCurrentPoolThread();
+
+    if (currentThread != nullptr)
+    {
+        // A job added by one of our own jobs goes on the end of its thread's queue, so
+        // that thread will run it next unless another one steals it first.
+        const SpinLock::ScopedLockType sl (currentThread->queueLock);
+        currentThread->queue.add (job);
+    }
+    else
+    {
+        pushIncomingJob (job);
+    }
+
+    startThreadIfNeeded();
+    wakeIdleThread();
+}
+
+void ThreadPool::pushIncomingJob (ThreadPoolJob* const job)
+{
+    // Jobs only ever come off this stack all at once, so a plain compare-and-swap
+    // push is safe without any ABA protection.
+    for (;;)
+    {
+        ThreadPoolJob* const head = incomingJobs.get();
+        job->nextQueuedJob = head;
+
+        if (incomingJobs.compareAndSetBool (job, head))
+            break;
+    }
+}
+
+void ThreadPool::takeAllIncomingJobs (Array <ThreadPoolJob*>& jobsFound)
+{
+    const int start = jobsFound.size();
+
+    for (ThreadPoolJob* job = incomingJobs.exchange (nullptr); job != nullptr; job = job->nextQueuedJob)
+        jobsFound.add (job);
+
+    // the stack is newest-first, so reverse it to leave them in the order they were added
+    for (int i = start, j = jobsFound.size() - 1; i < j; ++i, --j)
+        jobsFound.swap (i, j);
+}
+
+void ThreadPool::restoreIncomingJobs (const Array <ThreadPoolJob*>& jobsToRestore)
+{
+    for (int i = 0; i < jobsToRestore.size(); ++i)
+        pushIncomingJob (jobsToRestore.getUnchecked (i));
+
+    if (jobsToRestore.size() > 0)
+        wakeIdleThread();
+}
+
+void ThreadPool::getAllJobs (Array <ThreadPoolJob*>& jobsFound, const bool onlyRunningJobs) const
+{
+    ThreadPool& pool = const_cast <ThreadPool&> (*this);
+    const ScopedLock sl (lock);
+
+    Array <ThreadPoolJob*> queuedJobs, incoming;
+
+    if (! onlyRunningJobs)
+    {
+        pool.takeAllIncomingJobs (incoming);
+
+        for (int i = 0; i < threads.size(); ++i)
+        {
+            ThreadPoolThread& thread = *threads.getUnchecked(i);
+
+            const SpinLock::ScopedLockType sl2 (thread.queueLock);
 
-            job = nullptr;
+            for (int j = thread.queue.size(); --j >= thread.firstQueuedJob;)
+                queuedJobs.add (thread.queue.getUnchecked (j));
         }
+    }
+
+    for (int i = 0; i < threads.size(); ++i)
+    {
+        ThreadPoolThread& thread = *threads.getUnchecked(i);
+        const SpinLock::ScopedLockType sl2 (thread.queueLock);
 
-        if (job != nullptr)
-            job->isActive = true;
+        for (ThreadPoolJob* job = thread.currentJob.get(); job != nullptr; job = job->outerRunningJob)
+        {
+            // a job that was still queued when its queue was searched may have started since
+            queuedJobs.removeValue (job);
+            jobsFound.add (job);
+        }
+    }
 
+    if (! onlyRunningJobs)
+    {
+        jobsFound.addArray (queuedJobs);
+        jobsFound.addArray (incoming);
+        jobsFound.addArray (waitingJobs);
+        pool.restoreIncomingJobs (incoming);
     }
+}
 
-    if (job != nullptr)
+bool ThreadPool::isWorkAvailable() const
+{
+    if (incomingJobs.get() != nullptr)
+        return true;
+
+    for (int i = threads.size(); --i >= 0;)
     {
-        JUCE_TRY
+        const ThreadPoolThread& thread = *threads.getUnchecked(i);
+        const SpinLock::ScopedLockType sl (thread.queueLock);
+
+        if (thread.hasQueuedJobs())
+            return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::wakeIdleThread()
+{
+    if (numIdleThreads.get() > 0)
+    {
+        for (int i = 0; i < threads.size(); ++i)
         {
-            ThreadPoolJob::JobStatus result = job->runJob();
+            ThreadPoolThread* const thread = threads.getUnchecked(i);
 
-            lastJobEndTime = Time::getApproximateMillisecondCounter();
+            if (thread->isIdle.compareAndSetBool (0, 1))
+            {
+                --numIdleThreads;
+                thread->notify();
+                break;
+            }
+        }
+    }
+}
 
-            const ScopedLock sl (lock);
+void ThreadPool::startThreadIfNeeded()
+{
+    if (numThreadsRunning.get() < threads.size())
+    {
+        const ScopedLock sl (threadStartLock);
+
+        for (int i = 0; i < threads.size(); ++i)
+        {
+            ThreadPoolThread* const thread = threads.getUnchecked(i);
 
-            if (jobs.contains (job))
+            if (! thread->isStarted)
             {
-                job->isActive = false;
-
-                if (result != ThreadPoolJob::jobNeedsRunningAgain || job->shouldStop)
-                {
-                    job->pool = nullptr;
-                    job->shouldStop = true;
-                    jobs.removeValue (job);
-
-                    if (result == ThreadPoolJob::jobHasFinishedAndShouldBeDeleted)
-                        delete job;
-
-                    jobFinishedSignal.signal();
-                }
-                else
-                {
-                    // move the job to the end of the queue if it wants another go
-                    jobs.move (jobs.indexOf (job), -1);
-                }
+                // it may have only just stopped itself, and still be on its way out
+                thread->waitForThreadToExit (-1);
+
+                thread->isStarted = true;
+                ++numThreadsRunning;
+                thread->startThread (priority);
+                break;
             }
         }
-#if JUCE_CATCH_UNHANDLED_EXCEPTIONS
-        catch (...)
+    }
+}
+
+bool ThreadPool::stopIdleThread (ThreadPoolThread& thread)
+{
+    if (threadStopTimeout > 0
+         && Time::getApproximateMillisecondCounter() > lastJobEndTime + threadStopTimeout)
+    {
+        const ScopedLock sl (threadStartLock);
+
+        // The count is dropped before checking for jobs, so that anything added at the same
+        // moment will either be seen here or will see that it needs to start a thread.
+        --numThreadsRunning;
+
+        if (numJobs.get() == 0)
         {
-            const ScopedLock sl (lock);
-            jobs.removeValue (job);
+            thread.isStarted = false;
+            return true;
         }
-#endif
+
+        ++numThreadsRunning;
     }
-    else
+
+    return false;
+}
+
+ThreadPool::ThreadPoolThread* ThreadPool::getCurrentPoolThread() const
+{
+    const Thread::ThreadID currentThreadId = Thread::getCurrentThreadId();
+
+    for (int i = threads.size(); --i >= 0;)
+        if (threads.getUnchecked(i)->getThreadId() == currentThreadId)
+            return threads.getUnchecked(i);
+
+    return nullptr;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+#include "../utilities/juce_UnitTest.h"
+
+class ThreadPoolTests  : public UnitTest
+{
+public:
+    ThreadPoolTests() : UnitTest ("ThreadPool") {}
+
+    class CountingJob  : public ThreadPoolJob
+    {
+    public:
+        CountingJob (Atomic<int>& counter_)  : ThreadPoolJob ("count"), counter (counter_) {}
+
+        JobStatus runJob()      { ++counter; return jobHasFinished; }
+
+    private:
+        Atomic<int>& counter;
+    };
+
+    class OrderedJob  : public ThreadPoolJob
     {
-        if (threadStopTimeout > 0
-             && Time::getApproximateMillisecondCounter() > lastJobEndTime + threadStopTimeout)
+    public:
+        OrderedJob (Array<int, CriticalSection>& order_, int id_)
+            : ThreadPoolJob ("order"), order (order_), id (id_)
         {
-            const ScopedLock sl (lock);
+        }
+
+        JobStatus runJob()      { order.add (id); return jobHasFinished; }
+
+    private:
+        Array<int, CriticalSection>& order;
+        const int id;
+    };
 
-            if (jobs.size() == 0)
-                for (int i = threads.size(); --i >= 0;)
-                    threads.getUnchecked(i)->signalThreadShouldExit();
+    class ForkingJob  : public ThreadPoolJob
+    {
+    public:
+        ForkingJob (ThreadPool& pool_, Atomic<int>& counter_)
+            : ThreadPoolJob ("fork"), pool (pool_), counter (counter_)
+        {
         }
-        else
+
+        JobStatus runJob()
         {
-            return false;
+            OwnedArray<CountingJob> children;
+
+            for (int i = 0; i < 20; ++i)
+            {
+                children.add (new CountingJob (counter));
+                pool.addJob (children.getLast());
+            }
+
+            for (int i = 0; i < children.size(); ++i)
+                pool.waitForJobToFinish (children.getUnchecked(i), -1);
+
+            return jobHasFinished;
+        }
+
+    private:
+        ThreadPool& pool;
+        Atomic<int>& counter;
+    };
+
+    void runTest()
+    {
+        ThreadPool pool (3);
+        Atomic<int> counter;
+
+        beginTest ("Many small jobs");
+
+        OwnedArray<CountingJob> jobs;
+
+        for (int i = 0; i < 2000; ++i)
+        {
+            jobs.add (new CountingJob (counter));
+            pool.addJob (jobs.getLast());
+        }
+
+        for (int i = 0; i < jobs.size(); ++i)
+            expect (pool.waitForJobToFinish (jobs.getUnchecked(i), 10000));
+
+        expectEquals (counter.get(), 2000);
+        expectEquals (pool.getNumJobs(), 0);
+
+        beginTest ("Continuations");
+
+        Array<int, CriticalSection> order;
+        OwnedArray<OrderedJob> chain;
+
+        for (int i = 0; i < 20; ++i)
+        {
+            Array<ThreadPoolJob*> prerequisites;
+            prerequisites.add (chain.getLast());
+
+            chain.add (new OrderedJob (order, i));
+            pool.addJobAfter (chain.getLast(), prerequisites);
         }
+
+        expect (pool.waitForJobToFinish (chain.getLast(), 10000));
+        expectEquals (order.size(), 20);
+
+        for (int i = 0; i < order.size(); ++i)
+            expectEquals (order[i], i);
+
+        beginTest ("Waiting from inside a job");
+
+        counter = 0;
+        OwnedArray<ForkingJob> forks;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            forks.add (new ForkingJob (pool, counter));
+            pool.addJob (forks.getLast());
+        }
+
+        for (int i = 0; i < forks.size(); ++i)
+            expect (pool.waitForJobToFinish (forks.getUnchecked(i), 10000));
+
+        expectEquals (counter.get(), 80);
+
+        beginTest ("Removing jobs");
+
+        jobs.clear();
+
+        for (int i = 0; i < 500; ++i)
+        {
+            jobs.add (new CountingJob (counter));
+            pool.addJob (jobs.getLast());
+        }
+
+        Array<ThreadPoolJob*> prerequisites;
+        prerequisites.add (jobs.getLast());
+        CountingJob dependentJob (counter);
+        pool.addJobAfter (&dependentJob, prerequisites);
+
+        expect (pool.removeAllJobs (true, 10000));
+        expectEquals (pool.getNumJobs(), 0);
+        expect (! pool.contains (&dependentJob));
     }
+};
 
-    return true;
-}
+static ThreadPoolTests threadPoolTests;
+
+#endif
 
 END_JUCE_NAMESPACE
@@ -30,6 +30,7 @@
 #include "../text/juce_StringArray.h"
 #include "../containers/juce_Array.h"
 #include "../containers/juce_OwnedArray.h"
+#include "../memory/juce_Atomic.h"
 class ThreadPool;
 class ThreadPoolThread;
 
@@ -130,7 +131,18 @@ private:
     friend class ThreadPoolThread;
     String jobName;
     ThreadPool* pool;
+
+    /** Whether the job's in a pool. This is what ThreadPool::contains() looks at, so it's
+        the last thing to change when a job leaves, and a job that's on its way out can't
+        be given any new dependents.
+    */
+    enum PoolState { notInPool = 0, inPool, inPoolWithDependents, leavingPool };
+    Atomic <int> poolState;
+
     bool shouldStop, isActive, shouldBeDeleted;
+    ThreadPoolJob* nextQueuedJob;
+    ThreadPoolJob* outerRunningJob;
+    Array <ThreadPoolJob*> unfinishedPrerequisites, dependentJobs;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPoolJob);
 };
@@ -143,6 +155,13 @@ private:
     When a ThreadPoolJob object is added to the ThreadPool's list, its run() method
     will be called by the next pooled thread that becomes free.
 
+    Each thread keeps its own queue of jobs and takes work from the other threads'
+    queues when its own runs dry, so adding jobs never blocks, and jobs that are added
+    from inside a running job are picked up by the same thread while they're still hot
+    in its cache. Jobs can also be held back until others have finished with
+    addJobAfter(), and a job that calls waitForJobToFinish() will help run the queued
+    jobs rather than just blocking its thread.
+
     @see ThreadPoolJob, Thread
 */
 class JUCE_API  ThreadPool
@@ -203,6 +222,21 @@ public:
     */
     void addJob (ThreadPoolJob* job);
 
+    /** Adds a job that will only be started once some other jobs have finished.
+
+        The job is held back until every one of the prerequisite jobs has either
+        finished or been removed from the pool, and then it's queued as if it had been
+        passed to addJob(). Any prerequisites that aren't currently in this pool are
+        ignored, so if none of them are still pending, the job is queued straight away.
+
+        While it's waiting, the job counts as one of the pool's jobs, so it can be
+        found with getJob() or removed with removeJob() like any other queued job.
+
+        As with contains(), the prerequisites mustn't be jobs that might already have
+        deleted themselves.
+    */
+    void addJobAfter (ThreadPoolJob* job, const Array <ThreadPoolJob*>& prerequisites);
+
     /** Tries to remove a job from the pool.
 
         If the job isn't yet running, this will simply remove it. If it is running, it
@@ -257,6 +291,9 @@ public:
 
     /** Returns true if the given job is currently queued or running.
 
+        This looks at the job object itself, so it mustn't be used on a job that might
+        already have deleted itself by returning ThreadPoolJob::jobHasFinishedAndShouldBeDeleted.
+
         @see isJobRunning()
     */
     bool contains (const ThreadPoolJob* job) const;
@@ -270,8 +307,13 @@ public:
         This will wait until the job is no longer in the pool - i.e. until its
         runJob() method returns ThreadPoolJob::jobHasFinished.
 
+        If this is called from inside one of this pool's jobs, the calling thread will
+        carry on running other queued jobs while it waits, so a job can split its work
+        into smaller jobs and wait for them without tying up a thread.
+
         If the timeout period expires before the job finishes, this will return false;
-        it returns true if the job has finished successfully.
+        it returns true if the job has finished successfully. As with contains(), the job
+        mustn't be one that deletes itself when it finishes.
     */
     bool waitForJobToFinish (const ThreadPoolJob* job,
                              int timeOutMilliseconds) const;
@@ -297,14 +339,32 @@ private:
     class ThreadPoolThread;
     friend class OwnedArray <ThreadPoolThread>;
     OwnedArray <ThreadPoolThread> threads;
-    Array <ThreadPoolJob*> jobs;
 
-    CriticalSection lock;
+    Atomic <ThreadPoolJob*> incomingJobs;
+    Atomic <int> numJobs, numThreadsRunning, numIdleThreads;
+    Array <ThreadPoolJob*> waitingJobs;
+
+    CriticalSection lock, threadStartLock;
     uint32 lastJobEndTime;
     WaitableEvent jobFinishedSignal;
 
     friend class ThreadPoolThread;
-    bool runNextJob();
+    bool runNextJob (ThreadPoolThread&);
+    ThreadPoolJob* takeNextJob (ThreadPoolThread&);
+    void finishJob (ThreadPoolThread&, ThreadPoolJob*, ThreadPoolJob::JobStatus);
+    void releaseDependentJobs (ThreadPoolJob*);
+    void jobHasLeftPool (ThreadPoolJob*);
+    void removeQueuedJobs (JobSelector*, Array <ThreadPoolJob*>& removedJobs);
+    void queueJob (ThreadPoolJob*);
+    void pushIncomingJob (ThreadPoolJob*);
+    void takeAllIncomingJobs (Array <ThreadPoolJob*>&);
+    void restoreIncomingJobs (const Array <ThreadPoolJob*>&);
+    void getAllJobs (Array <ThreadPoolJob*>&, bool onlyRunningJobs) const;
+    bool isWorkAvailable() const;
+    void wakeIdleThread();
+    void startThreadIfNeeded();
+    bool stopIdleThread (ThreadPoolThread&);
+    ThreadPoolThread* getCurrentPoolThread() const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadPool);
 };
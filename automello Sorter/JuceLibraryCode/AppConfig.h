@@ -0,0 +1,41 @@
+/*
+
+    IMPORTANT! This file is auto-generated by the Jucer each time you save your
+    project - if you alter its contents, your changes may be overwritten!
+
+    If you want to change any of these values, use the Jucer to do so, rather than
+    editing this file directly!
+
+    Any commented-out settings will fall back to using the default values that
+    they are given in juce_Config.h
+
+*/
+
+//#define  JUCE_FORCE_DEBUG
+//#define  JUCE_LOG_ASSERTIONS
+//#define  JUCE_ASIO
+//#define  JUCE_WASAPI
+//#define  JUCE_DIRECTSOUND
+//#define  JUCE_DIRECTSHOW
+//#define  JUCE_MEDIAFOUNDATION
+//#define  JUCE_ALSA
+#define    JUCE_QUICKTIME 0
+//#define  JUCE_OPENGL
+//#define  JUCE_DIRECT2D
+//#define  JUCE_USE_FLAC
+//#define  JUCE_USE_OGGVORBIS
+//#define  JUCE_USE_CDBURNER
+//#define  JUCE_USE_CDREADER
+//#define  JUCE_USE_CAMERA
+//#define  JUCE_ENABLE_REPAINT_DEBUGGING
+//#define  JUCE_USE_XINERAMA
+//#define  JUCE_USE_XSHM
+//#define  JUCE_USE_XRENDER
+//#define  JUCE_USE_XCURSOR
+//#define  JUCE_PLUGINHOST_VST
+//#define  JUCE_PLUGINHOST_AU
+//#define  JUCE_ONLY_BUILD_CORE_LIBRARY
+//#define  JUCE_WEB_BROWSER
+//#define  JUCE_SUPPORT_CARBON
+//#define  JUCE_CHECK_MEMORY_LEAKS
+//#define  JUCE_CATCH_UNHANDLED_EXCEPTIONS
@@ -0,0 +1,15 @@
+/*
+
+    IMPORTANT! This file is auto-generated by the Jucer each time you save your
+    project - if you alter its contents, your changes may be overwritten!
+
+    This file pulls in all the Juce source code, and builds it using the settings
+    defined in AppConfig.h.
+
+    If you want to change the method by which Juce is linked into your app, use the
+    Jucer to change it, rather than trying to edit this file directly.
+
+*/
+
+#include "AppConfig.h"
+#include "../../automello Plugin/juce/amalgamation/juce_amalgamated3.cpp"
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Command-line front end for the TonalitySorter: builds a dataset for the plugin
+    out of a directory of candidate snippets.
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "TonalitySorter.h"
+#include <stdio.h>
+
+//==============================================================================
+int main( int argc, char* argv[] )
+{
+  if (argc < 3)
+  {
+    printf( "Usage: %s snippetDirectory outputDirectory [numThreads]\n", argv[0] );
+    return -1;
+  }
+
+  const File snippetDirectory( File::getCurrentWorkingDirectory().getChildFile( argv[1] ) );
+  const File destinationDirectory( File::getCurrentWorkingDirectory().getChildFile( argv[2] ) );
+  const int numThreads = argc > 3 ? String( argv[3] ).getIntValue() : SystemStats::getNumCpus();
+
+  printf( "Sorting %s...\n", snippetDirectory.getFullPathName().toUTF8().getAddress() );
+
+  TonalitySorter sorter;
+  const Result result( sorter.sortFiles( snippetDirectory, destinationDirectory, numThreads ) );
+
+  if (result.failed())
+  {
+    fprintf( stderr, "ERROR: %s\n", result.getErrorMessage().toUTF8().getAddress() );
+    return 1;
+  }
+
+  printf( "\nSamples written to %s\n", destinationDirectory.getFullPathName().toUTF8().getAddress() );
+  return 0;
+}
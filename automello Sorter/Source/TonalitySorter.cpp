@@ -0,0 +1,507 @@
+/*
+  ==============================================================================
+
+    TonalitySorter.cpp
+
+  ==============================================================================
+*/
+
+#include "TonalitySorter.h"
+#include <complex>
+
+namespace
+{
+  // A file's pitch has to be within this fraction of a note's frequency for it to be used
+  const double pitchTolerance = 0.05;
+  // The number of the most tonal files that get their pitch checked for each note
+  const int pitchesToRun = 6;
+
+  typedef std::complex<double> Complex;
+
+  double midiToHz( const double midiNote )
+  {
+    return 440.0 * std::pow( 2.0, (midiNote - 69.0) / 12.0 );
+  }
+
+  int nextPowerOfTwo( const int n )
+  {
+    int size = 1;
+    while (size < n)
+      size <<= 1;
+    return size;
+  }
+
+  // Rounds halves to the nearest even number, like numpy does
+  int roundHalfToEven( const double value )
+  {
+    double rounded = std::floor( value );
+    const double fraction = value - rounded;
+    if (fraction > 0.5 || (fraction == 0.5 && std::fmod( rounded, 2.0 ) != 0.0))
+      rounded += 1.0;
+    return (int) rounded;
+  }
+
+  //==============================================================================
+  // In-place radix-2 FFT.  The size has to be a power of two, and the inverse isn't scaled.
+  void performFFT( Complex* data, const int size, const bool inverse )
+  {
+    for (int i = 1, j = 0; i < size; ++i)
+    {
+      int bit = size >> 1;
+      for (; (j & bit) != 0; bit >>= 1)
+        j ^= bit;
+      j ^= bit;
+
+      if (i < j)
+        std::swap( data[i], data[j] );
+    }
+
+    // The twiddle factors are worked out directly rather than by repeated multiplication,
+    // so that long transforms stay accurate
+    HeapBlock<Complex> twiddles( jmax( 1, size / 2 ) );
+    for (int i = 0; i < size / 2; ++i)
+    {
+      const double angle = (inverse ? 2.0 : -2.0) * double_Pi * i / size;
+      twiddles[i] = Complex( std::cos( angle ), std::sin( angle ) );
+    }
+
+    for (int length = 2; length <= size; length <<= 1)
+    {
+      const int half = length / 2;
+      const int stride = size / length;
+
+      for (int start = 0; start < size; start += length)
+      {
+        for (int k = 0; k < half; ++k)
+        {
+          const Complex even( data[start + k] );
+          const Complex odd( data[start + k + half] * twiddles[k * stride] );
+          data[start + k] = even + odd;
+          data[start + k + half] = even - odd;
+        }
+      }
+    }
+  }
+
+  // Writes the magnitudes of bins 0 to numSamples / 2 of the DFT of some real data, which
+  // can be any length (this uses Bluestein's algorithm, so it matches numpy's rfft for
+  // lengths that aren't a power of two)
+  void getMagnitudeSpectrum( const double* data, const int numSamples, double* magnitudes )
+  {
+    const int size = nextPowerOfTwo( 2 * numSamples - 1 );
+
+    HeapBlock<Complex> chirp( numSamples ), a, b;
+    a.calloc( size );
+    b.calloc( size );
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+      // (i * i is wrapped to keep the angle small enough to be accurate)
+      const double angle = double_Pi * (double) (((int64) i * i) % (2 * numSamples)) / numSamples;
+      chirp[i] = Complex( std::cos( angle ), -std::sin( angle ) );
+      a[i] = data[i] * chirp[i];
+    }
+
+    b[0] = std::conj( chirp[0] );
+    for (int i = 1; i < numSamples; ++i)
+      b[i] = b[size - i] = std::conj( chirp[i] );
+
+    performFFT( a, size, false );
+    performFFT( b, size, false );
+    for (int i = 0; i < size; ++i)
+      a[i] *= b[i];
+    performFFT( a, size, true );
+
+    for (int i = 0; i <= numSamples / 2; ++i)
+      magnitudes[i] = std::abs( a[i] * chirp[i] ) / size;
+  }
+
+  //==============================================================================
+  // Sorts file indexes the way that np.argsort( scores )[::-1] does
+  class ScoreComparator
+  {
+  public:
+    ScoreComparator( const Array<double>& scores_ )
+      : scores( scores_ )
+    {
+    }
+
+    int compareElements( const int first, const int second ) const
+    {
+      if (scores[first] != scores[second])
+        return scores[first] > scores[second] ? -1 : 1;
+      return second - first;
+    }
+
+  private:
+    const Array<double>& scores;
+
+    JUCE_DECLARE_NON_COPYABLE (ScoreComparator);
+  };
+
+  class FileComparator
+  {
+  public:
+    static int compareElements( const File& first, const File& second )
+    {
+      return first.getFullPathName().compare( second.getFullPathName() );
+    }
+  };
+}
+
+//==============================================================================
+// Reads one file and either scores it for every note, or finds its pitch
+class TonalitySorter::AnalysisJob  : public ThreadPoolJob
+{
+public:
+  AnalysisJob( const TonalitySorter& owner_, const File& file_, const bool findPitch_ )
+    : ThreadPoolJob( file_.getFileName() ),
+      owner( owner_ ),
+      file( file_ ),
+      findPitch( findPitch_ ),
+      pitch( 0.0 )
+  {
+  }
+
+  JobStatus runJob()
+  {
+    HeapBlock<double> audio;
+    int numSamples = 0;
+    double fileSampleRate = 0.0;
+
+    if (! readAudio( file, audio, numSamples, fileSampleRate ))
+    {
+      error = "Couldn't read " + file.getFullPathName();
+    }
+    else if (fileSampleRate != owner.sampleRate)
+    {
+      error = file.getFullPathName() + " is at " + String( fileSampleRate )
+                + " Hz, but the snippets need to be at " + String( owner.sampleRate ) + " Hz";
+    }
+    else if (findPitch)
+    {
+      pitch = owner.yinPitchDetect( audio, numSamples );
+    }
+    else
+    {
+      scores.malloc( owner.numNotes );
+      owner.getTonality( audio, numSamples, scores );
+    }
+
+    return jobHasFinished;
+  }
+
+  const TonalitySorter& owner;
+  const File file;
+  const bool findPitch;
+  HeapBlock<double> scores;
+  double pitch;
+  String error;
+
+private:
+  JUCE_DECLARE_NON_COPYABLE (AnalysisJob);
+};
+
+//==============================================================================
+TonalitySorter::TonalitySorter( double sampleRate_, int numNotes_, int baseNote_ )
+  : sampleRate( sampleRate_ ),
+    numNotes( numNotes_ ),
+    baseNote( baseNote_ )
+{
+}
+
+Result TonalitySorter::sortFiles( const File& snippetDirectory, const File& destinationDirectory, int numThreads )
+{
+  Array<File> files;
+  snippetDirectory.findChildFiles( files, File::findFiles, true, "*.wav" );
+  FileComparator fileComparator;
+  files.sort( fileComparator );
+
+  const int numFiles = files.size();
+  if (numFiles == 0)
+    return Result::fail( "No .wav files were found in " + snippetDirectory.getFullPathName() );
+
+  if (! destinationDirectory.createDirectory())
+    return Result::fail( "Couldn't create " + destinationDirectory.getFullPathName() );
+
+  ThreadPool pool( jmax( 1, numThreads ) );
+
+  // Score every file for every note...
+  OwnedArray<AnalysisJob> tonalityJobs;
+  for (int i = 0; i < numFiles; ++i)
+  {
+    tonalityJobs.add( new AnalysisJob( *this, files.getReference( i ), false ) );
+    pool.addJob( tonalityJobs.getLast() );
+  }
+
+  for (int i = 0; i < numFiles; ++i)
+  {
+    pool.waitForJobToFinish( tonalityJobs.getUnchecked( i ), -1 );
+    if (tonalityJobs.getUnchecked( i )->error.isNotEmpty())
+    {
+      pool.removeAllJobs( true, 10000 );
+      return Result::fail( tonalityJobs.getUnchecked( i )->error );
+    }
+  }
+
+  // ...and rank the files for each note, most tonal first
+  HeapBlock<int> rankings( numNotes * numFiles );
+  for (int note = 0; note < numNotes; ++note)
+  {
+    Array<double> scores;
+    Array<int> ranking;
+    for (int i = 0; i < numFiles; ++i)
+    {
+      scores.add( tonalityJobs.getUnchecked( i )->scores[note] );
+      ranking.add( i );
+    }
+
+    ScoreComparator scoreComparator( scores );
+    ranking.sort( scoreComparator, true );
+
+    for (int i = 0; i < numFiles; ++i)
+      rankings[note * numFiles + i] = ranking.getUnchecked( i );
+  }
+
+  // Which of the top few files for a note get their pitch checked depends on the pitches
+  // that are found, so all of the top few for every note are checked at once up front
+  HashMap<int, AnalysisJob*> pitchJobsForFiles;
+  OwnedArray<AnalysisJob> pitchJobs;
+  for (int note = 0; note < numNotes; ++note)
+  {
+    for (int i = 0; i < jmin( pitchesToRun, numFiles ); ++i)
+    {
+      const int fileIndex = rankings[note * numFiles + i];
+      if (! pitchJobsForFiles.contains( fileIndex ))
+      {
+        AnalysisJob* const job = new AnalysisJob( *this, files.getReference( fileIndex ), true );
+        pitchJobs.add( job );
+        pitchJobsForFiles.set( fileIndex, job );
+        pool.addJob( job );
+      }
+    }
+  }
+
+  for (int i = 0; i < pitchJobs.size(); ++i)
+    pool.waitForJobToFinish( pitchJobs.getUnchecked( i ), -1 );
+
+  // Pick a file for each note in the same way that the Python sorter does
+  for (int note = 0; note < numNotes; ++note)
+  {
+    const int* const ranking = rankings + note * numFiles;
+    const double targetHz = midiToHz( baseNote + note );
+    double detectedHz = 1.0;
+    int sortedIndex = 0;
+
+    // Go down the rankings until a file's pitch is close enough to the note's
+    while ((targetHz / detectedHz < 1.0 - pitchTolerance || targetHz / detectedHz > 1.0 + pitchTolerance)
+             && sortedIndex < numFiles && sortedIndex < pitchesToRun)
+    {
+      detectedHz = pitchJobsForFiles[ranking[sortedIndex]]->pitch;
+      ++sortedIndex;
+    }
+
+    // (if every file had to be checked, the most tonal one gets used, whatever its pitch)
+    const File& chosenFile = files.getReference( sortedIndex < numFiles ? ranking[sortedIndex - 1] : ranking[0] );
+    const File destinationFile( destinationDirectory.getChildFile( String( baseNote + note ) + ".wav" ) );
+
+    if (! chosenFile.copyFileTo( destinationFile ))
+      return Result::fail( "Couldn't write " + destinationFile.getFullPathName() );
+  }
+
+  return Result::ok();
+}
+
+//==============================================================================
+bool TonalitySorter::readAudio( const File& file, HeapBlock<double>& audio, int& numSamples, double& fileSampleRate )
+{
+  WavAudioFormat wavFormat;
+  ScopedPointer<AudioFormatReader> reader( wavFormat.createReaderFor( new FileInputStream( file ), true ) );
+
+  if (reader == nullptr || reader->lengthInSamples <= 0)
+    return false;
+
+  numSamples = (int) reader->lengthInSamples;
+  fileSampleRate = reader->sampleRate;
+
+  const int numChannels = jmin( 2, (int) reader->numChannels );
+  AudioSampleBuffer buffer( numChannels, numSamples );
+  buffer.readFromAudioReader( reader, 0, numSamples, 0, true, numChannels > 1 );
+
+  audio.malloc( numSamples );
+  double peak = 0.0;
+  for (int i = 0; i < numSamples; ++i)
+  {
+    double sample = buffer.getSampleData( 0 )[i];
+    if (numChannels > 1)
+      sample = (sample + buffer.getSampleData( 1 )[i]) / 2.0;
+
+    audio[i] = sample;
+    peak = jmax( peak, std::abs( sample ) );
+  }
+
+  if (peak > 0.0)
+  {
+    for (int i = 0; i < numSamples; ++i)
+      audio[i] = 32767.0 * audio[i] / peak;
+  }
+
+  return true;
+}
+
+void TonalitySorter::getTonality( const double* audio, int numSamples, double* scores ) const
+{
+  const int numBins = numSamples / 2 + 1;
+  HeapBlock<double> spectrum( numBins );
+  getMagnitudeSpectrum( audio, numSamples, spectrum );
+
+  double sumOfSquares = 0.0;
+  for (int i = 0; i < numSamples; ++i)
+    sumOfSquares += audio[i] * audio[i];
+  const double rms = std::sqrt( sumOfSquares ) / numSamples;
+
+  // The Python version's masks are numSamples / 2 - 1 bins long, so the top two bins
+  // never get looked at
+  const int numMaskBins = jmax( 0, numSamples / 2 - 1 );
+  double totalOfMaskBins = 0.0;
+  for (int i = 0; i < numMaskBins; ++i)
+    totalOfMaskBins += spectrum[i];
+
+  // No harmonics above here are looked at
+  const double maxFrequency = jmin( midiToHz( baseNote + numNotes + 24 ), sampleRate * 0.9 / 2.0 );
+
+  HeapBlock<bool> isHarmonicBin;
+  isHarmonicBin.calloc( jmax( 1, numMaskBins ) );
+  Array<int> harmonicBins;
+
+  for (int note = 0; note < numNotes; ++note)
+  {
+    const double baseFrequency = midiToHz( baseNote + note );
+
+    for (int harmonic = 0; harmonic < 4; ++harmonic)
+    {
+      const double frequency = baseFrequency * (1 << harmonic);
+      if (frequency > maxFrequency)
+        break;
+
+      // Every bin from 2% below the harmonic to 2% above it, in steps of one bin from the
+      // bottom and then rounded, as utility.hzToBins does
+      const double lowestBin = 0.98 * frequency * numSamples / sampleRate;
+      const double highestBin = 1.02 * frequency * numSamples / sampleRate;
+      const int numSteps = (int) std::ceil( highestBin - lowestBin );
+
+      for (int i = 0; i < numSteps; ++i)
+      {
+        const int bin = roundHalfToEven( lowestBin + i );
+        if (isPositiveAndBelow( bin, numMaskBins ) && ! isHarmonicBin[bin])
+        {
+          isHarmonicBin[bin] = true;
+          harmonicBins.add( bin );
+        }
+      }
+    }
+
+    const int numOtherBins = numMaskBins - harmonicBins.size();
+    if (harmonicBins.size() == 0 || numOtherBins == 0)
+    {
+      scores[note] = 0.0;
+    }
+    else
+    {
+      double loudestHarmonic = 0.0, totalOfHarmonics = 0.0;
+      for (int i = 0; i < harmonicBins.size(); ++i)
+      {
+        const double magnitude = spectrum[harmonicBins.getUnchecked( i )];
+        loudestHarmonic = jmax( loudestHarmonic, magnitude );
+        totalOfHarmonics += magnitude;
+      }
+
+      const double meanOfOtherBins = (totalOfMaskBins - totalOfHarmonics) / numOtherBins;
+      scores[note] = (loudestHarmonic / meanOfOtherBins) * rms;
+    }
+
+    for (int i = 0; i < harmonicBins.size(); ++i)
+      isHarmonicBin[harmonicBins.getUnchecked( i )] = false;
+    harmonicBins.clearQuick();
+  }
+}
+
+double TonalitySorter::yinPitchDetect( const double* frame, int numSamples, double threshold ) const
+{
+  const int windowSize = numSamples / 2;
+  const int numLags = numSamples - windowSize;
+  if (windowSize < 1 || numLags < 3)
+    return 0.0;
+
+  // The squared difference between the window and the frame at each lag is expanded into
+  // the energy of the window, the energy of the lagged part of the frame, and their
+  // cross-correlation, which is worked out with FFTs
+  const int size = nextPowerOfTwo( numSamples + windowSize );
+  HeapBlock<Complex> frameSpectrum, windowSpectrum;
+  frameSpectrum.calloc( size );
+  windowSpectrum.calloc( size );
+
+  for (int i = 0; i < numSamples; ++i)
+    frameSpectrum[i] = frame[i];
+  for (int i = 0; i < windowSize; ++i)
+    windowSpectrum[i] = frame[i];
+
+  performFFT( frameSpectrum, size, false );
+  performFFT( windowSpectrum, size, false );
+  for (int i = 0; i < size; ++i)
+    frameSpectrum[i] *= std::conj( windowSpectrum[i] );
+  performFFT( frameSpectrum, size, true );
+
+  HeapBlock<double> energies( numSamples + 1 );
+  energies[0] = 0.0;
+  for (int i = 0; i < numSamples; ++i)
+    energies[i + 1] = energies[i] + frame[i] * frame[i];
+
+  // The cumulative-mean-normalised difference, which (like the Python version) divides by
+  // the mean of the differences before each lag, not including the lag itself
+  HeapBlock<double> normalised( numLags );
+  normalised[0] = 1.0;
+  double runningTotal = 0.0;
+
+  for (int lag = 1; lag < numLags; ++lag)
+  {
+    const double crossCorrelation = frameSpectrum[lag].real() / size;
+    const double difference = jmax( 0.0, energies[windowSize] + (energies[lag + windowSize] - energies[lag])
+                                            - 2.0 * crossCorrelation );
+
+    normalised[lag] = difference / (runningTotal / lag);
+    runningTotal += difference;
+  }
+
+  // Use the first dip that's below the threshold...
+  int bestLag = 0;
+  for (int lag = 1; lag < numLags - 1; ++lag)
+  {
+    if (normalised[lag - 1] > normalised[lag] && normalised[lag + 1] > normalised[lag]
+          && normalised[lag] < threshold)
+    {
+      bestLag = lag;
+      break;
+    }
+  }
+
+  // ...or failing that, the lowest point.  The Python version takes this index from a
+  // slice that starts at lag 1 without adding the 1 back on, so the same is done here
+  // to get the same estimates.
+  if (bestLag == 0)
+  {
+    for (int lag = 2; lag < numLags - 1; ++lag)
+    {
+      if (normalised[lag] < normalised[bestLag + 1])
+        bestLag = lag - 1;
+    }
+  }
+
+  // Parabolic interpolation around the chosen lag (where lag -1 wraps round to the end,
+  // as a negative index does in Python)
+  const double previous = normalised[bestLag > 0 ? bestLag - 1 : numLags - 1];
+  const double next = normalised[bestLag + 1];
+  const double peakOffset = (next - previous) / (2.0 * (2.0 * normalised[bestLag] - next - previous));
+
+  return sampleRate / (bestLag + peakOffset);
+}
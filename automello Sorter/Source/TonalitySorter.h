@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    TonalitySorter.h
+
+    Picks the best snippet for each MIDI note out of a directory of candidate
+    snippets.  This is a native port of monophonic_tonality_sorter.py.
+
+  ==============================================================================
+*/
+
+#ifndef __TONALITYSORTER_H_7F3A91C2__
+#define __TONALITYSORTER_H_7F3A91C2__
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+
+//==============================================================================
+/**
+    Scores every snippet for how strongly it sounds each note, checks the pitch of the
+    best-scoring snippets for each note with YIN, and copies the winner to
+    <midiNote>.wav in the destination directory - the layout that the plugin loads.
+
+    The scores, the pitch estimates and the files that get picked are all the same as the
+    Python sorter's.  The spectra and the YIN difference functions are worked out with
+    FFTs though, and the files are analysed on a pool of threads.
+*/
+class TonalitySorter
+{
+public:
+  //==============================================================================
+  TonalitySorter( double sampleRate = 44100.0, int numNotes = 72, int baseNote = 24 );
+
+  // Sorts all the .wav files in snippetDirectory (and its subdirectories) and writes
+  // the dataset, using up to numThreads threads for the analysis
+  Result sortFiles( const File& snippetDirectory, const File& destinationDirectory, int numThreads );
+
+  //==============================================================================
+  // Reads a wav file as utility.getWavData does: the first two channels are mixed down,
+  // and the result is normalised to a peak of 32767
+  static bool readAudio( const File& file, HeapBlock<double>& audio, int& numSamples, double& fileSampleRate );
+
+  // Writes one score per note into scores: the loudest bin around the note's first four
+  // harmonics, divided by the mean of all the other bins, and multiplied by the RMS
+  void getTonality( const double* audio, int numSamples, double* scores ) const;
+
+  // Returns the pitch of a frame in Hz, found with YIN using the first half of the frame
+  // as the window
+  double yinPitchDetect( const double* frame, int numSamples, double threshold = 0.15 ) const;
+
+  int getNumNotes() const     { return numNotes; }
+  int getBaseNote() const     { return baseNote; }
+
+private:
+  //==============================================================================
+  class AnalysisJob;
+
+  const double sampleRate;
+  const int numNotes, baseNote;
+
+  JUCE_DECLARE_NON_COPYABLE (TonalitySorter);
+};
+
+
+#endif  // __TONALITYSORTER_H_7F3A91C2__